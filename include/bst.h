@@ -1,17 +1,18 @@
 #ifndef BST_H
 #define BST_H
 
+#include "bst_writer.h"
 #include <stddef.h>
 
 /**
- * BST Node structure
- * Represents a single node in the Binary Search Tree containing a city name
+ * BST Node (opaque)
+ * Represents a single node in the Binary Search Tree containing a city name.
+ * The tree is kept AVL-balanced by bst_insert and bst_remove, so its height
+ * stays O(log n) even when cities arrive in sorted order. Every node also
+ * tracks its subtree size, which makes counting and rank/select cheap.
+ * The layout is private to the core module; use the bst_node_* accessors.
  */
-typedef struct BSTNode {
-    char *city;              // City name (dynamically allocated)
-    struct BSTNode *left;    // Left child (cities alphabetically before this city)
-    struct BSTNode *right;   // Right child (cities alphabetically after this city)
-} BSTNode;
+typedef struct BSTNode BSTNode;
 
 /**
  * Create a new BST node with the given city name
@@ -21,13 +22,44 @@ typedef struct BSTNode {
 BSTNode *bst_create_node(const char *city);
 
 /**
- * Insert a city into the BST
+ * Get the city name stored in a node
+ * @param node The node to inspect
+ * @return The city name (owned by the node), or NULL if node is NULL
+ */
+const char *bst_node_city(const BSTNode *node);
+
+/**
+ * Get the left child of a node (cities alphabetically before this city)
+ * @param node The node to inspect
+ * @return The left child, or NULL if there is none or node is NULL
+ */
+BSTNode *bst_node_left(const BSTNode *node);
+
+/**
+ * Get the right child of a node (cities alphabetically after this city)
+ * @param node The node to inspect
+ * @return The right child, or NULL if there is none or node is NULL
+ */
+BSTNode *bst_node_right(const BSTNode *node);
+
+/**
+ * Insert a city into the BST, rebalancing on the way back up
  * @param root Pointer to the root of the BST (or NULL for empty tree)
  * @param city The city name to insert
- * @return Pointer to the root of the modified BST
+ * @return Pointer to the root of the modified BST (may differ after rotations)
  */
 BSTNode *bst_insert(BSTNode *root, const char *city);
 
+/**
+ * Build a perfectly balanced BST from an array of cities in one pass
+ * Input that is already sorted is detected and only deduplicated; otherwise
+ * the cities are sorted once. NULL entries and duplicates are skipped.
+ * @param cities Array of city names (strings will be duplicated)
+ * @param n Number of entries in the array
+ * @return Pointer to the root of the new BST, or NULL if empty or on failure
+ */
+BSTNode *bst_build_from_array(const char **cities, size_t n);
+
 /**
  * Search for a city in the BST
  * @param root Pointer to the root of the BST
@@ -44,26 +76,72 @@ BSTNode *bst_search(BSTNode *root, const char *city);
 BSTNode *bst_find_min(BSTNode *root);
 
 /**
- * Remove a city from the BST
+ * Remove a city from the BST, rebalancing on the way back up
  * @param root Pointer to the root of the BST
  * @param city The city name to remove
- * @return Pointer to the root of the modified BST
+ * @return Pointer to the root of the modified BST (may differ after rotations)
  */
 BSTNode *bst_remove(BSTNode *root, const char *city);
 
+/**
+ * Insert a batch of cities into the BST in one merge pass
+ * The batch is sorted once and merged top-down, so subtrees with no new
+ * cities are skipped and nearby cities share one walk. Far cheaper than
+ * calling bst_insert n times when the batch is large. NULL entries and
+ * duplicates are skipped.
+ * @param root Pointer to the root of the BST (or NULL for empty tree)
+ * @param cities Array of city names (any order)
+ * @param n Number of entries in the array
+ * @return Pointer to the root of the modified BST
+ */
+BSTNode *bst_insert_batch(BSTNode *root, const char **cities, size_t n);
+
+/**
+ * Remove a batch of cities from the BST in one merge pass
+ * Cities that are not in the tree are ignored.
+ * @param root Pointer to the root of the BST
+ * @param cities Array of city names (any order)
+ * @param n Number of entries in the array
+ * @return Pointer to the root of the modified BST
+ */
+BSTNode *bst_remove_batch(BSTNode *root, const char **cities, size_t n);
+
 /**
  * Print the BST in in-order traversal (alphabetically sorted)
+ * Uses O(1) extra space by threading the tree temporarily, so it must not
+ * run concurrently with other readers of the same tree. Flushes stdout,
+ * then writes to its descriptor through a stack buffer.
  * @param root Pointer to the root of the BST
  */
 void bst_print_inorder(BSTNode *root);
 
+/**
+ * Write the cities one per line in alphabetical order (bst_print_inorder's format)
+ * Threads the tree temporarily like bst_print_inorder.
+ * @param root Pointer to the root of the BST
+ * @param writer Destination (see bst_writer.h); not flushed
+ * @return 0 on success, -1 if the writer's sink failed
+ */
+int bst_write_inorder(BSTNode *root, BSTWriter *writer);
+
 /**
  * Print the BST in a rotated format (right → root → left) for visualization
+ * Threads the tree temporarily like bst_print_inorder.
  * @param root Pointer to the root of the BST
  * @param space Spacing for indentation (use 0 initially)
  */
 void bst_print_rotated(BSTNode *root, int space);
 
+/**
+ * Write the rotated view (bst_print_rotated's format)
+ * Threads the tree temporarily like bst_print_inorder.
+ * @param root Pointer to the root of the BST
+ * @param space Spacing for indentation (use 0 initially)
+ * @param writer Destination (see bst_writer.h); not flushed
+ * @return 0 on success, -1 if the writer's sink failed
+ */
+int bst_write_rotated(BSTNode *root, int space, BSTWriter *writer);
+
 /**
  * Delete the entire BST and free all memory
  * @param root Pointer to the root of the BST
@@ -72,6 +150,7 @@ void bst_delete_tree(BSTNode *root);
 
 /**
  * Get the height of the BST
+ * Reads the height maintained by the balancing code, so this is O(1).
  * @param root Pointer to the root of the BST
  * @return The height of the tree (0 for single node, -1 for empty tree)
  */
@@ -79,9 +158,44 @@ int bst_height(BSTNode *root);
 
 /**
  * Get the number of nodes in the BST
+ * Reads the subtree size kept in every node, so this is O(1).
  * @param root Pointer to the root of the BST
  * @return The number of nodes in the tree
  */
 size_t bst_count_nodes(BSTNode *root);
 
+/**
+ * Get the number of cities that sort before a city, in O(log n)
+ * The city does not have to be in the tree.
+ * @param root Pointer to the root of the BST
+ * @param city The city name to rank
+ * @return The number of cities alphabetically before city (0 if city is NULL)
+ */
+size_t bst_rank(BSTNode *root, const char *city);
+
+/**
+ * Count the cities in a half-open range [lo, hi), in O(log n)
+ * @param root Pointer to the root of the BST
+ * @param lo Inclusive lower bound (NULL for no lower bound)
+ * @param hi Exclusive upper bound (NULL for no upper bound)
+ * @return The number of cities c with lo <= c < hi
+ */
+size_t bst_count_range(BSTNode *root, const char *lo, const char *hi);
+
+/**
+ * Count the cities starting with a prefix, in O(log n)
+ * @param root Pointer to the root of the BST
+ * @param prefix The prefix to match ("" matches every city)
+ * @return The number of matching cities (0 if prefix is NULL)
+ */
+size_t bst_count_prefix(BSTNode *root, const char *prefix);
+
+/**
+ * Find the k-th smallest city (0-based), in O(log n)
+ * @param root Pointer to the root of the BST
+ * @param k Rank of the city to find
+ * @return Pointer to the node holding that city, or NULL if k >= count
+ */
+BSTNode *bst_select(BSTNode *root, size_t k);
+
 #endif // BST_H
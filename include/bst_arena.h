@@ -0,0 +1,69 @@
+#ifndef BST_ARENA_H
+#define BST_ARENA_H
+
+#include "bst.h"
+
+/**
+ * Arena-backed tree context
+ * Nodes (and the occasional name too long to be stored inline) are
+ * bump-allocated side by side from large chunks, so building a tree costs
+ * one malloc call per ~1000 cities. Slots and long-name spaces released by
+ * bst_arena_remove go onto free lists (names by size) and are reused by
+ * later inserts, so add/remove churn does not grow the arena.
+ * Destroying the arena releases every node and string in O(number of chunks).
+ *
+ * Trees built through an arena must only be modified through the bst_arena_*
+ * functions and must never be passed to bst_remove or bst_delete_tree.
+ * Read-only functions (bst_search, bst_height, ...) work on either kind.
+ */
+typedef struct BSTArena BSTArena;
+
+/**
+ * Create an empty arena
+ * @return Pointer to the new arena, or NULL on failure
+ */
+BSTArena *bst_arena_create(void);
+
+/**
+ * Destroy an arena, releasing all trees allocated from it at once
+ * @param arena The arena to destroy (NULL is ignored)
+ */
+void bst_arena_destroy(BSTArena *arena);
+
+/**
+ * Insert a city into an arena-backed BST
+ * @param arena The arena that owns the tree
+ * @param root Pointer to the root of the BST (or NULL for empty tree)
+ * @param city The city name to insert
+ * @return Pointer to the root of the modified BST
+ */
+BSTNode *bst_arena_insert(BSTArena *arena, BSTNode *root, const char *city);
+
+/**
+ * Remove a city from an arena-backed BST
+ * The node slot and its long-name space are recycled by later inserts.
+ * @param arena The arena that owns the tree
+ * @param root Pointer to the root of the BST
+ * @param city The city name to remove
+ * @return Pointer to the root of the modified BST
+ */
+BSTNode *bst_arena_remove(BSTArena *arena, BSTNode *root, const char *city);
+
+/**
+ * Build a perfectly balanced arena-backed BST from an array of cities
+ * Same semantics as bst_build_from_array.
+ * @param arena The arena that will own the tree
+ * @param cities Array of city names (strings will be copied into the arena)
+ * @param n Number of entries in the array
+ * @return Pointer to the root of the new BST, or NULL if empty or on failure
+ */
+BSTNode *bst_arena_build_from_array(BSTArena *arena, const char **cities, size_t n);
+
+/**
+ * Get the number of bytes the arena has requested from malloc
+ * @param arena The arena to inspect
+ * @return Total size of all node and string chunks
+ */
+size_t bst_arena_bytes_reserved(const BSTArena *arena);
+
+#endif // BST_ARENA_H
@@ -0,0 +1,46 @@
+#ifndef BST_COLLATE_H
+#define BST_COLLATE_H
+
+#include <stddef.h>
+
+/**
+ * Collation by sort key
+ * A collation maps each city to a binary sort key, and trees that use one
+ * order cities by their keys. The key is computed once when a city is
+ * inserted and stored in its node, so every comparison during a lookup is
+ * still a plain memcmp; only the searched city is converted per lookup.
+ * Two cities are the same entry exactly when their keys are equal.
+ */
+
+/**
+ * Sort-key function
+ * Writes the key for city into key, truncated to capacity bytes including a
+ * terminator (nothing is written when capacity is 0), and returns the full
+ * key length like snprintf. Keys must not contain NUL bytes, and the key of
+ * a prefix should be a prefix of the key so prefix searches keep working.
+ * @param city The city name (NUL-terminated UTF-8)
+ * @param key Output buffer
+ * @param capacity Size of the output buffer in bytes
+ * @param ctx User context
+ * @return Key length in bytes, excluding the terminator
+ */
+typedef size_t (*BSTCollateFn)(const char *city, char *key, size_t capacity, void *ctx);
+
+/**
+ * Built-in locale-independent collation: case-folded, accent-stripped keys
+ * ASCII letters fold to lower case; Latin-1 and Latin Extended-A letters
+ * (plus Romanian S/T with comma) fold to their unaccented base letters, with
+ * ligatures spelled out ("Æ" -> "ae", "ß" -> "ss"); combining accents
+ * (U+0300-U+036F) are dropped, so decomposed input gets the same key.
+ * Everything else, including invalid UTF-8, is kept byte for byte.
+ * "Ålesund", "ALESUND" and "Alesund" therefore share the key "alesund",
+ * which sorts between "Aachen" and "Berlin".
+ * @param city The city name (NUL-terminated UTF-8)
+ * @param key Output buffer
+ * @param capacity Size of the output buffer in bytes
+ * @param ctx Unused (may be NULL)
+ * @return Key length in bytes, excluding the terminator
+ */
+size_t bst_collate_fold(const char *city, char *key, size_t capacity, void *ctx);
+
+#endif // BST_COLLATE_H
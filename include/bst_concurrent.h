@@ -0,0 +1,108 @@
+#ifndef BST_CONCURRENT_H
+#define BST_CONCURRENT_H
+
+#include "bst.h"
+#include <stddef.h>
+
+/**
+ * Thread-safe tree with wait-free readers
+ * Writers never modify a node that readers can see: each update copies the
+ * nodes on its root-to-leaf path (and any it rotates), then publishes the
+ * new root with one atomic store. A reader therefore always sees a complete,
+ * balanced version of the tree and never takes a lock. Replaced nodes are
+ * freed only after every reader that might still hold them has left its
+ * read section (epoch-based reclamation). Writers are serialized by a mutex.
+ *
+ * Readers:
+ *   BSTReader *reader = bst_reader_register(tree);      // once per thread
+ *   BSTNode *root = bst_reader_enter(reader);
+ *   ... bst_search(root, ...), bst_rank(root, ...), bst_select(root, ...) ...
+ *   bst_reader_exit(reader);
+ *
+ * Inside a read section only the read-only bst_* functions may be used on
+ * the returned root; bst_print_inorder and bst_print_rotated thread the tree
+ * while they run and must not be called on a shared version.
+ */
+typedef struct BSTConcurrent BSTConcurrent;
+
+/**
+ * Per-thread reader registration
+ */
+typedef struct BSTReader BSTReader;
+
+// Readers that can be registered with one tree at the same time
+#define BST_CONCURRENT_MAX_READERS 128
+
+/**
+ * Create an empty concurrent tree
+ * @return Pointer to the new tree, or NULL on failure
+ */
+BSTConcurrent *bst_concurrent_create(void);
+
+/**
+ * Destroy a concurrent tree
+ * Every reader must have been unregistered and no writer may be running.
+ * @param tree The tree to destroy (NULL is ignored)
+ */
+void bst_concurrent_destroy(BSTConcurrent *tree);
+
+/**
+ * Insert a city (safe to call from any thread)
+ * @param tree The tree to modify
+ * @param city The city name to insert
+ * @return 1 if inserted, 0 if already present, -1 on invalid input or allocation failure
+ */
+int bst_concurrent_insert(BSTConcurrent *tree, const char *city);
+
+/**
+ * Remove a city (safe to call from any thread)
+ * @param tree The tree to modify
+ * @param city The city name to remove
+ * @return 1 if removed, 0 if not found, -1 on invalid input or allocation failure
+ */
+int bst_concurrent_remove(BSTConcurrent *tree, const char *city);
+
+/**
+ * Number of replaced nodes waiting for readers to move on
+ * @param tree The tree to inspect
+ * @return The number of retired nodes not yet freed
+ */
+size_t bst_concurrent_pending(BSTConcurrent *tree);
+
+/**
+ * Register the calling thread as a reader
+ * @param tree The tree to read
+ * @return A reader handle, or NULL if BST_CONCURRENT_MAX_READERS are registered
+ */
+BSTReader *bst_reader_register(BSTConcurrent *tree);
+
+/**
+ * Release a reader handle (must not be inside a read section)
+ * @param reader The handle to release (NULL is ignored)
+ */
+void bst_reader_unregister(BSTReader *reader);
+
+/**
+ * Start a read section and get the current version of the tree
+ * Never blocks. Sections must not nest; keep them short, since nodes
+ * replaced while a section is open are only freed after it ends.
+ * @param reader The calling thread's reader handle
+ * @return Root of a consistent, immutable version (NULL when empty)
+ */
+BSTNode *bst_reader_enter(BSTReader *reader);
+
+/**
+ * End a read section; nodes of the version must not be used afterwards
+ * @param reader The calling thread's reader handle
+ */
+void bst_reader_exit(BSTReader *reader);
+
+/**
+ * Check whether a city is present (one complete read section)
+ * @param reader The calling thread's reader handle
+ * @param city The city name to look up
+ * @return 1 if present, 0 otherwise
+ */
+int bst_reader_contains(BSTReader *reader, const char *city);
+
+#endif // BST_CONCURRENT_H
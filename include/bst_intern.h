@@ -0,0 +1,66 @@
+#ifndef BST_INTERN_H
+#define BST_INTERN_H
+
+#include <stddef.h>
+
+/**
+ * Process-wide string interner
+ * Each distinct byte string is stored once and reference counted: interning
+ * an equal string again returns the same pointer, so two interned strings
+ * are equal exactly when their pointers are. Strings are carved out of
+ * 64 KiB chunks and recycled through size-class free lists rather than
+ * allocated one by one; the chunks are returned to the system once the
+ * last reference is released.
+ *
+ * Trees created with BST_TREE_INTERN (see bst_tree.h) point their long
+ * names here, so a name shared by many countries' trees is stored once.
+ * Every function is thread-safe (the interner takes a mutex).
+ */
+
+/**
+ * Interner occupancy
+ */
+typedef struct BSTInternStats {
+    size_t strings;          // Distinct strings stored
+    size_t references;       // Outstanding references (>= strings)
+    size_t bytes;            // String bytes stored, terminators included
+    size_t bytes_saved;      // String bytes a private copy per reference would add
+    size_t bytes_reserved;   // Bytes requested from malloc (chunks and table)
+} BSTInternStats;
+
+/**
+ * Intern a byte string (it may contain NUL bytes)
+ * @param str The bytes
+ * @param len Number of bytes; the stored copy is followed by a terminator
+ * @return The shared copy, holding one new reference, or NULL on invalid
+ *         input or allocation failure
+ */
+const char *bst_intern(const char *str, size_t len);
+
+/**
+ * Take another reference to an interned string
+ * @param str A pointer returned by bst_intern
+ * @return str
+ */
+const char *bst_intern_retain(const char *str);
+
+/**
+ * Drop a reference; the string is freed with its last one
+ * @param str A pointer returned by bst_intern (NULL is ignored)
+ */
+void bst_intern_release(const char *str);
+
+/**
+ * Drop one reference to each of several strings, taking the lock once
+ * @param strs Pointers returned by bst_intern (NULL entries are ignored)
+ * @param n Number of pointers
+ */
+void bst_intern_release_many(const char *const *strs, size_t n);
+
+/**
+ * Get the interner's occupancy
+ * @param stats Receives the counts
+ */
+void bst_intern_stats(BSTInternStats *stats);
+
+#endif // BST_INTERN_H
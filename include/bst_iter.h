@@ -0,0 +1,106 @@
+#ifndef BST_ITER_H
+#define BST_ITER_H
+
+#include "bst.h"
+#include <stddef.h>
+
+/**
+ * Bidirectional cursor over a tree
+ * Seeking costs O(log n) and each step O(1) amortized, so reading k cities
+ * from a seek position costs O(log n + k). The cursor keeps the path from
+ * the root to the current city in the iterator itself; only trees deeper
+ * than BST_ITER_INLINE_DEPTH (never an AVL tree built by bst_insert) make it
+ * allocate, once, on the way down.
+ *
+ * Cities starting with "San", 20 per page:
+ *   BSTIter it;
+ *   bst_iter_init(&it, root);
+ *   bst_iter_seek_prefix(&it, "San");
+ *   size_t total = bst_count_prefix(root, "San");
+ *   const char *city = bst_iter_seek_rank(&it, bst_rank(root, "San") + page * 20);
+ *   for (int i = 0; city && i < 20; i++, city = bst_iter_next(&it)) { ... }
+ *   bst_iter_release(&it);
+ *
+ * The tree must not be modified while a cursor is positioned on it. Do not
+ * copy a BSTIter; pass it by pointer.
+ */
+
+// Path entries stored inside the iterator (an AVL tree this tall has > 10^13 nodes)
+#define BST_ITER_INLINE_DEPTH 64
+
+/**
+ * Iterator state (fields are private)
+ */
+typedef struct BSTIter {
+    BSTNode *root;
+    BSTNode **heap_path;     // Used instead of inline_path for very deep trees
+    size_t capacity;
+    size_t depth;            // Path length; 0 when not positioned on a city
+    const char *prefix;      // Bound set by bst_iter_seek_prefix (NULL for none)
+    size_t prefix_len;
+    BSTNode *inline_path[BST_ITER_INLINE_DEPTH];
+} BSTIter;
+
+/**
+ * Prepare an iterator over a tree (not positioned on any city)
+ * @param it The iterator
+ * @param root Pointer to the root of the BST
+ */
+void bst_iter_init(BSTIter *it, BSTNode *root);
+
+/**
+ * Free anything the iterator allocated for very deep trees
+ * @param it The iterator (may be re-initialized afterwards)
+ */
+void bst_iter_release(BSTIter *it);
+
+/**
+ * Position on the first city >= key and drop any prefix bound
+ * @param it The iterator
+ * @param key Lower bound (NULL for the first city)
+ * @return The city, or NULL if every city sorts before key
+ */
+const char *bst_iter_seek(BSTIter *it, const char *key);
+
+/**
+ * Position on the first city starting with prefix, and stop next/prev at
+ * the edges of the matching cities
+ * @param it The iterator
+ * @param prefix The prefix (must stay valid while the bound is in use)
+ * @return The first matching city, or NULL if none match
+ */
+const char *bst_iter_seek_prefix(BSTIter *it, const char *prefix);
+
+/**
+ * Position on the city with the given rank (0-based), for pagination
+ * Keeps a prefix bound; lands nowhere if that city does not match it.
+ * @param it The iterator
+ * @param rank Number of cities before the target
+ * @return The city, or NULL if rank is out of range or outside the bound
+ */
+const char *bst_iter_seek_rank(BSTIter *it, size_t rank);
+
+/**
+ * Get the current city
+ * @param it The iterator
+ * @return The city, or NULL if not positioned on one
+ */
+const char *bst_iter_current(const BSTIter *it);
+
+/**
+ * Move to the next city in alphabetical order
+ * @param it The iterator
+ * @return The new current city, or NULL at the end (the iterator then
+ *         needs a new seek)
+ */
+const char *bst_iter_next(BSTIter *it);
+
+/**
+ * Move to the previous city in alphabetical order
+ * @param it The iterator
+ * @return The new current city, or NULL at the start (the iterator then
+ *         needs a new seek)
+ */
+const char *bst_iter_prev(BSTIter *it);
+
+#endif // BST_ITER_H
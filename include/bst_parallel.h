@@ -0,0 +1,107 @@
+#ifndef BST_PARALLEL_H
+#define BST_PARALLEL_H
+
+#include "bst.h"
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * Parallel traversal over a thread pool
+ * Every node stores its subtree size, so a tree of n cities splits into
+ * ordered rank ranges of equal size in O(log n) each. The tree is cut into
+ * several ranges per thread and idle workers claim the next unclaimed range,
+ * so a slow range does not hold the others up.
+ *
+ * All walks here are read-only (no Morris threading), so several can run on
+ * the same tree at once, but not while it is being modified.
+ *
+ * Count and height need no parallel versions: bst_count_nodes and
+ * bst_height read values stored in the root.
+ */
+typedef struct BSTPool BSTPool;
+
+/**
+ * An ordered slice of the tree handed to one worker
+ */
+typedef struct BSTRange {
+    BSTNode *root;           // Tree being walked
+    size_t index;            // Position of this range among all ranges
+    size_t first;            // Rank of the first city in the range
+    size_t count;            // Number of cities in the range
+} BSTRange;
+
+/**
+ * Create a thread pool
+ * @param threads Number of worker threads (0 for one per online CPU)
+ * @return Pointer to the new pool, or NULL on failure
+ */
+BSTPool *bst_pool_create(size_t threads);
+
+/**
+ * Stop the workers and free the pool
+ * @param pool The pool to destroy (NULL is ignored)
+ */
+void bst_pool_destroy(BSTPool *pool);
+
+/**
+ * Get the number of worker threads
+ * @param pool The pool
+ * @return The number of workers
+ */
+size_t bst_pool_threads(const BSTPool *pool);
+
+/**
+ * Split a tree into ordered ranges and process them on the pool
+ * Ranges are contiguous, in order, and together cover every city once.
+ * Returns when every range has been processed.
+ * @param pool The pool to run on
+ * @param root The tree to split
+ * @param ranges Number of ranges (0 picks a few per thread)
+ * @param fn Called once per range, from any worker thread
+ * @param ctx Context pointer passed to fn
+ * @return The number of ranges processed, or 0 for an empty tree or invalid input
+ */
+size_t bst_parallel_ranges(BSTPool *pool, BSTNode *root, size_t ranges,
+                           void (*fn)(const BSTRange *range, void *ctx), void *ctx);
+
+/**
+ * Visit the cities of one range in alphabetical order
+ * @param range The range to walk
+ * @param visit Called with each node
+ * @param ctx Context pointer passed to visit
+ */
+void bst_range_walk(const BSTRange *range, void (*visit)(const BSTNode *node, void *ctx), void *ctx);
+
+/**
+ * Count the cities matching a predicate in parallel
+ * @param pool The pool to run on
+ * @param root The tree to scan
+ * @param match Predicate called with each city name (from any worker thread)
+ * @param ctx Context pointer passed to match
+ * @return The number of cities for which match returned nonzero
+ */
+size_t bst_parallel_count_if(BSTPool *pool, BSTNode *root, int (*match)(const char *city, void *ctx),
+                             void *ctx);
+
+/**
+ * Write every city, one per line in alphabetical order (the same bytes as
+ * bst_print_inorder)
+ * Workers format ranges into private buffers; the calling thread writes the
+ * buffers out in order as they complete.
+ * @param pool The pool to run on
+ * @param root The tree to export
+ * @param out The stream to write to
+ * @return 0 on success, -1 on invalid input, allocation or write failure
+ */
+int bst_parallel_export(BSTPool *pool, BSTNode *root, FILE *out);
+
+/**
+ * Free a malloc-backed tree using every worker
+ * The top levels are detached by the calling thread and the subtrees below
+ * them are freed in parallel. Arena-backed trees are freed with their arena.
+ * @param pool The pool to run on
+ * @param root The tree to free
+ */
+void bst_parallel_delete(BSTPool *pool, BSTNode *root);
+
+#endif // BST_PARALLEL_H
@@ -0,0 +1,97 @@
+#ifndef BST_SNAPSHOT_H
+#define BST_SNAPSHOT_H
+
+#include "bst.h"
+#include <stddef.h>
+
+/**
+ * Read-only snapshot of a BST, laid out for lookup-heavy workloads
+ * The cities are stored as a flat array in Eytzinger (breadth-first) order,
+ * with all names packed into one contiguous blob in alphabetical order.
+ * A lookup walks the array with arithmetic instead of pointers and
+ * prefetches a few levels ahead, so it touches far fewer cache lines than
+ * bst_search. The snapshot does not track later changes to the tree; call
+ * bst_freeze again to rebuild it. Snapshots can be saved to a file and
+ * mapped back in without loading.
+ */
+typedef struct BSTSnapshot BSTSnapshot;
+
+/**
+ * Freeze the current contents of a BST into an immutable snapshot
+ * The tree is only read, never threaded, so it may be frozen while other
+ * readers use it (a root from bst_reader_enter, or a shared version).
+ * @param root Pointer to the root of the BST (NULL gives an empty snapshot)
+ * @return Pointer to the new snapshot, or NULL on failure
+ */
+BSTSnapshot *bst_freeze(BSTNode *root);
+
+/**
+ * Free a snapshot
+ * @param snapshot The snapshot to free (NULL is ignored)
+ */
+void bst_snapshot_free(BSTSnapshot *snapshot);
+
+/**
+ * Search for a city in a snapshot
+ * @param snapshot The snapshot to search
+ * @param city The city name to search for
+ * @return The stored city name (owned by the snapshot), or NULL if not found
+ */
+const char *bst_snapshot_search(const BSTSnapshot *snapshot, const char *city);
+
+/**
+ * Rebuild a mutable, balanced BST from a snapshot
+ * Names are already sorted and unique, so no comparison sort is needed.
+ * @param snapshot The snapshot to copy
+ * @return Pointer to the root of the new tree, or NULL if empty or on failure
+ */
+BSTNode *bst_thaw(const BSTSnapshot *snapshot);
+
+/**
+ * Get the cities of a snapshot in alphabetical order
+ * The names point into the snapshot's string table, so bst_tree_load can
+ * build a tree from them in one pass, without an intermediate tree.
+ * @param snapshot The snapshot to read
+ * @param names Receives bst_snapshot_count(snapshot) pointers (owned by the snapshot)
+ * @return The number of names stored
+ */
+size_t bst_snapshot_names(const BSTSnapshot *snapshot, const char **names);
+
+// Check the checksum and every entry of the file when opening it (reads every page)
+#define BST_SNAPSHOT_VERIFY 0x1u
+
+/**
+ * Write the current contents of a BST to a snapshot file
+ * The file holds a versioned header, the entry array in Eytzinger order
+ * and the sorted string table, exactly as bst_open_snapshot maps them. It
+ * is written to a temporary file, renamed into place, and the directory
+ * is synced so the rename survives a crash.
+ * @param root Pointer to the root of the BST (NULL writes an empty snapshot)
+ * @param path Destination file
+ * @return 0 on success, -1 on failure
+ */
+int bst_save_snapshot(BSTNode *root, const char *path);
+
+/**
+ * Map a snapshot file for lookups
+ * Nothing is parsed or copied: the snapshot points into the read-only
+ * mapping, and pages are read on first use. The header (with its own
+ * checksum) and the section bounds are always validated; lookups check
+ * each entry they read against the string table, so a damaged entry makes
+ * them miss rather than read outside the file. The body checksum, and the
+ * order and layout of every entry, are only checked with BST_SNAPSHOT_VERIFY.
+ * @param path Snapshot file written by bst_save_snapshot
+ * @param flags Bitwise OR of BST_SNAPSHOT_* flags (0 for none)
+ * @return Pointer to the snapshot (free with bst_snapshot_free), or NULL if
+ *         the file is missing, invalid or from another platform
+ */
+BSTSnapshot *bst_open_snapshot(const char *path, unsigned flags);
+
+/**
+ * Get the number of cities in a snapshot
+ * @param snapshot The snapshot to inspect
+ * @return The number of cities (0 for NULL)
+ */
+size_t bst_snapshot_count(const BSTSnapshot *snapshot);
+
+#endif // BST_SNAPSHOT_H
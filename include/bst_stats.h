@@ -0,0 +1,158 @@
+#ifndef BST_STATS_H
+#define BST_STATS_H
+
+#include "bst_writer.h"
+#include <stdint.h>
+
+/**
+ * Runtime counters and histograms
+ * When built with BST_STATS defined (CMake option ENABLE_STATS), the tree
+ * operations and the connector record what they do:
+ *   - per operation: calls, latency histogram and, for tree operations,
+ *     a histogram of the depth reached (nodes visited = key comparisons)
+ *   - counters: comparisons, node and out-of-line name allocations, frees,
+ *     cities passed to batch calls and cities received from the API
+ * Each thread records into its own shard without locks or atomic
+ * read-modify-writes; bst_stats_read merges the shards (and those of exited
+ * threads). Tree operations are timed one call in bst_stats_sample_period
+ * (default 64) to keep clock reads off most calls; calls, depths and
+ * counters are recorded for every call. Fetches are always timed.
+ *
+ * Latency histograms are log-linear (HDR-style): every power of two is
+ * split into BST_STATS_SUB_BUCKETS buckets, so a recorded value is off by
+ * at most 1/16 (6.25%) of itself, from 1 ns up to ~18 minutes.
+ *
+ * Without BST_STATS the recording macros expand to nothing, so the hot
+ * paths carry no extra code; the functions below still exist, report
+ * bst_stats_enabled() == 0 and read as all zeros.
+ */
+
+typedef enum BSTStatOp {
+    BST_STAT_INSERT,         // Single-city inserts (bst_insert, bst_arena_insert, bst_tree_insert)
+    BST_STAT_SEARCH,         // bst_search (and bst_tree_search without a hash index)
+    BST_STAT_REMOVE,         // Single-city removes
+    BST_STAT_FETCH,          // Connector transfers (latency from libcurl's total time)
+    BST_STAT_OP_COUNT
+} BSTStatOp;
+
+typedef enum BSTStatCounter {
+    BST_STAT_COMPARES,       // Key comparisons in single-city operations
+    BST_STAT_NODE_ALLOCS,    // Nodes allocated (malloc or arena)
+    BST_STAT_NAME_ALLOCS,    // Names too long to store inline
+    BST_STAT_NODE_FREES,     // Nodes freed one by one (arena teardown is not counted)
+    BST_STAT_BATCH_CITIES,   // Cities passed to batch inserts and removes
+    BST_STAT_FETCH_CITIES,   // Cities received from the API
+    BST_STAT_COUNTER_COUNT
+} BSTStatCounter;
+
+#define BST_STATS_SUB_BITS 4
+#define BST_STATS_SUB_BUCKETS (1 << BST_STATS_SUB_BITS)
+#define BST_STATS_MAX_BITS 40
+#define BST_STATS_LATENCY_BUCKETS ((BST_STATS_MAX_BITS - BST_STATS_SUB_BITS + 1) * BST_STATS_SUB_BUCKETS)
+#define BST_STATS_DEPTH_BUCKETS 64
+
+/**
+ * Merged view of all counters and histograms (about 21 KB; allocate it)
+ */
+typedef struct BSTStatsReport {
+    uint64_t ops[BST_STAT_OP_COUNT];
+    uint64_t counters[BST_STAT_COUNTER_COUNT];
+    uint64_t latency[BST_STAT_OP_COUNT][BST_STATS_LATENCY_BUCKETS];  // Sampled calls per bucket
+    uint64_t depth[BST_STAT_OP_COUNT][BST_STATS_DEPTH_BUCKETS];      // Calls per depth (last bucket: deeper)
+} BSTStatsReport;
+
+#ifdef BST_STATS
+#define BST_STATS_ADD(counter, n) bst_stats_add((counter), (n))
+#define BST_STATS_TIMER(name) uint64_t name = bst_stats_timer_start()
+#define BST_STATS_OP(op, timer, depth) bst_stats_record_op((op), (timer), (depth))
+#define BST_STATS_LATENCY(op, ns) bst_stats_record_latency((op), (ns))
+#else
+#define BST_STATS_ADD(counter, n) ((void)0)
+#define BST_STATS_TIMER(name)
+#define BST_STATS_OP(op, timer, depth) ((void)(depth))
+#define BST_STATS_LATENCY(op, ns) ((void)0)
+#endif
+
+/**
+ * Check whether statistics were compiled in
+ * @return 1 if built with BST_STATS, 0 otherwise
+ */
+int bst_stats_enabled(void);
+
+/**
+ * Add to a counter of the calling thread
+ * @param counter The counter
+ * @param n Amount to add
+ */
+void bst_stats_add(BSTStatCounter counter, uint64_t n);
+
+/**
+ * Start timing a tree operation, if this call is sampled
+ * @return Start time for bst_stats_record_op, or 0 if the call is not timed
+ */
+uint64_t bst_stats_timer_start(void);
+
+/**
+ * Record a tree operation of the calling thread
+ * @param op The operation
+ * @param start Value returned by bst_stats_timer_start (0 records no latency)
+ * @param depth Nodes visited (each costs one key comparison)
+ */
+void bst_stats_record_op(BSTStatOp op, uint64_t start, unsigned depth);
+
+/**
+ * Record an operation timed by the caller
+ * @param op The operation
+ * @param ns Its latency in nanoseconds
+ */
+void bst_stats_record_latency(BSTStatOp op, uint64_t ns);
+
+/**
+ * Time one tree operation in every period calls (per thread)
+ * @param period Sampling period (1 times every call; 0 is treated as 1)
+ */
+void bst_stats_sample_period(unsigned period);
+
+/**
+ * Merge every thread's counters and histograms, less the last reset
+ * @param report Receives the merged view (all zeros without BST_STATS)
+ */
+void bst_stats_read(BSTStatsReport *report);
+
+/**
+ * Start counting from zero (threads keep recording while this runs)
+ */
+void bst_stats_reset(void);
+
+/**
+ * Get the value a latency bucket stands for (its midpoint)
+ * @param bucket Bucket index (< BST_STATS_LATENCY_BUCKETS)
+ * @return The value in nanoseconds
+ */
+uint64_t bst_stats_bucket_value(unsigned bucket);
+
+/**
+ * Get a percentile of a latency histogram
+ * @param histogram One row of BSTStatsReport.latency
+ * @param percentile Percentile in [0, 100]
+ * @return The value in nanoseconds (0 for an empty histogram)
+ */
+uint64_t bst_stats_percentile(const uint64_t *histogram, double percentile);
+
+/**
+ * Write a report as text (one line per operation, then the counters)
+ * @param report The report to write
+ * @param writer Destination (not flushed)
+ * @return 0 on success, -1 on invalid input or output failure
+ */
+int bst_stats_write_text(const BSTStatsReport *report, BSTWriter *writer);
+
+/**
+ * Write a report as one JSON object, including the non-empty histogram buckets
+ * @param report The report to write
+ * @param writer Destination (not flushed)
+ * @return 0 on success, -1 on invalid input or output failure
+ */
+int bst_stats_write_json(const BSTStatsReport *report, BSTWriter *writer);
+
+#endif // BST_STATS_H
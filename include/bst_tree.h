@@ -0,0 +1,163 @@
+#ifndef BST_TREE_H
+#define BST_TREE_H
+
+#include "bst.h"
+#include "bst_collate.h"
+#include <stddef.h>
+
+/**
+ * Tree handle
+ * Owns the root of a BST together with the resources behind it, so callers
+ * do not have to thread the root pointer (and an optional arena) through
+ * every call. Count and height are read from the root in O(1), and
+ * rank/select run in O(log n) using the per-node subtree sizes.
+ *
+ * A tree may order its cities by a collation (see bst_collate.h) instead of
+ * byte order. Each node then stores the city's sort key next to the city,
+ * and the bst_tree_* functions convert their city arguments to keys.
+ * bst_node_city still returns the city as it was first inserted. Raw bst_*
+ * functions that take a city (bst_search, bst_count_prefix, bst_iter_seek,
+ * ...) compare it against the stored keys when given a collated tree's
+ * root, so pass them keys made with the same collation.
+ */
+typedef struct BSTree BSTree;
+
+// Allocate the tree's nodes from a private arena (see bst_arena.h)
+#define BST_TREE_ARENA 0x1u
+
+// Order cities with bst_collate_fold (case-folded, accent-stripped)
+#define BST_TREE_FOLD 0x2u
+
+// Keep a hash index beside the tree: bst_tree_search answers in O(1)
+// expected time, and inserting a present or removing an absent city skips
+// the tree walk. Costs 16 bytes per slot at a load factor of at most 3/4.
+#define BST_TREE_HASH 0x4u
+
+// Share names through the process-wide interner (see bst_intern.h) instead
+// of copying them into each tree, so a name held by many trees is stored
+// once. Lookups still compare bytes, since search keys are the caller's own
+// strings; a merge over several trees (city_catalog.h) can compare the
+// trees' names by pointer. Only names stored outside the
+// node are interned: long ones, and every name of a collated tree. Implies
+// BST_TREE_ARENA. Each node holds one reference, dropped when its city is
+// removed; destroying or reloading the tree walks the nodes to drop theirs.
+#define BST_TREE_INTERN 0x8u
+
+/**
+ * Create an empty tree
+ * @param flags Bitwise OR of BST_TREE_* flags (0 for a malloc-backed tree)
+ * @return Pointer to the new tree, or NULL on failure
+ */
+BSTree *bst_tree_create(unsigned flags);
+
+/**
+ * Destroy a tree and every city in it
+ * @param tree The tree to destroy (NULL is ignored)
+ */
+void bst_tree_destroy(BSTree *tree);
+
+/**
+ * Set the collation that orders the tree's cities
+ * @param tree The tree to configure (must be empty)
+ * @param collate Sort-key function (NULL for byte order)
+ * @param ctx User context passed to collate
+ * @return 0 on success, -1 if tree is NULL or not empty
+ */
+int bst_tree_set_collation(BSTree *tree, BSTCollateFn collate, void *ctx);
+
+/**
+ * Insert a city into the tree
+ * In a collated tree a city whose key is already present counts as present,
+ * and the spelling stored first is kept.
+ * @param tree The tree to modify
+ * @param city The city name to insert
+ * @return 1 if inserted, 0 if already present, -1 on invalid input or allocation failure
+ */
+int bst_tree_insert(BSTree *tree, const char *city);
+
+/**
+ * Remove a city from the tree
+ * @param tree The tree to modify
+ * @param city The city name to remove
+ * @return 1 if removed, 0 if not found
+ */
+int bst_tree_remove(BSTree *tree, const char *city);
+
+/**
+ * Insert a batch of cities in one merge pass (see bst_insert_batch)
+ * @param tree The tree to modify
+ * @param cities Array of city names (any order; NULL entries are skipped)
+ * @param n Number of entries in the array
+ * @param inserted Receives the number of cities added (may be NULL)
+ * @return 0 on success, -1 on invalid input or allocation failure (the tree
+ *         stays valid but may hold only part of the batch)
+ */
+int bst_tree_insert_batch(BSTree *tree, const char **cities, size_t n, size_t *inserted);
+
+/**
+ * Remove a batch of cities in one merge pass (see bst_remove_batch)
+ * @param tree The tree to modify
+ * @param cities Array of city names (any order; NULL entries are skipped)
+ * @param n Number of entries in the array
+ * @param removed Receives the number of cities removed (may be NULL)
+ * @return 0 on success, -1 on invalid input or allocation failure (the tree is unchanged)
+ */
+int bst_tree_remove_batch(BSTree *tree, const char **cities, size_t n, size_t *removed);
+
+/**
+ * Replace the tree's contents with a balanced tree built from cities
+ * Duplicates are dropped. The old contents are only released once the new
+ * tree has been built, so on failure the tree is left unchanged.
+ * @param tree The tree to load into
+ * @param cities Array of city names (any order)
+ * @param n Number of cities in the array
+ * @return 0 on success, -1 on invalid input or allocation failure
+ */
+int bst_tree_load(BSTree *tree, const char **cities, size_t n);
+
+/**
+ * Search for a city in the tree (through the hash index with BST_TREE_HASH)
+ * @param tree The tree to search
+ * @param city The city name to search for
+ * @return Pointer to the node containing the city, or NULL if not found
+ */
+BSTNode *bst_tree_search(const BSTree *tree, const char *city);
+
+/**
+ * Get the root node, for use with the read-only bst_* functions
+ * @param tree The tree to inspect
+ * @return The root node, or NULL for an empty tree
+ */
+BSTNode *bst_tree_root(const BSTree *tree);
+
+/**
+ * Get the number of cities in the tree, in O(1)
+ * @param tree The tree to inspect
+ * @return The number of cities (0 for NULL)
+ */
+size_t bst_tree_count(const BSTree *tree);
+
+/**
+ * Get the height of the tree, in O(1)
+ * @param tree The tree to inspect
+ * @return The height (0 for a single city, -1 for an empty tree)
+ */
+int bst_tree_height(const BSTree *tree);
+
+/**
+ * Get the number of cities that sort before a city, in O(log n)
+ * @param tree The tree to inspect
+ * @param city The city name to rank (need not be in the tree)
+ * @return The number of cities alphabetically before city
+ */
+size_t bst_tree_rank(const BSTree *tree, const char *city);
+
+/**
+ * Find the k-th smallest city (0-based), in O(log n)
+ * @param tree The tree to inspect
+ * @param k Rank of the city to find
+ * @return Pointer to the node holding that city, or NULL if k >= count
+ */
+BSTNode *bst_tree_select(const BSTree *tree, size_t k);
+
+#endif // BST_TREE_H
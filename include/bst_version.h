@@ -0,0 +1,98 @@
+#ifndef BST_VERSION_H
+#define BST_VERSION_H
+
+#include "bst.h"
+#include <stddef.h>
+
+/**
+ * Persistent (immutable) tree versions
+ * A version never changes once created. Insert and remove return a new
+ * version that copies the O(log n) nodes on the changed path and shares
+ * every other subtree with the version it came from. Versions and nodes are
+ * reference counted, so a node is freed when the last version using it is
+ * released.
+ *
+ * Taking a snapshot is O(1) (bst_version_retain), rolling back is keeping
+ * the previous version, and a long scan of one version is unaffected by
+ * updates that create newer ones:
+ *   BSTVersion *before = bst_version_retain(current);
+ *   BSTVersion *next = bst_version_insert(current, "Lagos");
+ *   ... if the refresh was bad, keep using before and release next ...
+ *
+ * Versions may be read, retained, released and updated from any thread;
+ * publishing "the current version" between threads is up to the caller.
+ */
+typedef struct BSTVersion BSTVersion;
+
+/**
+ * Create an empty version
+ * @return Pointer to the new version (reference count 1), or NULL on failure
+ */
+BSTVersion *bst_version_create(void);
+
+/**
+ * Take another reference to a version (an O(1) snapshot)
+ * @param version The version to retain (NULL is ignored)
+ * @return version
+ */
+BSTVersion *bst_version_retain(BSTVersion *version);
+
+/**
+ * Drop a reference; the last one frees the version and any nodes no other
+ * version shares
+ * @param version The version to release (NULL is ignored)
+ */
+void bst_version_release(BSTVersion *version);
+
+/**
+ * Create the version that also contains city
+ * @param version The version to start from (left unchanged)
+ * @param city The city name to insert
+ * @return A new reference: a new version, or version itself if city is
+ *         already present; NULL on invalid input or allocation failure
+ */
+BSTVersion *bst_version_insert(BSTVersion *version, const char *city);
+
+/**
+ * Create the version without city
+ * @param version The version to start from (left unchanged)
+ * @param city The city name to remove
+ * @return A new reference: a new version, or version itself if city is
+ *         absent; NULL on invalid input or allocation failure
+ */
+BSTVersion *bst_version_remove(BSTVersion *version, const char *city);
+
+/**
+ * Get the root of a version for the read-only bst_* functions
+ * (bst_search, bst_rank, bst_select, ...). Do not pass it to
+ * bst_print_inorder or bst_print_rotated, which thread the tree while
+ * they run; use bst_version_print_inorder instead.
+ * @param version The version
+ * @return The root node (NULL for an empty version)
+ */
+BSTNode *bst_version_root(const BSTVersion *version);
+
+/**
+ * Get the number of cities in a version
+ * @param version The version
+ * @return The number of cities (0 for NULL)
+ */
+size_t bst_version_count(const BSTVersion *version);
+
+/**
+ * Visit every city of a version in alphabetical order without modifying it
+ * @param version The version to walk
+ * @param visit Called with each city name
+ * @param ctx Context pointer passed to visit
+ */
+void bst_version_walk(const BSTVersion *version, void (*visit)(const char *city, void *ctx), void *ctx);
+
+/**
+ * Print a version one city per line in alphabetical order
+ * Same output as bst_print_inorder, but safe while other threads read or
+ * update the same version.
+ * @param version The version to print
+ */
+void bst_version_print_inorder(const BSTVersion *version);
+
+#endif // BST_VERSION_H
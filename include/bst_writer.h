@@ -0,0 +1,91 @@
+#ifndef BST_WRITER_H
+#define BST_WRITER_H
+
+#include <stddef.h>
+
+/**
+ * Buffered output sink for tree dumps
+ * Output is collected in a caller-supplied buffer and handed to the sink in
+ * large blocks, so printing never allocates and costs one system call per
+ * buffer rather than one stdio call per city. A file descriptor sink (file,
+ * pipe or socket) flushes with write/writev; any other destination can be
+ * served by a callback.
+ *
+ *   char buffer[65536];
+ *   BSTWriter writer;
+ *   bst_writer_init_fd(&writer, fd, buffer, sizeof(buffer));
+ *   bst_write_inorder(root, &writer);
+ *   bst_writer_flush(&writer);
+ */
+
+/**
+ * Callback sink
+ * @param data Bytes to write
+ * @param len Number of bytes
+ * @param ctx The context pointer given to bst_writer_init
+ * @return 0 if every byte was written, -1 on failure
+ */
+typedef int (*BSTWriteFn)(const char *data, size_t len, void *ctx);
+
+/**
+ * Writer state
+ * Declared here so it can live on the caller's stack; treat the fields as
+ * private.
+ */
+typedef struct BSTWriter {
+    char *buffer;
+    size_t capacity;
+    size_t len;              // Bytes buffered but not yet written
+    int fd;                  // Descriptor sink, or -1 for a callback sink
+    BSTWriteFn write;
+    void *ctx;
+    int failed;              // Set on the first sink failure; later writes are dropped
+} BSTWriter;
+
+/**
+ * Set up a writer that flushes to a file descriptor
+ * @param writer The writer to initialize
+ * @param fd Destination descriptor (left open by the writer)
+ * @param buffer Buffer space owned by the caller
+ * @param capacity Size of buffer in bytes (must be nonzero)
+ */
+void bst_writer_init_fd(BSTWriter *writer, int fd, char *buffer, size_t capacity);
+
+/**
+ * Set up a writer that flushes through a callback
+ * @param writer The writer to initialize
+ * @param write Sink callback
+ * @param ctx Context pointer passed to write
+ * @param buffer Buffer space owned by the caller
+ * @param capacity Size of buffer in bytes (must be nonzero)
+ */
+void bst_writer_init(BSTWriter *writer, BSTWriteFn write, void *ctx, char *buffer, size_t capacity);
+
+/**
+ * Append bytes
+ * Data larger than the buffer is written straight through together with
+ * anything already buffered.
+ * @param writer The writer
+ * @param data Bytes to append
+ * @param len Number of bytes
+ * @return 0 on success, -1 if the sink has failed
+ */
+int bst_writer_put(BSTWriter *writer, const char *data, size_t len);
+
+/**
+ * Append count copies of one byte (for example an indentation run)
+ * @param writer The writer
+ * @param byte The byte to repeat
+ * @param count Number of copies
+ * @return 0 on success, -1 if the sink has failed
+ */
+int bst_writer_fill(BSTWriter *writer, char byte, size_t count);
+
+/**
+ * Write out everything buffered
+ * @param writer The writer
+ * @return 0 on success, -1 if any write so far has failed
+ */
+int bst_writer_flush(BSTWriter *writer);
+
+#endif // BST_WRITER_H
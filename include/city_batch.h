@@ -0,0 +1,62 @@
+#ifndef CITY_BATCH_H
+#define CITY_BATCH_H
+
+#include <stddef.h>
+
+/**
+ * Append-only buffer of city names
+ * Names are packed back to back into one growing block, so collecting a
+ * country's cities costs a few reallocations instead of one malloc per
+ * city. Used as a staging area before bulk-building a tree.
+ */
+typedef struct CityBatch CityBatch;
+
+/**
+ * Create an empty batch
+ * @return Pointer to the new batch, or NULL on failure
+ */
+CityBatch *city_batch_create(void);
+
+/**
+ * Destroy a batch and every name in it
+ * @param batch The batch to destroy (NULL is ignored)
+ */
+void city_batch_destroy(CityBatch *batch);
+
+/**
+ * Append a city name
+ * @param batch The batch to append to
+ * @param city The city name (need not be NUL-terminated)
+ * @param len Length of the city name in bytes
+ * @return 0 on success, -1 on allocation failure
+ */
+int city_batch_add(CityBatch *batch, const char *city, size_t len);
+
+/**
+ * CityStreamCallback adapter that appends each city to the batch in ctx
+ * @return 0 on success, -1 on allocation failure (aborts the stream)
+ */
+int city_batch_collect(const char *city, size_t len, void *ctx);
+
+/**
+ * Get the number of names in the batch
+ * @param batch The batch to inspect
+ * @return The number of names (0 for NULL)
+ */
+size_t city_batch_count(const CityBatch *batch);
+
+/**
+ * Get an array of pointers to the names, in insertion order
+ * The array and the names stay valid until the next add or destroy.
+ * @param batch The batch to inspect
+ * @return The name array, or NULL if the batch is empty or on failure
+ */
+const char **city_batch_names(CityBatch *batch);
+
+/**
+ * Remove every name, keeping the allocated storage for reuse
+ * @param batch The batch to clear
+ */
+void city_batch_clear(CityBatch *batch);
+
+#endif // CITY_BATCH_H
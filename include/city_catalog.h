@@ -0,0 +1,135 @@
+#ifndef CITY_CATALOG_H
+#define CITY_CATALOG_H
+
+#include "bst_tree.h"
+#include <stddef.h>
+
+/**
+ * Cities grouped by country
+ * Each country owns its own tree, so a city that exists in two countries
+ * is kept twice and per-country queries are ordinary tree queries.
+ * Reloading a country rebuilds only that country's tree.
+ *
+ * The global alphabetical view is not stored anywhere: a CityCatalogIter
+ * merges the country trees on the fly with a min-heap of one cursor per
+ * country, so listing all n cities of k countries costs O(n log k) time
+ * and O(k) memory. A city found in several countries is listed once per
+ * country, in country order. With BST_TREE_INTERN trees, equal long names
+ * from different countries share one copy and the merge compares them by
+ * pointer.
+ *
+ *   CityCatalog *catalog = city_catalog_create(BST_TREE_INTERN);
+ *   countries_load_tree(NULL, "nigeria", city_catalog_tree(catalog, "nigeria"));
+ *   ...
+ *   CityCatalogIter *it = city_catalog_iter_create(catalog, NULL);
+ *   const char *city, *country;
+ *   while (city_catalog_iter_next(it, &city, &country) == 1) { ... }
+ *   city_catalog_iter_destroy(it);
+ */
+typedef struct CityCatalog CityCatalog;
+
+/**
+ * Cursor over the cities of every country in alphabetical order
+ */
+typedef struct CityCatalogIter CityCatalogIter;
+
+/**
+ * Create an empty catalog
+ * @param tree_flags BST_TREE_* flags for every country's tree
+ * @return Pointer to the new catalog, or NULL on failure
+ */
+CityCatalog *city_catalog_create(unsigned tree_flags);
+
+/**
+ * Destroy a catalog and every country's tree
+ * @param catalog The catalog to destroy (NULL is ignored)
+ */
+void city_catalog_destroy(CityCatalog *catalog);
+
+/**
+ * Get a country's tree, adding the country with an empty tree if needed
+ * The tree stays owned by the catalog; it may be loaded or modified
+ * directly, but not while an iterator is open.
+ * @param catalog The catalog
+ * @param country Country name (copied)
+ * @return The country's tree, or NULL on invalid input or allocation failure
+ */
+BSTree *city_catalog_tree(CityCatalog *catalog, const char *country);
+
+/**
+ * Get a country's tree without adding the country
+ * @param catalog The catalog
+ * @param country Country name
+ * @return The country's tree, or NULL if the country is not in the catalog
+ */
+BSTree *city_catalog_find(const CityCatalog *catalog, const char *country);
+
+/**
+ * Replace a country's cities, adding the country if needed
+ * Only this country's tree is rebuilt; on failure it is left unchanged.
+ * @param catalog The catalog
+ * @param country Country name (copied)
+ * @param cities Array of city names (duplicates are ignored)
+ * @param n Number of entries in the array
+ * @return 0 on success, -1 on invalid input or allocation failure
+ */
+int city_catalog_load(CityCatalog *catalog, const char *country, const char **cities, size_t n);
+
+/**
+ * Remove a country and its tree
+ * @param catalog The catalog
+ * @param country Country name
+ * @return 1 if the country was removed, 0 if absent, -1 on invalid input
+ */
+int city_catalog_remove(CityCatalog *catalog, const char *country);
+
+/**
+ * Get the number of countries
+ * @param catalog The catalog
+ * @return The number of countries (0 for NULL)
+ */
+size_t city_catalog_country_count(const CityCatalog *catalog);
+
+/**
+ * Get a country by its position in alphabetical order
+ * @param catalog The catalog
+ * @param index Position (< city_catalog_country_count)
+ * @return The country name, or NULL if index is out of range
+ */
+const char *city_catalog_country_at(const CityCatalog *catalog, size_t index);
+
+/**
+ * Get the number of cities across all countries (one per country holding it)
+ * @param catalog The catalog
+ * @return The number of cities (0 for NULL)
+ */
+size_t city_catalog_city_count(const CityCatalog *catalog);
+
+/**
+ * Start iterating over every country's cities in alphabetical order
+ * With BST_TREE_FOLD trees, the order (and from) follow the folded keys.
+ * Adding, loading or removing countries ends the iteration; modifying a
+ * country's tree while an iterator is open is not allowed.
+ * @param catalog The catalog
+ * @param from Lower bound: start at the first city >= from (NULL for the first city)
+ * @return Pointer to the new iterator, or NULL on invalid input or allocation failure
+ */
+CityCatalogIter *city_catalog_iter_create(const CityCatalog *catalog, const char *from);
+
+/**
+ * Move to the next city
+ * @param it The iterator
+ * @param city Receives the city (may be NULL)
+ * @param country Receives the country holding it (may be NULL)
+ * @return 1 if a city was produced, 0 at the end, -1 if the catalog's
+ *         countries changed since the iterator was created
+ */
+int city_catalog_iter_next(CityCatalogIter *it, const char **city, const char **country);
+
+/**
+ * Destroy an iterator
+ * @param it The iterator to destroy (NULL is ignored)
+ */
+void city_catalog_iter_destroy(CityCatalogIter *it);
+
+#endif // CITY_CATALOG_H
@@ -0,0 +1,93 @@
+#ifndef CITY_STREAM_H
+#define CITY_STREAM_H
+
+#include <stddef.h>
+
+/**
+ * Incremental parser for CountriesNow city responses
+ * Accepts the response body in arbitrary chunks (for example straight from
+ * a libcurl write callback) and reports every string in the top-level
+ * "data" array as soon as it is complete. Only the string being parsed is
+ * buffered, so memory use does not grow with the size of the response.
+ *
+ * Expected document shape:
+ *   {"error": false, "msg": "cities in nigeria retrieved", "data": ["Aba", ...]}
+ * The whole document is validated as JSON; unknown members are skipped.
+ */
+typedef struct CityStream CityStream;
+
+/**
+ * Called once per city in the "data" array, in document order
+ * @param city The city name (NUL-terminated, valid only during the call)
+ * @param len Length of the city name in bytes
+ * @param ctx The context pointer given to city_stream_create
+ * @return 0 to continue, nonzero to abort parsing
+ */
+typedef int (*CityStreamCallback)(const char *city, size_t len, void *ctx);
+
+/**
+ * Create a parser
+ * @param on_city Callback for each city (may be NULL to only validate)
+ * @param ctx Context pointer passed to the callback
+ * @return Pointer to the new parser, or NULL on failure
+ */
+CityStream *city_stream_create(CityStreamCallback on_city, void *ctx);
+
+/**
+ * Destroy a parser
+ * @param stream The parser to destroy (NULL is ignored)
+ */
+void city_stream_destroy(CityStream *stream);
+
+/**
+ * Feed the next chunk of the response body
+ * @param stream The parser
+ * @param data Chunk bytes (need not end on a token boundary)
+ * @param len Number of bytes in the chunk
+ * @return 0 on success, -1 if the document is invalid or the callback aborted
+ */
+int city_stream_feed(CityStream *stream, const char *data, size_t len);
+
+/**
+ * Signal the end of the response body
+ * @param stream The parser
+ * @return 0 if a complete document was parsed, -1 otherwise
+ */
+int city_stream_finish(CityStream *stream);
+
+/**
+ * Get the value of the top-level "error" member
+ * @param stream The parser
+ * @return 1 for true, 0 for false, -1 if missing or not a boolean
+ */
+int city_stream_api_error(const CityStream *stream);
+
+/**
+ * Get the value of the top-level "msg" member
+ * @param stream The parser
+ * @return The message (owned by the parser), or NULL if missing
+ */
+const char *city_stream_message(const CityStream *stream);
+
+/**
+ * Check whether the top-level "data" array was present
+ * @param stream The parser
+ * @return 1 if a "data" array was seen, 0 otherwise
+ */
+int city_stream_has_data(const CityStream *stream);
+
+/**
+ * Get the number of cities reported so far
+ * @param stream The parser
+ * @return The number of callback invocations
+ */
+size_t city_stream_city_count(const CityStream *stream);
+
+/**
+ * Describe why parsing failed
+ * @param stream The parser
+ * @return A static description, or NULL if no error occurred
+ */
+const char *city_stream_error(const CityStream *stream);
+
+#endif // CITY_STREAM_H
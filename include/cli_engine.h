@@ -0,0 +1,96 @@
+#ifndef CLI_ENGINE_H
+#define CLI_ENGINE_H
+
+#include "bst_tree.h"
+#include "bst_writer.h"
+#include <stddef.h>
+
+/**
+ * Command engine for the CitySorter CLI
+ * Reads commands in large blocks (one read per block rather than one per
+ * line), parses them in place without allocating, and applies each run of
+ * consecutive add or remove commands as one batched tree update. Output
+ * and error messages go through a BSTWriter, which is flushed after every
+ * block, so an interactive session sees each command's output as soon as
+ * its line has been read.
+ *
+ * Commands, one per line (blank lines and lines starting with # are skipped):
+ *   add <city>       Add a city (silently ignored if already present)
+ *   remove <city>    Remove a city (silently ignored if absent)
+ *   print            Print the tree rotated (right, root, left)
+ *   stats [json]     Print the bst_stats.h counters and histograms
+ *   stats reset      Start the counters from zero
+ *   stop             Stop; later input is ignored
+ * The city is the rest of the line with surrounding blanks trimmed. A
+ * malformed line is reported as "line N: ..." and skipped.
+ */
+typedef struct CliEngine CliEngine;
+
+/**
+ * Counters of the work done by an engine
+ */
+typedef struct CliEngineStats {
+    size_t lines;            // Lines read
+    size_t commands;         // Valid commands executed
+    size_t added;            // Cities added to the tree
+    size_t removed;          // Cities removed from the tree
+    size_t batches;          // Batched tree updates applied
+    size_t errors;           // Malformed lines skipped
+} CliEngineStats;
+
+/**
+ * Create an engine
+ * @param tree The tree the commands operate on (not owned)
+ * @param out Writer for command output and error messages (not owned)
+ * @return Pointer to the new engine, or NULL on invalid input or allocation failure
+ */
+CliEngine *cli_engine_create(BSTree *tree, BSTWriter *out);
+
+/**
+ * Destroy an engine (input not yet ended with cli_engine_finish is dropped)
+ * @param engine The engine to destroy (NULL is ignored)
+ */
+void cli_engine_destroy(CliEngine *engine);
+
+/**
+ * Read one block from a descriptor and execute the complete lines in it
+ * A partial last line is kept until the rest of it arrives.
+ * @param engine The engine
+ * @param fd Descriptor to read from
+ * @return Number of bytes read (0 at end of input or once stopped), or -1 on
+ *         a read error (errno is preserved, so EINTR can be retried) or
+ *         allocation failure
+ */
+long cli_engine_read(CliEngine *engine, int fd);
+
+/**
+ * Execute the complete lines in a chunk of input
+ * @param engine The engine
+ * @param data Input bytes (lines may span chunks)
+ * @param len Number of bytes
+ * @return 0 on success, -1 on allocation failure
+ */
+int cli_engine_feed(CliEngine *engine, const char *data, size_t len);
+
+/**
+ * End the input: execute a last line without a newline and flush the output
+ * @param engine The engine
+ * @return 0 on success, -1 on allocation failure or output failure
+ */
+int cli_engine_finish(CliEngine *engine);
+
+/**
+ * Check whether a stop command has been executed
+ * @param engine The engine
+ * @return 1 if stopped, 0 otherwise
+ */
+int cli_engine_stopped(const CliEngine *engine);
+
+/**
+ * Get the engine's counters
+ * @param engine The engine
+ * @param stats Receives the counters
+ */
+void cli_engine_stats(const CliEngine *engine, CliEngineStats *stats);
+
+#endif // CLI_ENGINE_H
@@ -0,0 +1,37 @@
+#ifndef CLI_SHUTDOWN_H
+#define CLI_SHUTDOWN_H
+
+/**
+ * Signal-driven shutdown for the CLI loop
+ * SIGINT, SIGTERM and SIGHUP do not kill the process. The handler only
+ * records the signal and writes a byte to a self-pipe, which is all that is
+ * async-signal-safe. The loop polls the pipe next to its input and, once it
+ * is readable, stops reading and runs its normal exit path (outside the
+ * handler). A second signal while shutting down restores the default
+ * action and re-raises it, so a stuck shutdown can still be forced.
+ *
+ *   int wake_fd = cli_shutdown_install();
+ *   struct pollfd fds[2] = {{input, POLLIN, 0}, {wake_fd, POLLIN, 0}};
+ *   while (!cli_shutdown_signal()) { poll(fds, 2, -1); ... }
+ */
+
+/**
+ * Install the handlers and create the self-pipe
+ * Handlers are installed without SA_RESTART, so a blocking read or poll
+ * returns EINTR when a signal arrives.
+ * @return The read end of the pipe (readable once a signal has arrived), or -1 on failure
+ */
+int cli_shutdown_install(void);
+
+/**
+ * Get the shutdown signal
+ * @return The first shutdown signal received, or 0 if none
+ */
+int cli_shutdown_signal(void);
+
+/**
+ * Restore the default handlers, close the pipe and forget any received signal
+ */
+void cli_shutdown_uninstall(void);
+
+#endif // CLI_SHUTDOWN_H
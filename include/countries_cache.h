@@ -0,0 +1,72 @@
+#ifndef COUNTRIES_CACHE_H
+#define COUNTRIES_CACHE_H
+
+#include "countries_client.h"
+#include <stddef.h>
+
+/**
+ * Persistent response cache
+ * Keeps each country's parsed city list in its own file under a cache
+ * directory, so a warm start loads trees without touching the network.
+ * Entries older than the TTL are revalidated with If-None-Match /
+ * If-Modified-Since; a 304 answer only refreshes the entry's timestamp.
+ * Entries are written to a temporary file and renamed into place, so a
+ * crash never leaves a torn entry behind.
+ */
+typedef struct CountriesCache CountriesCache;
+
+/**
+ * Cache counters since the cache was opened
+ */
+typedef struct CountriesCacheStats {
+    size_t hits;                 // Fresh entries served without a request
+    size_t misses;               // No usable entry; fetched in full
+    size_t stale;                // Entries past their TTL that needed a request
+    size_t revalidated;          // Stale entries confirmed unchanged by a 304
+    size_t stale_served;         // Stale entries served because the request failed
+} CountriesCacheStats;
+
+/**
+ * Open a cache directory, creating it if needed
+ * @param dir Directory holding the cache entries
+ * @param ttl_seconds Age below which entries are used without revalidation (0 to always revalidate)
+ * @return Pointer to the cache, or NULL on failure
+ */
+CountriesCache *countries_cache_open(const char *dir, long ttl_seconds);
+
+/**
+ * Close a cache (entries stay on disk)
+ * @param cache The cache to close (NULL is ignored)
+ */
+void countries_cache_close(CountriesCache *cache);
+
+/**
+ * Load a country's cities into a tree, going to the network only if needed
+ * A fresh entry is used directly. Otherwise the country is fetched (or
+ * revalidated) and the entry is rewritten. If that request fails, a stale
+ * entry is served instead of failing. On failure the tree is unchanged.
+ * @param cache The cache to use
+ * @param options Request options (NULL for defaults)
+ * @param country Country name, for example "nigeria"
+ * @param tree The tree to load into (previous contents are replaced)
+ * @return COUNTRIES_OK on success, or the reason for failure
+ */
+CountriesStatus countries_cache_load_tree(CountriesCache *cache, const CountriesFetchOptions *options,
+                                          const char *country, BSTree *tree);
+
+/**
+ * Drop a country's entry
+ * @param cache The cache to modify
+ * @param country Country name
+ * @return 1 if an entry was removed, 0 if there was none
+ */
+int countries_cache_invalidate(CountriesCache *cache, const char *country);
+
+/**
+ * Read the cache counters
+ * @param cache The cache to inspect
+ * @param stats Receives the counters
+ */
+void countries_cache_stats(const CountriesCache *cache, CountriesCacheStats *stats);
+
+#endif // COUNTRIES_CACHE_H
@@ -0,0 +1,74 @@
+#ifndef COUNTRIES_CLIENT_H
+#define COUNTRIES_CLIENT_H
+
+#include "bst_tree.h"
+#include "city_stream.h"
+#include <stddef.h>
+
+/**
+ * CountriesNow API client
+ * Response bodies are parsed as they arrive from libcurl (see city_stream.h),
+ * so the raw body is never held in memory: cities are handed to a callback,
+ * or staged in a compact buffer and bulk-built into a tree.
+ */
+
+// Endpoint returning the cities of one country (POST {"country": "..."})
+#define COUNTRIES_API_URL "https://countriesnow.space/api/v0.1/countries/cities"
+
+/**
+ * Result of a request
+ */
+typedef enum CountriesStatus {
+    COUNTRIES_OK = 0,            // Every city was delivered
+    COUNTRIES_ERR_INVALID,       // Invalid arguments
+    COUNTRIES_ERR_NETWORK,       // Transfer failed (DNS, connect, timeout, ...)
+    COUNTRIES_ERR_HTTP,          // Server answered with a non-2xx status
+    COUNTRIES_ERR_RATE_LIMITED,  // Server answered 429 or 503 (after any retries)
+    COUNTRIES_ERR_PARSE,         // Body is not a valid city response
+    COUNTRIES_ERR_API,           // API reported an error (for example an unknown country)
+    COUNTRIES_ERR_ABORTED,       // The city callback asked to stop
+    COUNTRIES_ERR_MEMORY         // Allocation failure
+} CountriesStatus;
+
+/**
+ * Request options
+ * A zeroed struct (or NULL) selects the defaults.
+ */
+typedef struct CountriesFetchOptions {
+    const char *url;             // Endpoint URL (NULL for COUNTRIES_API_URL); file:// works for fixtures
+    long timeout_ms;             // Whole-transfer timeout in milliseconds (0 for no limit)
+} CountriesFetchOptions;
+
+/**
+ * Fetch the cities of a country, streaming each one to a callback
+ * Cities are delivered while the response is still downloading, so a
+ * failure status can follow cities that were already reported.
+ * @param options Request options (NULL for defaults)
+ * @param country Country name, for example "nigeria"
+ * @param on_city Callback for each city, in response order
+ * @param ctx Context pointer passed to the callback
+ * @return COUNTRIES_OK on success, or the reason for failure
+ */
+CountriesStatus countries_fetch_cities(const CountriesFetchOptions *options, const char *country,
+                                       CityStreamCallback on_city, void *ctx);
+
+/**
+ * Fetch the cities of a country and load them into a tree
+ * The tree's previous contents are replaced only if the whole response was
+ * received and parsed; on failure the tree is left unchanged.
+ * @param options Request options (NULL for defaults)
+ * @param country Country name, for example "nigeria"
+ * @param tree The tree to load into
+ * @return COUNTRIES_OK on success, or the reason for failure
+ */
+CountriesStatus countries_load_tree(const CountriesFetchOptions *options, const char *country,
+                                    BSTree *tree);
+
+/**
+ * Describe a status code
+ * @param status The status to describe
+ * @return A static, human-readable description
+ */
+const char *countries_status_string(CountriesStatus status);
+
+#endif // COUNTRIES_CLIENT_H
@@ -0,0 +1,55 @@
+#ifndef COUNTRIES_MULTI_H
+#define COUNTRIES_MULTI_H
+
+#include "countries_client.h"
+#include <stddef.h>
+
+/**
+ * Concurrent multi-country fetch
+ * Runs many city requests from one libcurl multi event loop. Connections
+ * are pooled and kept alive between requests, at most max_concurrency
+ * transfers are in flight, and 429/503 answers are retried with
+ * exponential backoff (honouring Retry-After). Each country's cities are
+ * merged into the tree as soon as its response completes.
+ */
+
+// Transfers in flight when max_concurrency is 0
+#define COUNTRIES_MULTI_DEFAULT_CONCURRENCY 4
+
+// Retries per country when max_retries is 0
+#define COUNTRIES_MULTI_DEFAULT_RETRIES 3
+
+// First backoff delay in milliseconds when backoff_ms is 0
+#define COUNTRIES_MULTI_DEFAULT_BACKOFF_MS 500
+
+// Upper bound on any single backoff delay in milliseconds
+#define COUNTRIES_MULTI_MAX_BACKOFF_MS 60000
+
+/**
+ * Fetch options
+ * A zeroed struct (or NULL) selects the defaults.
+ */
+typedef struct CountriesMultiOptions {
+    const char *url;             // Endpoint URL (NULL for COUNTRIES_API_URL)
+    long timeout_ms;             // Per-transfer timeout in milliseconds (0 for no limit)
+    size_t max_concurrency;      // Transfers in flight and pooled connections (0 for the default)
+    int max_retries;             // Retries after a 429/503 (0 for the default, negative for none)
+    long backoff_ms;             // First retry delay, doubled per attempt (0 for the default)
+} CountriesMultiOptions;
+
+/**
+ * Fetch several countries concurrently and merge their cities into a tree
+ * A country whose request fails contributes no cities; the others are
+ * still merged. Cities already in the tree are kept.
+ * @param options Fetch options (NULL for defaults)
+ * @param countries Country names, for example {"nigeria", "ghana"}
+ * @param n Number of countries
+ * @param tree The tree to merge into
+ * @param statuses Optional array of n entries receiving each country's status
+ * @return COUNTRIES_OK if every country succeeded, otherwise the status of
+ *         the first failed country (in input order)
+ */
+CountriesStatus countries_load_tree_many(const CountriesMultiOptions *options, const char **countries,
+                                         size_t n, BSTree *tree, CountriesStatus *statuses);
+
+#endif // COUNTRIES_MULTI_H
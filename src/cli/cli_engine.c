@@ -0,0 +1,376 @@
+#include "cli_engine.h"
+#include "bst_stats.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CLI_BUFFER_SIZE 65536    // Input block size, and the longest accepted line
+#define CLI_BATCH_MAX 4096       // Cities queued before a batch is applied
+
+typedef enum PendingKind {
+    PENDING_NONE,
+    PENDING_ADD,
+    PENDING_REMOVE
+} PendingKind;
+
+struct CliEngine {
+    BSTree *tree;
+    BSTWriter *out;
+    char *buffer;            // CLI_BUFFER_SIZE bytes plus room for a terminator
+    size_t fill;             // Bytes held, starting with an incomplete line
+    int discarding;          // Dropping the rest of an overlong line
+    int stopped;
+    PendingKind pending_kind;
+    size_t pending_count;
+    const char *pending[CLI_BATCH_MAX]; // Cities of the current run, pointing into buffer
+    CliEngineStats stats;
+};
+
+/**
+ * Create an engine
+ */
+CliEngine *cli_engine_create(BSTree *tree, BSTWriter *out) {
+    if (!tree || !out) {
+        return NULL;
+    }
+
+    CliEngine *engine = (CliEngine *)calloc(1, sizeof(CliEngine));
+    if (!engine) {
+        return NULL;
+    }
+    engine->buffer = (char *)malloc(CLI_BUFFER_SIZE + 1);
+    if (!engine->buffer) {
+        free(engine);
+        return NULL;
+    }
+
+    engine->tree = tree;
+    engine->out = out;
+    return engine;
+}
+
+/**
+ * Destroy an engine
+ */
+void cli_engine_destroy(CliEngine *engine) {
+    if (!engine) {
+        return;
+    }
+
+    free(engine->buffer);
+    free(engine);
+}
+
+/**
+ * Write a "line N: ..." message for the current line
+ */
+static void report(CliEngine *engine, const char *message, const char *detail) {
+    char text[160];
+    int used = snprintf(text, sizeof(text), "line %zu: %s%s%.64s%s\n", engine->stats.lines, message,
+                        detail ? " '" : "", detail ? detail : "", detail ? "'" : "");
+
+    engine->stats.errors++;
+    if (used > 0) {
+        bst_writer_put(engine->out, text, (size_t)used < sizeof(text) ? (size_t)used : sizeof(text) - 1);
+    }
+}
+
+/**
+ * Apply the queued run of adds or removes as one batch
+ */
+static int flush_pending(CliEngine *engine) {
+    size_t changed = 0;
+    int status = 0;
+
+    if (engine->pending_count == 0) {
+        return 0;
+    }
+
+    if (engine->pending_kind == PENDING_ADD) {
+        status = bst_tree_insert_batch(engine->tree, engine->pending, engine->pending_count, &changed);
+        engine->stats.added += changed;
+    } else {
+        status = bst_tree_remove_batch(engine->tree, engine->pending, engine->pending_count, &changed);
+        engine->stats.removed += changed;
+    }
+
+    engine->stats.batches++;
+    engine->pending_count = 0;
+    engine->pending_kind = PENDING_NONE;
+    return status;
+}
+
+/**
+ * Queue a city for the current run, applying the previous run first if it was of the other kind
+ */
+static int queue_city(CliEngine *engine, PendingKind kind, const char *city) {
+    if (engine->pending_kind != kind && flush_pending(engine) < 0) {
+        return -1;
+    }
+
+    engine->pending_kind = kind;
+    engine->pending[engine->pending_count++] = city;
+    if (engine->pending_count == CLI_BATCH_MAX) {
+        return flush_pending(engine);
+    }
+    return 0;
+}
+
+static int is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+/**
+ * Check that a city name has no control characters
+ */
+static int valid_city(const char *city) {
+    for (const unsigned char *p = (const unsigned char *)city; *p; p++) {
+        if (*p < 0x20 && *p != '\t') {
+            return 0;
+        }
+        if (*p == 0x7f) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Execute "stats", "stats json" or "stats reset"
+ * Queued updates are applied first so they show up in the counters.
+ */
+static int run_stats(CliEngine *engine, const char *arg) {
+    int json = strcmp(arg, "json") == 0;
+    int reset = strcmp(arg, "reset") == 0;
+    if (*arg != '\0' && !json && !reset) {
+        report(engine, "unexpected argument to", "stats");
+        return 0;
+    }
+
+    engine->stats.commands++;
+    if (flush_pending(engine) < 0) {
+        return -1;
+    }
+    if (reset) {
+        bst_stats_reset();
+        return 0;
+    }
+
+    BSTStatsReport *stats = (BSTStatsReport *)malloc(sizeof(BSTStatsReport));
+    if (!stats) {
+        return -1;
+    }
+    bst_stats_read(stats);
+    if (json) {
+        bst_stats_write_json(stats, engine->out);
+    } else {
+        bst_stats_write_text(stats, engine->out);
+    }
+    free(stats);
+    return 0;
+}
+
+/**
+ * Parse and execute one NUL-terminated line in place
+ */
+static int execute_line(CliEngine *engine, char *line, size_t len) {
+    // Trim the line, then split off the command word
+    while (len > 0 && is_blank(line[len - 1])) {
+        len--;
+    }
+    line[len] = '\0';
+    while (is_blank(*line)) {
+        line++;
+    }
+    if (*line == '\0' || *line == '#') {
+        return 0;
+    }
+
+    char *arg = line;
+    while (*arg && !is_blank(*arg)) {
+        arg++;
+    }
+    size_t command_len = (size_t)(arg - line);
+    while (is_blank(*arg)) {
+        *arg++ = '\0';
+    }
+
+    PendingKind kind = PENDING_NONE;
+    if (command_len == 3 && memcmp(line, "add", 3) == 0) {
+        kind = PENDING_ADD;
+    } else if (command_len == 6 && memcmp(line, "remove", 6) == 0) {
+        kind = PENDING_REMOVE;
+    }
+    if (kind != PENDING_NONE) {
+        if (*arg == '\0') {
+            report(engine, "missing city for", line);
+            return 0;
+        }
+        if (!valid_city(arg)) {
+            report(engine, "control character in city for", line);
+            return 0;
+        }
+        engine->stats.commands++;
+        return queue_city(engine, kind, arg);
+    }
+
+    if (command_len == 5 && memcmp(line, "stats", 5) == 0) {
+        return run_stats(engine, arg);
+    }
+
+    int is_print = command_len == 5 && memcmp(line, "print", 5) == 0;
+    int is_stop = command_len == 4 && memcmp(line, "stop", 4) == 0;
+    if (is_print || is_stop) {
+        if (*arg != '\0') {
+            report(engine, "unexpected argument to", line);
+            return 0;
+        }
+        engine->stats.commands++;
+        if (flush_pending(engine) < 0) {
+            return -1;
+        }
+        if (is_stop) {
+            engine->stopped = 1;
+        } else {
+            bst_write_rotated(bst_tree_root(engine->tree), 0, engine->out);
+        }
+        return 0;
+    }
+
+    report(engine, "unknown command", line);
+    return 0;
+}
+
+/**
+ * Execute the complete lines held in the buffer (and a partial last line if final)
+ * Pending batches point into the buffer, so they are applied before the
+ * partial line is moved to the front.
+ */
+static int process_buffer(CliEngine *engine, int final) {
+    char *start = engine->buffer;
+    char *end = engine->buffer + engine->fill;
+    int status = 0;
+
+    while (start < end && !engine->stopped && status == 0) {
+        char *newline = (char *)memchr(start, '\n', (size_t)(end - start));
+        if (!newline) {
+            if (!final) {
+                break;
+            }
+            newline = end;
+        }
+        *newline = '\0';
+        engine->stats.lines++;
+
+        if (engine->discarding) {
+            engine->discarding = 0;
+            report(engine, "line too long", NULL);
+        } else {
+            status = execute_line(engine, start, (size_t)(newline - start));
+        }
+        start = newline + 1;
+    }
+    if (final && engine->discarding && status == 0) {
+        engine->discarding = 0;
+        engine->stats.lines++;
+        report(engine, "line too long", NULL);
+    }
+
+    if (flush_pending(engine) < 0) {
+        status = -1;
+    }
+
+    // Keep the partial line; a line that fills the whole buffer is dropped
+    size_t remaining = start < end && !engine->stopped ? (size_t)(end - start) : 0;
+    if (remaining == CLI_BUFFER_SIZE) {
+        engine->discarding = 1;
+        remaining = 0;
+    }
+    memmove(engine->buffer, start, remaining);
+    engine->fill = remaining;
+
+    bst_writer_flush(engine->out);
+    return status;
+}
+
+/**
+ * Read one block from a descriptor and execute the complete lines in it
+ */
+long cli_engine_read(CliEngine *engine, int fd) {
+    if (!engine || engine->stopped) {
+        return 0;
+    }
+
+    ssize_t got = read(fd, engine->buffer + engine->fill, CLI_BUFFER_SIZE - engine->fill);
+    if (got <= 0) {
+        return got < 0 ? -1 : 0;
+    }
+
+    engine->fill += (size_t)got;
+    if (process_buffer(engine, 0) < 0) {
+        errno = ENOMEM;
+        return -1;
+    }
+    return (long)got;
+}
+
+/**
+ * Execute the complete lines in a chunk of input
+ */
+int cli_engine_feed(CliEngine *engine, const char *data, size_t len) {
+    if (!engine || (!data && len > 0)) {
+        return -1;
+    }
+
+    while (len > 0 && !engine->stopped) {
+        size_t take = CLI_BUFFER_SIZE - engine->fill;
+        if (take > len) {
+            take = len;
+        }
+        memcpy(engine->buffer + engine->fill, data, take);
+        engine->fill += take;
+        data += take;
+        len -= take;
+
+        if (process_buffer(engine, 0) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * End the input
+ */
+int cli_engine_finish(CliEngine *engine) {
+    if (!engine) {
+        return -1;
+    }
+
+    int status = engine->stopped ? 0 : process_buffer(engine, 1);
+    engine->fill = 0;
+    if (bst_writer_flush(engine->out) < 0) {
+        return -1;
+    }
+    return status;
+}
+
+/**
+ * Check whether a stop command has been executed
+ */
+int cli_engine_stopped(const CliEngine *engine) {
+    return engine ? engine->stopped : 0;
+}
+
+/**
+ * Get the engine's counters
+ */
+void cli_engine_stats(const CliEngine *engine, CliEngineStats *stats) {
+    if (!engine || !stats) {
+        return;
+    }
+
+    *stats = engine->stats;
+}
@@ -0,0 +1,100 @@
+#include "cli_shutdown.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stddef.h>
+#include <unistd.h>
+
+static const int shutdown_signals[] = {SIGINT, SIGTERM, SIGHUP};
+
+#define SHUTDOWN_SIGNAL_COUNT (sizeof(shutdown_signals) / sizeof(shutdown_signals[0]))
+
+static volatile sig_atomic_t received_signal;
+static int wake_pipe[2] = {-1, -1};
+
+/**
+ * Record the signal and wake the loop; a repeated signal takes its default action
+ */
+static void on_shutdown_signal(int signo) {
+    int saved_errno = errno;
+
+    if (received_signal) {
+        signal(signo, SIG_DFL);
+        raise(signo);
+    } else {
+        received_signal = signo;
+        char byte = (char)signo;
+        ssize_t written = write(wake_pipe[1], &byte, 1);
+        (void)written;
+    }
+
+    errno = saved_errno;
+}
+
+/**
+ * Make a descriptor non-blocking and close-on-exec
+ */
+static int configure_fd(int fd) {
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        return -1;
+    }
+    return fcntl(fd, F_SETFD, FD_CLOEXEC);
+}
+
+/**
+ * Install the handlers and create the self-pipe
+ */
+int cli_shutdown_install(void) {
+    if (wake_pipe[0] >= 0) {
+        return wake_pipe[0];
+    }
+
+    if (pipe(wake_pipe) < 0) {
+        return -1;
+    }
+    if (configure_fd(wake_pipe[0]) < 0 || configure_fd(wake_pipe[1]) < 0) {
+        cli_shutdown_uninstall();
+        return -1;
+    }
+
+    struct sigaction action;
+    action.sa_handler = on_shutdown_signal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = 0;
+    for (size_t i = 0; i < SHUTDOWN_SIGNAL_COUNT; i++) {
+        sigaddset(&action.sa_mask, shutdown_signals[i]);
+    }
+    for (size_t i = 0; i < SHUTDOWN_SIGNAL_COUNT; i++) {
+        if (sigaction(shutdown_signals[i], &action, NULL) < 0) {
+            cli_shutdown_uninstall();
+            return -1;
+        }
+    }
+
+    return wake_pipe[0];
+}
+
+/**
+ * Get the shutdown signal
+ */
+int cli_shutdown_signal(void) {
+    return (int)received_signal;
+}
+
+/**
+ * Restore the default handlers and close the pipe
+ */
+void cli_shutdown_uninstall(void) {
+    for (size_t i = 0; i < SHUTDOWN_SIGNAL_COUNT; i++) {
+        signal(shutdown_signals[i], SIG_DFL);
+    }
+
+    for (int i = 0; i < 2; i++) {
+        if (wake_pipe[i] >= 0) {
+            close(wake_pipe[i]);
+            wake_pipe[i] = -1;
+        }
+    }
+    received_signal = 0;
+}
@@ -1,11 +1,206 @@
+#include "bst_snapshot.h"
+#include "bst_tree.h"
+#include "bst_writer.h"
+#include "cli_engine.h"
+#include "cli_shutdown.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
 
-int main(int args, char *argv[]) {
-    int input;
-    printf("Passed %d arguments to %s\n", args, argv[0]);
+/*
+ * Usage: citysorter [--batch FILE] [--snapshot PATH] [--verify-snapshot] [--full-cleanup]
+ * Without arguments, commands are read from stdin (with a prompt when stdin
+ * is a terminal). With --batch, they are read from FILE (- for stdin) and a
+ * throughput summary is printed to stderr once the input ends.
+ *
+ * SIGINT, SIGTERM and SIGHUP stop reading input; commands from blocks
+ * already read are applied, a partial last line is dropped, and the exit
+ * path below runs as for stop. With --snapshot, the tree is loaded from
+ * PATH at startup (if the file exists) and saved there on exit; the tree is
+ * built straight from the snapshot's sorted names, and the checksum over
+ * the whole file is only checked with --verify-snapshot.
+ *
+ * By default nothing is freed at exit: once the output is flushed and the
+ * snapshot written nothing else depends on the tree, and the kernel
+ * reclaims the whole heap at once. --full-cleanup (the default under
+ * AddressSanitizer) frees everything, for leak checkers; the tree is
+ * arena-backed, so that releases chunks rather than walking every node.
+ */
 
-    printf("Pick a number from 0-10: ");
-    scanf("%d", &input);
-    printf("You picked %d\n", input);
-    return 0;
-}
\ No newline at end of file
+#if defined(__SANITIZE_ADDRESS__)
+#define DEFAULT_FULL_CLEANUP 1
+#else
+#define DEFAULT_FULL_CLEANUP 0
+#endif
+
+// Monotonic clock in seconds
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void usage(const char *program) {
+    fprintf(stderr, "usage: %s [--batch FILE] [--snapshot PATH] [--verify-snapshot] [--full-cleanup]\n",
+            program);
+}
+
+/**
+ * Load the tree from a snapshot file written on a previous exit
+ * The names are already sorted, so the arena tree is built in one pass.
+ * Returns 0 if the file does not exist, -1 if it cannot be loaded.
+ */
+static int restore_snapshot(BSTree *tree, const char *path, unsigned flags) {
+    if (access(path, F_OK) < 0) {
+        return 0;
+    }
+
+    BSTSnapshot *snapshot = bst_open_snapshot(path, flags);
+    if (!snapshot) {
+        return -1;
+    }
+
+    size_t count = bst_snapshot_count(snapshot);
+    const char **names = (const char **)malloc((count ? count : 1) * sizeof(*names));
+    int status = -1;
+    if (names) {
+        status = bst_tree_load(tree, names, bst_snapshot_names(snapshot, names));
+    }
+
+    free(names);
+    bst_snapshot_free(snapshot);
+    return status;
+}
+
+int main(int argc, char *argv[]) {
+    const char *batch_path = NULL;
+    const char *snapshot_path = NULL;
+    unsigned snapshot_flags = 0;
+    int full_cleanup = DEFAULT_FULL_CLEANUP;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batch_path = argv[++i];
+        } else if (strcmp(argv[i], "--snapshot") == 0 && i + 1 < argc) {
+            snapshot_path = argv[++i];
+        } else if (strcmp(argv[i], "--verify-snapshot") == 0) {
+            snapshot_flags |= BST_SNAPSHOT_VERIFY;
+        } else if (strcmp(argv[i], "--full-cleanup") == 0) {
+            full_cleanup = 1;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    int in = STDIN_FILENO;
+    if (batch_path && strcmp(batch_path, "-") != 0) {
+        in = open(batch_path, O_RDONLY);
+        if (in < 0) {
+            perror(batch_path);
+            return 1;
+        }
+    }
+    int interactive = !batch_path && isatty(in);
+
+    int wake_fd = cli_shutdown_install();
+    if (wake_fd < 0) {
+        perror("signal handlers");
+        return 1;
+    }
+
+    static char out_buffer[65536];
+    BSTWriter out;
+    bst_writer_init_fd(&out, STDOUT_FILENO, out_buffer, sizeof(out_buffer));
+
+    BSTree *tree = bst_tree_create(BST_TREE_ARENA);
+    CliEngine *engine = tree ? cli_engine_create(tree, &out) : NULL;
+    if (!engine) {
+        fprintf(stderr, "out of memory\n");
+        bst_tree_destroy(tree);
+        return 1;
+    }
+    if (snapshot_path && restore_snapshot(tree, snapshot_path, snapshot_flags) < 0) {
+        fprintf(stderr, "%s: cannot load snapshot\n", snapshot_path);
+        cli_engine_destroy(engine);
+        bst_tree_destroy(tree);
+        return 1;
+    }
+
+    // Wait for input or a shutdown signal, whichever comes first
+    struct pollfd fds[2] = {{in, POLLIN, 0}, {wake_fd, POLLIN, 0}};
+    double start = now_seconds();
+    int status = 0;
+    int prompt = interactive;
+    while (!cli_shutdown_signal()) {
+        if (prompt) {
+            bst_writer_put(&out, "> ", 2);
+            bst_writer_flush(&out);
+            prompt = 0;
+        }
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("poll");
+            status = 1;
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            break;
+        }
+
+        long got = cli_engine_read(engine, in);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got < 0) {
+            perror(batch_path ? batch_path : "stdin");
+            status = 1;
+            break;
+        }
+        if (got == 0 || cli_engine_stopped(engine)) {
+            break;
+        }
+        prompt = interactive;
+    }
+
+    int signo = cli_shutdown_signal();
+    if (signo) {
+        // Stop ingestion: every block read so far has been applied
+        bst_writer_flush(&out);
+        fprintf(stderr, "caught signal %d, shutting down\n", signo);
+        status = 128 + signo;
+    } else if (cli_engine_finish(engine) < 0) {
+        status = 1;
+    }
+    double elapsed = now_seconds() - start;
+
+    CliEngineStats stats;
+    cli_engine_stats(engine, &stats);
+    if (batch_path) {
+        fprintf(stderr, "%zu commands (%zu added, %zu removed, %zu errors) in %.3f s: %.0f commands/sec, %zu batches\n",
+                stats.commands, stats.added, stats.removed, stats.errors, elapsed,
+                elapsed > 0 ? (double)stats.commands / elapsed : 0.0, stats.batches);
+    }
+
+    if (snapshot_path && bst_save_snapshot(bst_tree_root(tree), snapshot_path) < 0) {
+        fprintf(stderr, "%s: cannot save snapshot\n", snapshot_path);
+        status = status ? status : 1;
+    }
+
+    if (full_cleanup) {
+        cli_engine_destroy(engine);
+        bst_tree_destroy(tree);
+        cli_shutdown_uninstall();
+        if (in != STDIN_FILENO) {
+            close(in);
+        }
+    }
+    return status;
+}
@@ -0,0 +1,440 @@
+#include "countries_cache.h"
+#include "countries_request.h"
+#include "city_batch.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// First line of every entry; bump the version when the layout changes
+#define CACHE_MAGIC "citysorter-cache 1"
+
+/*
+ * Entry layout: a text header, a blank line, then the city names, each
+ * terminated by a NUL byte (city names never contain NUL).
+ *
+ *   citysorter-cache 1
+ *   fetched 1760000000
+ *   etag "abc"
+ *   last-modified Wed, 01 Oct 2025 10:00:00 GMT
+ *   count 2
+ *
+ *   Aba\0Abuja\0
+ */
+
+struct CountriesCache {
+    char *dir;
+    long ttl_seconds;
+    CountriesCacheStats stats;
+};
+
+/**
+ * A cache entry read back from disk
+ */
+typedef struct CacheEntry {
+    long long fetched;           // Unix time of the last successful request
+    char etag[COUNTRIES_VALIDATOR_SIZE];
+    char last_modified[COUNTRIES_VALIDATOR_SIZE];
+    char *data;                  // Whole file; names point into it
+    const char **names;
+    size_t count;
+} CacheEntry;
+
+/**
+ * Open a cache directory, creating it if needed
+ */
+CountriesCache *countries_cache_open(const char *dir, long ttl_seconds) {
+    if (!dir || dir[0] == '\0' || ttl_seconds < 0) {
+        return NULL;
+    }
+
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        return NULL;
+    }
+
+    CountriesCache *cache = (CountriesCache *)calloc(1, sizeof(CountriesCache));
+    if (!cache || !(cache->dir = strdup(dir))) {
+        free(cache);
+        return NULL;
+    }
+
+    cache->ttl_seconds = ttl_seconds;
+    return cache;
+}
+
+/**
+ * Close a cache (entries stay on disk)
+ */
+void countries_cache_close(CountriesCache *cache) {
+    if (!cache) {
+        return;
+    }
+
+    free(cache->dir);
+    free(cache);
+}
+
+/**
+ * Build "<dir>/<country>.cities", percent-encoding bytes that are not
+ * safe in a file name
+ */
+static char *entry_path(const CountriesCache *cache, const char *country) {
+    size_t dir_len = strlen(cache->dir);
+    char *path = (char *)malloc(dir_len + 1 + strlen(country) * 3 + sizeof(".cities"));
+    if (!path) {
+        return NULL;
+    }
+
+    char *out = path + sprintf(path, "%s/", cache->dir);
+    for (const unsigned char *c = (const unsigned char *)country; *c; c++) {
+        if ((*c >= 'a' && *c <= 'z') || (*c >= 'A' && *c <= 'Z') || (*c >= '0' && *c <= '9')
+            || *c == '-' || *c == '_') {
+            *out++ = (char)*c;
+        } else {
+            out += sprintf(out, "%%%02X", *c);
+        }
+    }
+    strcpy(out, ".cities");
+
+    return path;
+}
+
+static void entry_free(CacheEntry *entry) {
+    free(entry->data);
+    free(entry->names);
+    memset(entry, 0, sizeof(*entry));
+}
+
+/**
+ * Copy the value of a "<key> <value>" header line
+ */
+static int header_value(const char *line, const char *key, char *out, size_t out_size) {
+    size_t key_len = strlen(key);
+
+    if (strncmp(line, key, key_len) != 0 || line[key_len] != ' ') {
+        return 0;
+    }
+
+    size_t len = strlen(line + key_len + 1);
+    if (len >= out_size) {
+        return 0;
+    }
+
+    memcpy(out, line + key_len + 1, len + 1);
+    return 1;
+}
+
+/**
+ * Read an entry; a missing, truncated or foreign file counts as absent
+ */
+static int read_entry(const char *path, CacheEntry *entry) {
+    memset(entry, 0, sizeof(*entry));
+
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return -1;
+    }
+
+    long size = -1;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        size = ftell(file);
+    }
+    if (size <= 0 || fseek(file, 0, SEEK_SET) != 0 || !(entry->data = (char *)malloc((size_t)size + 1))
+        || fread(entry->data, 1, (size_t)size, file) != (size_t)size) {
+        fclose(file);
+        entry_free(entry);
+        return -1;
+    }
+    fclose(file);
+    entry->data[size] = '\0';
+
+    // Header: one "key value" per line up to a blank line
+    char *end = entry->data + size;
+    char *line = entry->data;
+    int have_magic = 0, have_fetched = 0, have_count = 0;
+    char value[COUNTRIES_VALIDATOR_SIZE];
+
+    for (;;) {
+        char *newline = memchr(line, '\n', (size_t)(end - line));
+        if (!newline) {
+            entry_free(entry);
+            return -1;
+        }
+        *newline = '\0';
+
+        if (line == newline) {
+            line = newline + 1;
+            break;
+        }
+
+        if (strcmp(line, CACHE_MAGIC) == 0) {
+            have_magic = 1;
+        } else if (header_value(line, "fetched", value, sizeof(value))) {
+            entry->fetched = strtoll(value, NULL, 10);
+            have_fetched = 1;
+        } else if (header_value(line, "count", value, sizeof(value))) {
+            entry->count = (size_t)strtoull(value, NULL, 10);
+            have_count = 1;
+        } else {
+            header_value(line, "etag", entry->etag, sizeof(entry->etag));
+            header_value(line, "last-modified", entry->last_modified, sizeof(entry->last_modified));
+        }
+
+        line = newline + 1;
+    }
+
+    if (!have_magic || !have_fetched || !have_count || entry->count > (size_t)(end - line)) {
+        entry_free(entry);
+        return -1;
+    }
+
+    // Names: exactly count NUL-terminated strings filling the rest of the file
+    entry->names = (const char **)malloc((entry->count ? entry->count : 1) * sizeof(*entry->names));
+    if (!entry->names) {
+        entry_free(entry);
+        return -1;
+    }
+
+    for (size_t i = 0; i < entry->count; i++) {
+        char *nul = memchr(line, '\0', (size_t)(end - line));
+        if (!nul) {
+            entry_free(entry);
+            return -1;
+        }
+        entry->names[i] = line;
+        line = nul + 1;
+    }
+
+    if (line != end) {
+        entry_free(entry);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Write an entry atomically: temporary file, fsync, rename, fsync the directory
+ */
+static int write_entry(const CountriesCache *cache, const char *path, long long fetched,
+                       const char *etag, const char *last_modified, const char **names, size_t count) {
+    size_t path_len = strlen(path);
+    char *tmp_path = (char *)malloc(path_len + sizeof(".XXXXXX"));
+    if (!tmp_path) {
+        return -1;
+    }
+    memcpy(tmp_path, path, path_len);
+    memcpy(tmp_path + path_len, ".XXXXXX", sizeof(".XXXXXX"));
+
+    int fd = mkstemp(tmp_path);
+    FILE *file = fd >= 0 ? fdopen(fd, "wb") : NULL;
+    if (!file) {
+        if (fd >= 0) {
+            close(fd);
+            unlink(tmp_path);
+        }
+        free(tmp_path);
+        return -1;
+    }
+
+    int ok = fprintf(file, "%s\nfetched %lld\n", CACHE_MAGIC, fetched) > 0;
+    if (ok && etag && etag[0]) {
+        ok = fprintf(file, "etag %s\n", etag) > 0;
+    }
+    if (ok && last_modified && last_modified[0]) {
+        ok = fprintf(file, "last-modified %s\n", last_modified) > 0;
+    }
+    ok = ok && fprintf(file, "count %zu\n\n", count) > 0;
+
+    for (size_t i = 0; ok && i < count; i++) {
+        ok = fwrite(names[i], 1, strlen(names[i]) + 1, file) == strlen(names[i]) + 1;
+    }
+
+    ok = ok && fflush(file) == 0 && fsync(fileno(file)) == 0;
+    ok = fclose(file) == 0 && ok;
+    ok = ok && rename(tmp_path, path) == 0;
+
+    if (!ok) {
+        unlink(tmp_path);
+    } else {
+        // Make the rename itself durable
+        int dir_fd = open(cache->dir, O_RDONLY);
+        if (dir_fd >= 0) {
+            fsync(dir_fd);
+            close(dir_fd);
+        }
+    }
+
+    free(tmp_path);
+    return ok ? 0 : -1;
+}
+
+/**
+ * Add If-None-Match / If-Modified-Since for a stale entry
+ */
+static CountriesStatus add_validators(CountriesRequest *req, const CacheEntry *entry) {
+    char header[COUNTRIES_VALIDATOR_SIZE + 32];
+
+    if (entry->etag[0]) {
+        snprintf(header, sizeof(header), "If-None-Match: %s", entry->etag);
+        if (countries_request_add_header(req, header) != COUNTRIES_OK) {
+            return COUNTRIES_ERR_MEMORY;
+        }
+    }
+    if (entry->last_modified[0]) {
+        snprintf(header, sizeof(header), "If-Modified-Since: %s", entry->last_modified);
+        if (countries_request_add_header(req, header) != COUNTRIES_OK) {
+            return COUNTRIES_ERR_MEMORY;
+        }
+    }
+
+    return COUNTRIES_OK;
+}
+
+/**
+ * Load an entry's names into the tree
+ */
+static CountriesStatus load_entry(const CacheEntry *entry, BSTree *tree) {
+    return bst_tree_load(tree, entry->names, entry->count) == 0 ? COUNTRIES_OK : COUNTRIES_ERR_MEMORY;
+}
+
+/**
+ * Request the country (conditionally when a stale entry exists) and
+ * update the entry and the tree from the answer
+ */
+static CountriesStatus refresh(CountriesCache *cache, const CountriesFetchOptions *options,
+                               const char *country, const char *path, CacheEntry *entry, int have_entry,
+                               BSTree *tree) {
+    CityBatch *batch = city_batch_create();
+    if (!batch) {
+        return COUNTRIES_ERR_MEMORY;
+    }
+
+    CountriesRequest req;
+    CountriesStatus status = countries_request_init(&req, options, country, city_batch_collect, batch);
+    if (status != COUNTRIES_OK) {
+        city_batch_destroy(batch);
+        return status;
+    }
+
+    if (have_entry) {
+        status = add_validators(&req, entry);
+    }
+
+    CURLcode result = status == COUNTRIES_OK ? curl_easy_perform(req.curl) : CURLE_FAILED_INIT;
+    long http_code = 0;
+    curl_easy_getinfo(req.curl, CURLINFO_RESPONSE_CODE, &http_code);
+    long long now = (long long)time(NULL);
+
+    if (status != COUNTRIES_OK) {
+        // Setup failed; nothing was sent
+    } else if (have_entry && result == CURLE_OK && http_code == 304) {
+        // Unchanged: keep the names, restart the TTL, keep validators the server did not resend
+        cache->stats.revalidated++;
+        write_entry(cache, path, now, req.etag[0] ? req.etag : entry->etag,
+                    req.last_modified[0] ? req.last_modified : entry->last_modified,
+                    entry->names, entry->count);
+        status = load_entry(entry, tree);
+    } else {
+        status = countries_request_finish(&req, result);
+
+        // The batch callback only stops the stream when it runs out of memory
+        if (status == COUNTRIES_ERR_ABORTED) {
+            status = COUNTRIES_ERR_MEMORY;
+        }
+
+        if (status == COUNTRIES_OK) {
+            size_t count = city_batch_count(batch);
+            const char **names = city_batch_names(batch);
+
+            if (count > 0 && !names) {
+                status = COUNTRIES_ERR_MEMORY;
+            } else {
+                // A failed write only costs a refetch next time
+                write_entry(cache, path, now, req.etag, req.last_modified, names, count);
+                if (bst_tree_load(tree, names, count) != 0) {
+                    status = COUNTRIES_ERR_MEMORY;
+                }
+            }
+        } else if (have_entry && (status == COUNTRIES_ERR_NETWORK || status == COUNTRIES_ERR_HTTP
+                                  || status == COUNTRIES_ERR_RATE_LIMITED)) {
+            // Old cities beat no cities when the service is unreachable
+            cache->stats.stale_served++;
+            status = load_entry(entry, tree);
+        }
+    }
+
+    countries_request_cleanup(&req);
+    city_batch_destroy(batch);
+    return status;
+}
+
+/**
+ * Load a country's cities into a tree, going to the network only if needed
+ */
+CountriesStatus countries_cache_load_tree(CountriesCache *cache, const CountriesFetchOptions *options,
+                                          const char *country, BSTree *tree) {
+    if (!cache || !country || country[0] == '\0' || !tree) {
+        return COUNTRIES_ERR_INVALID;
+    }
+
+    char *path = entry_path(cache, country);
+    if (!path) {
+        return COUNTRIES_ERR_MEMORY;
+    }
+
+    CacheEntry entry;
+    int have_entry = read_entry(path, &entry) == 0;
+    long long age = (long long)time(NULL) - entry.fetched;
+    CountriesStatus status;
+
+    if (have_entry && age >= 0 && age < cache->ttl_seconds) {
+        cache->stats.hits++;
+        status = load_entry(&entry, tree);
+    } else {
+        if (have_entry) {
+            cache->stats.stale++;
+        } else {
+            cache->stats.misses++;
+        }
+        status = refresh(cache, options, country, path, &entry, have_entry, tree);
+    }
+
+    entry_free(&entry);
+    free(path);
+    return status;
+}
+
+/**
+ * Drop a country's entry
+ */
+int countries_cache_invalidate(CountriesCache *cache, const char *country) {
+    if (!cache || !country) {
+        return 0;
+    }
+
+    char *path = entry_path(cache, country);
+    int removed = path && unlink(path) == 0;
+
+    free(path);
+    return removed;
+}
+
+/**
+ * Read the cache counters
+ */
+void countries_cache_stats(const CountriesCache *cache, CountriesCacheStats *stats) {
+    if (!stats) {
+        return;
+    }
+
+    if (cache) {
+        *stats = cache->stats;
+    } else {
+        memset(stats, 0, sizeof(*stats));
+    }
+}
@@ -0,0 +1,84 @@
+#include "countries_client.h"
+#include "countries_request.h"
+#include "city_batch.h"
+
+/**
+ * Fetch the cities of a country, streaming each one to a callback
+ */
+CountriesStatus countries_fetch_cities(const CountriesFetchOptions *options, const char *country,
+                                       CityStreamCallback on_city, void *ctx) {
+    CountriesRequest req;
+    CountriesStatus status = countries_request_init(&req, options, country, on_city, ctx);
+    if (status != COUNTRIES_OK) {
+        return status;
+    }
+
+    status = countries_request_finish(&req, curl_easy_perform(req.curl));
+
+    countries_request_cleanup(&req);
+    return status;
+}
+
+/**
+ * Fetch the cities of a country and load them into a tree
+ * Names are staged in a CityBatch (one packed block, no per-city
+ * allocation) and the tree is bulk-built once the response is complete.
+ */
+CountriesStatus countries_load_tree(const CountriesFetchOptions *options, const char *country,
+                                    BSTree *tree) {
+    if (!tree) {
+        return COUNTRIES_ERR_INVALID;
+    }
+
+    CityBatch *batch = city_batch_create();
+    if (!batch) {
+        return COUNTRIES_ERR_MEMORY;
+    }
+
+    CountriesStatus status = countries_fetch_cities(options, country, city_batch_collect, batch);
+
+    // The batch callback only stops the stream when it runs out of memory
+    if (status == COUNTRIES_ERR_ABORTED) {
+        status = COUNTRIES_ERR_MEMORY;
+    }
+
+    if (status == COUNTRIES_OK) {
+        size_t count = city_batch_count(batch);
+        const char **names = city_batch_names(batch);
+
+        if ((count > 0 && !names) || bst_tree_load(tree, names, count) != 0) {
+            status = COUNTRIES_ERR_MEMORY;
+        }
+    }
+
+    city_batch_destroy(batch);
+    return status;
+}
+
+/**
+ * Describe a status code
+ */
+const char *countries_status_string(CountriesStatus status) {
+    switch (status) {
+        case COUNTRIES_OK:
+            return "success";
+        case COUNTRIES_ERR_INVALID:
+            return "invalid argument";
+        case COUNTRIES_ERR_NETWORK:
+            return "network error";
+        case COUNTRIES_ERR_HTTP:
+            return "unexpected HTTP status";
+        case COUNTRIES_ERR_RATE_LIMITED:
+            return "rate limited";
+        case COUNTRIES_ERR_PARSE:
+            return "malformed response";
+        case COUNTRIES_ERR_API:
+            return "API reported an error";
+        case COUNTRIES_ERR_ABORTED:
+            return "aborted by callback";
+        case COUNTRIES_ERR_MEMORY:
+            return "out of memory";
+    }
+
+    return "unknown status";
+}
@@ -0,0 +1,337 @@
+#include "countries_multi.h"
+#include "countries_request.h"
+#include "city_batch.h"
+#include <stdlib.h>
+#include <time.h>
+
+typedef enum JobState {
+    JOB_QUEUED,                  // Not started yet
+    JOB_RUNNING,                 // Transfer attached to the multi handle
+    JOB_BACKOFF,                 // Rate limited, waiting until due_ms
+    JOB_DONE                     // Finished with a final status
+} JobState;
+
+/**
+ * One country's request and its staged cities
+ */
+typedef struct FetchJob {
+    const char *country;
+    CountriesRequest req;
+    CityBatch *batch;
+    JobState state;
+    int retries;                 // Retries used so far
+    long long due_ms;            // Earliest start time while in JOB_BACKOFF
+    CountriesStatus status;
+} FetchJob;
+
+/**
+ * Event loop state
+ */
+typedef struct FetchLoop {
+    CURLM *multi;
+    FetchJob *jobs;
+    size_t n;
+    size_t next_queued;          // Jobs before this index have been started at least once
+    size_t running;
+    size_t max_concurrency;
+    int max_retries;
+    long backoff_ms;
+    long long paused_until_ms;   // No new transfers start before this time
+    const CountriesMultiOptions *options;
+    BSTree *tree;
+} FetchLoop;
+
+/**
+ * Milliseconds on a monotonic clock
+ */
+static long long now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * Attach a job's transfer to the multi handle
+ */
+static void start_job(FetchLoop *loop, FetchJob *job) {
+    CountriesFetchOptions fetch = {loop->options ? loop->options->url : NULL,
+                                   loop->options ? loop->options->timeout_ms : 0};
+
+    city_batch_clear(job->batch);
+    CountriesStatus status = countries_request_init(&job->req, &fetch, job->country,
+                                                    city_batch_collect, job->batch);
+    if (status != COUNTRIES_OK) {
+        job->status = status;
+        job->state = JOB_DONE;
+        return;
+    }
+
+    curl_easy_setopt(job->req.curl, CURLOPT_PRIVATE, job);
+    curl_easy_setopt(job->req.curl, CURLOPT_PIPEWAIT, 1L);
+
+    if (curl_multi_add_handle(loop->multi, job->req.curl) != CURLM_OK) {
+        countries_request_cleanup(&job->req);
+        job->status = COUNTRIES_ERR_MEMORY;
+        job->state = JOB_DONE;
+        return;
+    }
+
+    job->state = JOB_RUNNING;
+    loop->running++;
+}
+
+/**
+ * Start transfers until the concurrency cap is reached
+ * Jobs whose backoff has expired go first so a retry is not starved by
+ * the remaining queue.
+ */
+static void fill_slots(FetchLoop *loop, long long now) {
+    if (now < loop->paused_until_ms) {
+        return;
+    }
+
+    for (size_t i = 0; i < loop->next_queued && loop->running < loop->max_concurrency; i++) {
+        FetchJob *job = &loop->jobs[i];
+        if (job->state == JOB_BACKOFF && job->due_ms <= now) {
+            start_job(loop, job);
+        }
+    }
+
+    while (loop->next_queued < loop->n && loop->running < loop->max_concurrency) {
+        start_job(loop, &loop->jobs[loop->next_queued++]);
+    }
+}
+
+/**
+ * Schedule a rate-limited job for another attempt
+ * The delay doubles per retry and never undercuts the server's Retry-After.
+ * New transfers are held back for the same period, since the limit usually
+ * applies to the whole client rather than one country.
+ */
+static void schedule_retry(FetchLoop *loop, FetchJob *job, long long now) {
+    long long delay = loop->backoff_ms;
+    for (int i = 0; i < job->retries && delay < COUNTRIES_MULTI_MAX_BACKOFF_MS; i++) {
+        delay *= 2;
+    }
+
+    curl_off_t retry_after = 0;
+    curl_easy_getinfo(job->req.curl, CURLINFO_RETRY_AFTER, &retry_after);
+    if (retry_after > 0 && retry_after * 1000 > delay) {
+        delay = retry_after * 1000;
+    }
+    if (delay > COUNTRIES_MULTI_MAX_BACKOFF_MS) {
+        delay = COUNTRIES_MULTI_MAX_BACKOFF_MS;
+    }
+
+    job->retries++;
+    job->due_ms = now + delay;
+    job->state = JOB_BACKOFF;
+
+    if (job->due_ms > loop->paused_until_ms) {
+        loop->paused_until_ms = job->due_ms;
+    }
+}
+
+/**
+ * Merge a completed job's cities into the tree
+ */
+static CountriesStatus merge_cities(FetchLoop *loop, FetchJob *job) {
+    size_t count = city_batch_count(job->batch);
+    const char **names = city_batch_names(job->batch);
+
+    if (count > 0 && !names) {
+        return COUNTRIES_ERR_MEMORY;
+    }
+
+    return bst_tree_insert_batch(loop->tree, names, count, NULL) == 0 ? COUNTRIES_OK : COUNTRIES_ERR_MEMORY;
+}
+
+/**
+ * Handle a finished transfer
+ */
+static void complete_job(FetchLoop *loop, FetchJob *job, CURLcode result, long long now) {
+    curl_multi_remove_handle(loop->multi, job->req.curl);
+    loop->running--;
+
+    CountriesStatus status = countries_request_finish(&job->req, result);
+
+    // The batch callback only stops the stream when it runs out of memory
+    if (status == COUNTRIES_ERR_ABORTED) {
+        status = COUNTRIES_ERR_MEMORY;
+    }
+
+    if (status == COUNTRIES_ERR_RATE_LIMITED && job->retries < loop->max_retries) {
+        schedule_retry(loop, job, now);
+        countries_request_cleanup(&job->req);
+        return;
+    }
+
+    countries_request_cleanup(&job->req);
+
+    if (status == COUNTRIES_OK) {
+        status = merge_cities(loop, job);
+    }
+
+    job->status = status;
+    job->state = JOB_DONE;
+
+    // Staged names are no longer needed once merged
+    city_batch_destroy(job->batch);
+    job->batch = NULL;
+}
+
+/**
+ * How long the loop may sleep before something needs attention
+ */
+static int next_timeout_ms(const FetchLoop *loop, long long now) {
+    long long wake = -1;
+
+    for (size_t i = 0; i < loop->next_queued; i++) {
+        const FetchJob *job = &loop->jobs[i];
+        if (job->state == JOB_BACKOFF && (wake < 0 || job->due_ms < wake)) {
+            wake = job->due_ms;
+        }
+    }
+    if (loop->next_queued < loop->n && loop->paused_until_ms > now
+        && (wake < 0 || loop->paused_until_ms < wake)) {
+        wake = loop->paused_until_ms;
+    }
+
+    // With transfers running, libcurl's own timers decide; cap the sleep anyway
+    long long timeout = wake < 0 ? 1000 : wake - now;
+    if (timeout < 0) {
+        timeout = 0;
+    }
+    return timeout > 1000 ? 1000 : (int)timeout;
+}
+
+/**
+ * Are there jobs that have not reached JOB_DONE?
+ */
+static int has_pending(const FetchLoop *loop) {
+    if (loop->running > 0 || loop->next_queued < loop->n) {
+        return 1;
+    }
+
+    for (size_t i = 0; i < loop->n; i++) {
+        if (loop->jobs[i].state == JOB_BACKOFF) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Run every job to completion
+ */
+static CountriesStatus run_loop(FetchLoop *loop) {
+    while (has_pending(loop)) {
+        fill_slots(loop, now_ms());
+
+        int still_running = 0;
+        if (curl_multi_perform(loop->multi, &still_running) != CURLM_OK) {
+            return COUNTRIES_ERR_NETWORK;
+        }
+
+        CURLMsg *msg;
+        int queued;
+        while ((msg = curl_multi_info_read(loop->multi, &queued))) {
+            if (msg->msg != CURLMSG_DONE) {
+                continue;
+            }
+
+            FetchJob *job = NULL;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&job);
+            complete_job(loop, job, msg->data.result, now_ms());
+        }
+
+        if (!has_pending(loop)) {
+            break;
+        }
+
+        // Sleeps until socket activity, a libcurl timer, or the next retry is due
+        if (curl_multi_poll(loop->multi, NULL, 0, next_timeout_ms(loop, now_ms()), NULL) != CURLM_OK) {
+            return COUNTRIES_ERR_NETWORK;
+        }
+    }
+
+    return COUNTRIES_OK;
+}
+
+/**
+ * Fetch several countries concurrently and merge their cities into a tree
+ */
+CountriesStatus countries_load_tree_many(const CountriesMultiOptions *options, const char **countries,
+                                         size_t n, BSTree *tree, CountriesStatus *statuses) {
+    if (!tree || (n > 0 && !countries)) {
+        return COUNTRIES_ERR_INVALID;
+    }
+
+    FetchLoop loop = {0};
+    loop.n = n;
+    loop.options = options;
+    loop.tree = tree;
+    loop.max_concurrency = options && options->max_concurrency ? options->max_concurrency
+                                                               : COUNTRIES_MULTI_DEFAULT_CONCURRENCY;
+    loop.max_retries = options && options->max_retries ? options->max_retries
+                                                       : COUNTRIES_MULTI_DEFAULT_RETRIES;
+    if (loop.max_retries < 0) {
+        loop.max_retries = 0;
+    }
+    loop.backoff_ms = options && options->backoff_ms > 0 ? options->backoff_ms
+                                                         : COUNTRIES_MULTI_DEFAULT_BACKOFF_MS;
+
+    loop.jobs = (FetchJob *)calloc(n ? n : 1, sizeof(FetchJob));
+    loop.multi = curl_multi_init();
+    if (!loop.jobs || !loop.multi) {
+        free(loop.jobs);
+        if (loop.multi) {
+            curl_multi_cleanup(loop.multi);
+        }
+        return COUNTRIES_ERR_MEMORY;
+    }
+
+    // The pool holds one connection per slot; finished transfers hand theirs on
+    curl_multi_setopt(loop.multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, (long)loop.max_concurrency);
+    curl_multi_setopt(loop.multi, CURLMOPT_MAXCONNECTS, (long)loop.max_concurrency);
+    curl_multi_setopt(loop.multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+
+    CountriesStatus engine = COUNTRIES_OK;
+    for (size_t i = 0; i < n; i++) {
+        loop.jobs[i].country = countries[i];
+        loop.jobs[i].batch = city_batch_create();
+        if (!loop.jobs[i].batch) {
+            engine = COUNTRIES_ERR_MEMORY;
+        }
+    }
+
+    if (engine == COUNTRIES_OK) {
+        engine = run_loop(&loop);
+    }
+
+    CountriesStatus result = engine;
+    for (size_t i = 0; i < n; i++) {
+        FetchJob *job = &loop.jobs[i];
+
+        if (job->state == JOB_RUNNING) {
+            curl_multi_remove_handle(loop.multi, job->req.curl);
+            countries_request_cleanup(&job->req);
+        }
+        if (job->state != JOB_DONE) {
+            job->status = engine;
+        }
+        if (statuses) {
+            statuses[i] = job->status;
+        }
+        if (result == COUNTRIES_OK) {
+            result = job->status;
+        }
+
+        city_batch_destroy(job->batch);
+    }
+
+    curl_multi_cleanup(loop.multi);
+    free(loop.jobs);
+    return result;
+}
@@ -0,0 +1,273 @@
+#include "countries_request.h"
+#include "bst_stats.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+/**
+ * Build the JSON request body {"country": "<country>"}
+ */
+static char *build_body(const char *country) {
+    static const char prefix[] = "{\"country\": \"";
+    static const char suffix[] = "\"}";
+    size_t len = strlen(country);
+
+    // Worst case every byte becomes a six-byte \u00XX escape
+    char *body = (char *)malloc(sizeof(prefix) + len * 6 + sizeof(suffix));
+    if (!body) {
+        return NULL;
+    }
+
+    char *out = body;
+    memcpy(out, prefix, sizeof(prefix) - 1);
+    out += sizeof(prefix) - 1;
+
+    for (const unsigned char *c = (const unsigned char *)country; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            *out++ = '\\';
+            *out++ = (char)*c;
+        } else if (*c < 0x20) {
+            out += sprintf(out, "\\u%04x", *c);
+        } else {
+            *out++ = (char)*c;
+        }
+    }
+
+    memcpy(out, suffix, sizeof(suffix));
+    return body;
+}
+
+/**
+ * Forward a city to the caller, remembering whether it asked to stop
+ */
+static int deliver_city(const char *city, size_t len, void *ctx) {
+    CountriesRequest *req = (CountriesRequest *)ctx;
+
+    BST_STATS_ADD(BST_STAT_FETCH_CITIES, 1);
+    if (req->on_city && req->on_city(city, len, req->ctx) != 0) {
+        req->aborted = 1;
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Is this a "slow down" answer that is worth retrying later?
+ */
+static int is_rate_limit_code(long http_code) {
+    return http_code == 429 || http_code == 503;
+}
+
+/**
+ * Should the body of the current response go to the parser?
+ * Successful answers (and file:// transfers, which report 0) are parsed.
+ * Error answers are only parsed when they are declared JSON, which is how
+ * the API reports an unknown country; anything else (an HTML error page
+ * from a proxy, a rate-limit notice) is drained and ignored.
+ */
+static int wants_body(CountriesRequest *req) {
+    long http_code = 0;
+    curl_easy_getinfo(req->curl, CURLINFO_RESPONSE_CODE, &http_code);
+    if (http_code == 0 || (http_code >= 200 && http_code < 300)) {
+        return 1;
+    }
+    if (is_rate_limit_code(http_code)) {
+        return 0;
+    }
+
+    const char *type = NULL;
+    curl_easy_getinfo(req->curl, CURLINFO_CONTENT_TYPE, &type);
+    return type && strncasecmp(type, "application/json", 16) == 0;
+}
+
+/**
+ * libcurl write callback: parse the chunk in place
+ * Returning less than the chunk size makes libcurl stop the transfer, so a
+ * malformed body is abandoned as soon as it is detected.
+ */
+static size_t write_chunk(char *data, size_t size, size_t nmemb, void *userdata) {
+    CountriesRequest *req = (CountriesRequest *)userdata;
+    size_t len = size * nmemb;
+
+    if (!wants_body(req)) {
+        return len;
+    }
+
+    if (city_stream_feed(req->stream, data, len) != 0) {
+        return 0;
+    }
+
+    return len;
+}
+
+/**
+ * Copy a header's value if the line is "<name>: <value>"
+ */
+static void capture_header(const char *line, size_t len, const char *name, char *out) {
+    size_t name_len = strlen(name);
+
+    if (len <= name_len || strncasecmp(line, name, name_len) != 0 || line[name_len] != ':') {
+        return;
+    }
+
+    const char *value = line + name_len + 1;
+    const char *end = line + len;
+    while (value < end && (*value == ' ' || *value == '\t')) {
+        value++;
+    }
+    while (end > value && isspace((unsigned char)end[-1])) {
+        end--;
+    }
+
+    size_t value_len = (size_t)(end - value);
+    if (value_len < COUNTRIES_VALIDATOR_SIZE) {
+        memcpy(out, value, value_len);
+        out[value_len] = '\0';
+    }
+}
+
+/**
+ * libcurl header callback: remember the response's cache validators
+ * A new status line (after a redirect or a 100 Continue) starts a new
+ * response, so earlier values are dropped.
+ */
+static size_t read_header(char *line, size_t size, size_t nmemb, void *userdata) {
+    CountriesRequest *req = (CountriesRequest *)userdata;
+    size_t len = size * nmemb;
+
+    if (len >= 5 && strncmp(line, "HTTP/", 5) == 0) {
+        req->etag[0] = '\0';
+        req->last_modified[0] = '\0';
+    } else {
+        capture_header(line, len, "ETag", req->etag);
+        capture_header(line, len, "Last-Modified", req->last_modified);
+    }
+
+    return len;
+}
+
+/**
+ * Prepare a request; on failure nothing needs to be cleaned up
+ */
+CountriesStatus countries_request_init(CountriesRequest *req, const CountriesFetchOptions *options,
+                                       const char *country, CityStreamCallback on_city, void *ctx) {
+    if (!req || !country || country[0] == '\0') {
+        return COUNTRIES_ERR_INVALID;
+    }
+
+    memset(req, 0, sizeof(*req));
+    req->on_city = on_city;
+    req->ctx = ctx;
+
+    req->body = build_body(country);
+    req->stream = city_stream_create(deliver_city, req);
+    req->curl = curl_easy_init();
+    req->headers = curl_slist_append(NULL, "Content-Type: application/json");
+
+    if (!req->body || !req->stream || !req->curl || !req->headers) {
+        countries_request_cleanup(req);
+        return COUNTRIES_ERR_MEMORY;
+    }
+
+    const char *url = options && options->url ? options->url : COUNTRIES_API_URL;
+    long timeout_ms = options ? options->timeout_ms : 0;
+
+    curl_easy_setopt(req->curl, CURLOPT_URL, url);
+    curl_easy_setopt(req->curl, CURLOPT_HTTPHEADER, req->headers);
+    curl_easy_setopt(req->curl, CURLOPT_POSTFIELDS, req->body);
+    curl_easy_setopt(req->curl, CURLOPT_WRITEFUNCTION, write_chunk);
+    curl_easy_setopt(req->curl, CURLOPT_WRITEDATA, req);
+    curl_easy_setopt(req->curl, CURLOPT_HEADERFUNCTION, read_header);
+    curl_easy_setopt(req->curl, CURLOPT_HEADERDATA, req);
+    curl_easy_setopt(req->curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(req->curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(req->curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(req->curl, CURLOPT_ACCEPT_ENCODING, "");
+    curl_easy_setopt(req->curl, CURLOPT_TIMEOUT_MS, timeout_ms);
+
+    return COUNTRIES_OK;
+}
+
+/**
+ * Add a request header before the transfer starts
+ */
+CountriesStatus countries_request_add_header(CountriesRequest *req, const char *header) {
+    struct curl_slist *headers = curl_slist_append(req->headers, header);
+    if (!headers) {
+        return COUNTRIES_ERR_MEMORY;
+    }
+
+    req->headers = headers;
+    curl_easy_setopt(req->curl, CURLOPT_HTTPHEADER, req->headers);
+    return COUNTRIES_OK;
+}
+
+/**
+ * Turn the transfer result and the parsed body into a status
+ */
+CountriesStatus countries_request_finish(CountriesRequest *req, CURLcode result) {
+#ifdef BST_STATS
+    curl_off_t total_us = 0;
+    if (curl_easy_getinfo(req->curl, CURLINFO_TOTAL_TIME_T, &total_us) == CURLE_OK) {
+        BST_STATS_LATENCY(BST_STAT_FETCH, (uint64_t)total_us * 1000);
+    }
+#endif
+
+    if (req->aborted) {
+        return COUNTRIES_ERR_ABORTED;
+    }
+
+    // file:// transfers report 0, which is fine for fixtures
+    long http_code = 0;
+    curl_easy_getinfo(req->curl, CURLINFO_RESPONSE_CODE, &http_code);
+    int http_ok = http_code == 0 || (http_code >= 200 && http_code < 300);
+
+    if (result == CURLE_WRITE_ERROR && city_stream_error(req->stream)) {
+        return http_ok ? COUNTRIES_ERR_PARSE : COUNTRIES_ERR_HTTP;
+    }
+
+    if (result != CURLE_OK) {
+        return COUNTRIES_ERR_NETWORK;
+    }
+
+    if (is_rate_limit_code(http_code)) {
+        return COUNTRIES_ERR_RATE_LIMITED;
+    }
+
+    int parsed = city_stream_finish(req->stream) == 0;
+
+    if (parsed && city_stream_api_error(req->stream) == 1) {
+        return COUNTRIES_ERR_API;
+    }
+
+    if (!http_ok) {
+        return COUNTRIES_ERR_HTTP;
+    }
+
+    if (!parsed || !city_stream_has_data(req->stream)) {
+        return COUNTRIES_ERR_PARSE;
+    }
+
+    return COUNTRIES_OK;
+}
+
+/**
+ * Release everything owned by a request
+ */
+void countries_request_cleanup(CountriesRequest *req) {
+    if (!req) {
+        return;
+    }
+
+    if (req->curl) {
+        curl_easy_cleanup(req->curl);
+    }
+    curl_slist_free_all(req->headers);
+    city_stream_destroy(req->stream);
+    free(req->body);
+
+    memset(req, 0, sizeof(*req));
+}
@@ -0,0 +1,52 @@
+#ifndef COUNTRIES_REQUEST_H
+#define COUNTRIES_REQUEST_H
+
+#include "countries_client.h"
+#include <curl/curl.h>
+
+/*
+ * Request plumbing shared by the connector front ends.
+ * One CountriesRequest is one POST whose body is parsed by a CityStream
+ * straight from the libcurl write callback.
+ */
+
+// Room for a response validator (ETag or Last-Modified value)
+#define COUNTRIES_VALIDATOR_SIZE 256
+
+/**
+ * State of one city request
+ */
+typedef struct CountriesRequest {
+    CURL *curl;                  // Easy handle configured for the request
+    struct curl_slist *headers;  // Request headers (owned)
+    char *body;                  // JSON request body (owned)
+    CityStream *stream;          // Parser fed by the write callback
+    CityStreamCallback on_city;  // Caller's city callback
+    void *ctx;                   // Caller's callback context
+    int aborted;                 // Set when on_city asked to stop
+    char etag[COUNTRIES_VALIDATOR_SIZE];           // ETag of the final response ("" if none)
+    char last_modified[COUNTRIES_VALIDATOR_SIZE];  // Last-Modified of the final response ("" if none)
+} CountriesRequest;
+
+/**
+ * Prepare a request; on failure nothing needs to be cleaned up
+ */
+CountriesStatus countries_request_init(CountriesRequest *req, const CountriesFetchOptions *options,
+                                       const char *country, CityStreamCallback on_city, void *ctx);
+
+/**
+ * Add a request header such as "If-None-Match: \"abc\"" before the transfer starts
+ */
+CountriesStatus countries_request_add_header(CountriesRequest *req, const char *header);
+
+/**
+ * Turn the transfer result and the parsed body into a status
+ */
+CountriesStatus countries_request_finish(CountriesRequest *req, CURLcode result);
+
+/**
+ * Release everything owned by a request
+ */
+void countries_request_cleanup(CountriesRequest *req);
+
+#endif // COUNTRIES_REQUEST_H
@@ -1,62 +1,433 @@
 #include "bst.h"
+#include "bst_internal.h"
+#include "bst_stats.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
 /**
- * Create a new BST node with the given city name
+ * Allocate a malloc-backed node holding key
  */
-BSTNode *bst_create_node(const char *city) {
-    if (!city) {
-        return NULL;
-    }
-
+static BSTNode *create_node(const BSTKey *key) {
     BSTNode *node = (BSTNode *)malloc(sizeof(BSTNode));
     if (!node) {
         return NULL;
     }
 
-    node->city = (char *)malloc(strlen(city) + 1);
-    if (!node->city) {
-        free(node);
-        return NULL;
+    // Short names live inside the node; only long ones need a second block
+    char *heap_city = NULL;
+    size_t heap_len = bst_key_heap_len(key);
+    if (heap_len) {
+        heap_city = (char *)malloc(heap_len);
+        if (!heap_city) {
+            free(node);
+            return NULL;
+        }
+        BST_STATS_ADD(BST_STAT_NAME_ALLOCS, 1);
     }
+    BST_STATS_ADD(BST_STAT_NODE_ALLOCS, 1);
 
-    strcpy(node->city, city);
+    bst_node_set_name(node, key, heap_city);
     node->left = NULL;
     node->right = NULL;
+    node->height = 0;
+    node->size = 1;
 
     return node;
 }
 
 /**
- * Insert a city into the BST
+ * Create a new BST node with the given city name
  */
-BSTNode *bst_insert(BSTNode *root, const char *city) {
+BSTNode *bst_create_node(const char *city) {
+    if (!city) {
+        return NULL;
+    }
+
+    BSTKey key = bst_key_make(city);
+    return create_node(&key);
+}
+
+/**
+ * Get the city name stored in a node
+ */
+const char *bst_node_city(const BSTNode *node) {
+    return node ? bst_node_display(node) : NULL;
+}
+
+/**
+ * Get the left child of a node
+ */
+BSTNode *bst_node_left(const BSTNode *node) {
+    return node ? node->left : NULL;
+}
+
+/**
+ * Get the right child of a node
+ */
+BSTNode *bst_node_right(const BSTNode *node) {
+    return node ? node->right : NULL;
+}
+
+/**
+ * Allocate a node from the arena, or from malloc when there is none
+ */
+static BSTNode *alloc_node(BSTArena *arena, const BSTKey *key) {
+    return arena ? bst_arena_alloc_node(arena, key) : create_node(key);
+}
+
+/**
+ * Release a node (and its long name for malloc-backed nodes)
+ */
+static void free_node(BSTArena *arena, BSTNode *node) {
+    BST_STATS_ADD(BST_STAT_NODE_FREES, 1);
+    if (arena) {
+        bst_arena_free_node(arena, node);
+        return;
+    }
+
+    if (!bst_node_is_inline(node)) {
+        free(node->name.heap_city);
+    }
+    free(node);
+}
+
+/**
+ * Restore the AVL property at root after one of its subtrees changed height
+ */
+static BSTNode *rebalance(BSTNode *root) {
+    bst_update_node(root);
+
+    int balance = bst_subtree_height(root->left) - bst_subtree_height(root->right);
+
+    if (balance > 1) {
+        // Left-heavy: a left-right case needs the child rotated first
+        if (bst_subtree_height(root->left->left) < bst_subtree_height(root->left->right)) {
+            root->left = bst_rotate_left(root->left);
+        }
+        return bst_rotate_right(root);
+    }
+
+    if (balance < -1) {
+        // Right-heavy: a right-left case needs the child rotated first
+        if (bst_subtree_height(root->right->right) < bst_subtree_height(root->right->left)) {
+            root->right = bst_rotate_right(root->right);
+        }
+        return bst_rotate_left(root);
+    }
+
+    return root;
+}
+
+// Inline slots in a path stack; AVL trees of any realistic size fit in them
+#define PATH_INLINE_CAPACITY 96
+
+/**
+ * Stack of child links visited on the way down from the root
+ */
+typedef struct PathStack {
+    BSTNode **inline_links[PATH_INLINE_CAPACITY];
+    BSTNode ***links;        // inline_links, or a heap copy for very deep trees
+    size_t size;
+    size_t capacity;
+} PathStack;
+
+/**
+ * Grow a path stack, moving it to the heap once the inline slots run out
+ * Only hand-built or otherwise unbalanced trees are deep enough to need this.
+ */
+static int path_grow(PathStack *path) {
+    size_t capacity = path->capacity * 2;
+    BSTNode ***links;
+
+    if (path->links == path->inline_links) {
+        links = (BSTNode ***)malloc(capacity * sizeof(*links));
+        if (links) {
+            memcpy(links, path->inline_links, path->size * sizeof(*links));
+        }
+    } else {
+        links = (BSTNode ***)realloc(path->links, capacity * sizeof(*links));
+    }
+
+    if (!links) {
+        return 0;
+    }
+
+    path->links = links;
+    path->capacity = capacity;
+    return 1;
+}
+
+/**
+ * Start an empty path stack
+ */
+static void path_init(PathStack *path) {
+    path->links = path->inline_links;
+    path->size = 0;
+    path->capacity = PATH_INLINE_CAPACITY;
+}
+
+/**
+ * Push the address of a child link, returning 0 if the stack cannot grow
+ */
+static int path_push(PathStack *path, BSTNode **link) {
+    if (path->size == path->capacity && !path_grow(path)) {
+        return 0;
+    }
+
+    path->links[path->size++] = link;
+    return 1;
+}
+
+/**
+ * Release any heap storage held by a path stack
+ */
+static void path_release(PathStack *path) {
+    if (path->links != path->inline_links) {
+        free(path->links);
+    }
+}
+
+/**
+ * Rebalance every subtree on the path, bottom-up, after a node was added
+ * (delta = 1) or removed (delta = -1) below it
+ * Once a subtree keeps both its root and its height, nothing above it can
+ * need rotations, so the remaining ancestors only have their size adjusted.
+ */
+static void path_rebalance(PathStack *path, int delta) {
+    while (path->size > 0) {
+        BSTNode **link = path->links[--path->size];
+        BSTNode *node = *link;
+        int old_height = node->height;
+
+        *link = rebalance(node);
+        if (*link == node && node->height == old_height) {
+            break;
+        }
+    }
+
+    while (path->size > 0) {
+        BSTNode *node = *path->links[--path->size];
+        if (delta > 0) {
+            node->size++;
+        } else {
+            node->size--;
+        }
+    }
+}
+
+/**
+ * Insert a prepared key into a tree whose nodes come from arena (or malloc when NULL)
+ */
+BSTNode *bst_insert_key_with(BSTArena *arena, BSTNode *root, const BSTKey *key, BSTNode **inserted) {
+    PathStack path;
+    BSTNode **link = &root;
+
+    if (inserted) {
+        *inserted = NULL;
+    }
+
+    BST_STATS_TIMER(timer);
+    path_init(&path);
+
+    // Walk down, remembering each link so the way back up needs no recursion
+    while (*link != NULL) {
+        int cmp = bst_key_compare(key, *link);
+
+        if (cmp == 0) {
+            // The city already exists, so don't insert duplicates
+            BST_STATS_OP(BST_STAT_INSERT, timer, (unsigned)path.size + 1);
+            path_release(&path);
+            return root;
+        }
+        if (!path_push(&path, link)) {
+            path_release(&path);
+            return root;
+        }
+
+        link = cmp < 0 ? &(*link)->left : &(*link)->right;
+    }
+
+    // Rebalancing pops the path, so take the depth first
+    unsigned depth = (unsigned)path.size;
+    BSTNode *node = alloc_node(arena, key);
+    *link = node;
+    if (node != NULL) {
+        path_rebalance(&path, 1);
+        if (inserted) {
+            *inserted = node;
+        }
+    }
+
+    BST_STATS_OP(BST_STAT_INSERT, timer, depth);
+    path_release(&path);
+    return root;
+}
+
+/**
+ * Insert a city into a tree whose nodes come from arena (or malloc when NULL)
+ */
+BSTNode *bst_insert_with(BSTArena *arena, BSTNode *root, const char *city) {
     if (!city) {
         return root;
     }
 
-    // Base case: empty tree
-    if (root == NULL) {
-        return bst_create_node(city);
+    BSTKey key = bst_key_make(city);
+    return bst_insert_key_with(arena, root, &key, NULL);
+}
+
+/**
+ * Insert a city into the BST
+ */
+BSTNode *bst_insert(BSTNode *root, const char *city) {
+    return bst_insert_with(NULL, root, city);
+}
+
+/**
+ * qsort comparator for an array of search keys (same order as strcmp)
+ */
+static int compare_keys(const void *a, const void *b) {
+    const BSTKey *x = (const BSTKey *)a;
+    const BSTKey *y = (const BSTKey *)b;
+
+    if (x->prefix != y->prefix) {
+        return x->prefix < y->prefix ? -1 : 1;
     }
+    return strcmp(x->str, y->str);
+}
 
-    // Compare city with root's city
-    int cmp = strcmp(city, root->city);
+/**
+ * Sort keys in place and collapse duplicates, returning the unique count
+ * Already sorted input is not re-sorted.
+ */
+static size_t sort_unique_keys(BSTKey *keys, size_t count) {
+    int in_order = 1;
+    for (size_t i = 1; i < count && in_order; i++) {
+        in_order = compare_keys(&keys[i - 1], &keys[i]) <= 0;
+    }
 
-    if (cmp < 0) {
-        // Insert into left subtree
-        root->left = bst_insert(root->left, city);
-    } else if (cmp > 0) {
-        // Insert into right subtree
-        root->right = bst_insert(root->right, city);
+    if (!in_order) {
+        qsort(keys, count, sizeof(*keys), compare_keys);
     }
-    // If cmp == 0, the city already exists, so don't insert duplicates
 
+    // Collapse duplicates, which are now adjacent
+    size_t unique = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (unique == 0 || compare_keys(&keys[unique - 1], &keys[i]) != 0) {
+            keys[unique++] = keys[i];
+        }
+    }
+
+    return unique;
+}
+
+/**
+ * Turn a batch of cities into sorted, deduplicated search keys
+ * NULL entries are skipped. Returns -1 if the key array cannot be allocated.
+ */
+static int make_sorted_keys(const char **cities, size_t n, BSTKey **keys_out, size_t *count_out) {
+    *keys_out = NULL;
+    *count_out = 0;
+    if (!cities || n == 0) {
+        return 0;
+    }
+
+    BSTKey *keys = (BSTKey *)malloc(n * sizeof(*keys));
+    if (!keys) {
+        return -1;
+    }
+
+    size_t count = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (cities[i]) {
+            keys[count++] = bst_key_make(cities[i]);
+        }
+    }
+
+    *keys_out = keys;
+    *count_out = sort_unique_keys(keys, count);
+    return 0;
+}
+
+/**
+ * Build a balanced subtree from the sorted, deduplicated keys [lo, hi)
+ * When created is non-NULL, created[i] receives the node built for keys[i].
+ * Sets *failed and returns NULL if an allocation fails; the entries of
+ * the nodes reclaimed on the way out are cleared again.
+ */
+static BSTNode *build_balanced(BSTArena *arena, const BSTKey *keys, size_t lo, size_t hi,
+                               BSTNode **created, int *failed) {
+    if (lo >= hi) {
+        return NULL;
+    }
+
+    size_t mid = lo + (hi - lo) / 2;
+
+    BSTNode *left = build_balanced(arena, keys, lo, mid, created, failed);
+    if (*failed) {
+        return NULL;
+    }
+
+    BSTNode *node = alloc_node(arena, &keys[mid]);
+    if (!node) {
+        bst_delete_tree_with(arena, left);
+        if (created) {
+            memset(created + lo, 0, (mid - lo) * sizeof(*created));
+        }
+        *failed = 1;
+        return NULL;
+    }
+    node->left = left;
+    if (created) {
+        created[mid] = node;
+    }
+
+    node->right = build_balanced(arena, keys, mid + 1, hi, created, failed);
+    if (*failed) {
+        bst_delete_tree_with(arena, node);
+        if (created) {
+            memset(created + lo, 0, (mid + 1 - lo) * sizeof(*created));
+        }
+        return NULL;
+    }
+
+    bst_update_node(node);
+    return node;
+}
+
+/**
+ * Bulk-build a tree whose nodes come from arena (or malloc when NULL)
+ */
+BSTNode *bst_build_with(BSTArena *arena, const char **cities, size_t n) {
+    BSTKey *keys;
+    size_t count;
+
+    if (make_sorted_keys(cities, n, &keys, &count) != 0) {
+        return NULL;
+    }
+
+    int failed = 0;
+    BSTNode *root = build_balanced(arena, keys, 0, count, NULL, &failed);
+
+    free(keys);
     return root;
 }
 
+/**
+ * Bulk-build a tree from prepared keys
+ */
+BSTNode *bst_build_keys_with(BSTArena *arena, BSTKey *keys, size_t n) {
+    int failed = 0;
+    return build_balanced(arena, keys, 0, sort_unique_keys(keys, n), NULL, &failed);
+}
+
+/**
+ * Build a perfectly balanced BST from an array of cities in one pass
+ */
+BSTNode *bst_build_from_array(const char **cities, size_t n) {
+    return bst_build_with(NULL, cities, n);
+}
+
 /**
  * Search for a city in the BST
  */
@@ -65,15 +436,22 @@ BSTNode *bst_search(BSTNode *root, const char *city) {
         return NULL;
     }
 
-    int cmp = strcmp(city, root->city);
+    BST_STATS_TIMER(timer);
+    BSTKey key = bst_key_make(city);
+    unsigned depth = 0;
 
-    if (cmp == 0) {
-        return root;
-    } else if (cmp < 0) {
-        return bst_search(root->left, city);
-    } else {
-        return bst_search(root->right, city);
+    while (root != NULL) {
+        int cmp = bst_key_compare(&key, root);
+
+        depth++;
+        if (cmp == 0) {
+            break;
+        }
+        root = cmp < 0 ? root->left : root->right;
     }
+
+    BST_STATS_OP(BST_STAT_SEARCH, timer, depth);
+    return root;
 }
 
 /**
@@ -92,138 +470,602 @@ BSTNode *bst_find_min(BSTNode *root) {
 }
 
 /**
- * Remove a city from the BST
+ * Remove a city from a tree whose nodes come from arena (or malloc when NULL)
  */
-BSTNode *bst_remove(BSTNode *root, const char *city) {
+BSTNode *bst_remove_with(BSTArena *arena, BSTNode *root, const char *city) {
     if (!root || !city) {
         return root;
     }
 
-    int cmp = strcmp(city, root->city);
+    BST_STATS_TIMER(timer);
+    BSTKey key = bst_key_make(city);
+    PathStack path;
+    BSTNode **link = &root;
 
-    if (cmp < 0) {
-        root->left = bst_remove(root->left, city);
-    } else if (cmp > 0) {
-        root->right = bst_remove(root->right, city);
-    } else {
-        // Node to be deleted found
+    path_init(&path);
 
-        // Case 1: Node has no children (leaf node)
-        if (root->left == NULL && root->right == NULL) {
-            free(root->city);
-            free(root);
-            return NULL;
+    // Find the node to delete, remembering the links above it
+    while (*link != NULL) {
+        int cmp = bst_key_compare(&key, *link);
+
+        if (cmp == 0) {
+            break;
+        }
+        if (!path_push(&path, link)) {
+            path_release(&path);
+            return root;
+        }
+
+        link = cmp < 0 ? &(*link)->left : &(*link)->right;
+    }
+
+    BSTNode *target = *link;
+    if (target == NULL) {
+        // City not found
+        BST_STATS_OP(BST_STAT_REMOVE, timer, (unsigned)path.size);
+        path_release(&path);
+        return root;
+    }
+    unsigned depth = (unsigned)path.size + 1;
+
+    if (target->left != NULL && target->right != NULL) {
+        // Two children: unlink the in-order successor (smallest node in the
+        // right subtree) and move that node into the target's place
+        BSTNode **target_link = link;
+        size_t target_depth = path.size;
+        if (!path_push(&path, link)) {
+            path_release(&path);
+            return root;
         }
 
-        // Case 2: Node has only one child
-        if (root->left == NULL) {
-            BSTNode *temp = root->right;
-            free(root->city);
-            free(root);
-            return temp;
+        link = &target->right;
+        while ((*link)->left != NULL) {
+            if (!path_push(&path, link)) {
+                path_release(&path);
+                return root;
+            }
+            link = &(*link)->left;
         }
 
-        if (root->right == NULL) {
-            BSTNode *temp = root->left;
-            free(root->city);
-            free(root);
-            return temp;
+        BSTNode *successor = *link;
+        *link = successor->right;
+
+        successor->left = target->left;
+        successor->right = target->right;
+        successor->height = target->height;
+        successor->size = target->size;
+        *target_link = successor;
+
+        // The link below the target lived inside it; it now lives in the successor
+        if (path.size > target_depth + 1) {
+            path.links[target_depth + 1] = &successor->right;
         }
+    } else {
+        // At most one child: splice it into the parent's link
+        *link = target->left != NULL ? target->left : target->right;
+    }
+
+    free_node(arena, target);
+
+    path_rebalance(&path, -1);
+    BST_STATS_OP(BST_STAT_REMOVE, timer, depth);
+    path_release(&path);
+    return root;
+}
 
-        // Case 3: Node has two children
-        // Find the in-order successor (smallest node in right subtree)
-        BSTNode *successor = bst_find_min(root->right);
+/**
+ * Remove a city from the BST
+ */
+BSTNode *bst_remove(BSTNode *root, const char *city) {
+    return bst_remove_with(NULL, root, city);
+}
 
-        // Replace root's city with successor's city
-        free(root->city);
-        root->city = (char *)malloc(strlen(successor->city) + 1);
-        if (root->city) {
-            strcpy(root->city, successor->city);
+/**
+ * Join two AVL trees and a middle node (every name in left < node < right)
+ * Descends the taller tree's inner spine until the heights are within one,
+ * links the node there and rebalances on the way back. The recursion depth
+ * is the height difference, so joining a small tree to a large one is cheap.
+ */
+static BSTNode *join(BSTNode *left, BSTNode *node, BSTNode *right) {
+    int left_height = bst_subtree_height(left);
+    int right_height = bst_subtree_height(right);
+
+    if (left_height > right_height + 1) {
+        left->right = join(left->right, node, right);
+        return rebalance(left);
+    }
+    if (right_height > left_height + 1) {
+        right->left = join(left, node, right->left);
+        return rebalance(right);
+    }
+
+    node->left = left;
+    node->right = right;
+    bst_update_node(node);
+    return node;
+}
+
+/**
+ * Unlink the smallest node of a non-empty subtree, returning the new subtree root
+ */
+static BSTNode *detach_min(BSTNode *node, BSTNode **min) {
+    if (node->left == NULL) {
+        *min = node;
+        return node->right;
+    }
+
+    node->left = detach_min(node->left, min);
+    return rebalance(node);
+}
+
+/**
+ * Number of keys in the sorted array that sort before node
+ */
+static size_t keys_before(const BSTKey *keys, size_t n, const BSTNode *node) {
+    size_t lo = 0, hi = n;
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (bst_key_compare(&keys[mid], node) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
         }
+    }
+
+    return lo;
+}
 
-        // Delete the successor node
-        root->right = bst_remove(root->right, successor->city);
+/**
+ * Merge sorted keys into a subtree
+ * Each node splits the keys between its children, so a node is visited
+ * only if some key falls in its range; empty spots receive a balanced
+ * subtree built from the keys that land there, and join() restores the
+ * balance on the way back up. Recursion depth is bounded by the height.
+ * When created is non-NULL it runs parallel to keys and receives the
+ * nodes built for them (entries of keys already present are untouched).
+ */
+static BSTNode *insert_keys(BSTArena *arena, BSTNode *node, const BSTKey *keys, size_t n,
+                            BSTNode **created, int *failed) {
+    if (n == 0) {
+        return node;
+    }
+    if (node == NULL) {
+        return build_balanced(arena, keys, 0, n, created, failed);
+    }
+
+    size_t split = keys_before(keys, n, node);
+    size_t match = split < n && bst_key_compare(&keys[split], node) == 0;
+    size_t skip = split + match;
+
+    BSTNode *left = insert_keys(arena, node->left, keys, split, created, failed);
+    BSTNode *right = insert_keys(arena, node->right, keys + skip, n - skip,
+                                 created ? created + skip : NULL, failed);
+
+    return join(left, node, right);
+}
+
+/**
+ * Merge sorted keys and report the nodes created
+ * created (room for n entries, may be NULL) ends up holding the new nodes
+ * in key order, and *created_count how many there are.
+ */
+static BSTNode *merge_keys(BSTArena *arena, BSTNode *root, const BSTKey *keys, size_t n,
+                           BSTNode **created, size_t *created_count, int *failed) {
+    if (created) {
+        memset(created, 0, n * sizeof(*created));
     }
 
+    root = insert_keys(arena, root, keys, n, created, failed);
+
+    if (created) {
+        size_t kept = 0;
+        for (size_t i = 0; i < n; i++) {
+            if (created[i]) {
+                created[kept++] = created[i];
+            }
+        }
+        *created_count = kept;
+    }
+    return root;
+}
+
+/**
+ * Remove the nodes matching sorted keys from a subtree
+ */
+static BSTNode *remove_keys(BSTArena *arena, BSTNode *node, const BSTKey *keys, size_t n) {
+    if (n == 0 || node == NULL) {
+        return node;
+    }
+
+    size_t split = keys_before(keys, n, node);
+    size_t match = split < n && bst_key_compare(&keys[split], node) == 0;
+
+    BSTNode *left = remove_keys(arena, node->left, keys, split);
+    BSTNode *right = remove_keys(arena, node->right, keys + split + match, n - split - match);
+
+    if (!match) {
+        return join(left, node, right);
+    }
+
+    // The node goes away: its successor (if any) becomes the middle of the join
+    free_node(arena, node);
+    if (right == NULL) {
+        return left;
+    }
+
+    BSTNode *successor;
+    right = detach_min(right, &successor);
+    return join(left, successor, right);
+}
+
+/**
+ * Insert a batch of cities into a tree whose nodes come from arena (or malloc when NULL)
+ */
+BSTNode *bst_insert_batch_with(BSTArena *arena, BSTNode *root, const char **cities, size_t n,
+                               BSTNode **created, size_t *created_count, int *failed) {
+    BSTKey *keys;
+    size_t count;
+
+    *failed = 0;
+    if (created) {
+        *created_count = 0;
+    }
+    BST_STATS_ADD(BST_STAT_BATCH_CITIES, n);
+    if (make_sorted_keys(cities, n, &keys, &count) != 0) {
+        *failed = 1;
+        return root;
+    }
+
+    root = merge_keys(arena, root, keys, count, created, created_count, failed);
+
+    free(keys);
     return root;
 }
 
+/**
+ * Remove a batch of cities from a tree whose nodes come from arena (or malloc when NULL)
+ */
+BSTNode *bst_remove_batch_with(BSTArena *arena, BSTNode *root, const char **cities, size_t n,
+                               int *failed) {
+    BSTKey *keys;
+    size_t count;
+
+    *failed = 0;
+    BST_STATS_ADD(BST_STAT_BATCH_CITIES, n);
+    if (make_sorted_keys(cities, n, &keys, &count) != 0) {
+        *failed = 1;
+        return root;
+    }
+
+    root = remove_keys(arena, root, keys, count);
+
+    free(keys);
+    return root;
+}
+
+/**
+ * Merge prepared keys into a tree
+ */
+BSTNode *bst_insert_batch_keys_with(BSTArena *arena, BSTNode *root, BSTKey *keys, size_t n,
+                                    BSTNode **created, size_t *created_count, int *failed) {
+    *failed = 0;
+    BST_STATS_ADD(BST_STAT_BATCH_CITIES, n);
+    return merge_keys(arena, root, keys, sort_unique_keys(keys, n), created, created_count, failed);
+}
+
+/**
+ * Remove prepared keys from a tree
+ */
+BSTNode *bst_remove_batch_keys_with(BSTArena *arena, BSTNode *root, BSTKey *keys, size_t n) {
+    BST_STATS_ADD(BST_STAT_BATCH_CITIES, n);
+    return remove_keys(arena, root, keys, sort_unique_keys(keys, n));
+}
+
+/**
+ * Insert a batch of cities into the BST in one merge pass
+ */
+BSTNode *bst_insert_batch(BSTNode *root, const char **cities, size_t n) {
+    int failed;
+    return bst_insert_batch_with(NULL, root, cities, n, NULL, NULL, &failed);
+}
+
+/**
+ * Remove a batch of cities from the BST in one merge pass
+ */
+BSTNode *bst_remove_batch(BSTNode *root, const char **cities, size_t n) {
+    int failed;
+    return bst_remove_batch_with(NULL, root, cities, n, &failed);
+}
+
+/**
+ * Visit every node in order without recursion or a stack
+ * Morris traversal: temporary threads replace the stack, and every thread
+ * is removed again before the function returns.
+ */
+void bst_walk_inorder(BSTNode *root, void (*visit)(BSTNode *node, void *ctx), void *ctx) {
+    BSTNode *current = root;
+
+    while (current != NULL) {
+        if (current->left == NULL) {
+            visit(current, ctx);
+            current = current->right;
+            continue;
+        }
+
+        // Find the in-order predecessor of current
+        BSTNode *predecessor = current->left;
+        while (predecessor->right != NULL && predecessor->right != current) {
+            predecessor = predecessor->right;
+        }
+
+        if (predecessor->right == NULL) {
+            // First visit: thread the predecessor back to current
+            predecessor->right = current;
+            current = current->left;
+        } else {
+            // Left subtree done: remove the thread and visit current
+            predecessor->right = NULL;
+            visit(current, ctx);
+            current = current->right;
+        }
+    }
+}
+
+// Stack buffer used by the print functions
+#define PRINT_BUFFER_SIZE 32768
+
+/**
+ * In-order visitor that writes one city per line
+ */
+static void write_city(BSTNode *node, void *ctx) {
+    BSTWriter *writer = (BSTWriter *)ctx;
+
+    // After a sink failure the walk still runs to completion to remove its threads
+    if (bst_writer_put(writer, bst_node_display(node), bst_node_display_len(node)) == 0) {
+        bst_writer_put(writer, "\n", 1);
+    }
+}
+
+/**
+ * Write the cities in in-order traversal (alphabetically sorted)
+ */
+int bst_write_inorder(BSTNode *root, BSTWriter *writer) {
+    if (!writer) {
+        return -1;
+    }
+
+    bst_walk_inorder(root, write_city, writer);
+    return writer->failed ? -1 : 0;
+}
+
 /**
  * Print the BST in in-order traversal (alphabetically sorted)
  */
 void bst_print_inorder(BSTNode *root) {
-    if (root == NULL) {
-        return;
-    }
+    char buffer[PRINT_BUFFER_SIZE];
+    BSTWriter writer;
 
-    bst_print_inorder(root->left);
-    printf("%s\n", root->city);
-    bst_print_inorder(root->right);
+    // Earlier stdio output must come first
+    fflush(stdout);
+    bst_writer_init_fd(&writer, fileno(stdout), buffer, sizeof(buffer));
+    bst_write_inorder(root, &writer);
+    bst_writer_flush(&writer);
 }
 
 /**
- * Print the BST in a rotated format (right → root → left) for visualization
+ * Write one node of the rotated view at the given depth
  */
-void bst_print_rotated(BSTNode *root, int space) {
-    if (root == NULL) {
-        return;
+static void write_rotated_node(BSTWriter *writer, const BSTNode *node, int space, size_t depth) {
+    long long indent = (long long)space + 5 * (long long)depth;
+
+    bst_writer_put(writer, "\n", 1);
+    if (indent > 0) {
+        bst_writer_fill(writer, ' ', (size_t)indent);
     }
+    bst_writer_put(writer, bst_node_display(node), bst_node_display_len(node));
+    bst_writer_put(writer, "\n", 1);
+}
 
-    // Increase space for next level
-    space += 5;
+/**
+ * Write the BST in a rotated format (right → root → left) for visualization
+ * Mirrored Morris traversal; the depth needed for indentation is recovered
+ * from the length of each predecessor walk.
+ */
+int bst_write_rotated(BSTNode *root, int space, BSTWriter *writer) {
+    if (!writer) {
+        return -1;
+    }
+
+    BSTNode *current = root;
+    size_t depth = 0;
 
-    // Process right subtree
-    bst_print_rotated(root->right, space);
+    while (current != NULL) {
+        if (current->right == NULL) {
+            write_rotated_node(writer, current, space, depth);
+            current = current->left;
+            depth++;
+            continue;
+        }
 
-    // Print current node
-    printf("\n");
-    for (int i = 5; i < space; i++) {
-        printf(" ");
+        // Find the predecessor in right → root → left order
+        BSTNode *predecessor = current->right;
+        size_t steps = 1;
+        while (predecessor->left != NULL && predecessor->left != current) {
+            predecessor = predecessor->left;
+            steps++;
+        }
+
+        if (predecessor->left == NULL) {
+            // First visit: thread the predecessor back to current
+            predecessor->left = current;
+            current = current->right;
+            depth++;
+        } else {
+            // Right subtree done: we arrived over the thread, one level below
+            // the predecessor, which itself sits steps levels below current
+            predecessor->left = NULL;
+            depth -= steps + 1;
+            write_rotated_node(writer, current, space, depth);
+            current = current->left;
+            depth++;
+        }
     }
-    printf("%s\n", root->city);
 
-    // Process left subtree
-    bst_print_rotated(root->left, space);
+    return writer->failed ? -1 : 0;
+}
+
+/**
+ * Print the BST in a rotated format (right → root → left) for visualization
+ */
+void bst_print_rotated(BSTNode *root, int space) {
+    char buffer[PRINT_BUFFER_SIZE];
+    BSTWriter writer;
+
+    fflush(stdout);
+    bst_writer_init_fd(&writer, fileno(stdout), buffer, sizeof(buffer));
+    bst_write_rotated(root, space, &writer);
+    bst_writer_flush(&writer);
 }
 
 /**
  * Delete the entire BST and free all memory
+ * Rotates left children up until the current node has none, then frees it
+ * and moves right, so no stack is needed.
  */
 void bst_delete_tree(BSTNode *root) {
-    if (root == NULL) {
-        return;
-    }
+    bst_delete_tree_with(NULL, root);
+}
 
-    // Recursively delete left and right subtrees
-    bst_delete_tree(root->left);
-    bst_delete_tree(root->right);
+/**
+ * Free every node of a tree whose nodes come from arena (or malloc when NULL)
+ */
+void bst_delete_tree_with(BSTArena *arena, BSTNode *root) {
+    while (root != NULL) {
+        if (root->left != NULL) {
+            BSTNode *left = root->left;
+            root->left = left->right;
+            left->right = root;
+            root = left;
+            continue;
+        }
 
-    // Free the node itself
-    free(root->city);
-    free(root);
+        BSTNode *right = root->right;
+        free_node(arena, root);
+        root = right;
+    }
 }
 
 /**
  * Get the height of the BST
  */
 int bst_height(BSTNode *root) {
-    if (root == NULL) {
-        return -1;
+    return bst_subtree_height(root);
+}
+
+/**
+ * Get the number of nodes in the BST
+ */
+size_t bst_count_nodes(BSTNode *root) {
+    return bst_subtree_size(root);
+}
+
+/**
+ * Get the number of cities in the BST that sort before city
+ */
+size_t bst_rank(BSTNode *root, const char *city) {
+    if (!city) {
+        return 0;
     }
 
-    int left_height = bst_height(root->left);
-    int right_height = bst_height(root->right);
+    BSTKey key = bst_key_make(city);
+    size_t rank = 0;
+
+    while (root != NULL) {
+        int cmp = bst_key_compare(&key, root);
 
-    return 1 + (left_height > right_height ? left_height : right_height);
+        if (cmp == 0) {
+            return rank + bst_subtree_size(root->left);
+        }
+        if (cmp < 0) {
+            root = root->left;
+        } else {
+            // Everything in the left subtree and root itself sort before city
+            rank += bst_subtree_size(root->left) + 1;
+            root = root->right;
+        }
+    }
+
+    return rank;
 }
 
 /**
- * Get the number of nodes in the BST
+ * Count the nodes sorting before key; with include_prefixed, nodes starting
+ * with key count as before it too (they follow key and are contiguous)
  */
-size_t bst_count_nodes(BSTNode *root) {
-    if (root == NULL) {
+static size_t count_before(BSTNode *root, const BSTKey *key, int include_prefixed) {
+    size_t count = 0;
+
+    while (root != NULL) {
+        if (bst_key_compare(key, root) > 0 || (include_prefixed && bst_node_has_prefix(root, key))) {
+            count += bst_subtree_size(root->left) + 1;
+            root = root->right;
+        } else {
+            root = root->left;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * Count the cities in [lo, hi)
+ */
+size_t bst_count_range(BSTNode *root, const char *lo, const char *hi) {
+    size_t start = 0;
+    size_t end = bst_subtree_size(root);
+
+    if (lo) {
+        BSTKey key = bst_key_make(lo);
+        start = count_before(root, &key, 0);
+    }
+    if (hi) {
+        BSTKey key = bst_key_make(hi);
+        end = count_before(root, &key, 0);
+    }
+
+    return end > start ? end - start : 0;
+}
+
+/**
+ * Count the cities starting with prefix
+ */
+size_t bst_count_prefix(BSTNode *root, const char *prefix) {
+    if (!prefix) {
         return 0;
     }
 
-    return 1 + bst_count_nodes(root->left) + bst_count_nodes(root->right);
+    BSTKey key = bst_key_make(prefix);
+    return count_before(root, &key, 1) - count_before(root, &key, 0);
+}
+
+/**
+ * Find the node holding the k-th smallest city (0-based)
+ */
+BSTNode *bst_select(BSTNode *root, size_t k) {
+    while (root != NULL) {
+        size_t left_size = bst_subtree_size(root->left);
+
+        if (k == left_size) {
+            return root;
+        }
+        if (k < left_size) {
+            root = root->left;
+        } else {
+            k -= left_size + 1;
+            root = root->right;
+        }
+    }
+
+    return NULL;
 }
@@ -0,0 +1,325 @@
+#include "bst_arena.h"
+#include "bst_intern.h"
+#include "bst_internal.h"
+#include "bst_stats.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Size of each bump chunk; names that do not fit comfortably get their own chunk
+#define CHUNK_SIZE (64 * 1024)
+
+// Alignment for node slots carved out of a chunk
+#define NODE_ALIGN (sizeof(void *))
+
+// Collated names up to this size are assembled on the stack before interning
+#define INTERN_INLINE_CAPACITY 256
+
+// Freed name spans up to NAME_CLASSES * NODE_ALIGN bytes get a free list per size;
+// longer ones share one list
+#define NAME_CLASSES 64
+
+/**
+ * Chunk of bump-allocated nodes and long city names
+ * A fresh node is laid out directly before its name when the name is too
+ * long to be stored inline, so both usually share a cache line.
+ */
+typedef struct Chunk {
+    struct Chunk *next;
+    size_t size;             // Usable bytes in data
+    size_t used;             // Bytes handed out so far
+    char data[];
+} Chunk;
+
+/**
+ * Freed name span of a size class, chained through its first bytes
+ */
+typedef struct FreeName {
+    struct FreeName *next;
+} FreeName;
+
+/**
+ * Freed name span too long for a size class
+ */
+typedef struct FreeLongName {
+    struct FreeLongName *next;
+    size_t size;
+} FreeLongName;
+
+struct BSTArena {
+    Chunk *chunks;           // Current bump chunk first
+    BSTNode *free_nodes;     // Recycled slots, chained through their left pointer
+    FreeName *free_names[NAME_CLASSES];  // Recycled name spans, by size in NODE_ALIGN units
+    FreeLongName *free_long_names;       // Recycled spans above the largest class
+    size_t bytes_reserved;   // Total bytes requested from malloc
+    int interned;            // Long names point into bst_intern.h storage
+};
+
+/**
+ * Create an empty arena
+ */
+BSTArena *bst_arena_create(void) {
+    return (BSTArena *)calloc(1, sizeof(BSTArena));
+}
+
+/**
+ * Destroy an arena, releasing all trees allocated from it at once
+ */
+void bst_arena_destroy(BSTArena *arena) {
+    if (!arena) {
+        return;
+    }
+
+    while (arena->chunks) {
+        Chunk *next = arena->chunks->next;
+        free(arena->chunks);
+        arena->chunks = next;
+    }
+
+    free(arena);
+}
+
+/**
+ * Bump-allocate len bytes, starting a new chunk when the current one is full
+ * Every block is padded to NODE_ALIGN, so a node carved after a lone name
+ * (one stored for a recycled slot) is still aligned.
+ */
+static char *bump(BSTArena *arena, size_t len) {
+    Chunk *chunk = arena->chunks;
+
+    len = (len + NODE_ALIGN - 1) & ~(NODE_ALIGN - 1);
+
+    if (!chunk || chunk->size - chunk->used < len) {
+        size_t size = len > CHUNK_SIZE / 4 ? len : CHUNK_SIZE;
+        Chunk *fresh = (Chunk *)malloc(sizeof(Chunk) + size);
+        if (!fresh) {
+            return NULL;
+        }
+        fresh->size = size;
+        fresh->used = 0;
+        arena->bytes_reserved += sizeof(Chunk) + size;
+
+        if (size == len && chunk) {
+            // Keep filling the current chunk; park the oversized one behind it
+            fresh->next = chunk->next;
+            chunk->next = fresh;
+        } else {
+            fresh->next = chunk;
+            arena->chunks = fresh;
+        }
+        chunk = fresh;
+    }
+
+    char *mem = chunk->data + chunk->used;
+    chunk->used += len;
+    return mem;
+}
+
+/**
+ * Bytes a name of heap_len bytes takes up in the arena
+ */
+static size_t name_span(size_t heap_len) {
+    return (heap_len + NODE_ALIGN - 1) & ~(NODE_ALIGN - 1);
+}
+
+/**
+ * Take a freed name span of exactly span bytes, or NULL if there is none
+ * A span's size is recomputed from the name stored in it when it is freed,
+ * so handing out larger spans would lose their tails for good.
+ */
+static char *take_name(BSTArena *arena, size_t span) {
+    size_t size_class = span / NODE_ALIGN;
+    if (size_class <= NAME_CLASSES) {
+        FreeName *name = arena->free_names[size_class - 1];
+        if (name) {
+            arena->free_names[size_class - 1] = name->next;
+        }
+        return (char *)name;
+    }
+
+    for (FreeLongName **link = &arena->free_long_names; *link; link = &(*link)->next) {
+        FreeLongName *name = *link;
+        if (name->size == span) {
+            *link = name->next;
+            return (char *)name;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Keep a name span of span bytes for a later name of the same size
+ */
+static void put_name(BSTArena *arena, char *mem, size_t span) {
+    size_t size_class = span / NODE_ALIGN;
+    if (size_class <= NAME_CLASSES) {
+        FreeName *name = (FreeName *)mem;
+        name->next = arena->free_names[size_class - 1];
+        arena->free_names[size_class - 1] = name;
+    } else {
+        FreeLongName *name = (FreeLongName *)mem;
+        name->size = span;
+        name->next = arena->free_long_names;
+        arena->free_long_names = name;
+    }
+}
+
+/**
+ * Point long names of nodes allocated from now on into the interner
+ */
+void bst_arena_intern_names(BSTArena *arena) {
+    arena->interned = 1;
+}
+
+/**
+ * Intern the bytes a node holding key would copy into its heap storage
+ */
+static const char *intern_name(const BSTKey *key, size_t heap_len) {
+    if (!key->display) {
+        return bst_intern(key->str, key->len);
+    }
+
+    // A collated name is the sort key and the city, each with its terminator
+    char inline_name[INTERN_INLINE_CAPACITY];
+    char *name = heap_len <= sizeof(inline_name) ? inline_name : (char *)malloc(heap_len);
+    if (!name) {
+        return NULL;
+    }
+    memcpy(name, key->str, key->len + 1);
+    memcpy(name + key->len + 1, key->display, key->display_len + 1);
+
+    const char *interned = bst_intern(name, heap_len - 1);
+    if (name != inline_name) {
+        free(name);
+    }
+    return interned;
+}
+
+/**
+ * Allocate a node holding key from the arena
+ */
+BSTNode *bst_arena_alloc_node(BSTArena *arena, const BSTKey *key) {
+    // Short names are stored inline; long ones get bump space in the arena,
+    // or are shared through the interner
+    size_t heap_len = bst_key_heap_len(key);
+    int interned = heap_len && arena->interned;
+    const char *shared_name = NULL;
+    BSTNode *node;
+    char *heap_city;
+
+    if (interned) {
+        shared_name = intern_name(key, heap_len);
+        if (!shared_name) {
+            return NULL;
+        }
+        heap_len = 0;
+    }
+
+    // A long name goes into a freed span of its size if there is one
+    heap_city = heap_len ? take_name(arena, name_span(heap_len)) : NULL;
+
+    if (arena->free_nodes) {
+        // Recycled slot: only a long name without a recycled span needs fresh space
+        if (heap_len && !heap_city) {
+            heap_city = bump(arena, heap_len);
+            if (!heap_city) {
+                return NULL;
+            }
+        }
+        node = arena->free_nodes;
+        arena->free_nodes = node->left;
+    } else if (heap_city) {
+        // Recycled name: only the slot needs fresh space
+        node = (BSTNode *)bump(arena, sizeof(BSTNode));
+        if (!node) {
+            put_name(arena, heap_city, name_span(heap_len));
+            return NULL;
+        }
+    } else {
+        // Fresh slot: node and long name side by side, padded to keep nodes aligned
+        size_t span = (sizeof(BSTNode) + heap_len + NODE_ALIGN - 1) & ~(NODE_ALIGN - 1);
+        node = (BSTNode *)bump(arena, span);
+        if (!node) {
+            bst_intern_release(shared_name);
+            return NULL;
+        }
+        heap_city = (char *)(node + 1);
+    }
+
+    BST_STATS_ADD(BST_STAT_NODE_ALLOCS, 1);
+    if (heap_len) {
+        BST_STATS_ADD(BST_STAT_NAME_ALLOCS, 1);
+    }
+
+    if (interned) {
+        bst_node_share_name(node, key, shared_name);
+    } else {
+        bst_node_set_name(node, key, heap_city);
+    }
+    node->left = NULL;
+    node->right = NULL;
+    node->height = 0;
+    node->size = 1;
+
+    return node;
+}
+
+/**
+ * Return a node slot to the arena's free list, along with its name span
+ * (or its reference to an interned name)
+ */
+void bst_arena_free_node(BSTArena *arena, BSTNode *node) {
+    if (!bst_node_is_inline(node)) {
+        if (arena->interned) {
+            bst_intern_release(node->name.heap_city);
+        } else {
+            size_t heap_len = node->len + 1;
+            if (node->collated) {
+                heap_len += bst_node_display_len(node) + 1;
+            }
+            put_name(arena, node->name.heap_city, name_span(heap_len));
+        }
+    }
+    node->right = NULL;
+    node->left = arena->free_nodes;
+    arena->free_nodes = node;
+}
+
+/**
+ * Insert a city into an arena-backed BST
+ */
+BSTNode *bst_arena_insert(BSTArena *arena, BSTNode *root, const char *city) {
+    if (!arena) {
+        return root;
+    }
+
+    return bst_insert_with(arena, root, city);
+}
+
+/**
+ * Remove a city from an arena-backed BST
+ */
+BSTNode *bst_arena_remove(BSTArena *arena, BSTNode *root, const char *city) {
+    if (!arena) {
+        return root;
+    }
+
+    return bst_remove_with(arena, root, city);
+}
+
+/**
+ * Build a perfectly balanced arena-backed BST from an array of cities
+ */
+BSTNode *bst_arena_build_from_array(BSTArena *arena, const char **cities, size_t n) {
+    if (!arena) {
+        return NULL;
+    }
+
+    return bst_build_with(arena, cities, n);
+}
+
+/**
+ * Get the number of bytes the arena has requested from malloc
+ */
+size_t bst_arena_bytes_reserved(const BSTArena *arena) {
+    return arena ? arena->bytes_reserved : 0;
+}
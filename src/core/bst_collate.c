@@ -0,0 +1,113 @@
+#include "bst_collate.h"
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Code points folded to a base spelling, sorted by first
+ */
+typedef struct FoldRange {
+    uint32_t first;
+    uint32_t last;
+    const char *base;        // Replacement ("" drops the code point)
+} FoldRange;
+
+static const FoldRange fold_ranges[] = {
+    // Latin-1 Supplement (U+00D7 and U+00F7 are signs and stay as they are)
+    {0x00C0, 0x00C5, "a"},  {0x00C6, 0x00C6, "ae"}, {0x00C7, 0x00C7, "c"},  {0x00C8, 0x00CB, "e"},
+    {0x00CC, 0x00CF, "i"},  {0x00D0, 0x00D0, "d"},  {0x00D1, 0x00D1, "n"},  {0x00D2, 0x00D6, "o"},
+    {0x00D8, 0x00D8, "o"},  {0x00D9, 0x00DC, "u"},  {0x00DD, 0x00DD, "y"},  {0x00DE, 0x00DE, "th"},
+    {0x00DF, 0x00DF, "ss"}, {0x00E0, 0x00E5, "a"},  {0x00E6, 0x00E6, "ae"}, {0x00E7, 0x00E7, "c"},
+    {0x00E8, 0x00EB, "e"},  {0x00EC, 0x00EF, "i"},  {0x00F0, 0x00F0, "d"},  {0x00F1, 0x00F1, "n"},
+    {0x00F2, 0x00F6, "o"},  {0x00F8, 0x00F8, "o"},  {0x00F9, 0x00FC, "u"},  {0x00FD, 0x00FD, "y"},
+    {0x00FE, 0x00FE, "th"}, {0x00FF, 0x00FF, "y"},
+
+    // Latin Extended-A
+    {0x0100, 0x0105, "a"},  {0x0106, 0x010D, "c"},  {0x010E, 0x0111, "d"},  {0x0112, 0x011B, "e"},
+    {0x011C, 0x0123, "g"},  {0x0124, 0x0127, "h"},  {0x0128, 0x0131, "i"},  {0x0132, 0x0133, "ij"},
+    {0x0134, 0x0135, "j"},  {0x0136, 0x0138, "k"},  {0x0139, 0x0142, "l"},  {0x0143, 0x014B, "n"},
+    {0x014C, 0x0151, "o"},  {0x0152, 0x0153, "oe"}, {0x0154, 0x0159, "r"},  {0x015A, 0x0161, "s"},
+    {0x0162, 0x0167, "t"},  {0x0168, 0x0173, "u"},  {0x0174, 0x0175, "w"},  {0x0176, 0x0178, "y"},
+    {0x0179, 0x017E, "z"},  {0x017F, 0x017F, "s"},
+
+    // Romanian S and T with comma below
+    {0x0218, 0x0219, "s"},  {0x021A, 0x021B, "t"},
+
+    // Combining diacritical marks
+    {0x0300, 0x036F, ""},
+};
+
+/**
+ * Base spelling of a code point, or NULL if it is kept as it is
+ */
+static const char *fold_lookup(uint32_t cp) {
+    size_t lo = 0, hi = sizeof(fold_ranges) / sizeof(fold_ranges[0]);
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (cp < fold_ranges[mid].first) {
+            hi = mid;
+        } else if (cp > fold_ranges[mid].last) {
+            lo = mid + 1;
+        } else {
+            return fold_ranges[mid].base;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Decode the two-byte UTF-8 sequence at s (the only lengths the table
+ * covers), returning its code point or 0 if s does not start one
+ */
+static uint32_t decode_two_byte(const unsigned char *s) {
+    if (s[0] >= 0xC2 && s[0] <= 0xDF && (s[1] & 0xC0) == 0x80) {
+        return ((uint32_t)(s[0] & 0x1F) << 6) | (s[1] & 0x3F);
+    }
+    return 0;
+}
+
+/**
+ * Append bytes to the key, keeping count of the full length
+ */
+static void key_append(char *key, size_t capacity, size_t *len, const char *bytes, size_t n) {
+    if (*len < capacity) {
+        size_t room = capacity - 1 - *len;
+        memcpy(key + *len, bytes, n < room ? n : room);
+    }
+    *len += n;
+}
+
+/**
+ * Case-folded, accent-stripped sort key
+ */
+size_t bst_collate_fold(const char *city, char *key, size_t capacity, void *ctx) {
+    const unsigned char *s = (const unsigned char *)city;
+    size_t len = 0;
+    (void)ctx;
+
+    while (*s) {
+        // ASCII fast path
+        if (*s < 0x80) {
+            char c = (char)(*s >= 'A' && *s <= 'Z' ? *s + ('a' - 'A') : *s);
+            key_append(key, capacity, &len, &c, 1);
+            s++;
+            continue;
+        }
+
+        uint32_t cp = decode_two_byte(s);
+        const char *base = cp ? fold_lookup(cp) : NULL;
+        if (base) {
+            key_append(key, capacity, &len, base, strlen(base));
+            s += 2;
+        } else {
+            key_append(key, capacity, &len, (const char *)s, 1);
+            s++;
+        }
+    }
+
+    if (capacity > 0) {
+        key[len < capacity ? len : capacity - 1] = '\0';
+    }
+    return len;
+}
@@ -0,0 +1,361 @@
+#include "bst_concurrent.h"
+#include "bst_internal.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Assumed cache line size; reader slots are padded to it so they never share a line
+#define CACHE_LINE 64
+
+/**
+ * Reader slot
+ * epoch is the global epoch observed when the current read section began,
+ * or 0 outside a read section.
+ */
+struct BSTReader {
+    _Alignas(CACHE_LINE) _Atomic uint64_t epoch;
+    atomic_int in_use;
+    BSTConcurrent *tree;
+};
+
+/**
+ * Node replaced by a writer, waiting for readers of older versions to leave
+ */
+typedef struct Retired {
+    BSTNode *node;
+    uint64_t epoch;          // Global epoch when the node was unlinked
+    int owns_name;           // Free the long name too (removed nodes only)
+} Retired;
+
+struct BSTConcurrent {
+    BSTReader readers[BST_CONCURRENT_MAX_READERS];
+    _Alignas(CACHE_LINE) BSTNode *_Atomic root;
+    _Atomic uint64_t epoch;              // Starts at 1 so 0 can mean "not reading"
+    atomic_int reader_limit;             // One past the highest slot ever claimed
+    pthread_mutex_t write_lock;
+
+    // Limbo list (writers only), ordered by epoch; live entries are [retired_head, retired_count)
+    Retired *retired;
+    size_t retired_head;
+    size_t retired_count;
+    size_t retired_capacity;
+};
+
+/**
+ * Free a node, and its long name if it owns one
+ */
+static void free_retired(const Retired *entry) {
+    if (entry->owns_name && !bst_node_is_inline(entry->node)) {
+        free(entry->node->name.heap_city);
+    }
+    free(entry->node);
+}
+
+/**
+ * Copy a node; after publication the copy owns the original's long name
+ */
+static BSTNode *copy_node(const BSTNode *node) {
+    BSTNode *copy = (BSTNode *)malloc(sizeof(BSTNode));
+    if (copy) {
+        memcpy(copy, node, sizeof(BSTNode));
+    }
+    return copy;
+}
+
+/**
+ * Allocate a leaf with its own long name
+ */
+static BSTNode *create_node(const BSTKey *key) {
+    return bst_create_node(key->str);
+}
+
+/**
+ * Free an unpublished node; copies share their name with the original
+ */
+static void discard_node(BSTNode *node, int is_leaf) {
+    Retired entry = {node, 0, is_leaf};
+    free_retired(&entry);
+}
+
+static const BSTCowAlloc cow_alloc = {copy_node, create_node, discard_node};
+
+/**
+ * Make room for extra limbo entries, compacting consumed ones first
+ */
+static int reserve_retired(BSTConcurrent *tree, size_t extra) {
+    if (tree->retired_head > 0) {
+        size_t live = tree->retired_count - tree->retired_head;
+        memmove(tree->retired, tree->retired + tree->retired_head, live * sizeof(Retired));
+        tree->retired_count = live;
+        tree->retired_head = 0;
+    }
+
+    if (tree->retired_count + extra <= tree->retired_capacity) {
+        return 0;
+    }
+
+    size_t capacity = tree->retired_capacity ? tree->retired_capacity : 64;
+    while (capacity < tree->retired_count + extra) {
+        capacity *= 2;
+    }
+
+    Retired *resized = (Retired *)realloc(tree->retired, capacity * sizeof(Retired));
+    if (!resized) {
+        return -1;
+    }
+    tree->retired = resized;
+    tree->retired_capacity = capacity;
+    return 0;
+}
+
+/**
+ * Advance the global epoch if every active reader has observed it, then
+ * free everything retired at least two epochs ago
+ * A reader that could still hold a node retired in epoch e has an epoch
+ * of at most e, which blocks the global epoch from reaching e + 2.
+ */
+static void reclaim(BSTConcurrent *tree) {
+    uint64_t epoch = atomic_load(&tree->epoch);
+    int limit = atomic_load(&tree->reader_limit);
+    int quiescent = 1;
+
+    for (int i = 0; i < limit; i++) {
+        uint64_t seen = atomic_load(&tree->readers[i].epoch);
+        if (seen != 0 && seen != epoch) {
+            quiescent = 0;
+            break;
+        }
+    }
+
+    if (quiescent) {
+        epoch++;
+        atomic_store(&tree->epoch, epoch);
+    }
+
+    while (tree->retired_head < tree->retired_count &&
+           tree->retired[tree->retired_head].epoch + 2 <= epoch) {
+        free_retired(&tree->retired[tree->retired_head]);
+        tree->retired_head++;
+    }
+}
+
+/**
+ * Publish an update's root and retire the nodes it replaced
+ * Called with the write lock held; room for the limbo entries is reserved
+ * before anything becomes visible.
+ */
+static int publish(BSTConcurrent *tree, const BSTCow *cow, BSTNode *root) {
+    size_t extra = cow->replaced_count + (cow->removed ? 1 : 0);
+    if (reserve_retired(tree, extra) != 0) {
+        return -1;
+    }
+
+    atomic_store(&tree->root, root);
+
+    uint64_t epoch = atomic_load(&tree->epoch);
+    for (size_t i = 0; i < cow->replaced_count; i++) {
+        tree->retired[tree->retired_count++] = (Retired){cow->replaced[i], epoch, 0};
+    }
+    if (cow->removed) {
+        tree->retired[tree->retired_count++] = (Retired){cow->removed, epoch, 1};
+    }
+
+    reclaim(tree);
+    return 0;
+}
+
+/**
+ * Create an empty concurrent tree
+ */
+BSTConcurrent *bst_concurrent_create(void) {
+    size_t bytes = (sizeof(BSTConcurrent) + CACHE_LINE - 1) & ~(size_t)(CACHE_LINE - 1);
+    BSTConcurrent *tree = (BSTConcurrent *)aligned_alloc(CACHE_LINE, bytes);
+    if (!tree) {
+        return NULL;
+    }
+
+    memset(tree, 0, sizeof(*tree));
+    if (pthread_mutex_init(&tree->write_lock, NULL) != 0) {
+        free(tree);
+        return NULL;
+    }
+
+    for (int i = 0; i < BST_CONCURRENT_MAX_READERS; i++) {
+        atomic_init(&tree->readers[i].epoch, 0);
+        atomic_init(&tree->readers[i].in_use, 0);
+        tree->readers[i].tree = tree;
+    }
+    atomic_init(&tree->root, NULL);
+    atomic_init(&tree->epoch, 1);
+    atomic_init(&tree->reader_limit, 0);
+
+    return tree;
+}
+
+/**
+ * Destroy a concurrent tree
+ */
+void bst_concurrent_destroy(BSTConcurrent *tree) {
+    if (!tree) {
+        return;
+    }
+
+    for (size_t i = tree->retired_head; i < tree->retired_count; i++) {
+        free_retired(&tree->retired[i]);
+    }
+    free(tree->retired);
+
+    bst_delete_tree(atomic_load(&tree->root));
+    pthread_mutex_destroy(&tree->write_lock);
+    free(tree);
+}
+
+/**
+ * Insert a city (writers are serialized)
+ */
+int bst_concurrent_insert(BSTConcurrent *tree, const char *city) {
+    if (!tree || !city) {
+        return -1;
+    }
+
+    BSTKey key = bst_key_make(city);
+    BSTCow cow;
+    int result = 1;
+
+    bst_cow_init(&cow, &cow_alloc);
+    pthread_mutex_lock(&tree->write_lock);
+
+    // Only this thread publishes roots, so the lookup cannot go stale
+    BSTNode *root = atomic_load_explicit(&tree->root, memory_order_relaxed);
+    if (bst_search(root, city)) {
+        result = 0;
+    } else {
+        BSTNode *updated = bst_cow_insert(&cow, root, &key);
+        if (cow.failed || publish(tree, &cow, updated) != 0) {
+            bst_cow_abandon(&cow);
+            result = -1;
+        }
+    }
+
+    pthread_mutex_unlock(&tree->write_lock);
+
+    bst_cow_release(&cow);
+    return result;
+}
+
+/**
+ * Remove a city (writers are serialized)
+ */
+int bst_concurrent_remove(BSTConcurrent *tree, const char *city) {
+    if (!tree || !city) {
+        return -1;
+    }
+
+    BSTKey key = bst_key_make(city);
+    BSTCow cow;
+    int result = 1;
+
+    bst_cow_init(&cow, &cow_alloc);
+    pthread_mutex_lock(&tree->write_lock);
+
+    BSTNode *root = atomic_load_explicit(&tree->root, memory_order_relaxed);
+    if (!bst_search(root, city)) {
+        result = 0;
+    } else {
+        BSTNode *updated = bst_cow_remove(&cow, root, &key);
+        if (cow.failed || publish(tree, &cow, updated) != 0) {
+            bst_cow_abandon(&cow);
+            result = -1;
+        }
+    }
+
+    pthread_mutex_unlock(&tree->write_lock);
+
+    bst_cow_release(&cow);
+    return result;
+}
+
+/**
+ * Number of retired nodes not yet freed
+ */
+size_t bst_concurrent_pending(BSTConcurrent *tree) {
+    if (!tree) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&tree->write_lock);
+    size_t pending = tree->retired_count - tree->retired_head;
+    pthread_mutex_unlock(&tree->write_lock);
+
+    return pending;
+}
+
+/**
+ * Claim a free reader slot
+ */
+BSTReader *bst_reader_register(BSTConcurrent *tree) {
+    if (!tree) {
+        return NULL;
+    }
+
+    for (int i = 0; i < BST_CONCURRENT_MAX_READERS; i++) {
+        int expected = 0;
+        if (atomic_compare_exchange_strong(&tree->readers[i].in_use, &expected, 1)) {
+            // Writers scan slots below the limit, so raise it to cover this one
+            int limit = atomic_load(&tree->reader_limit);
+            while (limit <= i && !atomic_compare_exchange_weak(&tree->reader_limit, &limit, i + 1)) {
+            }
+            return &tree->readers[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Release a reader slot
+ */
+void bst_reader_unregister(BSTReader *reader) {
+    if (!reader) {
+        return;
+    }
+
+    atomic_store(&reader->epoch, 0);
+    atomic_store(&reader->in_use, 0);
+}
+
+/**
+ * Start a read section
+ * The slot is published before the root is loaded (both sequentially
+ * consistent), so a writer scanning slots after retiring a node either sees
+ * this reader or this reader sees the root that no longer links the node.
+ */
+BSTNode *bst_reader_enter(BSTReader *reader) {
+    BSTConcurrent *tree = reader->tree;
+
+    atomic_store(&reader->epoch, atomic_load(&tree->epoch));
+    return atomic_load(&tree->root);
+}
+
+/**
+ * End a read section
+ */
+void bst_reader_exit(BSTReader *reader) {
+    atomic_store_explicit(&reader->epoch, 0, memory_order_release);
+}
+
+/**
+ * Check whether a city is present
+ */
+int bst_reader_contains(BSTReader *reader, const char *city) {
+    if (!reader || !city) {
+        return 0;
+    }
+
+    int found = bst_search(bst_reader_enter(reader), city) != NULL;
+    bst_reader_exit(reader);
+
+    return found;
+}
@@ -0,0 +1,232 @@
+#include "bst_internal.h"
+#include <stdlib.h>
+
+/**
+ * Append to a growable pointer array
+ */
+static int push_node(BSTNode ***items, size_t *count, size_t *capacity, BSTNode *node) {
+    if (*count == *capacity) {
+        size_t grown = *capacity ? *capacity * 2 : 32;
+        BSTNode **resized = (BSTNode **)realloc(*items, grown * sizeof(*resized));
+        if (!resized) {
+            return -1;
+        }
+        *items = resized;
+        *capacity = grown;
+    }
+
+    (*items)[(*count)++] = node;
+    return 0;
+}
+
+/**
+ * Start a copy-on-write update
+ */
+void bst_cow_init(BSTCow *cow, const BSTCowAlloc *alloc) {
+    memset(cow, 0, sizeof(*cow));
+    cow->alloc = alloc;
+}
+
+/**
+ * Was node allocated by this update (and therefore safe to modify)?
+ * Paths are O(log n) long, so a linear scan is cheaper than a set.
+ */
+int bst_cow_is_fresh(const BSTCow *cow, const BSTNode *node) {
+    for (size_t i = cow->fresh_count; i > 0; i--) {
+        if (cow->fresh[i - 1] == node) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Get a private, writable version of node
+ */
+static BSTNode *cow_copy(BSTCow *cow, BSTNode *node) {
+    if (bst_cow_is_fresh(cow, node)) {
+        return node;
+    }
+
+    BSTNode *copy = cow->alloc->copy(node);
+    if (!copy) {
+        cow->failed = 1;
+        return NULL;
+    }
+
+    if (push_node(&cow->fresh, &cow->fresh_count, &cow->fresh_capacity, copy) != 0) {
+        cow->alloc->discard(copy, 0);
+        cow->failed = 1;
+        return NULL;
+    }
+    if (push_node(&cow->replaced, &cow->replaced_count, &cow->replaced_capacity, node) != 0) {
+        cow->failed = 1;
+        return NULL;
+    }
+
+    return copy;
+}
+
+/**
+ * Restore the AVL property at a fresh node, copying any child a rotation moves
+ */
+static BSTNode *cow_rebalance(BSTCow *cow, BSTNode *root) {
+    bst_update_node(root);
+
+    int balance = bst_subtree_height(root->left) - bst_subtree_height(root->right);
+
+    if (balance > 1) {
+        BSTNode *left = cow_copy(cow, root->left);
+        if (!left) {
+            return NULL;
+        }
+        root->left = left;
+
+        // Left-right case: the grandchild becomes the subtree root
+        if (bst_subtree_height(left->left) < bst_subtree_height(left->right)) {
+            BSTNode *grandchild = cow_copy(cow, left->right);
+            if (!grandchild) {
+                return NULL;
+            }
+            left->right = grandchild;
+            root->left = bst_rotate_left(left);
+        }
+        return bst_rotate_right(root);
+    }
+
+    if (balance < -1) {
+        BSTNode *right = cow_copy(cow, root->right);
+        if (!right) {
+            return NULL;
+        }
+        root->right = right;
+
+        // Right-left case: the grandchild becomes the subtree root
+        if (bst_subtree_height(right->right) < bst_subtree_height(right->left)) {
+            BSTNode *grandchild = cow_copy(cow, right->left);
+            if (!grandchild) {
+                return NULL;
+            }
+            right->left = grandchild;
+            root->right = bst_rotate_right(right);
+        }
+        return bst_rotate_left(root);
+    }
+
+    return root;
+}
+
+/**
+ * Insert key (known to be absent) below node, copying the path
+ */
+BSTNode *bst_cow_insert(BSTCow *cow, BSTNode *node, const BSTKey *key) {
+    if (!node) {
+        BSTNode *leaf = cow->alloc->create(key);
+        if (!leaf) {
+            cow->failed = 1;
+            return NULL;
+        }
+
+        // Rotations on the way up may move the leaf; it must not be copied
+        if (push_node(&cow->fresh, &cow->fresh_count, &cow->fresh_capacity, leaf) != 0) {
+            cow->alloc->discard(leaf, 1);
+            cow->failed = 1;
+            return NULL;
+        }
+        cow->leaf = leaf;
+        return leaf;
+    }
+
+    BSTNode *copy = cow_copy(cow, node);
+    if (!copy) {
+        return NULL;
+    }
+
+    if (bst_key_compare(key, node) < 0) {
+        copy->left = bst_cow_insert(cow, node->left, key);
+    } else {
+        copy->right = bst_cow_insert(cow, node->right, key);
+    }
+
+    return cow->failed ? NULL : cow_rebalance(cow, copy);
+}
+
+/**
+ * Detach the minimum of a non-empty subtree, copying the path
+ * *min receives a fresh copy of the minimum node.
+ */
+static BSTNode *cow_detach_min(BSTCow *cow, BSTNode *node, BSTNode **min) {
+    BSTNode *copy = cow_copy(cow, node);
+    if (!copy) {
+        return NULL;
+    }
+
+    if (!node->left) {
+        *min = copy;
+        return node->right;
+    }
+
+    copy->left = cow_detach_min(cow, node->left, min);
+    return cow->failed ? NULL : cow_rebalance(cow, copy);
+}
+
+/**
+ * Remove key (known to be present) from below node, copying the path
+ */
+BSTNode *bst_cow_remove(BSTCow *cow, BSTNode *node, const BSTKey *key) {
+    int cmp = bst_key_compare(key, node);
+
+    if (cmp == 0) {
+        cow->removed = node;
+        if (!node->left) {
+            return node->right;
+        }
+        if (!node->right) {
+            return node->left;
+        }
+
+        // Two children: a copy of the successor takes the node's place
+        BSTNode *successor = NULL;
+        BSTNode *right = cow_detach_min(cow, node->right, &successor);
+        if (cow->failed) {
+            return NULL;
+        }
+        successor->left = node->left;
+        successor->right = right;
+        return cow_rebalance(cow, successor);
+    }
+
+    BSTNode *copy = cow_copy(cow, node);
+    if (!copy) {
+        return NULL;
+    }
+
+    if (cmp < 0) {
+        copy->left = bst_cow_remove(cow, node->left, key);
+    } else {
+        copy->right = bst_cow_remove(cow, node->right, key);
+    }
+
+    return cow->failed ? NULL : cow_rebalance(cow, copy);
+}
+
+/**
+ * Free every node an unpublished update allocated
+ */
+void bst_cow_abandon(BSTCow *cow) {
+    for (size_t i = 0; i < cow->fresh_count; i++) {
+        cow->alloc->discard(cow->fresh[i], cow->fresh[i] == cow->leaf);
+    }
+    cow->fresh_count = 0;
+    cow->leaf = NULL;
+}
+
+/**
+ * Release an update's bookkeeping (not the nodes)
+ */
+void bst_cow_release(BSTCow *cow) {
+    free(cow->fresh);
+    free(cow->replaced);
+    cow->fresh = NULL;
+    cow->replaced = NULL;
+}
@@ -0,0 +1,158 @@
+#include "bst_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Smallest table allocated
+#define MIN_CAPACITY 16
+
+/**
+ * Multiply-xorshift step used to absorb each 8-byte word
+ */
+static inline uint64_t mix(uint64_t value) {
+    value *= 0x9E3779B97F4A7C15ULL;
+    return value ^ (value >> 32);
+}
+
+/**
+ * Hash a name 8 bytes at a time
+ */
+uint64_t bst_hash_bytes(const char *str, size_t len) {
+    uint64_t hash = 0x243F6A8885A308D3ULL ^ len;
+    uint64_t word;
+
+    while (len >= 8) {
+        memcpy(&word, str, 8);
+        hash = mix(hash ^ word);
+        str += 8;
+        len -= 8;
+    }
+
+    word = 0;
+    memcpy(&word, str, len);
+    hash = mix(hash ^ word);
+
+    // splitmix64 finalizer, so the low bits used for the slot depend on every byte
+    hash ^= hash >> 30;
+    hash *= 0xBF58476D1CE4E5B9ULL;
+    hash ^= hash >> 27;
+    hash *= 0x94D049BB133111EBULL;
+    return hash ^ (hash >> 31);
+}
+
+/**
+ * Start an empty index
+ */
+void bst_hash_index_init(BSTHashIndex *index) {
+    index->slots = NULL;
+    index->capacity = 0;
+    index->count = 0;
+}
+
+/**
+ * Free the index's table
+ */
+void bst_hash_index_release(BSTHashIndex *index) {
+    free(index->slots);
+    bst_hash_index_init(index);
+}
+
+/**
+ * Store an entry in the first free slot of its probe sequence
+ */
+static void place(BSTHashEntry *slots, size_t mask, uint64_t hash, BSTNode *node) {
+    size_t slot = (size_t)hash & mask;
+
+    while (slots[slot].node != NULL) {
+        slot = (slot + 1) & mask;
+    }
+    slots[slot].hash = hash;
+    slots[slot].node = node;
+}
+
+/**
+ * Make room for count entries, keeping the load factor at most 3/4
+ */
+int bst_hash_index_reserve(BSTHashIndex *index, size_t count) {
+    if (count * 4 <= index->capacity * 3) {
+        return 0;
+    }
+
+    size_t capacity = index->capacity ? index->capacity : MIN_CAPACITY;
+    while (count * 4 > capacity * 3) {
+        capacity *= 2;
+    }
+
+    BSTHashEntry *slots = (BSTHashEntry *)calloc(capacity, sizeof(*slots));
+    if (!slots) {
+        return -1;
+    }
+
+    // Rehash from the stored hashes without touching the nodes
+    for (size_t i = 0; i < index->capacity; i++) {
+        if (index->slots[i].node) {
+            place(slots, capacity - 1, index->slots[i].hash, index->slots[i].node);
+        }
+    }
+
+    free(index->slots);
+    index->slots = slots;
+    index->capacity = capacity;
+    return 0;
+}
+
+/**
+ * Find the node holding a name
+ */
+BSTNode *bst_hash_index_find(const BSTHashIndex *index, uint64_t hash, const char *name, size_t len) {
+    if (index->count == 0) {
+        return NULL;
+    }
+
+    size_t mask = index->capacity - 1;
+    for (size_t slot = (size_t)hash & mask; index->slots[slot].node; slot = (slot + 1) & mask) {
+        BSTNode *node = index->slots[slot].node;
+        if (index->slots[slot].hash == hash && node->len == len && memcmp(bst_node_name(node), name, len) == 0) {
+            return node;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Add a node that is not yet indexed
+ */
+void bst_hash_index_add(BSTHashIndex *index, uint64_t hash, BSTNode *node) {
+    place(index->slots, index->capacity - 1, hash, node);
+    index->count++;
+}
+
+/**
+ * Drop a node's entry, shifting the rest of its cluster back
+ */
+void bst_hash_index_remove(BSTHashIndex *index, uint64_t hash, const BSTNode *node) {
+    if (index->count == 0) {
+        return;
+    }
+
+    size_t mask = index->capacity - 1;
+    size_t hole = (size_t)hash & mask;
+    while (index->slots[hole].node != node) {
+        if (index->slots[hole].node == NULL) {
+            return;
+        }
+        hole = (hole + 1) & mask;
+    }
+
+    // An entry may move into the hole if the hole lies on its probe path
+    for (size_t slot = (hole + 1) & mask; index->slots[slot].node; slot = (slot + 1) & mask) {
+        size_t home = (size_t)index->slots[slot].hash & mask;
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+            index->slots[hole] = index->slots[slot];
+            hole = slot;
+        }
+    }
+
+    index->slots[hole].node = NULL;
+    index->count--;
+}
@@ -0,0 +1,344 @@
+#include "bst_intern.h"
+#include "bst_internal.h"
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Size of each chunk strings are carved from
+#define CHUNK_SIZE (64 * 1024)
+
+// Strings are stored in spans of whole granules, header included
+#define GRANULE 16
+
+// Spans of up to this many granules are recycled through free lists;
+// longer strings get an allocation of their own
+#define MAX_CLASS 64
+
+// Smallest table allocated
+#define MIN_CAPACITY 64
+
+/**
+ * Stored string: a header, then the bytes and a terminator
+ * The interned pointer is bytes, so the header is found by subtraction.
+ */
+typedef struct Entry {
+    union {
+        uint64_t refs;             // References held (live entries)
+        struct Entry *next_free;   // Next recycled span of the same class
+    } u;
+    uint64_t len;                  // Length in bytes, excluding the terminator
+    char bytes[];
+} Entry;
+
+/**
+ * Chunk of bump-allocated spans
+ */
+typedef struct Chunk {
+    struct Chunk *next;
+    size_t used;                   // Bytes handed out so far
+    char data[];
+} Chunk;
+
+#define CHUNK_DATA (CHUNK_SIZE - sizeof(Chunk))
+
+/**
+ * Table slot: an entry with its hash, so probes and rehashing rarely touch it
+ */
+typedef struct Slot {
+    uint64_t hash;
+    Entry *entry;                  // NULL for an empty slot
+} Slot;
+
+/*
+ * All state sits behind one mutex. Strings are interned when a node is
+ * created and released when it is freed, so the lock is never taken on a
+ * lookup path.
+ */
+static pthread_mutex_t intern_lock = PTHREAD_MUTEX_INITIALIZER;
+static Slot *slots;
+static size_t capacity;            // 0 or a power of two
+static size_t count;               // Distinct strings
+static Chunk *chunks;              // Current bump chunk first
+static Entry *free_spans[MAX_CLASS + 1];
+static size_t references;
+static size_t string_bytes;
+static size_t saved_bytes;
+static size_t reserved_bytes;
+
+/**
+ * Number of granules a string of len bytes occupies
+ */
+static size_t span_class(size_t len) {
+    return (sizeof(Entry) + len + 1 + GRANULE - 1) / GRANULE;
+}
+
+/**
+ * Store a slot in the first free position of its probe sequence
+ */
+static void place(Slot *table, size_t mask, uint64_t hash, Entry *entry) {
+    size_t slot = (size_t)hash & mask;
+
+    while (table[slot].entry != NULL) {
+        slot = (slot + 1) & mask;
+    }
+    table[slot].hash = hash;
+    table[slot].entry = entry;
+}
+
+/**
+ * Make room for one more string, keeping the load factor at most 3/4
+ */
+static int reserve_slot(void) {
+    if ((count + 1) * 4 <= capacity * 3) {
+        return 0;
+    }
+
+    size_t grown = capacity ? capacity * 2 : MIN_CAPACITY;
+    Slot *table = (Slot *)calloc(grown, sizeof(*table));
+    if (!table) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < capacity; i++) {
+        if (slots[i].entry) {
+            place(table, grown - 1, slots[i].hash, slots[i].entry);
+        }
+    }
+
+    free(slots);
+    reserved_bytes += (grown - capacity) * sizeof(Slot);
+    slots = table;
+    capacity = grown;
+    return 0;
+}
+
+/**
+ * Allocate a span of the given class: recycled, bumped, or on its own
+ */
+static Entry *alloc_span(size_t granules) {
+    size_t size = granules * GRANULE;
+
+    if (granules > MAX_CLASS) {
+        Entry *entry = (Entry *)malloc(size);
+        if (entry) {
+            reserved_bytes += size;
+        }
+        return entry;
+    }
+
+    if (free_spans[granules]) {
+        Entry *entry = free_spans[granules];
+        free_spans[granules] = entry->u.next_free;
+        return entry;
+    }
+
+    if (!chunks || CHUNK_DATA - chunks->used < size) {
+        // The tail of the old chunk is abandoned; it is under one maximal span
+        Chunk *chunk = (Chunk *)malloc(CHUNK_SIZE);
+        if (!chunk) {
+            return NULL;
+        }
+        chunk->next = chunks;
+        chunk->used = 0;
+        chunks = chunk;
+        reserved_bytes += CHUNK_SIZE;
+    }
+
+    Entry *entry = (Entry *)(chunks->data + chunks->used);
+    chunks->used += size;
+    return entry;
+}
+
+/**
+ * Return a span to its free list (or to malloc when it has no class)
+ */
+static void free_span(Entry *entry) {
+    size_t granules = span_class((size_t)entry->len);
+
+    if (granules > MAX_CLASS) {
+        reserved_bytes -= granules * GRANULE;
+        free(entry);
+        return;
+    }
+
+    entry->u.next_free = free_spans[granules];
+    free_spans[granules] = entry;
+}
+
+/**
+ * Release every chunk and the table once no string is left
+ */
+static void release_storage(void) {
+    while (chunks) {
+        Chunk *next = chunks->next;
+        free(chunks);
+        chunks = next;
+    }
+    memset(free_spans, 0, sizeof(free_spans));
+
+    free(slots);
+    slots = NULL;
+    capacity = 0;
+    reserved_bytes = 0;
+}
+
+/**
+ * Header of an interned string
+ */
+static Entry *entry_of(const char *str) {
+    return (Entry *)(void *)(str - offsetof(Entry, bytes));
+}
+
+/**
+ * Intern a byte string
+ */
+const char *bst_intern(const char *str, size_t len) {
+    if (!str) {
+        return NULL;
+    }
+
+    uint64_t hash = bst_hash_bytes(str, len);
+    const char *result = NULL;
+
+    pthread_mutex_lock(&intern_lock);
+
+    if (count > 0) {
+        size_t mask = capacity - 1;
+        for (size_t slot = (size_t)hash & mask; slots[slot].entry; slot = (slot + 1) & mask) {
+            Entry *entry = slots[slot].entry;
+            if (slots[slot].hash == hash && entry->len == len && memcmp(entry->bytes, str, len) == 0) {
+                entry->u.refs++;
+                references++;
+                saved_bytes += len + 1;
+                result = entry->bytes;
+                goto done;
+            }
+        }
+    }
+
+    if (reserve_slot() == 0) {
+        Entry *entry = alloc_span(span_class(len));
+        if (entry) {
+            entry->u.refs = 1;
+            entry->len = len;
+            memcpy(entry->bytes, str, len);
+            entry->bytes[len] = '\0';
+
+            place(slots, capacity - 1, hash, entry);
+            count++;
+            references++;
+            string_bytes += len + 1;
+            result = entry->bytes;
+        }
+    }
+
+    if (count == 0) {
+        // Nothing was stored: do not keep a table allocated for it
+        release_storage();
+    }
+
+done:
+    pthread_mutex_unlock(&intern_lock);
+    return result;
+}
+
+/**
+ * Take another reference to an interned string
+ */
+const char *bst_intern_retain(const char *str) {
+    Entry *entry = entry_of(str);
+
+    pthread_mutex_lock(&intern_lock);
+    entry->u.refs++;
+    references++;
+    saved_bytes += entry->len + 1;
+    pthread_mutex_unlock(&intern_lock);
+
+    return str;
+}
+
+/**
+ * Drop a reference with the lock held, freeing the string with its last one
+ */
+static void release_locked(const char *str) {
+    Entry *entry = entry_of(str);
+    size_t len = (size_t)entry->len;
+
+    references--;
+    if (--entry->u.refs > 0) {
+        saved_bytes -= len + 1;
+        return;
+    }
+
+    // Find the entry's slot by pointer, then shift the rest of its cluster back
+    size_t mask = capacity - 1;
+    size_t hole = (size_t)bst_hash_bytes(entry->bytes, len) & mask;
+    while (slots[hole].entry != entry) {
+        hole = (hole + 1) & mask;
+    }
+
+    for (size_t slot = (hole + 1) & mask; slots[slot].entry; slot = (slot + 1) & mask) {
+        size_t home = (size_t)slots[slot].hash & mask;
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+            slots[hole] = slots[slot];
+            hole = slot;
+        }
+    }
+    slots[hole].entry = NULL;
+
+    count--;
+    string_bytes -= len + 1;
+    free_span(entry);
+    if (count == 0) {
+        release_storage();
+    }
+}
+
+/**
+ * Drop a reference to an interned string
+ */
+void bst_intern_release(const char *str) {
+    if (!str) {
+        return;
+    }
+
+    pthread_mutex_lock(&intern_lock);
+    release_locked(str);
+    pthread_mutex_unlock(&intern_lock);
+}
+
+/**
+ * Drop one reference to each of several strings under one lock
+ */
+void bst_intern_release_many(const char *const *strs, size_t n) {
+    if (!strs || n == 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&intern_lock);
+    for (size_t i = 0; i < n; i++) {
+        if (strs[i]) {
+            release_locked(strs[i]);
+        }
+    }
+    pthread_mutex_unlock(&intern_lock);
+}
+
+/**
+ * Get the interner's occupancy
+ */
+void bst_intern_stats(BSTInternStats *stats) {
+    if (!stats) {
+        return;
+    }
+
+    pthread_mutex_lock(&intern_lock);
+    stats->strings = count;
+    stats->references = references;
+    stats->bytes = string_bytes;
+    stats->bytes_saved = saved_bytes;
+    stats->bytes_reserved = reserved_bytes;
+    pthread_mutex_unlock(&intern_lock);
+}
@@ -0,0 +1,453 @@
+#ifndef BST_INTERNAL_H
+#define BST_INTERNAL_H
+
+#include "bst.h"
+#include "bst_arena.h"
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Internal helpers shared by the core tree modules.
+ * Every function taking a BSTArena uses the malloc path when it is NULL.
+ */
+
+// Names shorter than this (including the terminator) are stored inside the node
+#define BST_INLINE_CAPACITY 24
+
+// Number of leading name bytes packed into the comparison prefix
+#define BST_PREFIX_BYTES 8
+
+/**
+ * BST Node layout
+ * The first bytes of the name are kept as a big-endian integer so most
+ * comparisons are decided without touching the name itself. Short names
+ * live inline; longer ones point to separately allocated storage.
+ * In a collated tree the name is the city's sort key, and the city as it
+ * was inserted follows the key's terminator in the same (heap) storage.
+ */
+struct BSTNode {
+    struct BSTNode *left;    // Left child (cities alphabetically before this city)
+    struct BSTNode *right;   // Right child (cities alphabetically after this city)
+    uint64_t prefix;         // First BST_PREFIX_BYTES of the name, big-endian, zero-padded
+    uint32_t len : 31;       // Name length in bytes, excluding the terminator
+    uint32_t collated : 1;   // Name is a sort key followed by the display name
+    int32_t height;          // Height of the subtree rooted at this node (0 for a leaf)
+    size_t size;             // Number of nodes in the subtree rooted at this node
+    union {
+        char inline_city[BST_INLINE_CAPACITY];  // Used when len < BST_INLINE_CAPACITY
+        char *heap_city;                        // Used for longer names
+    } name;
+};
+
+/**
+ * Search key with its prefix precomputed once per operation
+ */
+typedef struct BSTKey {
+    const char *str;         // Key bytes (NUL-terminated)
+    size_t len;              // Key length in bytes
+    uint64_t prefix;         // Same encoding as BSTNode.prefix
+    const char *display;     // City stored after a sort key (NULL for plain keys)
+    size_t display_len;
+} BSTKey;
+
+/**
+ * Pack the first BST_PREFIX_BYTES of a string into a big-endian integer
+ */
+static inline uint64_t bst_load_prefix(const char *str, size_t len) {
+    unsigned char bytes[BST_PREFIX_BYTES] = {0};
+    uint64_t prefix;
+
+    memcpy(bytes, str, len < BST_PREFIX_BYTES ? len : BST_PREFIX_BYTES);
+    memcpy(&prefix, bytes, sizeof(prefix));
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    prefix = __builtin_bswap64(prefix);
+#endif
+
+    return prefix;
+}
+
+/**
+ * Build a search key for city
+ */
+static inline BSTKey bst_key_make(const char *city) {
+    BSTKey key;
+
+    key.str = city;
+    key.len = strlen(city);
+    key.prefix = bst_load_prefix(city, key.len);
+    key.display = NULL;
+    key.display_len = 0;
+
+    return key;
+}
+
+/**
+ * Build a search key from a sort key of len bytes, remembering the city it
+ * was made from; the key must be NUL-terminated and free of NUL bytes
+ */
+static inline BSTKey bst_key_make_collated(const char *sort_key, size_t len, const char *city) {
+    BSTKey key;
+
+    key.str = sort_key;
+    key.len = len;
+    key.prefix = bst_load_prefix(sort_key, len);
+    key.display = city;
+    key.display_len = strlen(city);
+
+    return key;
+}
+
+/**
+ * Bytes of separate name storage a node holding key needs (0 when inline)
+ */
+static inline size_t bst_key_heap_len(const BSTKey *key) {
+    if (key->display) {
+        return key->len + 1 + key->display_len + 1;
+    }
+    return key->len >= BST_INLINE_CAPACITY ? key->len + 1 : 0;
+}
+
+/**
+ * Does the node keep its name inline?
+ */
+static inline int bst_node_is_inline(const BSTNode *node) {
+    return !node->collated && node->len < BST_INLINE_CAPACITY;
+}
+
+/**
+ * Name bytes of a node (NUL-terminated)
+ */
+static inline const char *bst_node_name(const BSTNode *node) {
+    return bst_node_is_inline(node) ? node->name.inline_city : node->name.heap_city;
+}
+
+/**
+ * City as inserted (differs from the name only in collated trees)
+ */
+static inline const char *bst_node_display(const BSTNode *node) {
+    return node->collated ? node->name.heap_city + node->len + 1 : bst_node_name(node);
+}
+
+/**
+ * Length of bst_node_display in bytes
+ */
+static inline size_t bst_node_display_len(const BSTNode *node) {
+    return node->collated ? strlen(bst_node_display(node)) : node->len;
+}
+
+/**
+ * Compare a key with a node's name, with strcmp's sign convention
+ * The prefix decides most comparisons; the remaining bytes are only read on
+ * a prefix tie between two names longer than the prefix.
+ */
+static inline int bst_key_compare(const BSTKey *key, const BSTNode *node) {
+    if (key->prefix != node->prefix) {
+        return key->prefix < node->prefix ? -1 : 1;
+    }
+
+    size_t shared = key->len < node->len ? key->len : node->len;
+    if (shared > BST_PREFIX_BYTES) {
+        int cmp = memcmp(key->str + BST_PREFIX_BYTES, bst_node_name(node) + BST_PREFIX_BYTES,
+                         shared - BST_PREFIX_BYTES);
+        if (cmp != 0) {
+            return cmp;
+        }
+    }
+
+    return (key->len > node->len) - (key->len < node->len);
+}
+
+/**
+ * Does the node's name start with the key?
+ */
+static inline int bst_node_has_prefix(const BSTNode *node, const BSTKey *key) {
+    return node->len >= key->len && memcmp(bst_node_name(node), key->str, key->len) == 0;
+}
+
+/**
+ * Fill in a node's name fields, copying long names into heap_storage
+ * heap_storage must hold bst_key_heap_len(key) bytes and is ignored for
+ * short plain names.
+ */
+static inline void bst_node_set_name(BSTNode *node, const BSTKey *key, char *heap_storage) {
+    node->len = (uint32_t)key->len;
+    node->collated = key->display != NULL;
+    node->prefix = key->prefix;
+
+    if (key->display) {
+        memcpy(heap_storage, key->str, key->len + 1);
+        memcpy(heap_storage + key->len + 1, key->display, key->display_len + 1);
+        node->name.heap_city = heap_storage;
+    } else if (bst_node_is_inline(node)) {
+        memcpy(node->name.inline_city, key->str, key->len + 1);
+    } else {
+        memcpy(heap_storage, key->str, key->len + 1);
+        node->name.heap_city = heap_storage;
+    }
+}
+
+/**
+ * Fill in a node's name fields, pointing at storage that already holds the
+ * bytes bst_node_set_name would copy there (an interned name)
+ */
+static inline void bst_node_share_name(BSTNode *node, const BSTKey *key, const char *storage) {
+    node->len = (uint32_t)key->len;
+    node->collated = key->display != NULL;
+    node->prefix = key->prefix;
+    node->name.heap_city = (char *)storage;
+}
+
+/**
+ * Height of a possibly empty subtree (-1 for NULL)
+ */
+static inline int bst_subtree_height(const BSTNode *node) {
+    return node ? node->height : -1;
+}
+
+/**
+ * Size of a possibly empty subtree (0 for NULL)
+ */
+static inline size_t bst_subtree_size(const BSTNode *node) {
+    return node ? node->size : 0;
+}
+
+/**
+ * Recompute a node's height and subtree size from its children
+ */
+static inline void bst_update_node(BSTNode *node) {
+    int left_height = bst_subtree_height(node->left);
+    int right_height = bst_subtree_height(node->right);
+
+    node->height = 1 + (left_height > right_height ? left_height : right_height);
+    node->size = 1 + bst_subtree_size(node->left) + bst_subtree_size(node->right);
+}
+
+/**
+ * Rotate the subtree right around root and return the new subtree root
+ */
+static inline BSTNode *bst_rotate_right(BSTNode *root) {
+    BSTNode *pivot = root->left;
+
+    root->left = pivot->right;
+    pivot->right = root;
+
+    bst_update_node(root);
+    bst_update_node(pivot);
+
+    return pivot;
+}
+
+/**
+ * Rotate the subtree left around root and return the new subtree root
+ */
+static inline BSTNode *bst_rotate_left(BSTNode *root) {
+    BSTNode *pivot = root->right;
+
+    root->right = pivot->left;
+    pivot->left = root;
+
+    bst_update_node(root);
+    bst_update_node(pivot);
+
+    return pivot;
+}
+
+/**
+ * Allocate a node holding key from the arena
+ */
+BSTNode *bst_arena_alloc_node(BSTArena *arena, const BSTKey *key);
+
+/**
+ * Point the long names of nodes allocated from now on into the process-wide
+ * interner; each such node holds one reference until it is freed. Destroying
+ * the arena does not release them: free the live nodes first.
+ */
+void bst_arena_intern_names(BSTArena *arena);
+
+/**
+ * Return a node slot to the arena's free list, along with its name span
+ * (or its reference to an interned name)
+ */
+void bst_arena_free_node(BSTArena *arena, BSTNode *node);
+
+/**
+ * Free every node of a tree whose nodes come from arena (or malloc when NULL)
+ */
+void bst_delete_tree_with(BSTArena *arena, BSTNode *root);
+
+/**
+ * Visit every node in order in O(1) extra space (Morris traversal)
+ * The tree is temporarily threaded, so it must not be read concurrently.
+ */
+void bst_walk_inorder(BSTNode *root, void (*visit)(BSTNode *node, void *ctx), void *ctx);
+
+/**
+ * Insert into a tree whose nodes come from arena (or malloc when NULL)
+ */
+BSTNode *bst_insert_with(BSTArena *arena, BSTNode *root, const char *city);
+
+/**
+ * Remove from a tree whose nodes come from arena (or malloc when NULL)
+ */
+BSTNode *bst_remove_with(BSTArena *arena, BSTNode *root, const char *city);
+
+/**
+ * Insert a prepared key (plain or collated) into a tree whose nodes come
+ * from arena (or malloc when NULL)
+ * *inserted (if not NULL) receives the new node, or NULL if nothing was added.
+ */
+BSTNode *bst_insert_key_with(BSTArena *arena, BSTNode *root, const BSTKey *key, BSTNode **inserted);
+
+/**
+ * Bulk-build a tree whose nodes come from arena (or malloc when NULL)
+ */
+BSTNode *bst_build_with(BSTArena *arena, const char **cities, size_t n);
+
+/**
+ * Bulk-build from prepared keys (any order; sorted and deduplicated in place)
+ */
+BSTNode *bst_build_keys_with(BSTArena *arena, BSTKey *keys, size_t n);
+
+/**
+ * Merge a batch into a tree whose nodes come from arena (or malloc when NULL)
+ * When created is non-NULL (room for n entries) it receives the nodes the
+ * merge added and *created_count their number. Sets *failed if an
+ * allocation failed; the tree stays valid but some cities may be missing.
+ */
+BSTNode *bst_insert_batch_with(BSTArena *arena, BSTNode *root, const char **cities, size_t n,
+                               BSTNode **created, size_t *created_count, int *failed);
+
+/**
+ * Remove a batch from a tree whose nodes come from arena (or malloc when NULL)
+ * Sets *failed (and leaves the tree unchanged) if the batch could not be sorted.
+ */
+BSTNode *bst_remove_batch_with(BSTArena *arena, BSTNode *root, const char **cities, size_t n,
+                               int *failed);
+
+/**
+ * Merge prepared keys (any order; sorted and deduplicated in place) into a tree
+ * created and created_count as for bst_insert_batch_with().
+ */
+BSTNode *bst_insert_batch_keys_with(BSTArena *arena, BSTNode *root, BSTKey *keys, size_t n,
+                                    BSTNode **created, size_t *created_count, int *failed);
+
+/**
+ * Remove prepared keys (any order; sorted and deduplicated in place) from a tree
+ */
+BSTNode *bst_remove_batch_keys_with(BSTArena *arena, BSTNode *root, BSTKey *keys, size_t n);
+
+/**
+ * Node allocation for copy-on-write updates
+ * The concurrent tree and persistent versions manage node lifetimes
+ * differently, so each supplies its own hooks.
+ */
+typedef struct BSTCowAlloc {
+    BSTNode *(*copy)(const BSTNode *node);        // Writable duplicate sharing node's children
+    BSTNode *(*create)(const BSTKey *key);        // New leaf holding key
+    void (*discard)(BSTNode *node, int is_leaf);  // Free a node that was never published
+} BSTCowAlloc;
+
+/**
+ * State of one copy-on-write update
+ * Nothing reachable from the starting root is modified: every node the
+ * update changes is copied first, so the old root stays a complete,
+ * valid tree. The caller decides what happens to the replaced originals
+ * once the new root is published.
+ */
+typedef struct BSTCow {
+    const BSTCowAlloc *alloc;
+    BSTNode **fresh;         // Nodes allocated by this update, all reachable from its result
+    size_t fresh_count;
+    size_t fresh_capacity;
+    BSTNode **replaced;      // Originals superseded by a copy
+    size_t replaced_count;
+    size_t replaced_capacity;
+    BSTNode *leaf;           // Node created by an insert
+    BSTNode *removed;        // Node unlinked by a remove
+    int failed;              // Set when an allocation failed; the result is unusable
+} BSTCow;
+
+/**
+ * Start a copy-on-write update
+ */
+void bst_cow_init(BSTCow *cow, const BSTCowAlloc *alloc);
+
+/**
+ * Insert key, which must be absent, and return the new root
+ */
+BSTNode *bst_cow_insert(BSTCow *cow, BSTNode *root, const BSTKey *key);
+
+/**
+ * Remove key, which must be present, and return the new root
+ */
+BSTNode *bst_cow_remove(BSTCow *cow, BSTNode *root, const BSTKey *key);
+
+/**
+ * Was node allocated by this update?
+ */
+int bst_cow_is_fresh(const BSTCow *cow, const BSTNode *node);
+
+/**
+ * Free every node the update allocated (after a failure)
+ */
+void bst_cow_abandon(BSTCow *cow);
+
+/**
+ * Free the update's bookkeeping arrays
+ */
+void bst_cow_release(BSTCow *cow);
+
+/**
+ * Open-addressing index from names to nodes
+ * Linear probing over a power-of-two table; each slot keeps the name's
+ * hash next to the node so probes and rehashing rarely touch the node.
+ * Removal shifts later entries back instead of leaving tombstones.
+ */
+typedef struct BSTHashEntry {
+    uint64_t hash;
+    BSTNode *node;           // NULL for an empty slot
+} BSTHashEntry;
+
+typedef struct BSTHashIndex {
+    BSTHashEntry *slots;
+    size_t capacity;         // 0 or a power of two
+    size_t count;
+} BSTHashIndex;
+
+/**
+ * Hash a name (fast, non-cryptographic)
+ */
+uint64_t bst_hash_bytes(const char *str, size_t len);
+
+/**
+ * Start an empty index
+ */
+void bst_hash_index_init(BSTHashIndex *index);
+
+/**
+ * Free the index's table
+ */
+void bst_hash_index_release(BSTHashIndex *index);
+
+/**
+ * Make room for count entries in total, returning -1 on allocation failure
+ */
+int bst_hash_index_reserve(BSTHashIndex *index, size_t count);
+
+/**
+ * Node whose name is the len bytes at name, or NULL
+ */
+BSTNode *bst_hash_index_find(const BSTHashIndex *index, uint64_t hash, const char *name, size_t len);
+
+/**
+ * Add a node that is not yet indexed (room must have been reserved)
+ */
+void bst_hash_index_add(BSTHashIndex *index, uint64_t hash, BSTNode *node);
+
+/**
+ * Drop a node's entry; only the pointer is compared, so node may already be freed
+ */
+void bst_hash_index_remove(BSTHashIndex *index, uint64_t hash, const BSTNode *node);
+
+#endif // BST_INTERNAL_H
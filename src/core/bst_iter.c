@@ -0,0 +1,248 @@
+#include "bst_iter.h"
+#include "bst_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Path storage currently in use
+ */
+static BSTNode **iter_path(BSTIter *it) {
+    return it->heap_path ? it->heap_path : it->inline_path;
+}
+
+/**
+ * Append a node to the path, moving it to the heap past the inline slots
+ */
+static int iter_push(BSTIter *it, BSTNode *node) {
+    if (it->depth == it->capacity) {
+        size_t capacity = it->capacity * 2;
+        BSTNode **path;
+
+        if (it->heap_path) {
+            path = (BSTNode **)realloc(it->heap_path, capacity * sizeof(*path));
+        } else {
+            path = (BSTNode **)malloc(capacity * sizeof(*path));
+            if (path) {
+                memcpy(path, it->inline_path, it->depth * sizeof(*path));
+            }
+        }
+        if (!path) {
+            it->depth = 0;
+            return -1;
+        }
+
+        it->heap_path = path;
+        it->capacity = capacity;
+    }
+
+    iter_path(it)[it->depth++] = node;
+    return 0;
+}
+
+/**
+ * Current city, after checking it against the prefix bound
+ */
+static const char *iter_result(BSTIter *it) {
+    if (it->depth == 0) {
+        return NULL;
+    }
+
+    const BSTNode *node = iter_path(it)[it->depth - 1];
+    if (it->prefix && (node->len < it->prefix_len || memcmp(bst_node_name(node), it->prefix, it->prefix_len) != 0)) {
+        it->depth = 0;
+        return NULL;
+    }
+
+    return bst_node_display(node);
+}
+
+/**
+ * Prepare an iterator over a tree
+ */
+void bst_iter_init(BSTIter *it, BSTNode *root) {
+    it->root = root;
+    it->heap_path = NULL;
+    it->capacity = BST_ITER_INLINE_DEPTH;
+    it->depth = 0;
+    it->prefix = NULL;
+    it->prefix_len = 0;
+}
+
+/**
+ * Free anything the iterator allocated
+ */
+void bst_iter_release(BSTIter *it) {
+    if (!it) {
+        return;
+    }
+
+    free(it->heap_path);
+    it->heap_path = NULL;
+    it->capacity = BST_ITER_INLINE_DEPTH;
+    it->depth = 0;
+}
+
+/**
+ * Descend to the first node >= key, keeping the path to it
+ * Every visited node is pushed; the path is then cut back to the last node
+ * that was >= key.
+ */
+static void seek_lower_bound(BSTIter *it, const char *key) {
+    BSTKey search = bst_key_make(key ? key : "");
+    BSTNode *node = it->root;
+    size_t found = 0;
+
+    it->depth = 0;
+    while (node) {
+        if (iter_push(it, node) != 0) {
+            return;
+        }
+
+        if (!key || bst_key_compare(&search, node) <= 0) {
+            found = it->depth;
+            node = node->left;
+        } else {
+            node = node->right;
+        }
+    }
+
+    it->depth = found;
+}
+
+/**
+ * Position on the first city >= key
+ */
+const char *bst_iter_seek(BSTIter *it, const char *key) {
+    if (!it) {
+        return NULL;
+    }
+
+    it->prefix = NULL;
+    it->prefix_len = 0;
+    seek_lower_bound(it, key);
+
+    return iter_result(it);
+}
+
+/**
+ * Position on the first city starting with prefix and bound the iteration
+ */
+const char *bst_iter_seek_prefix(BSTIter *it, const char *prefix) {
+    if (!it || !prefix) {
+        return NULL;
+    }
+
+    it->prefix = prefix;
+    it->prefix_len = strlen(prefix);
+    seek_lower_bound(it, prefix);
+
+    return iter_result(it);
+}
+
+/**
+ * Position on the city with the given rank
+ */
+const char *bst_iter_seek_rank(BSTIter *it, size_t rank) {
+    if (!it) {
+        return NULL;
+    }
+
+    BSTNode *node = it->root;
+
+    it->depth = 0;
+    while (node) {
+        if (iter_push(it, node) != 0) {
+            return NULL;
+        }
+
+        size_t left_size = bst_subtree_size(node->left);
+        if (rank == left_size) {
+            return iter_result(it);
+        }
+        if (rank < left_size) {
+            node = node->left;
+        } else {
+            rank -= left_size + 1;
+            node = node->right;
+        }
+    }
+
+    it->depth = 0;
+    return NULL;
+}
+
+/**
+ * Get the current city
+ */
+const char *bst_iter_current(const BSTIter *it) {
+    if (!it || it->depth == 0) {
+        return NULL;
+    }
+
+    const BSTNode *node = (it->heap_path ? it->heap_path : it->inline_path)[it->depth - 1];
+    return bst_node_display(node);
+}
+
+/**
+ * Move to the next city
+ * With a right subtree the successor is its leftmost node; otherwise it is
+ * the nearest ancestor reached from its left side.
+ */
+const char *bst_iter_next(BSTIter *it) {
+    if (!it || it->depth == 0) {
+        return NULL;
+    }
+
+    BSTNode **path = iter_path(it);
+    BSTNode *node = path[it->depth - 1];
+
+    if (node->right) {
+        for (node = node->right; node; node = node->left) {
+            if (iter_push(it, node) != 0) {
+                return NULL;
+            }
+        }
+        return iter_result(it);
+    }
+
+    for (;;) {
+        BSTNode *child = path[--it->depth];
+        if (it->depth == 0) {
+            return NULL;
+        }
+        if (path[it->depth - 1]->left == child) {
+            return iter_result(it);
+        }
+    }
+}
+
+/**
+ * Move to the previous city (mirror image of bst_iter_next)
+ */
+const char *bst_iter_prev(BSTIter *it) {
+    if (!it || it->depth == 0) {
+        return NULL;
+    }
+
+    BSTNode **path = iter_path(it);
+    BSTNode *node = path[it->depth - 1];
+
+    if (node->left) {
+        for (node = node->left; node; node = node->right) {
+            if (iter_push(it, node) != 0) {
+                return NULL;
+            }
+        }
+        return iter_result(it);
+    }
+
+    for (;;) {
+        BSTNode *child = path[--it->depth];
+        if (it->depth == 0) {
+            return NULL;
+        }
+        if (path[it->depth - 1]->right == child) {
+            return iter_result(it);
+        }
+    }
+}
@@ -0,0 +1,565 @@
+#include "bst_parallel.h"
+#include "bst_internal.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// AVL height stays below 1.45 * log2(n + 2), so this covers any addressable tree
+#define WALK_STACK_DEPTH 128
+
+// Ranges per worker; more ranges even out uneven workers at a small setup cost
+#define RANGES_PER_THREAD 8
+
+// Smallest range worth handing to a worker
+#define MIN_RANGE_SIZE 1024
+
+struct BSTPool {
+    pthread_t *threads;
+    size_t thread_count;
+    pthread_mutex_t job_lock;            // Held for a whole job: one job at a time
+
+    // Current job; workers claim task indexes from next_task
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;
+    pthread_cond_t work_done;
+    void (*task)(size_t index, void *ctx);
+    void *ctx;
+    size_t task_count;
+    atomic_size_t next_task;
+    size_t active;                       // Workers that have not finished the job
+    unsigned long generation;            // Bumped for every job
+    int shutdown;
+};
+
+/**
+ * Run tasks of the current job until none are left
+ */
+static void pool_drain(BSTPool *pool, void (*task)(size_t, void *), void *ctx, size_t count) {
+    for (;;) {
+        size_t index = atomic_fetch_add(&pool->next_task, 1);
+        if (index >= count) {
+            return;
+        }
+        task(index, ctx);
+    }
+}
+
+/**
+ * Worker thread: wait for a job, help drain it, report back
+ */
+static void *pool_worker(void *arg) {
+    BSTPool *pool = (BSTPool *)arg;
+    unsigned long seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->shutdown && pool->generation == seen) {
+            pthread_cond_wait(&pool->work_ready, &pool->lock);
+        }
+        if (pool->shutdown) {
+            break;
+        }
+
+        seen = pool->generation;
+        void (*task)(size_t, void *) = pool->task;
+        void *ctx = pool->ctx;
+        size_t count = pool->task_count;
+        pthread_mutex_unlock(&pool->lock);
+
+        pool_drain(pool, task, ctx, count);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->active == 0) {
+            pthread_cond_signal(&pool->work_done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+/**
+ * Hand a job of count tasks to the workers (job_lock must be held)
+ */
+static void pool_submit(BSTPool *pool, size_t count, void (*task)(size_t, void *), void *ctx) {
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->ctx = ctx;
+    pool->task_count = count;
+    atomic_store(&pool->next_task, 0);
+    pool->active = pool->thread_count;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * Wait until every worker has finished the current job
+ */
+static void pool_wait(BSTPool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    while (pool->active > 0) {
+        pthread_cond_wait(&pool->work_done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * Run a job to completion, with the calling thread helping
+ */
+static void pool_run(BSTPool *pool, size_t count, void (*task)(size_t, void *), void *ctx) {
+    pthread_mutex_lock(&pool->job_lock);
+    pool_submit(pool, count, task, ctx);
+    pool_drain(pool, task, ctx, count);
+    pool_wait(pool);
+    pthread_mutex_unlock(&pool->job_lock);
+}
+
+/**
+ * Create a thread pool
+ */
+BSTPool *bst_pool_create(size_t threads) {
+    if (threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (size_t)online : 1;
+    }
+
+    BSTPool *pool = (BSTPool *)calloc(1, sizeof(BSTPool));
+    if (!pool) {
+        return NULL;
+    }
+
+    pool->threads = (pthread_t *)malloc(threads * sizeof(pthread_t));
+    if (!pool->threads) {
+        free(pool);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->job_lock, NULL);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_ready, NULL);
+    pthread_cond_init(&pool->work_done, NULL);
+    atomic_init(&pool->next_task, 0);
+
+    for (size_t i = 0; i < threads; i++) {
+        if (pthread_create(&pool->threads[i], NULL, pool_worker, pool) != 0) {
+            break;
+        }
+        pool->thread_count++;
+    }
+
+    if (pool->thread_count == 0) {
+        bst_pool_destroy(pool);
+        return NULL;
+    }
+
+    return pool;
+}
+
+/**
+ * Stop the workers and free the pool
+ */
+void bst_pool_destroy(BSTPool *pool) {
+    if (!pool) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < pool->thread_count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->work_done);
+    pthread_cond_destroy(&pool->work_ready);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_mutex_destroy(&pool->job_lock);
+    free(pool->threads);
+    free(pool);
+}
+
+/**
+ * Get the number of worker threads
+ */
+size_t bst_pool_threads(const BSTPool *pool) {
+    return pool ? pool->thread_count : 0;
+}
+
+/**
+ * Number of ranges to cut a tree of n cities into
+ */
+static size_t default_ranges(const BSTPool *pool, size_t n) {
+    size_t ranges = pool->thread_count * RANGES_PER_THREAD;
+    size_t by_size = n / MIN_RANGE_SIZE;
+
+    if (ranges > by_size) {
+        ranges = by_size;
+    }
+    return ranges > 0 ? ranges : 1;
+}
+
+/**
+ * Bounds of range index when n cities are split into ranges parts
+ */
+static BSTRange make_range(BSTNode *root, size_t index, size_t ranges) {
+    size_t n = bst_subtree_size(root);
+    BSTRange range;
+
+    range.root = root;
+    range.index = index;
+    range.first = index * n / ranges;
+    range.count = (index + 1) * n / ranges - range.first;
+
+    return range;
+}
+
+/**
+ * Visit the cities of one range in alphabetical order
+ * Descends to the first rank once, then continues in order with a stack of
+ * the ancestors still to be visited.
+ */
+void bst_range_walk(const BSTRange *range, void (*visit)(const BSTNode *node, void *ctx), void *ctx) {
+    if (!range || !visit || range->count == 0) {
+        return;
+    }
+
+    const BSTNode *stack[WALK_STACK_DEPTH];
+    size_t depth = 0;
+    const BSTNode *node = range->root;
+    size_t rank = range->first;
+
+    // Stack every ancestor whose own rank is at or after the first rank
+    while (node) {
+        size_t left = bst_subtree_size(node->left);
+        if (rank < left) {
+            stack[depth++] = node;
+            node = node->left;
+        } else if (rank == left) {
+            stack[depth++] = node;
+            break;
+        } else {
+            rank -= left + 1;
+            node = node->right;
+        }
+    }
+
+    for (size_t remaining = range->count; remaining > 0 && depth > 0; remaining--) {
+        node = stack[--depth];
+        visit(node, ctx);
+
+        for (node = node->right; node; node = node->left) {
+            stack[depth++] = node;
+        }
+    }
+}
+
+/**
+ * Job state for bst_parallel_ranges
+ */
+typedef struct RangesJob {
+    BSTNode *root;
+    size_t ranges;
+    void (*fn)(const BSTRange *range, void *ctx);
+    void *ctx;
+} RangesJob;
+
+/**
+ * Process one range of a bst_parallel_ranges job
+ */
+static void ranges_task(size_t index, void *arg) {
+    RangesJob *job = (RangesJob *)arg;
+    BSTRange range = make_range(job->root, index, job->ranges);
+
+    job->fn(&range, job->ctx);
+}
+
+/**
+ * Split a tree into ordered ranges and process them on the pool
+ */
+size_t bst_parallel_ranges(BSTPool *pool, BSTNode *root, size_t ranges,
+                           void (*fn)(const BSTRange *range, void *ctx), void *ctx) {
+    size_t n = bst_subtree_size(root);
+    if (!pool || !fn || n == 0) {
+        return 0;
+    }
+
+    if (ranges == 0) {
+        ranges = default_ranges(pool, n);
+    }
+    if (ranges > n) {
+        ranges = n;
+    }
+
+    RangesJob job = {root, ranges, fn, ctx};
+    pool_run(pool, ranges, ranges_task, &job);
+
+    return ranges;
+}
+
+/**
+ * Job state for bst_parallel_count_if
+ */
+typedef struct CountJob {
+    int (*match)(const char *city, void *ctx);
+    void *ctx;
+    size_t *counts;          // One slot per range, so workers never share a counter
+} CountJob;
+
+typedef struct CountRange {
+    const CountJob *job;
+    size_t count;
+} CountRange;
+
+/**
+ * Count one node if it matches
+ */
+static void count_node(const BSTNode *node, void *arg) {
+    CountRange *range = (CountRange *)arg;
+
+    if (range->job->match(bst_node_display(node), range->job->ctx)) {
+        range->count++;
+    }
+}
+
+/**
+ * Count the matches in one range
+ */
+static void count_range(const BSTRange *range, void *arg) {
+    CountJob *job = (CountJob *)arg;
+    CountRange counter = {job, 0};
+
+    bst_range_walk(range, count_node, &counter);
+    job->counts[range->index] = counter.count;
+}
+
+/**
+ * Count the cities matching a predicate in parallel
+ */
+size_t bst_parallel_count_if(BSTPool *pool, BSTNode *root, int (*match)(const char *city, void *ctx),
+                             void *ctx) {
+    size_t n = bst_subtree_size(root);
+    if (!pool || !match || n == 0) {
+        return 0;
+    }
+
+    size_t ranges = default_ranges(pool, n);
+    CountJob job = {match, ctx, (size_t *)calloc(ranges, sizeof(size_t))};
+    if (!job.counts) {
+        return 0;
+    }
+
+    bst_parallel_ranges(pool, root, ranges, count_range, &job);
+
+    size_t total = 0;
+    for (size_t i = 0; i < ranges; i++) {
+        total += job.counts[i];
+    }
+    free(job.counts);
+
+    return total;
+}
+
+/**
+ * Formatted output of one export range
+ */
+typedef struct ExportBuffer {
+    char *data;
+    size_t len;
+    size_t capacity;
+    int ready;               // Set (under the job lock) once the range is formatted
+    int failed;
+} ExportBuffer;
+
+/**
+ * Job state for bst_parallel_export
+ */
+typedef struct ExportJob {
+    BSTNode *root;
+    size_t ranges;
+    ExportBuffer *buffers;
+    pthread_mutex_t lock;
+    pthread_cond_t range_ready;
+} ExportJob;
+
+/**
+ * Append one city and a newline to the range's buffer
+ */
+static void export_node(const BSTNode *node, void *arg) {
+    ExportBuffer *buffer = (ExportBuffer *)arg;
+    size_t len = bst_node_display_len(node);
+    size_t needed = buffer->len + len + 1;
+
+    if (buffer->failed) {
+        return;
+    }
+
+    if (needed > buffer->capacity) {
+        size_t capacity = buffer->capacity * 2;
+        while (capacity < needed) {
+            capacity *= 2;
+        }
+        char *resized = (char *)realloc(buffer->data, capacity);
+        if (!resized) {
+            buffer->failed = 1;
+            return;
+        }
+        buffer->data = resized;
+        buffer->capacity = capacity;
+    }
+
+    memcpy(buffer->data + buffer->len, bst_node_display(node), len);
+    buffer->data[buffer->len + len] = '\n';
+    buffer->len = needed;
+}
+
+/**
+ * Format one range and tell the writing thread it is ready
+ */
+static void export_task(size_t index, void *arg) {
+    ExportJob *job = (ExportJob *)arg;
+    BSTRange range = make_range(job->root, index, job->ranges);
+    ExportBuffer *buffer = &job->buffers[index];
+
+    // Most city names are short; the buffer grows if this guess is low
+    buffer->capacity = range.count * 16 + 64;
+    buffer->data = (char *)malloc(buffer->capacity);
+    if (buffer->data) {
+        bst_range_walk(&range, export_node, buffer);
+    } else {
+        buffer->failed = 1;
+    }
+
+    pthread_mutex_lock(&job->lock);
+    buffer->ready = 1;
+    pthread_cond_broadcast(&job->range_ready);
+    pthread_mutex_unlock(&job->lock);
+}
+
+/**
+ * Export every city in order, formatting ranges in parallel
+ */
+int bst_parallel_export(BSTPool *pool, BSTNode *root, FILE *out) {
+    if (!pool || !out) {
+        return -1;
+    }
+
+    size_t n = bst_subtree_size(root);
+    if (n == 0) {
+        return 0;
+    }
+
+    ExportJob job;
+    job.root = root;
+    job.ranges = default_ranges(pool, n);
+    job.buffers = (ExportBuffer *)calloc(job.ranges, sizeof(ExportBuffer));
+    if (!job.buffers) {
+        return -1;
+    }
+    pthread_mutex_init(&job.lock, NULL);
+    pthread_cond_init(&job.range_ready, NULL);
+
+    // Workers format; this thread writes each range as soon as it and all earlier ones are done
+    pthread_mutex_lock(&pool->job_lock);
+    pool_submit(pool, job.ranges, export_task, &job);
+
+    int result = 0;
+    for (size_t i = 0; i < job.ranges; i++) {
+        ExportBuffer *buffer = &job.buffers[i];
+
+        pthread_mutex_lock(&job.lock);
+        while (!buffer->ready) {
+            pthread_cond_wait(&job.range_ready, &job.lock);
+        }
+        pthread_mutex_unlock(&job.lock);
+
+        if (buffer->failed || (result == 0 && fwrite(buffer->data, 1, buffer->len, out) != buffer->len)) {
+            result = -1;
+        }
+        free(buffer->data);
+        buffer->data = NULL;
+    }
+
+    pool_wait(pool);
+    pthread_mutex_unlock(&pool->job_lock);
+
+    pthread_cond_destroy(&job.range_ready);
+    pthread_mutex_destroy(&job.lock);
+    free(job.buffers);
+
+    return result;
+}
+
+/**
+ * Free one detached subtree
+ */
+static void delete_task(size_t index, void *arg) {
+    BSTNode **subtrees = (BSTNode **)arg;
+    bst_delete_tree(subtrees[index]);
+}
+
+/**
+ * Free a malloc-backed tree using every worker
+ */
+void bst_parallel_delete(BSTPool *pool, BSTNode *root) {
+    if (!pool || !root) {
+        bst_delete_tree(root);
+        return;
+    }
+
+    // Cut the top levels off until there are enough subtrees to share out
+    size_t target = pool->thread_count * RANGES_PER_THREAD;
+    size_t capacity = 1;
+    while (capacity < target) {
+        capacity *= 2;
+    }
+
+    BSTNode **subtrees = (BSTNode **)malloc(capacity * sizeof(BSTNode *));
+    BSTNode **next = (BSTNode **)malloc(capacity * sizeof(BSTNode *));
+    if (!subtrees || !next) {
+        free(subtrees);
+        free(next);
+        bst_delete_tree(root);
+        return;
+    }
+
+    size_t count = 1;
+    subtrees[0] = root;
+    while (count * 2 <= capacity && count < target) {
+        size_t next_count = 0;
+
+        for (size_t i = 0; i < count; i++) {
+            BSTNode *node = subtrees[i];
+            if (node->left) {
+                next[next_count++] = node->left;
+            }
+            if (node->right) {
+                next[next_count++] = node->right;
+            }
+
+            // Detached from its children, the node is freed on its own
+            node->left = NULL;
+            node->right = NULL;
+            bst_delete_tree(node);
+        }
+
+        BSTNode **swap = subtrees;
+        subtrees = next;
+        next = swap;
+        count = next_count;
+        if (count == 0) {
+            break;
+        }
+    }
+
+    if (count > 0) {
+        pool_run(pool, count, delete_task, subtrees);
+    }
+
+    free(subtrees);
+    free(next);
+}
@@ -0,0 +1,578 @@
+#include "bst_snapshot.h"
+#include "bst_internal.h"
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Entries are aligned so that each group of four siblings shares a cache line
+#define SNAPSHOT_ALIGN 64
+
+// Snapshot file identification
+#define SNAPSHOT_MAGIC "CITYSNAP"
+#define SNAPSHOT_VERSION 1u
+#define SNAPSHOT_BYTE_ORDER 0x01020304u
+
+/**
+ * One city in Eytzinger order
+ */
+typedef struct SnapshotEntry {
+    uint64_t prefix;         // Same encoding as BSTNode.prefix
+    uint32_t offset;         // Offset of the name in the blob
+    uint32_t len;            // Name length in bytes, excluding the terminator
+} SnapshotEntry;
+
+struct BSTSnapshot {
+    size_t count;            // Number of cities
+    SnapshotEntry *entries;  // 1-based Eytzinger array; entries[0] is unused
+    char *blob;              // All names, NUL-terminated, in alphabetical order
+    size_t blob_size;        // Bytes used in blob
+    void *mapping;           // File mapping that entries and blob point into, or NULL
+    size_t mapping_size;     // Length of the mapping in bytes
+};
+
+/**
+ * Snapshot file header, followed by the entry array (entries[0] included)
+ * at entries_offset and the string table at blob_offset
+ */
+typedef struct SnapshotFileHeader {
+    char magic[8];           // SNAPSHOT_MAGIC, not NUL-terminated
+    uint32_t version;        // SNAPSHOT_VERSION
+    uint32_t byte_order;     // SNAPSHOT_BYTE_ORDER as written by the saving machine
+    uint64_t count;          // Number of cities
+    uint64_t entries_offset; // File offset of entries[0]
+    uint64_t blob_offset;    // File offset of the string table
+    uint64_t blob_size;      // String table size in bytes
+    uint64_t body_checksum;  // snapshot_checksum over the entry array and string table
+    uint64_t header_checksum;  // snapshot_checksum over the fields above
+} SnapshotFileHeader;
+
+/**
+ * Append the nodes of a subtree to sorted in order, returning the new count
+ * Only reads the tree (unlike bst_walk_inorder, which threads it), so it is
+ * safe next to other readers; recursion is on left children only, so its
+ * depth is bounded by the height.
+ */
+static size_t collect_sorted(const BSTNode *node, const BSTNode **sorted, size_t count) {
+    while (node != NULL) {
+        count = collect_sorted(node->left, sorted, count);
+        sorted[count++] = node;
+        node = node->right;
+    }
+    return count;
+}
+
+/**
+ * Place the sorted nodes into Eytzinger positions, copying names in order
+ * Visiting k's subtree in order consumes sorted nodes in order.
+ */
+static void fill_eytzinger(BSTSnapshot *snapshot, const BSTNode **sorted, size_t *next, size_t k) {
+    if (k > snapshot->count) {
+        return;
+    }
+
+    fill_eytzinger(snapshot, sorted, next, 2 * k);
+
+    const BSTNode *node = sorted[(*next)++];
+    SnapshotEntry *entry = &snapshot->entries[k];
+    entry->prefix = node->prefix;
+    entry->offset = (uint32_t)snapshot->blob_size;
+    entry->len = node->len;
+    memcpy(snapshot->blob + snapshot->blob_size, bst_node_name(node), node->len + 1);
+    snapshot->blob_size += node->len + 1;
+
+    fill_eytzinger(snapshot, sorted, next, 2 * k + 1);
+}
+
+/**
+ * Freeze the current contents of a BST into an immutable snapshot
+ */
+BSTSnapshot *bst_freeze(BSTNode *root) {
+    BSTSnapshot *snapshot = (BSTSnapshot *)calloc(1, sizeof(BSTSnapshot));
+    if (!snapshot) {
+        return NULL;
+    }
+
+    size_t count = bst_count_nodes(root);
+    if (count == 0) {
+        return snapshot;
+    }
+
+    const BSTNode **sorted = (const BSTNode **)malloc(count * sizeof(*sorted));
+    if (!sorted) {
+        free(snapshot);
+        return NULL;
+    }
+
+    size_t blob_size = 0;
+    collect_sorted(root, sorted, 0);
+    for (size_t i = 0; i < count; i++) {
+        blob_size += sorted[i]->len + 1;
+    }
+
+    // Offsets are 32-bit to keep entries at 16 bytes
+    size_t entries_size = ((count + 1) * sizeof(SnapshotEntry) + SNAPSHOT_ALIGN - 1)
+                          & ~(size_t)(SNAPSHOT_ALIGN - 1);
+    if (blob_size > UINT32_MAX) {
+        free((void *)sorted);
+        free(snapshot);
+        return NULL;
+    }
+
+    snapshot->count = count;
+    snapshot->entries = (SnapshotEntry *)aligned_alloc(SNAPSHOT_ALIGN, entries_size);
+    snapshot->blob = (char *)malloc(blob_size);
+    if (!snapshot->entries || !snapshot->blob) {
+        free((void *)sorted);
+        bst_snapshot_free(snapshot);
+        return NULL;
+    }
+
+    size_t next = 0;
+    memset(&snapshot->entries[0], 0, sizeof(SnapshotEntry));
+    fill_eytzinger(snapshot, sorted, &next, 1);
+
+    free((void *)sorted);
+    return snapshot;
+}
+
+/**
+ * Free a snapshot
+ */
+void bst_snapshot_free(BSTSnapshot *snapshot) {
+    if (!snapshot) {
+        return;
+    }
+
+    if (snapshot->mapping) {
+        munmap(snapshot->mapping, snapshot->mapping_size);
+    } else {
+        free(snapshot->entries);
+        free(snapshot->blob);
+    }
+    free(snapshot);
+}
+
+/**
+ * Rebuild a mutable, balanced BST from a snapshot
+ */
+BSTNode *bst_thaw(const BSTSnapshot *snapshot) {
+    if (!snapshot || snapshot->count == 0) {
+        return NULL;
+    }
+
+    const char **names = (const char **)malloc(snapshot->count * sizeof(*names));
+    if (!names) {
+        return NULL;
+    }
+
+    size_t count = bst_snapshot_names(snapshot, names);
+    BSTNode *root = bst_build_from_array(names, count);
+
+    free(names);
+    return root;
+}
+
+/**
+ * Get the cities of a snapshot in alphabetical order
+ */
+size_t bst_snapshot_names(const BSTSnapshot *snapshot, const char **names) {
+    if (!snapshot || !names) {
+        return 0;
+    }
+
+    // The blob holds the names back to back in alphabetical order; it ends
+    // with a terminator, so the walk stays inside it
+    size_t count = 0;
+    size_t offset = 0;
+    while (count < snapshot->count && offset < snapshot->blob_size) {
+        const char *name = snapshot->blob + offset;
+        names[count++] = name;
+        offset += strlen(name) + 1;
+    }
+
+    return count;
+}
+
+/**
+ * 64-bit checksum of a byte range, chained through seed
+ * Four independent multiply-rotate lanes over 8-byte words keep this near
+ * memory bandwidth, so verifying a large snapshot stays cheap.
+ */
+static uint64_t snapshot_checksum(const void *data, size_t len, uint64_t seed) {
+    const uint64_t P1 = 0x9E3779B185EBCA87ULL;
+    const uint64_t P2 = 0xC2B2AE3D27D4EB4FULL;
+    const unsigned char *p = (const unsigned char *)data;
+    uint64_t lanes[4] = {seed + P1, seed + P2, seed, seed - P1};
+    uint64_t word;
+
+    while (len >= 32) {
+        for (int i = 0; i < 4; i++) {
+            memcpy(&word, p + 8 * i, sizeof(word));
+            lanes[i] += word * P2;
+            lanes[i] = ((lanes[i] << 31) | (lanes[i] >> 33)) * P1;
+        }
+        p += 32;
+        len -= 32;
+    }
+
+    uint64_t hash = lanes[0] ^ ((lanes[1] << 7) | (lanes[1] >> 57)) ^ ((lanes[2] << 12) | (lanes[2] >> 52))
+                    ^ ((lanes[3] << 18) | (lanes[3] >> 46));
+    while (len > 0) {
+        hash = (hash ^ *p++) * P1;
+        len--;
+    }
+
+    hash ^= hash >> 33;
+    hash *= P2;
+    hash ^= hash >> 29;
+    return hash;
+}
+
+/**
+ * Size of the entry array (entries[0] included), padded to SNAPSHOT_ALIGN
+ */
+static size_t entries_bytes(size_t count) {
+    return ((count + 1) * sizeof(SnapshotEntry) + SNAPSHOT_ALIGN - 1) & ~(size_t)(SNAPSHOT_ALIGN - 1);
+}
+
+/**
+ * Checksum of the header fields that precede header_checksum
+ */
+static uint64_t header_checksum(const SnapshotFileHeader *header) {
+    return snapshot_checksum(header, offsetof(SnapshotFileHeader, header_checksum), 0);
+}
+
+/**
+ * Write all bytes to fd
+ */
+static int write_all(int fd, const void *data, size_t len) {
+    const char *p = (const char *)data;
+
+    while (len > 0) {
+        ssize_t written = write(fd, p, len);
+        if (written <= 0) {
+            return -1;
+        }
+        p += written;
+        len -= (size_t)written;
+    }
+
+    return 0;
+}
+
+/**
+ * fsync the directory holding the first path_len bytes of path
+ * path is scratch space: it is cut short at the last slash.
+ */
+static void sync_parent_dir(char *path, size_t path_len) {
+    const char *dir = ".";
+    char *slash = NULL;
+
+    for (size_t i = 0; i < path_len; i++) {
+        if (path[i] == '/') {
+            slash = &path[i];
+        }
+    }
+    if (slash == path) {
+        dir = "/";
+    } else if (slash) {
+        *slash = '\0';
+        dir = path;
+    }
+
+    int dir_fd = open(dir, O_RDONLY);
+    if (dir_fd >= 0) {
+        fsync(dir_fd);
+        close(dir_fd);
+    }
+}
+
+/**
+ * Write the current contents of a BST to a snapshot file
+ */
+int bst_save_snapshot(BSTNode *root, const char *path) {
+    if (!path) {
+        return -1;
+    }
+
+    BSTSnapshot *snapshot = bst_freeze(root);
+    if (!snapshot) {
+        return -1;
+    }
+
+    SnapshotEntry empty[1] = {{0, 0, 0}};
+    const void *entries = snapshot->count ? (const void *)snapshot->entries : (const void *)empty;
+    size_t entries_size = snapshot->count ? entries_bytes(snapshot->count) : sizeof(empty);
+
+    // Zero the padding so the file (and its checksum) is deterministic
+    if (snapshot->count) {
+        size_t used = (snapshot->count + 1) * sizeof(SnapshotEntry);
+        memset((char *)snapshot->entries + used, 0, entries_size - used);
+    }
+
+    SnapshotFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.byte_order = SNAPSHOT_BYTE_ORDER;
+    header.count = snapshot->count;
+    header.entries_offset = SNAPSHOT_ALIGN;
+    header.blob_offset = SNAPSHOT_ALIGN + entries_size;
+    header.blob_size = snapshot->blob_size;
+    header.body_checksum = snapshot_checksum(entries, entries_size, 0);
+    header.body_checksum = snapshot_checksum(snapshot->blob, snapshot->blob_size, header.body_checksum);
+    header.header_checksum = header_checksum(&header);
+
+    // Header padded out to the first entry
+    char header_block[SNAPSHOT_ALIGN] = {0};
+    memcpy(header_block, &header, sizeof(header));
+
+    size_t path_len = strlen(path);
+    char *tmp_path = (char *)malloc(path_len + sizeof(".XXXXXX"));
+    int fd = -1;
+    if (tmp_path) {
+        memcpy(tmp_path, path, path_len);
+        memcpy(tmp_path + path_len, ".XXXXXX", sizeof(".XXXXXX"));
+        fd = mkstemp(tmp_path);
+    }
+
+    int ok = fd >= 0
+             && write_all(fd, header_block, sizeof(header_block)) == 0
+             && write_all(fd, entries, entries_size) == 0
+             && write_all(fd, snapshot->blob, snapshot->blob_size) == 0
+             && fsync(fd) == 0;
+
+    if (fd >= 0) {
+        ok = close(fd) == 0 && ok;
+        ok = ok && rename(tmp_path, path) == 0;
+        if (!ok) {
+            unlink(tmp_path);
+        } else {
+            // Make the rename itself durable
+            sync_parent_dir(tmp_path, path_len);
+        }
+    }
+
+    free(tmp_path);
+    bst_snapshot_free(snapshot);
+    return ok ? 0 : -1;
+}
+
+/**
+ * Walk of the entry array in alphabetical order
+ */
+typedef struct EntryCheck {
+    const SnapshotEntry *entries;
+    const char *blob;
+    size_t count;
+    size_t blob_size;
+    size_t offset;           // Where the next name must start
+    const SnapshotEntry *previous;
+} EntryCheck;
+
+/**
+ * Check the entries under Eytzinger position k in order
+ * Names must tile the string table in order, each with its terminator,
+ * and carry their own prefix.
+ */
+static int check_entries(EntryCheck *check, size_t k) {
+    if (k > check->count) {
+        return 0;
+    }
+    if (check_entries(check, 2 * k) != 0) {
+        return -1;
+    }
+
+    const SnapshotEntry *entry = &check->entries[k];
+    const char *name = check->blob + entry->offset;
+    if (entry->offset != check->offset
+        || entry->len >= check->blob_size - entry->offset
+        || name[entry->len] != '\0'
+        || entry->prefix != bst_load_prefix(name, entry->len)) {
+        return -1;
+    }
+
+    // Prefixes decide the order; equal ones fall back to the remaining bytes
+    const SnapshotEntry *previous = check->previous;
+    if (previous && (previous->prefix > entry->prefix
+                     || (previous->prefix == entry->prefix
+                         && strcmp(check->blob + previous->offset, name) >= 0))) {
+        return -1;
+    }
+    check->previous = entry;
+    check->offset += entry->len + 1;
+
+    return check_entries(check, 2 * k + 1);
+}
+
+/**
+ * Check that a mapped file is a complete snapshot for this platform
+ */
+static int validate_file(const char *data, size_t size, unsigned flags) {
+    SnapshotFileHeader header;
+
+    if (size < SNAPSHOT_ALIGN) {
+        return -1;
+    }
+    memcpy(&header, data, sizeof(header));
+
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0
+        || header.version != SNAPSHOT_VERSION
+        || header.byte_order != SNAPSHOT_BYTE_ORDER
+        || header.header_checksum != header_checksum(&header)) {
+        return -1;
+    }
+
+    // Sections must be laid out exactly as bst_save_snapshot writes them
+    if (header.count > (size - SNAPSHOT_ALIGN) / sizeof(SnapshotEntry)
+        || header.entries_offset != SNAPSHOT_ALIGN
+        || header.blob_offset != SNAPSHOT_ALIGN + (header.count ? entries_bytes(header.count)
+                                                                : sizeof(SnapshotEntry))
+        || header.blob_size > UINT32_MAX
+        || header.blob_offset + header.blob_size != size
+        || header.blob_size < header.count
+        || (header.count > 0 && data[size - 1] != '\0')) {
+        return -1;
+    }
+
+    if (flags & BST_SNAPSHOT_VERIFY) {
+        uint64_t checksum = snapshot_checksum(data + header.entries_offset,
+                                              header.blob_offset - header.entries_offset, 0);
+        checksum = snapshot_checksum(data + header.blob_offset, header.blob_size, checksum);
+        if (checksum != header.body_checksum) {
+            return -1;
+        }
+
+        // The body is being read anyway: also check that it was written right
+        EntryCheck check = {(const SnapshotEntry *)(data + header.entries_offset), data + header.blob_offset,
+                            (size_t)header.count, (size_t)header.blob_size, 0, NULL};
+        if (check_entries(&check, 1) != 0 || check.offset != check.blob_size) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Map a snapshot file for lookups
+ */
+BSTSnapshot *bst_open_snapshot(const char *path, unsigned flags) {
+    if (!path) {
+        return NULL;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < SNAPSHOT_ALIGN) {
+        close(fd);
+        return NULL;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return NULL;
+    }
+
+    BSTSnapshot *snapshot = (BSTSnapshot *)calloc(1, sizeof(BSTSnapshot));
+    if (!snapshot || validate_file((const char *)mapping, size, flags) != 0) {
+        free(snapshot);
+        munmap(mapping, size);
+        return NULL;
+    }
+
+    const SnapshotFileHeader *header = (const SnapshotFileHeader *)mapping;
+    snapshot->count = header->count;
+    snapshot->entries = (SnapshotEntry *)((char *)mapping + header->entries_offset);
+    snapshot->blob = (char *)mapping + header->blob_offset;
+    snapshot->blob_size = header->blob_size;
+    snapshot->mapping = mapping;
+    snapshot->mapping_size = size;
+
+    return snapshot;
+}
+
+/**
+ * Does the entry's name lie inside the string table?
+ * Entries of an unverified file are only trusted this far, checked as they
+ * are read, so a damaged one makes lookups miss instead of leaving the mapping.
+ */
+static inline int entry_in_bounds(const BSTSnapshot *snapshot, const SnapshotEntry *entry) {
+    return (size_t)entry->offset + entry->len < snapshot->blob_size;
+}
+
+/**
+ * Is the entry's name strictly before the key?
+ */
+static inline int entry_before_key(const BSTSnapshot *snapshot, const SnapshotEntry *entry,
+                                   const BSTKey *key) {
+    if (entry->prefix != key->prefix) {
+        return entry->prefix < key->prefix;
+    }
+
+    size_t shared = entry->len < key->len ? entry->len : key->len;
+    if (shared > BST_PREFIX_BYTES && entry_in_bounds(snapshot, entry)) {
+        int cmp = memcmp(snapshot->blob + entry->offset + BST_PREFIX_BYTES,
+                         key->str + BST_PREFIX_BYTES, shared - BST_PREFIX_BYTES);
+        if (cmp != 0) {
+            return cmp < 0;
+        }
+    }
+
+    return entry->len < key->len;
+}
+
+/**
+ * Search for a city in a snapshot
+ */
+const char *bst_snapshot_search(const BSTSnapshot *snapshot, const char *city) {
+    if (!snapshot || !city || snapshot->count == 0) {
+        return NULL;
+    }
+
+    BSTKey key = bst_key_make(city);
+    const SnapshotEntry *entries = snapshot->entries;
+    size_t count = snapshot->count;
+    size_t k = 1;
+
+    // Branch-free descent: each step picks a child with arithmetic only.
+    // Eight entries three levels down share two cache lines, fetched early.
+    while (k <= count) {
+        __builtin_prefetch((const char *)entries + 8 * k * sizeof(SnapshotEntry));
+        __builtin_prefetch((const char *)entries + (8 * k + 4) * sizeof(SnapshotEntry));
+        k = 2 * k + (size_t)entry_before_key(snapshot, &entries[k], &key);
+    }
+
+    // Undo the trailing right turns to land on the first entry >= key
+    k >>= __builtin_ffsll((long long)~k);
+    if (k == 0) {
+        return NULL;
+    }
+
+    const SnapshotEntry *entry = &entries[k];
+    const char *name = snapshot->blob + entry->offset;
+    if (entry->prefix != key.prefix || entry->len != key.len || !entry_in_bounds(snapshot, entry)
+        || memcmp(name, city, key.len) != 0 || name[key.len] != '\0') {
+        return NULL;
+    }
+
+    return name;
+}
+
+/**
+ * Get the number of cities in a snapshot
+ */
+size_t bst_snapshot_count(const BSTSnapshot *snapshot) {
+    return snapshot ? snapshot->count : 0;
+}
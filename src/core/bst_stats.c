@@ -0,0 +1,459 @@
+#include "bst_stats.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef BST_STATS
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#endif
+
+static const char *op_names[BST_STAT_OP_COUNT] = {"insert", "search", "remove", "fetch"};
+static const char *counter_names[BST_STAT_COUNTER_COUNT] = {"compares",     "node_allocs",  "name_allocs",
+                                                            "node_frees",   "batch_cities", "fetch_cities"};
+
+#define DEFAULT_SAMPLE_PERIOD 64
+
+/**
+ * Get the value a latency bucket stands for (its midpoint)
+ */
+uint64_t bst_stats_bucket_value(unsigned bucket) {
+    if (bucket < BST_STATS_SUB_BUCKETS) {
+        return bucket;
+    }
+
+    unsigned shift = bucket / BST_STATS_SUB_BUCKETS - 1;
+    uint64_t low = (uint64_t)(bucket % BST_STATS_SUB_BUCKETS + BST_STATS_SUB_BUCKETS) << shift;
+    return low + ((1ULL << shift) >> 1);
+}
+
+/**
+ * Get a percentile of a latency histogram
+ */
+uint64_t bst_stats_percentile(const uint64_t *histogram, double percentile) {
+    uint64_t total = 0;
+
+    if (!histogram) {
+        return 0;
+    }
+    for (unsigned i = 0; i < BST_STATS_LATENCY_BUCKETS; i++) {
+        total += histogram[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    // The smallest value with at least percentile% of the samples at or below it
+    double wanted = percentile / 100.0 * (double)total;
+    uint64_t rank = (uint64_t)wanted;
+    if ((double)rank < wanted || rank == 0) {
+        rank++;
+    }
+    if (rank > total) {
+        rank = total;
+    }
+
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < BST_STATS_LATENCY_BUCKETS; i++) {
+        seen += histogram[i];
+        if (seen >= rank) {
+            return bst_stats_bucket_value(i);
+        }
+    }
+    return 0;
+}
+
+#ifdef BST_STATS
+
+/*
+ * One shard per thread. Only the owning thread writes it, so updates are a
+ * relaxed load and store rather than a locked add; readers see each cell
+ * whole because the cells are atomic. The registry lock is only taken when
+ * a thread records for the first time or exits, and by readers.
+ */
+typedef struct Shard {
+    _Atomic uint64_t ops[BST_STAT_OP_COUNT];
+    _Atomic uint64_t counters[BST_STAT_COUNTER_COUNT];
+    _Atomic uint64_t latency[BST_STAT_OP_COUNT][BST_STATS_LATENCY_BUCKETS];
+    _Atomic uint64_t depth[BST_STAT_OP_COUNT][BST_STATS_DEPTH_BUCKETS];
+    unsigned countdown;      // Calls until the next timed one (owner only)
+    struct Shard *next;
+} Shard;
+
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static Shard *live_shards;           // Shards of running threads
+static BSTStatsReport retired;       // Totals of exited threads
+static BSTStatsReport baseline;      // Totals at the last reset
+static pthread_key_t shard_key;
+static pthread_once_t shard_key_once = PTHREAD_ONCE_INIT;
+static atomic_uint sample_period = DEFAULT_SAMPLE_PERIOD;
+static _Thread_local Shard *local_shard;
+
+/**
+ * Histogram bucket of a latency: exact below BST_STATS_SUB_BUCKETS, then
+ * BST_STATS_SUB_BUCKETS buckets per power of two
+ */
+static unsigned bucket_index(uint64_t ns) {
+    if (ns < BST_STATS_SUB_BUCKETS) {
+        return (unsigned)ns;
+    }
+    if (ns >> BST_STATS_MAX_BITS) {
+        ns = (1ULL << BST_STATS_MAX_BITS) - 1;
+    }
+
+    unsigned shift = 63 - (unsigned)__builtin_clzll(ns) - BST_STATS_SUB_BITS;
+    return (shift + 1) * BST_STATS_SUB_BUCKETS + (unsigned)((ns >> shift) - BST_STATS_SUB_BUCKETS);
+}
+
+static void bump(_Atomic uint64_t *cell, uint64_t n) {
+    atomic_store_explicit(cell, atomic_load_explicit(cell, memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+// Monotonic clock in nanoseconds
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Add a shard's cells to a report (caller holds the registry lock)
+ */
+static void add_shard(BSTStatsReport *report, Shard *shard) {
+    for (int op = 0; op < BST_STAT_OP_COUNT; op++) {
+        report->ops[op] += atomic_load_explicit(&shard->ops[op], memory_order_relaxed);
+        for (int i = 0; i < BST_STATS_LATENCY_BUCKETS; i++) {
+            report->latency[op][i] += atomic_load_explicit(&shard->latency[op][i], memory_order_relaxed);
+        }
+        for (int i = 0; i < BST_STATS_DEPTH_BUCKETS; i++) {
+            report->depth[op][i] += atomic_load_explicit(&shard->depth[op][i], memory_order_relaxed);
+        }
+    }
+    for (int c = 0; c < BST_STAT_COUNTER_COUNT; c++) {
+        report->counters[c] += atomic_load_explicit(&shard->counters[c], memory_order_relaxed);
+    }
+}
+
+/**
+ * Fold an exiting thread's shard into the retired totals and free it
+ */
+static void retire_shard(void *arg) {
+    Shard *shard = (Shard *)arg;
+
+    pthread_mutex_lock(&registry_lock);
+    add_shard(&retired, shard);
+    for (Shard **link = &live_shards; *link; link = &(*link)->next) {
+        if (*link == shard) {
+            *link = shard->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&registry_lock);
+
+    free(shard);
+}
+
+static void make_shard_key(void) {
+    pthread_key_create(&shard_key, retire_shard);
+}
+
+/**
+ * Get the calling thread's shard, registering one on first use
+ */
+static Shard *shard_get(void) {
+    Shard *shard = local_shard;
+    if (shard) {
+        return shard;
+    }
+
+    pthread_once(&shard_key_once, make_shard_key);
+    shard = (Shard *)calloc(1, sizeof(Shard));
+    if (!shard) {
+        return NULL;
+    }
+    shard->countdown = 1;
+
+    pthread_mutex_lock(&registry_lock);
+    shard->next = live_shards;
+    live_shards = shard;
+    pthread_mutex_unlock(&registry_lock);
+
+    pthread_setspecific(shard_key, shard);
+    local_shard = shard;
+    return shard;
+}
+
+/**
+ * Sum every shard and the retired totals (caller holds the registry lock)
+ */
+static void collect(BSTStatsReport *report) {
+    memcpy(report, &retired, sizeof(*report));
+    for (Shard *shard = live_shards; shard; shard = shard->next) {
+        add_shard(report, shard);
+    }
+}
+
+/**
+ * Check whether statistics were compiled in
+ */
+int bst_stats_enabled(void) {
+    return 1;
+}
+
+/**
+ * Add to a counter of the calling thread
+ */
+void bst_stats_add(BSTStatCounter counter, uint64_t n) {
+    Shard *shard = shard_get();
+    if (shard) {
+        bump(&shard->counters[counter], n);
+    }
+}
+
+/**
+ * Start timing a tree operation, if this call is sampled
+ */
+uint64_t bst_stats_timer_start(void) {
+    Shard *shard = shard_get();
+    if (!shard || --shard->countdown > 0) {
+        return 0;
+    }
+
+    shard->countdown = atomic_load_explicit(&sample_period, memory_order_relaxed);
+    return now_ns();
+}
+
+/**
+ * Record a tree operation of the calling thread
+ */
+void bst_stats_record_op(BSTStatOp op, uint64_t start, unsigned depth) {
+    Shard *shard = shard_get();
+    if (!shard) {
+        return;
+    }
+
+    bump(&shard->ops[op], 1);
+    bump(&shard->counters[BST_STAT_COMPARES], depth);
+    bump(&shard->depth[op][depth < BST_STATS_DEPTH_BUCKETS ? depth : BST_STATS_DEPTH_BUCKETS - 1], 1);
+    if (start) {
+        bump(&shard->latency[op][bucket_index(now_ns() - start)], 1);
+    }
+}
+
+/**
+ * Record an operation timed by the caller
+ */
+void bst_stats_record_latency(BSTStatOp op, uint64_t ns) {
+    Shard *shard = shard_get();
+    if (!shard) {
+        return;
+    }
+
+    bump(&shard->ops[op], 1);
+    bump(&shard->latency[op][bucket_index(ns)], 1);
+}
+
+/**
+ * Time one tree operation in every period calls
+ */
+void bst_stats_sample_period(unsigned period) {
+    atomic_store(&sample_period, period ? period : 1);
+
+    // Apply it from the caller's next call rather than after its current countdown
+    if (local_shard) {
+        local_shard->countdown = 1;
+    }
+}
+
+/**
+ * Merge every thread's counters and histograms, less the last reset
+ */
+void bst_stats_read(BSTStatsReport *report) {
+    if (!report) {
+        return;
+    }
+
+    // The report is nothing but uint64_t arrays, so it can be subtracted cell by cell
+    pthread_mutex_lock(&registry_lock);
+    collect(report);
+    uint64_t *cells = (uint64_t *)report;
+    const uint64_t *base = (const uint64_t *)&baseline;
+    for (size_t i = 0; i < sizeof(*report) / sizeof(uint64_t); i++) {
+        cells[i] -= base[i];
+    }
+    pthread_mutex_unlock(&registry_lock);
+}
+
+/**
+ * Start counting from zero
+ */
+void bst_stats_reset(void) {
+    pthread_mutex_lock(&registry_lock);
+    collect(&baseline);
+    pthread_mutex_unlock(&registry_lock);
+}
+
+#else
+
+int bst_stats_enabled(void) {
+    return 0;
+}
+
+void bst_stats_add(BSTStatCounter counter, uint64_t n) {
+    (void)counter;
+    (void)n;
+}
+
+uint64_t bst_stats_timer_start(void) {
+    return 0;
+}
+
+void bst_stats_record_op(BSTStatOp op, uint64_t start, unsigned depth) {
+    (void)op;
+    (void)start;
+    (void)depth;
+}
+
+void bst_stats_record_latency(BSTStatOp op, uint64_t ns) {
+    (void)op;
+    (void)ns;
+}
+
+void bst_stats_sample_period(unsigned period) {
+    (void)period;
+}
+
+void bst_stats_read(BSTStatsReport *report) {
+    if (report) {
+        memset(report, 0, sizeof(*report));
+    }
+}
+
+void bst_stats_reset(void) {
+}
+
+#endif // BST_STATS
+
+/**
+ * Format a line into a writer
+ */
+static int put_format(BSTWriter *writer, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+static int put_format(BSTWriter *writer, const char *format, ...) {
+    char line[256];
+    va_list args;
+
+    va_start(args, format);
+    int used = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (used < 0) {
+        return -1;
+    }
+    return bst_writer_put(writer, line, (size_t)used < sizeof(line) ? (size_t)used : sizeof(line) - 1);
+}
+
+/**
+ * Largest recorded latency (bucket value), or 0
+ */
+static uint64_t histogram_max(const uint64_t *histogram) {
+    for (unsigned i = BST_STATS_LATENCY_BUCKETS; i > 0; i--) {
+        if (histogram[i - 1]) {
+            return bst_stats_bucket_value(i - 1);
+        }
+    }
+    return 0;
+}
+
+/**
+ * Mean of a depth histogram
+ */
+static double depth_mean(const uint64_t *histogram) {
+    uint64_t calls = 0;
+    uint64_t sum = 0;
+
+    for (unsigned i = 0; i < BST_STATS_DEPTH_BUCKETS; i++) {
+        calls += histogram[i];
+        sum += histogram[i] * i;
+    }
+    return calls ? (double)sum / (double)calls : 0.0;
+}
+
+/**
+ * Write a report as text
+ */
+int bst_stats_write_text(const BSTStatsReport *report, BSTWriter *writer) {
+    if (!report || !writer) {
+        return -1;
+    }
+    if (!bst_stats_enabled()) {
+        return put_format(writer, "stats: not compiled in (configure with -DENABLE_STATS=ON)\n");
+    }
+
+    int status = put_format(writer, "%-8s %12s %10s %10s %10s %10s %10s\n", "op", "calls", "p50 ns", "p99 ns", "p99.9 ns",
+               "max ns", "avg depth");
+    for (int op = 0; op < BST_STAT_OP_COUNT; op++) {
+        const uint64_t *latency = report->latency[op];
+        status |= put_format(writer, "%-8s %12llu %10llu %10llu %10llu %10llu %10.2f\n", op_names[op],
+                   (unsigned long long)report->ops[op], (unsigned long long)bst_stats_percentile(latency, 50),
+                   (unsigned long long)bst_stats_percentile(latency, 99),
+                   (unsigned long long)bst_stats_percentile(latency, 99.9),
+                   (unsigned long long)histogram_max(latency), depth_mean(report->depth[op]));
+    }
+    for (int c = 0; c < BST_STAT_COUNTER_COUNT; c++) {
+        status |= put_format(writer, "%-14s %12llu\n", counter_names[c], (unsigned long long)report->counters[c]);
+    }
+    return status ? -1 : 0;
+}
+
+/**
+ * Write the non-empty buckets of a histogram as [[value, count], ...]
+ */
+static void write_buckets(BSTWriter *writer, const uint64_t *histogram, unsigned count, int latency) {
+    int first = 1;
+
+    bst_writer_put(writer, "[", 1);
+    for (unsigned i = 0; i < count; i++) {
+        if (histogram[i] == 0) {
+            continue;
+        }
+        put_format(writer, "%s[%llu,%llu]", first ? "" : ",",
+                   (unsigned long long)(latency ? bst_stats_bucket_value(i) : i), (unsigned long long)histogram[i]);
+        first = 0;
+    }
+    bst_writer_put(writer, "]", 1);
+}
+
+/**
+ * Write a report as one JSON object
+ */
+int bst_stats_write_json(const BSTStatsReport *report, BSTWriter *writer) {
+    if (!report || !writer) {
+        return -1;
+    }
+
+    int status = put_format(writer, "{\"enabled\":%s,\"ops\":{", bst_stats_enabled() ? "true" : "false");
+    for (int op = 0; op < BST_STAT_OP_COUNT; op++) {
+        const uint64_t *latency = report->latency[op];
+        status |= put_format(writer,
+                   "%s\"%s\":{\"calls\":%llu,\"p50_ns\":%llu,\"p90_ns\":%llu,\"p99_ns\":%llu,\"p999_ns\":%llu,"
+                   "\"max_ns\":%llu,\"latency_ns\":",
+                   op ? "," : "", op_names[op], (unsigned long long)report->ops[op],
+                   (unsigned long long)bst_stats_percentile(latency, 50),
+                   (unsigned long long)bst_stats_percentile(latency, 90),
+                   (unsigned long long)bst_stats_percentile(latency, 99),
+                   (unsigned long long)bst_stats_percentile(latency, 99.9),
+                   (unsigned long long)histogram_max(latency));
+        write_buckets(writer, latency, BST_STATS_LATENCY_BUCKETS, 1);
+        bst_writer_put(writer, ",\"depth\":", 9);
+        write_buckets(writer, report->depth[op], BST_STATS_DEPTH_BUCKETS, 0);
+        bst_writer_put(writer, "}", 1);
+    }
+    bst_writer_put(writer, "},\"counters\":{", 14);
+    for (int c = 0; c < BST_STAT_COUNTER_COUNT; c++) {
+        put_format(writer, "%s\"%s\":%llu", c ? "," : "", counter_names[c], (unsigned long long)report->counters[c]);
+    }
+    status |= bst_writer_put(writer, "}}\n", 3);
+    return status ? -1 : 0;
+}
@@ -0,0 +1,572 @@
+#include "bst_tree.h"
+#include "bst_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct BSTree {
+    BSTNode *root;           // Root of the AVL tree (NULL when empty)
+    BSTArena *arena;         // Node allocator, or NULL for malloc-backed nodes
+    BSTCollateFn collate;    // Sort-key function, or NULL for byte order
+    void *collate_ctx;
+    int hashed;              // Keep index in sync with the tree
+    int interned;            // Arena shares long names through bst_intern.h
+    BSTHashIndex index;      // Exact-match index over the node names
+};
+
+// Sort keys up to this size (terminator included) are built on the stack
+#define SORT_KEY_INLINE_CAPACITY 128
+
+/**
+ * Name a city argument is stored under: the city itself, or its sort key
+ * in a collated tree
+ */
+typedef struct TreeKey {
+    const char *str;
+    size_t len;
+    char *heap_key;          // Storage for sort keys too long for inline_key
+    char inline_key[SORT_KEY_INLINE_CAPACITY];
+} TreeKey;
+
+/**
+ * Compute the name city is stored under, returning -1 if a long sort key
+ * cannot be allocated
+ */
+static int tree_key_make(const BSTree *tree, const char *city, TreeKey *key) {
+    key->heap_key = NULL;
+    if (!tree->collate) {
+        key->str = city;
+        key->len = strlen(city);
+        return 0;
+    }
+
+    key->str = key->inline_key;
+    key->len = tree->collate(city, key->inline_key, sizeof(key->inline_key), tree->collate_ctx);
+    if (key->len < sizeof(key->inline_key)) {
+        return 0;
+    }
+
+    key->heap_key = (char *)malloc(key->len + 1);
+    if (!key->heap_key) {
+        return -1;
+    }
+    tree->collate(city, key->heap_key, key->len + 1, tree->collate_ctx);
+    key->str = key->heap_key;
+    return 0;
+}
+
+/**
+ * Free a long sort key
+ */
+static void tree_key_release(TreeKey *key) {
+    free(key->heap_key);
+}
+
+/**
+ * Find the node stored under key
+ */
+static BSTNode *tree_key_search(const BSTree *tree, const TreeKey *key) {
+    if (tree->hashed) {
+        return bst_hash_index_find(&tree->index, bst_hash_bytes(key->str, key->len), key->str, key->len);
+    }
+    return bst_search(tree->root, key->str);
+}
+
+/**
+ * Collated search keys for a batch, with their sort keys packed into one buffer
+ * NULL entries are skipped. Returns NULL (with *count 0) if n is 0 or an
+ * allocation fails; *failed tells the two apart.
+ */
+static BSTKey *collate_batch(const BSTree *tree, const char **cities, size_t n, size_t *count,
+                             char **storage_out, int *failed) {
+    *count = 0;
+    *storage_out = NULL;
+    *failed = 0;
+    if (n == 0) {
+        return NULL;
+    }
+
+    size_t capacity = n * 32;
+    BSTKey *keys = (BSTKey *)malloc(n * sizeof(*keys));
+    char *storage = (char *)malloc(capacity);
+    if (!keys || !storage) {
+        goto fail;
+    }
+
+    // Keys are appended back to back; pointers are fixed up once the buffer stops moving
+    size_t used = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (!cities[i]) {
+            continue;
+        }
+
+        size_t len = tree->collate(cities[i], storage + used, capacity - used, tree->collate_ctx);
+        if (len >= capacity - used) {
+            size_t grown = capacity * 2 > used + len + 1 ? capacity * 2 : used + len + 1;
+            char *resized = (char *)realloc(storage, grown);
+            if (!resized) {
+                goto fail;
+            }
+            storage = resized;
+            capacity = grown;
+            tree->collate(cities[i], storage + used, capacity - used, tree->collate_ctx);
+        }
+
+        keys[*count].len = len;
+        keys[*count].display = cities[i];
+        (*count)++;
+        used += len + 1;
+    }
+
+    size_t offset = 0;
+    for (size_t i = 0; i < *count; i++) {
+        keys[i] = bst_key_make_collated(storage + offset, keys[i].len, keys[i].display);
+        offset += keys[i].len + 1;
+    }
+
+    *storage_out = storage;
+    return keys;
+
+fail:
+    free(keys);
+    free(storage);
+    *count = 0;
+    *failed = 1;
+    return NULL;
+}
+
+/**
+ * In-order visitor that adds each node to an index
+ */
+static void index_node(BSTNode *node, void *ctx) {
+    BSTHashIndex *index = (BSTHashIndex *)ctx;
+    bst_hash_index_add(index, bst_hash_bytes(bst_node_name(node), node->len), node);
+}
+
+/**
+ * Fill an empty index with every node of a tree, returning -1 on allocation failure
+ */
+static int index_tree(BSTHashIndex *index, BSTNode *root) {
+    if (bst_hash_index_reserve(index, bst_count_nodes(root)) != 0) {
+        return -1;
+    }
+
+    bst_walk_inorder(root, index_node, index);
+    return 0;
+}
+
+/**
+ * Create an empty tree
+ */
+BSTree *bst_tree_create(unsigned flags) {
+    BSTree *tree = (BSTree *)calloc(1, sizeof(BSTree));
+    if (!tree) {
+        return NULL;
+    }
+
+    if (flags & (BST_TREE_ARENA | BST_TREE_INTERN)) {
+        tree->arena = bst_arena_create();
+        if (!tree->arena) {
+            free(tree);
+            return NULL;
+        }
+    }
+    if (flags & BST_TREE_INTERN) {
+        tree->interned = 1;
+        bst_arena_intern_names(tree->arena);
+    }
+    if (flags & BST_TREE_FOLD) {
+        tree->collate = bst_collate_fold;
+    }
+    tree->hashed = (flags & BST_TREE_HASH) != 0;
+    bst_hash_index_init(&tree->index);
+
+    return tree;
+}
+
+/**
+ * Free the nodes under root along with the arena (if any) they came from
+ * Interned names are referenced per node, so an interning arena's nodes are
+ * walked to release them; otherwise the arena goes away in one step.
+ */
+static void release_nodes(BSTArena *arena, int interned, BSTNode *root) {
+    if (!arena) {
+        bst_delete_tree(root);
+        return;
+    }
+
+    if (interned) {
+        bst_delete_tree_with(arena, root);
+    }
+    bst_arena_destroy(arena);
+}
+
+/**
+ * Destroy a tree and every city in it
+ */
+void bst_tree_destroy(BSTree *tree) {
+    if (!tree) {
+        return;
+    }
+
+    release_nodes(tree->arena, tree->interned, tree->root);
+
+    bst_hash_index_release(&tree->index);
+    free(tree);
+}
+
+/**
+ * Set the collation that orders the tree's cities
+ */
+int bst_tree_set_collation(BSTree *tree, BSTCollateFn collate, void *ctx) {
+    if (!tree || tree->root) {
+        return -1;
+    }
+
+    tree->collate = collate;
+    tree->collate_ctx = ctx;
+    return 0;
+}
+
+/**
+ * Insert a city into the tree
+ */
+int bst_tree_insert(BSTree *tree, const char *city) {
+    if (!tree || !city) {
+        return -1;
+    }
+
+    TreeKey key;
+    if (tree_key_make(tree, city, &key) != 0) {
+        return -1;
+    }
+
+    // With an index, duplicates are answered without walking the tree, and
+    // room for the new entry is made before the tree changes
+    uint64_t hash = 0;
+    if (tree->hashed) {
+        hash = bst_hash_bytes(key.str, key.len);
+        if (bst_hash_index_find(&tree->index, hash, key.str, key.len)) {
+            tree_key_release(&key);
+            return 0;
+        }
+        if (bst_hash_index_reserve(&tree->index, tree->index.count + 1) != 0) {
+            tree_key_release(&key);
+            return -1;
+        }
+    }
+
+    BSTKey search = tree->collate ? bst_key_make_collated(key.str, key.len, city) : bst_key_make(city);
+    BSTNode *node;
+    tree->root = bst_insert_key_with(tree->arena, tree->root, &search, &node);
+
+    int result = 1;
+    if (node && tree->hashed) {
+        bst_hash_index_add(&tree->index, hash, node);
+    } else if (!node) {
+        // Nothing was added: either a duplicate or an allocation failure
+        result = !tree->hashed && bst_search(tree->root, key.str) ? 0 : -1;
+    }
+
+    tree_key_release(&key);
+    return result;
+}
+
+/**
+ * Remove a city from the tree
+ */
+int bst_tree_remove(BSTree *tree, const char *city) {
+    if (!tree || !city) {
+        return 0;
+    }
+
+    TreeKey key;
+    if (tree_key_make(tree, city, &key) != 0) {
+        return 0;
+    }
+
+    // With an index, absent cities are answered without walking the tree
+    uint64_t hash = 0;
+    BSTNode *node = NULL;
+    if (tree->hashed) {
+        hash = bst_hash_bytes(key.str, key.len);
+        node = bst_hash_index_find(&tree->index, hash, key.str, key.len);
+        if (!node) {
+            tree_key_release(&key);
+            return 0;
+        }
+    }
+
+    size_t before = bst_count_nodes(tree->root);
+    tree->root = bst_remove_with(tree->arena, tree->root, key.str);
+    int removed = bst_count_nodes(tree->root) != before;
+
+    if (removed && tree->hashed) {
+        bst_hash_index_remove(&tree->index, hash, node);
+    }
+
+    tree_key_release(&key);
+    return removed;
+}
+
+/**
+ * Insert a batch of cities in one merge pass
+ * The merge reports the nodes it created, which are indexed directly.
+ */
+int bst_tree_insert_batch(BSTree *tree, const char **cities, size_t n, size_t *inserted) {
+    if (inserted) {
+        *inserted = 0;
+    }
+    if (!tree || (n > 0 && !cities)) {
+        return -1;
+    }
+    if (n == 0) {
+        return 0;
+    }
+    if (tree->hashed && bst_hash_index_reserve(&tree->index, tree->index.count + n) != 0) {
+        return -1;
+    }
+
+    BSTNode **created = (BSTNode **)malloc(n * sizeof(BSTNode *));
+    if (!created) {
+        return -1;
+    }
+
+    size_t added = 0;
+    int failed;
+
+    if (tree->collate) {
+        size_t count;
+        char *storage;
+        BSTKey *keys = collate_batch(tree, cities, n, &count, &storage, &failed);
+        if (!failed) {
+            tree->root = bst_insert_batch_keys_with(tree->arena, tree->root, keys, count,
+                                                    created, &added, &failed);
+        }
+        free(keys);
+        free(storage);
+    } else {
+        tree->root = bst_insert_batch_with(tree->arena, tree->root, cities, n, created, &added, &failed);
+    }
+
+    if (tree->hashed) {
+        for (size_t i = 0; i < added; i++) {
+            index_node(created[i], &tree->index);
+        }
+    }
+    free(created);
+
+    if (inserted) {
+        *inserted = added;
+    }
+    return failed ? -1 : 0;
+}
+
+/**
+ * Index entries of the cities in a batch, so they can be dropped once
+ * the nodes are gone; returns NULL with *count 0 if none are present
+ */
+static BSTHashEntry *collect_entries(const BSTree *tree, const char **cities, size_t n, size_t *count,
+                                     int *failed) {
+    *count = 0;
+    *failed = 0;
+
+    BSTHashEntry *entries = n > 0 ? (BSTHashEntry *)malloc(n * sizeof(*entries)) : NULL;
+    if (n > 0 && !entries) {
+        *failed = 1;
+        return NULL;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        TreeKey key;
+        if (!cities[i]) {
+            continue;
+        }
+        if (tree_key_make(tree, cities[i], &key) != 0) {
+            free(entries);
+            *count = 0;
+            *failed = 1;
+            return NULL;
+        }
+
+        uint64_t hash = bst_hash_bytes(key.str, key.len);
+        BSTNode *node = bst_hash_index_find(&tree->index, hash, key.str, key.len);
+        if (node) {
+            entries[*count].hash = hash;
+            entries[*count].node = node;
+            (*count)++;
+        }
+        tree_key_release(&key);
+    }
+
+    return entries;
+}
+
+/**
+ * Remove a batch of cities in one merge pass
+ */
+int bst_tree_remove_batch(BSTree *tree, const char **cities, size_t n, size_t *removed) {
+    if (removed) {
+        *removed = 0;
+    }
+    if (!tree || (n > 0 && !cities)) {
+        return -1;
+    }
+
+    size_t entry_count = 0;
+    BSTHashEntry *entries = NULL;
+    int failed = 0;
+    if (tree->hashed) {
+        entries = collect_entries(tree, cities, n, &entry_count, &failed);
+        if (failed) {
+            return -1;
+        }
+    }
+
+    size_t before = bst_count_nodes(tree->root);
+
+    if (tree->collate) {
+        size_t count;
+        char *storage;
+        BSTKey *keys = collate_batch(tree, cities, n, &count, &storage, &failed);
+        if (!failed) {
+            tree->root = bst_remove_batch_keys_with(tree->arena, tree->root, keys, count);
+        }
+        free(keys);
+        free(storage);
+    } else {
+        tree->root = bst_remove_batch_with(tree->arena, tree->root, cities, n, &failed);
+    }
+
+    // A failed batch leaves the tree (and so the index) unchanged
+    if (!failed) {
+        for (size_t i = 0; i < entry_count; i++) {
+            bst_hash_index_remove(&tree->index, entries[i].hash, entries[i].node);
+        }
+    }
+    free(entries);
+
+    if (removed) {
+        *removed = before - bst_count_nodes(tree->root);
+    }
+    return failed ? -1 : 0;
+}
+
+/**
+ * Replace the tree's contents with a balanced tree built from cities
+ */
+int bst_tree_load(BSTree *tree, const char **cities, size_t n) {
+    if (!tree || (n > 0 && !cities)) {
+        return -1;
+    }
+
+    // Build beside the current contents so a failure leaves them intact
+    BSTArena *arena = NULL;
+    if (tree->arena) {
+        arena = bst_arena_create();
+        if (!arena) {
+            return -1;
+        }
+        if (tree->interned) {
+            bst_arena_intern_names(arena);
+        }
+    }
+
+    BSTNode *root;
+    int failed = 0;
+    if (tree->collate) {
+        size_t count;
+        char *storage;
+        BSTKey *keys = collate_batch(tree, cities, n, &count, &storage, &failed);
+        root = failed ? NULL : bst_build_keys_with(arena, keys, count);
+        failed = failed || (count > 0 && !root);
+        free(keys);
+        free(storage);
+    } else {
+        root = bst_build_with(arena, cities, n);
+        failed = n > 0 && !root;
+    }
+
+    BSTHashIndex index;
+    bst_hash_index_init(&index);
+    if (!failed && tree->hashed && index_tree(&index, root) != 0) {
+        failed = 1;
+    }
+
+    if (failed) {
+        release_nodes(arena, tree->interned, root);
+        return -1;
+    }
+
+    release_nodes(tree->arena, tree->interned, tree->root);
+    tree->arena = arena;
+    tree->root = root;
+    bst_hash_index_release(&tree->index);
+    tree->index = index;
+
+    return 0;
+}
+
+/**
+ * Search for a city in the tree
+ */
+BSTNode *bst_tree_search(const BSTree *tree, const char *city) {
+    if (!tree || !city) {
+        return NULL;
+    }
+    if (!tree->collate && !tree->hashed) {
+        return bst_search(tree->root, city);
+    }
+
+    TreeKey key;
+    if (tree_key_make(tree, city, &key) != 0) {
+        return NULL;
+    }
+    BSTNode *node = tree_key_search(tree, &key);
+    tree_key_release(&key);
+    return node;
+}
+
+/**
+ * Get the root node
+ */
+BSTNode *bst_tree_root(const BSTree *tree) {
+    return tree ? tree->root : NULL;
+}
+
+/**
+ * Get the number of cities in the tree
+ */
+size_t bst_tree_count(const BSTree *tree) {
+    return tree ? bst_count_nodes(tree->root) : 0;
+}
+
+/**
+ * Get the height of the tree
+ */
+int bst_tree_height(const BSTree *tree) {
+    return tree ? bst_height(tree->root) : -1;
+}
+
+/**
+ * Get the number of cities that sort before a city
+ */
+size_t bst_tree_rank(const BSTree *tree, const char *city) {
+    if (!tree || !city) {
+        return 0;
+    }
+
+    TreeKey key;
+    if (tree_key_make(tree, city, &key) != 0) {
+        return 0;
+    }
+    size_t rank = bst_rank(tree->root, key.str);
+    tree_key_release(&key);
+    return rank;
+}
+
+/**
+ * Find the k-th smallest city (0-based)
+ */
+BSTNode *bst_tree_select(const BSTree *tree, size_t k) {
+    return tree ? bst_select(tree->root, k) : NULL;
+}
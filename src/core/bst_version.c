@@ -0,0 +1,293 @@
+#include "bst_version.h"
+#include "bst_internal.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// AVL height stays below 1.45 * log2(n + 2), so this covers any addressable tree
+#define WALK_STACK_DEPTH 128
+
+/**
+ * Node shared between versions
+ * refs counts the parents and versions pointing at the node. A long name is
+ * stored right after the struct, so every node owns its own name bytes.
+ */
+typedef struct VersionNode {
+    BSTNode node;
+    atomic_size_t refs;
+} VersionNode;
+
+struct BSTVersion {
+    atomic_size_t refs;
+    BSTNode *root;
+};
+
+/**
+ * Shared header of a node
+ */
+static VersionNode *version_node(BSTNode *node) {
+    return (VersionNode *)node;
+}
+
+/**
+ * Allocate a node with room for its name, reference count 1
+ */
+static BSTNode *alloc_version_node(const BSTNode *source, const BSTKey *key) {
+    size_t len = source ? source->len : key->len;
+    size_t heap_len = len >= BST_INLINE_CAPACITY ? len + 1 : 0;
+    VersionNode *node = (VersionNode *)malloc(sizeof(VersionNode) + heap_len);
+    if (!node) {
+        return NULL;
+    }
+
+    char *heap_city = (char *)(node + 1);
+    if (source) {
+        memcpy(&node->node, source, sizeof(BSTNode));
+        if (heap_len) {
+            memcpy(heap_city, source->name.heap_city, heap_len);
+            node->node.name.heap_city = heap_city;
+        }
+    } else {
+        bst_node_set_name(&node->node, key, heap_city);
+        node->node.left = NULL;
+        node->node.right = NULL;
+        node->node.height = 0;
+        node->node.size = 1;
+    }
+    atomic_init(&node->refs, 1);
+
+    return &node->node;
+}
+
+/**
+ * Copy a node, name included; the copy shares the original's children
+ */
+static BSTNode *copy_node(const BSTNode *node) {
+    return alloc_version_node(node, NULL);
+}
+
+/**
+ * Allocate a leaf holding key
+ */
+static BSTNode *create_node(const BSTKey *key) {
+    return alloc_version_node(NULL, key);
+}
+
+/**
+ * Free an unpublished node (its name lives in the same block)
+ */
+static void discard_node(BSTNode *node, int is_leaf) {
+    (void)is_leaf;
+    free(version_node(node));
+}
+
+static const BSTCowAlloc cow_alloc = {copy_node, create_node, discard_node};
+
+/**
+ * Add a reference to a node
+ */
+static void retain_node(BSTNode *node) {
+    atomic_fetch_add_explicit(&version_node(node)->refs, 1, memory_order_relaxed);
+}
+
+/**
+ * Drop a reference to a subtree, freeing nodes no one else shares
+ * Recursion follows one branch and loops on the other, so depth is bounded
+ * by the tree height.
+ */
+static void release_node(BSTNode *node) {
+    while (node) {
+        if (atomic_fetch_sub_explicit(&version_node(node)->refs, 1, memory_order_acq_rel) != 1) {
+            return;
+        }
+
+        BSTNode *right = node->right;
+        release_node(node->left);
+        free(version_node(node));
+        node = right;
+    }
+}
+
+/**
+ * Wrap a root in a new version handle (taking over one reference to it)
+ */
+static BSTVersion *make_version(BSTNode *root) {
+    BSTVersion *version = (BSTVersion *)malloc(sizeof(BSTVersion));
+    if (!version) {
+        return NULL;
+    }
+
+    atomic_init(&version->refs, 1);
+    version->root = root;
+    return version;
+}
+
+/**
+ * Turn a finished update into a version
+ * Fresh nodes start with one reference (their parent); the shared nodes
+ * they now point at gain one each.
+ */
+static BSTVersion *commit(BSTCow *cow, BSTNode *root) {
+    BSTVersion *version = make_version(root);
+    if (!version) {
+        bst_cow_abandon(cow);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < cow->fresh_count; i++) {
+        BSTNode *node = cow->fresh[i];
+        if (node->left && !bst_cow_is_fresh(cow, node->left)) {
+            retain_node(node->left);
+        }
+        if (node->right && !bst_cow_is_fresh(cow, node->right)) {
+            retain_node(node->right);
+        }
+    }
+
+    // A remove can leave an old subtree as the new root
+    if (root && !bst_cow_is_fresh(cow, root)) {
+        retain_node(root);
+    }
+
+    return version;
+}
+
+/**
+ * Create an empty version
+ */
+BSTVersion *bst_version_create(void) {
+    return make_version(NULL);
+}
+
+/**
+ * Take another reference to a version
+ */
+BSTVersion *bst_version_retain(BSTVersion *version) {
+    if (version) {
+        atomic_fetch_add_explicit(&version->refs, 1, memory_order_relaxed);
+    }
+    return version;
+}
+
+/**
+ * Drop a reference to a version
+ */
+void bst_version_release(BSTVersion *version) {
+    if (!version) {
+        return;
+    }
+
+    if (atomic_fetch_sub_explicit(&version->refs, 1, memory_order_acq_rel) == 1) {
+        release_node(version->root);
+        free(version);
+    }
+}
+
+/**
+ * Create the version that also contains city
+ */
+BSTVersion *bst_version_insert(BSTVersion *version, const char *city) {
+    if (!version || !city) {
+        return NULL;
+    }
+    if (bst_search(version->root, city)) {
+        return bst_version_retain(version);
+    }
+
+    BSTKey key = bst_key_make(city);
+    BSTCow cow;
+    BSTVersion *result = NULL;
+
+    bst_cow_init(&cow, &cow_alloc);
+    BSTNode *root = bst_cow_insert(&cow, version->root, &key);
+    if (cow.failed) {
+        bst_cow_abandon(&cow);
+    } else {
+        result = commit(&cow, root);
+    }
+    bst_cow_release(&cow);
+
+    return result;
+}
+
+/**
+ * Create the version without city
+ */
+BSTVersion *bst_version_remove(BSTVersion *version, const char *city) {
+    if (!version || !city) {
+        return NULL;
+    }
+    if (!bst_search(version->root, city)) {
+        return bst_version_retain(version);
+    }
+
+    BSTKey key = bst_key_make(city);
+    BSTCow cow;
+    BSTVersion *result = NULL;
+
+    bst_cow_init(&cow, &cow_alloc);
+    BSTNode *root = bst_cow_remove(&cow, version->root, &key);
+    if (cow.failed) {
+        bst_cow_abandon(&cow);
+    } else {
+        result = commit(&cow, root);
+    }
+    bst_cow_release(&cow);
+
+    return result;
+}
+
+/**
+ * Get the root of a version
+ */
+BSTNode *bst_version_root(const BSTVersion *version) {
+    return version ? version->root : NULL;
+}
+
+/**
+ * Get the number of cities in a version
+ */
+size_t bst_version_count(const BSTVersion *version) {
+    return version ? bst_subtree_size(version->root) : 0;
+}
+
+/**
+ * Visit every city in order with an explicit stack (the version is shared,
+ * so it cannot be threaded like bst_walk_inorder does)
+ */
+void bst_version_walk(const BSTVersion *version, void (*visit)(const char *city, void *ctx), void *ctx) {
+    if (!version || !visit) {
+        return;
+    }
+
+    const BSTNode *stack[WALK_STACK_DEPTH];
+    size_t depth = 0;
+    const BSTNode *current = version->root;
+
+    while (current || depth > 0) {
+        while (current) {
+            stack[depth++] = current;
+            current = current->left;
+        }
+
+        current = stack[--depth];
+        visit(bst_node_name(current), ctx);
+        current = current->right;
+    }
+}
+
+/**
+ * Visitor that prints one city per line
+ */
+static void print_city(const char *city, void *ctx) {
+    (void)ctx;
+    printf("%s\n", city);
+}
+
+/**
+ * Print a version in alphabetical order
+ */
+void bst_version_print_inorder(const BSTVersion *version) {
+    bst_version_walk(version, print_city, NULL);
+}
@@ -0,0 +1,164 @@
+#include "bst_writer.h"
+#include <errno.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+/**
+ * Write every byte of up to two blocks to a descriptor
+ * Retries on EINTR and after partial writes (pipes and sockets).
+ */
+static int write_fd_all(int fd, const char *first, size_t first_len, const char *second, size_t second_len) {
+    struct iovec iov[2];
+    int count = 0;
+
+    if (first_len > 0) {
+        iov[count].iov_base = (void *)first;
+        iov[count].iov_len = first_len;
+        count++;
+    }
+    if (second_len > 0) {
+        iov[count].iov_base = (void *)second;
+        iov[count].iov_len = second_len;
+        count++;
+    }
+
+    struct iovec *pending = iov;
+    while (count > 0) {
+        ssize_t written = writev(fd, pending, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+
+        // Drop fully written blocks and advance into a partially written one
+        size_t remaining = (size_t)written;
+        while (count > 0 && remaining >= pending->iov_len) {
+            remaining -= pending->iov_len;
+            pending++;
+            count--;
+        }
+        if (count > 0) {
+            pending->iov_base = (char *)pending->iov_base + remaining;
+            pending->iov_len -= remaining;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Hand the buffered bytes plus an optional extra block to the sink
+ */
+static int sink(BSTWriter *writer, const char *extra, size_t extra_len) {
+    int result;
+
+    if (writer->fd >= 0) {
+        result = write_fd_all(writer->fd, writer->buffer, writer->len, extra, extra_len);
+    } else {
+        result = 0;
+        if (writer->len > 0) {
+            result = writer->write(writer->buffer, writer->len, writer->ctx);
+        }
+        if (result == 0 && extra_len > 0) {
+            result = writer->write(extra, extra_len, writer->ctx);
+        }
+    }
+
+    writer->len = 0;
+    if (result != 0) {
+        writer->failed = 1;
+    }
+    return result;
+}
+
+/**
+ * Set up a writer that flushes to a file descriptor
+ */
+void bst_writer_init_fd(BSTWriter *writer, int fd, char *buffer, size_t capacity) {
+    writer->buffer = buffer;
+    writer->capacity = capacity;
+    writer->len = 0;
+    writer->fd = fd;
+    writer->write = NULL;
+    writer->ctx = NULL;
+    writer->failed = fd < 0 || !buffer || capacity == 0;
+}
+
+/**
+ * Set up a writer that flushes through a callback
+ */
+void bst_writer_init(BSTWriter *writer, BSTWriteFn write, void *ctx, char *buffer, size_t capacity) {
+    writer->buffer = buffer;
+    writer->capacity = capacity;
+    writer->len = 0;
+    writer->fd = -1;
+    writer->write = write;
+    writer->ctx = ctx;
+    writer->failed = !write || !buffer || capacity == 0;
+}
+
+/**
+ * Append bytes
+ */
+int bst_writer_put(BSTWriter *writer, const char *data, size_t len) {
+    if (writer->failed) {
+        return -1;
+    }
+
+    if (len <= writer->capacity - writer->len) {
+        memcpy(writer->buffer + writer->len, data, len);
+        writer->len += len;
+        return 0;
+    }
+
+    // Too big to ever fit: send it along with the buffered bytes in one go
+    if (len >= writer->capacity) {
+        return sink(writer, data, len);
+    }
+
+    if (sink(writer, NULL, 0) != 0) {
+        return -1;
+    }
+    memcpy(writer->buffer, data, len);
+    writer->len = len;
+    return 0;
+}
+
+/**
+ * Append count copies of one byte
+ */
+int bst_writer_fill(BSTWriter *writer, char byte, size_t count) {
+    while (count > 0) {
+        if (writer->failed) {
+            return -1;
+        }
+
+        size_t room = writer->capacity - writer->len;
+        if (room == 0) {
+            if (sink(writer, NULL, 0) != 0) {
+                return -1;
+            }
+            room = writer->capacity;
+        }
+
+        size_t run = count < room ? count : room;
+        memset(writer->buffer + writer->len, byte, run);
+        writer->len += run;
+        count -= run;
+    }
+
+    return writer->failed ? -1 : 0;
+}
+
+/**
+ * Write out everything buffered
+ */
+int bst_writer_flush(BSTWriter *writer) {
+    if (writer->failed) {
+        return -1;
+    }
+    return writer->len > 0 ? sink(writer, NULL, 0) : 0;
+}
@@ -0,0 +1,126 @@
+#include "city_batch.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct CityBatch {
+    char *blob;              // Names, each NUL-terminated, back to back
+    size_t blob_len;
+    size_t blob_cap;
+    size_t *offsets;         // Start of each name in blob
+    size_t count;
+    size_t offsets_cap;
+    const char **names;      // Pointer view built by city_batch_names
+};
+
+/**
+ * Create an empty batch
+ */
+CityBatch *city_batch_create(void) {
+    return (CityBatch *)calloc(1, sizeof(CityBatch));
+}
+
+/**
+ * Destroy a batch and every name in it
+ */
+void city_batch_destroy(CityBatch *batch) {
+    if (!batch) {
+        return;
+    }
+
+    free(batch->blob);
+    free(batch->offsets);
+    free(batch->names);
+    free(batch);
+}
+
+/**
+ * Grow a buffer geometrically so that it holds at least needed elements
+ */
+static int reserve(void **buf, size_t *cap, size_t needed, size_t elem_size) {
+    if (needed <= *cap) {
+        return 0;
+    }
+
+    size_t new_cap = *cap ? *cap : 64;
+    while (new_cap < needed) {
+        new_cap *= 2;
+    }
+
+    void *grown = realloc(*buf, new_cap * elem_size);
+    if (!grown) {
+        return -1;
+    }
+
+    *buf = grown;
+    *cap = new_cap;
+    return 0;
+}
+
+/**
+ * Append a city name
+ */
+int city_batch_add(CityBatch *batch, const char *city, size_t len) {
+    if (!batch || !city) {
+        return -1;
+    }
+
+    if (reserve((void **)&batch->blob, &batch->blob_cap, batch->blob_len + len + 1, 1) != 0
+        || reserve((void **)&batch->offsets, &batch->offsets_cap, batch->count + 1,
+                   sizeof(size_t)) != 0) {
+        return -1;
+    }
+
+    memcpy(batch->blob + batch->blob_len, city, len);
+    batch->blob[batch->blob_len + len] = '\0';
+    batch->offsets[batch->count++] = batch->blob_len;
+    batch->blob_len += len + 1;
+
+    return 0;
+}
+
+/**
+ * CityStreamCallback adapter that appends each city to the batch in ctx
+ */
+int city_batch_collect(const char *city, size_t len, void *ctx) {
+    return city_batch_add((CityBatch *)ctx, city, len);
+}
+
+/**
+ * Get the number of names in the batch
+ */
+size_t city_batch_count(const CityBatch *batch) {
+    return batch ? batch->count : 0;
+}
+
+/**
+ * Get an array of pointers to the names, in insertion order
+ */
+const char **city_batch_names(CityBatch *batch) {
+    if (!batch || batch->count == 0) {
+        return NULL;
+    }
+
+    const char **names = (const char **)realloc(batch->names, batch->count * sizeof(*names));
+    if (!names) {
+        return NULL;
+    }
+    batch->names = names;
+
+    for (size_t i = 0; i < batch->count; i++) {
+        names[i] = batch->blob + batch->offsets[i];
+    }
+
+    return names;
+}
+
+/**
+ * Remove every name, keeping the allocated storage for reuse
+ */
+void city_batch_clear(CityBatch *batch) {
+    if (!batch) {
+        return;
+    }
+
+    batch->blob_len = 0;
+    batch->count = 0;
+}
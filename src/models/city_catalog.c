@@ -0,0 +1,437 @@
+#include "city_catalog.h"
+#include "bst_collate.h"
+#include "bst_iter.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Folded keys up to this size (terminator included) need no allocation
+#define KEY_INLINE_CAPACITY 64
+
+/**
+ * One country and its tree
+ */
+typedef struct CatalogEntry {
+    char *country;
+    BSTree *tree;
+} CatalogEntry;
+
+struct CityCatalog {
+    CatalogEntry *entries;   // Sorted by country name
+    size_t count;
+    size_t capacity;
+    unsigned tree_flags;
+    unsigned long generation;  // Bumped whenever iterators become invalid
+};
+
+/**
+ * Position of one country's tree in the merge
+ * key is what the trees are ordered by: the city itself, or its folded key
+ * in a BST_TREE_FOLD catalog.
+ */
+typedef struct Cursor {
+    BSTIter iter;
+    const char *city;        // Current city
+    const char *key;         // Ordering key of city
+    uint64_t prefix;         // First 8 bytes of key, big-endian, zero-padded
+    size_t country;          // Index into the catalog's entries
+    char *heap_key;          // Storage for keys too long for inline_key
+    size_t heap_capacity;
+    char inline_key[KEY_INLINE_CAPACITY];
+} Cursor;
+
+struct CityCatalogIter {
+    const CityCatalog *catalog;
+    unsigned long generation;
+    int folded;
+    Cursor *cursors;
+    size_t *heap;            // Min-heap of cursor indices, ordered by (key, country)
+    size_t heap_size;
+    size_t cursor_count;
+};
+
+/**
+ * Find a country's position, or where it would be inserted
+ * Returns 1 if found, 0 otherwise.
+ */
+static int find_entry(const CityCatalog *catalog, const char *country, size_t *index) {
+    size_t lo = 0;
+    size_t hi = catalog->count;
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int cmp = strcmp(catalog->entries[mid].country, country);
+        if (cmp == 0) {
+            *index = mid;
+            return 1;
+        }
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    *index = lo;
+    return 0;
+}
+
+/**
+ * Create an empty catalog
+ */
+CityCatalog *city_catalog_create(unsigned tree_flags) {
+    CityCatalog *catalog = (CityCatalog *)calloc(1, sizeof(CityCatalog));
+    if (!catalog) {
+        return NULL;
+    }
+
+    catalog->tree_flags = tree_flags;
+    return catalog;
+}
+
+/**
+ * Destroy a catalog and every country's tree
+ */
+void city_catalog_destroy(CityCatalog *catalog) {
+    if (!catalog) {
+        return;
+    }
+
+    for (size_t i = 0; i < catalog->count; i++) {
+        bst_tree_destroy(catalog->entries[i].tree);
+        free(catalog->entries[i].country);
+    }
+    free(catalog->entries);
+    free(catalog);
+}
+
+/**
+ * Get a country's tree, adding the country if needed
+ */
+BSTree *city_catalog_tree(CityCatalog *catalog, const char *country) {
+    if (!catalog || !country) {
+        return NULL;
+    }
+
+    size_t index;
+    if (find_entry(catalog, country, &index)) {
+        return catalog->entries[index].tree;
+    }
+
+    if (catalog->count == catalog->capacity) {
+        size_t capacity = catalog->capacity ? catalog->capacity * 2 : 16;
+        CatalogEntry *entries = (CatalogEntry *)realloc(catalog->entries, capacity * sizeof(*entries));
+        if (!entries) {
+            return NULL;
+        }
+        catalog->entries = entries;
+        catalog->capacity = capacity;
+    }
+
+    CatalogEntry entry;
+    entry.country = strdup(country);
+    entry.tree = bst_tree_create(catalog->tree_flags);
+    if (!entry.country || !entry.tree) {
+        free(entry.country);
+        bst_tree_destroy(entry.tree);
+        return NULL;
+    }
+
+    memmove(&catalog->entries[index + 1], &catalog->entries[index],
+            (catalog->count - index) * sizeof(*catalog->entries));
+    catalog->entries[index] = entry;
+    catalog->count++;
+    catalog->generation++;
+
+    return entry.tree;
+}
+
+/**
+ * Get a country's tree without adding the country
+ */
+BSTree *city_catalog_find(const CityCatalog *catalog, const char *country) {
+    size_t index;
+
+    if (!catalog || !country || !find_entry(catalog, country, &index)) {
+        return NULL;
+    }
+    return catalog->entries[index].tree;
+}
+
+/**
+ * Replace a country's cities
+ */
+int city_catalog_load(CityCatalog *catalog, const char *country, const char **cities, size_t n) {
+    BSTree *tree = city_catalog_tree(catalog, country);
+    if (!tree) {
+        return -1;
+    }
+
+    // The old nodes go away even if the load fails part way through
+    catalog->generation++;
+    return bst_tree_load(tree, cities, n);
+}
+
+/**
+ * Remove a country and its tree
+ */
+int city_catalog_remove(CityCatalog *catalog, const char *country) {
+    if (!catalog || !country) {
+        return -1;
+    }
+
+    size_t index;
+    if (!find_entry(catalog, country, &index)) {
+        return 0;
+    }
+
+    bst_tree_destroy(catalog->entries[index].tree);
+    free(catalog->entries[index].country);
+    memmove(&catalog->entries[index], &catalog->entries[index + 1],
+            (catalog->count - index - 1) * sizeof(*catalog->entries));
+    catalog->count--;
+    catalog->generation++;
+
+    return 1;
+}
+
+/**
+ * Get the number of countries
+ */
+size_t city_catalog_country_count(const CityCatalog *catalog) {
+    return catalog ? catalog->count : 0;
+}
+
+/**
+ * Get a country by its position in alphabetical order
+ */
+const char *city_catalog_country_at(const CityCatalog *catalog, size_t index) {
+    if (!catalog || index >= catalog->count) {
+        return NULL;
+    }
+    return catalog->entries[index].country;
+}
+
+/**
+ * Get the number of cities across all countries
+ */
+size_t city_catalog_city_count(const CityCatalog *catalog) {
+    size_t total = 0;
+
+    if (catalog) {
+        for (size_t i = 0; i < catalog->count; i++) {
+            total += bst_tree_count(catalog->entries[i].tree);
+        }
+    }
+    return total;
+}
+
+/**
+ * Fold city into a cursor's key storage, returning NULL on allocation failure
+ */
+static const char *fold_key(Cursor *cursor, const char *city) {
+    size_t len = bst_collate_fold(city, cursor->inline_key, sizeof(cursor->inline_key), NULL);
+    if (len < sizeof(cursor->inline_key)) {
+        return cursor->inline_key;
+    }
+
+    if (len + 1 > cursor->heap_capacity) {
+        char *grown = (char *)realloc(cursor->heap_key, len + 1);
+        if (!grown) {
+            return NULL;
+        }
+        cursor->heap_key = grown;
+        cursor->heap_capacity = len + 1;
+    }
+    bst_collate_fold(city, cursor->heap_key, cursor->heap_capacity, NULL);
+    return cursor->heap_key;
+}
+
+/**
+ * Pack the first 8 bytes of a key into an integer that orders like the key
+ */
+static uint64_t key_prefix(const char *key) {
+    uint64_t prefix = 0;
+
+    for (int i = 0; i < 8 && key[i]; i++) {
+        prefix |= (uint64_t)(unsigned char)key[i] << (56 - 8 * i);
+    }
+    return prefix;
+}
+
+/**
+ * Record the city a cursor now stands on, returning -1 on allocation failure
+ */
+static int cursor_settle(Cursor *cursor, const char *city, int folded) {
+    cursor->city = city;
+    cursor->key = city;
+    if (city && folded) {
+        cursor->key = fold_key(cursor, city);
+        if (!cursor->key) {
+            return -1;
+        }
+    }
+    if (city) {
+        cursor->prefix = key_prefix(cursor->key);
+    }
+    return 0;
+}
+
+/**
+ * Does cursor a come before cursor b in the merged order?
+ */
+static int cursor_before(const Cursor *a, const Cursor *b) {
+    // Most comparisons are decided by the prefixes, without reading the keys
+    if (a->prefix != b->prefix) {
+        return a->prefix < b->prefix;
+    }
+
+    // Interned names (BST_TREE_INTERN) that are equal share one pointer
+    if (a->key != b->key) {
+        int cmp = strcmp(a->key, b->key);
+        if (cmp != 0) {
+            return cmp < 0;
+        }
+    }
+    return a->country < b->country;
+}
+
+/**
+ * Restore the heap property below position slot
+ */
+static void sift_down(CityCatalogIter *it, size_t slot) {
+    size_t *heap = it->heap;
+    size_t moving = heap[slot];
+
+    for (;;) {
+        size_t child = 2 * slot + 1;
+        if (child >= it->heap_size) {
+            break;
+        }
+        if (child + 1 < it->heap_size && cursor_before(&it->cursors[heap[child + 1]], &it->cursors[heap[child]])) {
+            child++;
+        }
+        if (!cursor_before(&it->cursors[heap[child]], &it->cursors[moving])) {
+            break;
+        }
+        heap[slot] = heap[child];
+        slot = child;
+    }
+    heap[slot] = moving;
+}
+
+/**
+ * Start iterating over every country's cities in alphabetical order
+ */
+CityCatalogIter *city_catalog_iter_create(const CityCatalog *catalog, const char *from) {
+    if (!catalog) {
+        return NULL;
+    }
+
+    CityCatalogIter *it = (CityCatalogIter *)calloc(1, sizeof(CityCatalogIter));
+    if (!it) {
+        return NULL;
+    }
+    it->catalog = catalog;
+    it->generation = catalog->generation;
+    it->folded = (catalog->tree_flags & BST_TREE_FOLD) != 0;
+
+    size_t count = catalog->count;
+    it->cursors = (Cursor *)calloc(count ? count : 1, sizeof(*it->cursors));
+    it->heap = (size_t *)malloc((count ? count : 1) * sizeof(*it->heap));
+    if (!it->cursors || !it->heap) {
+        city_catalog_iter_destroy(it);
+        return NULL;
+    }
+
+    // Folded trees store folded keys, so the bound has to be folded too
+    Cursor bound;
+    const char *seek_key = from;
+    bound.heap_key = NULL;
+    bound.heap_capacity = 0;
+    if (from && it->folded) {
+        seek_key = fold_key(&bound, from);
+        if (!seek_key) {
+            city_catalog_iter_destroy(it);
+            return NULL;
+        }
+    }
+
+    // Position every cursor, then heapify the non-empty ones
+    int failed = 0;
+    for (size_t i = 0; i < count && !failed; i++) {
+        Cursor *cursor = &it->cursors[i];
+        bst_iter_init(&cursor->iter, bst_tree_root(catalog->entries[i].tree));
+        it->cursor_count++;
+        cursor->country = i;
+
+        const char *city = bst_iter_seek(&cursor->iter, seek_key);
+        if (cursor_settle(cursor, city, it->folded) != 0) {
+            failed = 1;
+        } else if (city) {
+            it->heap[it->heap_size++] = i;
+        }
+    }
+    free(bound.heap_key);
+    if (failed) {
+        city_catalog_iter_destroy(it);
+        return NULL;
+    }
+
+    for (size_t slot = it->heap_size / 2; slot-- > 0;) {
+        sift_down(it, slot);
+    }
+
+    return it;
+}
+
+/**
+ * Move to the next city
+ */
+int city_catalog_iter_next(CityCatalogIter *it, const char **city, const char **country) {
+    if (!it || it->generation != it->catalog->generation) {
+        return -1;
+    }
+    if (it->heap_size == 0) {
+        return 0;
+    }
+
+    // Report the smallest current city, then advance its cursor
+    Cursor *top = &it->cursors[it->heap[0]];
+    if (city) {
+        *city = top->city;
+    }
+    if (country) {
+        *country = it->catalog->entries[top->country].country;
+    }
+
+    const char *next = bst_iter_next(&top->iter);
+    if (cursor_settle(top, next, it->folded) != 0) {
+        return -1;
+    }
+    if (!next) {
+        it->heap[0] = it->heap[--it->heap_size];
+    }
+    if (it->heap_size > 0) {
+        sift_down(it, 0);
+    }
+
+    return 1;
+}
+
+/**
+ * Destroy an iterator
+ */
+void city_catalog_iter_destroy(CityCatalogIter *it) {
+    if (!it) {
+        return;
+    }
+
+    for (size_t i = 0; i < it->cursor_count; i++) {
+        bst_iter_release(&it->cursors[i].iter);
+        free(it->cursors[i].heap_key);
+    }
+    free(it->cursors);
+    free(it->heap);
+    free(it);
+}
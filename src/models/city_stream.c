@@ -0,0 +1,639 @@
+#include "city_stream.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Deepest container nesting accepted
+#define MAX_DEPTH 64
+
+// Longest string (city, key or message) accepted, in bytes
+#define MAX_STRING (64 * 1024)
+
+/**
+ * Parser states; structural states skip whitespace
+ */
+typedef enum ParseState {
+    ST_VALUE,                // Expecting a value
+    ST_VALUE_OR_END,         // After '[': expecting a value or ']'
+    ST_KEY_OR_END,           // After '{': expecting a key or '}'
+    ST_KEY,                  // After ',' in an object: expecting a key
+    ST_COLON,                // After a key: expecting ':'
+    ST_COMMA_OR_END,         // After a value: expecting ',' or the closing bracket
+    ST_STRING,               // Inside a string
+    ST_ESCAPE,               // After a backslash in a string
+    ST_UNICODE,              // Inside the four hex digits of a \u escape
+    ST_LITERAL,              // Inside true/false/null or a number
+    ST_DONE,                 // Top-level value complete
+    ST_ERROR                 // Invalid input; all further input is rejected
+} ParseState;
+
+/**
+ * Top-level members the parser cares about
+ */
+typedef enum TopKey {
+    KEY_OTHER,
+    KEY_DATA,
+    KEY_ERROR,
+    KEY_MSG
+} TopKey;
+
+struct CityStream {
+    CityStreamCallback on_city;
+    void *ctx;
+
+    ParseState state;
+    char stack[MAX_DEPTH];   // Open containers, '{' or '['
+    size_t depth;
+    int string_is_key;       // The string being parsed is an object key
+    TopKey top_key;          // Key of the current top-level member
+
+    char *buf;               // Current string or literal, NUL-terminated when complete
+    size_t len;
+    size_t cap;
+
+    uint32_t code_unit;      // \u escape being decoded
+    int hex_digits;          // Hex digits of code_unit read so far
+    uint32_t high_surrogate; // Pending high surrogate, or 0
+
+    int api_error;           // Value of "error": 1, 0 or -1 when unknown
+    char *message;           // Value of "msg", or NULL
+    int has_data;            // A top-level "data" array was opened
+    size_t city_count;
+    const char *error;       // Why parsing failed, or NULL
+};
+
+/**
+ * Create a parser
+ */
+CityStream *city_stream_create(CityStreamCallback on_city, void *ctx) {
+    CityStream *stream = (CityStream *)calloc(1, sizeof(CityStream));
+    if (!stream) {
+        return NULL;
+    }
+
+    stream->cap = 256;
+    stream->buf = (char *)malloc(stream->cap);
+    if (!stream->buf) {
+        free(stream);
+        return NULL;
+    }
+
+    stream->on_city = on_city;
+    stream->ctx = ctx;
+    stream->state = ST_VALUE;
+    stream->api_error = -1;
+
+    return stream;
+}
+
+/**
+ * Destroy a parser
+ */
+void city_stream_destroy(CityStream *stream) {
+    if (!stream) {
+        return;
+    }
+
+    free(stream->buf);
+    free(stream->message);
+    free(stream);
+}
+
+/**
+ * Move to the error state, keeping the first reason
+ */
+static int fail(CityStream *stream, const char *reason) {
+    if (stream->state != ST_ERROR) {
+        stream->state = ST_ERROR;
+        stream->error = reason;
+    }
+    return -1;
+}
+
+/**
+ * Append bytes to the current string, keeping room for the terminator
+ */
+static int buf_append(CityStream *stream, const char *data, size_t len) {
+    if (stream->len + len >= MAX_STRING) {
+        return fail(stream, "string too long");
+    }
+
+    if (stream->len + len + 1 > stream->cap) {
+        size_t cap = stream->cap;
+        while (stream->len + len + 1 > cap) {
+            cap *= 2;
+        }
+        char *buf = (char *)realloc(stream->buf, cap);
+        if (!buf) {
+            return fail(stream, "out of memory");
+        }
+        stream->buf = buf;
+        stream->cap = cap;
+    }
+
+    memcpy(stream->buf + stream->len, data, len);
+    stream->len += len;
+    return 0;
+}
+
+/**
+ * Append a Unicode code point as UTF-8
+ */
+static int append_code_point(CityStream *stream, uint32_t cp) {
+    char utf8[4];
+    size_t len;
+
+    if (cp == 0) {
+        return fail(stream, "NUL character in string");
+    }
+
+    if (cp < 0x80) {
+        utf8[0] = (char)cp;
+        len = 1;
+    } else if (cp < 0x800) {
+        utf8[0] = (char)(0xC0 | (cp >> 6));
+        utf8[1] = (char)(0x80 | (cp & 0x3F));
+        len = 2;
+    } else if (cp < 0x10000) {
+        utf8[0] = (char)(0xE0 | (cp >> 12));
+        utf8[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        utf8[2] = (char)(0x80 | (cp & 0x3F));
+        len = 3;
+    } else {
+        utf8[0] = (char)(0xF0 | (cp >> 18));
+        utf8[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+        utf8[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        utf8[3] = (char)(0x80 | (cp & 0x3F));
+        len = 4;
+    }
+
+    return buf_append(stream, utf8, len);
+}
+
+/**
+ * Handle a decoded \u code unit, pairing surrogates
+ */
+static int handle_code_unit(CityStream *stream, uint32_t unit) {
+    if (stream->high_surrogate) {
+        if (unit < 0xDC00 || unit > 0xDFFF) {
+            return fail(stream, "unpaired surrogate");
+        }
+        uint32_t cp = 0x10000 + ((stream->high_surrogate - 0xD800) << 10) + (unit - 0xDC00);
+        stream->high_surrogate = 0;
+        return append_code_point(stream, cp);
+    }
+
+    if (unit >= 0xD800 && unit <= 0xDBFF) {
+        stream->high_surrogate = unit;
+        return 0;
+    }
+    if (unit >= 0xDC00 && unit <= 0xDFFF) {
+        return fail(stream, "unpaired surrogate");
+    }
+
+    return append_code_point(stream, unit);
+}
+
+/**
+ * Is the literal a valid JSON number?
+ */
+static int is_json_number(const char *s) {
+    if (*s == '-') {
+        s++;
+    }
+
+    if (*s == '0') {
+        s++;
+    } else if (*s >= '1' && *s <= '9') {
+        while (*s >= '0' && *s <= '9') {
+            s++;
+        }
+    } else {
+        return 0;
+    }
+
+    if (*s == '.') {
+        s++;
+        if (!(*s >= '0' && *s <= '9')) {
+            return 0;
+        }
+        while (*s >= '0' && *s <= '9') {
+            s++;
+        }
+    }
+
+    if (*s == 'e' || *s == 'E') {
+        s++;
+        if (*s == '+' || *s == '-') {
+            s++;
+        }
+        if (!(*s >= '0' && *s <= '9')) {
+            return 0;
+        }
+        while (*s >= '0' && *s <= '9') {
+            s++;
+        }
+    }
+
+    return *s == '\0';
+}
+
+/**
+ * A value has ended: decide what may follow it
+ */
+static void value_done(CityStream *stream) {
+    stream->state = stream->depth == 0 ? ST_DONE : ST_COMMA_OR_END;
+}
+
+/**
+ * Is the parser directly inside the top-level object?
+ */
+static int in_top_object(const CityStream *stream) {
+    return stream->depth == 1 && stream->stack[0] == '{';
+}
+
+/**
+ * Is the parser directly inside the top-level "data" array?
+ */
+static int in_data_array(const CityStream *stream) {
+    return stream->depth == 2 && stream->stack[0] == '{' && stream->stack[1] == '['
+           && stream->top_key == KEY_DATA;
+}
+
+/**
+ * A string has ended: dispatch it as a key, a city or a message
+ */
+static int string_done(CityStream *stream) {
+    stream->buf[stream->len] = '\0';
+
+    if (stream->high_surrogate) {
+        return fail(stream, "unpaired surrogate");
+    }
+
+    if (stream->string_is_key) {
+        if (in_top_object(stream)) {
+            if (strcmp(stream->buf, "data") == 0) {
+                stream->top_key = KEY_DATA;
+            } else if (strcmp(stream->buf, "error") == 0) {
+                stream->top_key = KEY_ERROR;
+            } else if (strcmp(stream->buf, "msg") == 0) {
+                stream->top_key = KEY_MSG;
+            } else {
+                stream->top_key = KEY_OTHER;
+            }
+        }
+        stream->state = ST_COLON;
+        return 0;
+    }
+
+    if (in_data_array(stream)) {
+        stream->city_count++;
+        if (stream->on_city && stream->on_city(stream->buf, stream->len, stream->ctx) != 0) {
+            return fail(stream, "aborted by callback");
+        }
+    } else if (in_top_object(stream) && stream->top_key == KEY_MSG) {
+        free(stream->message);
+        stream->message = (char *)malloc(stream->len + 1);
+        if (!stream->message) {
+            return fail(stream, "out of memory");
+        }
+        memcpy(stream->message, stream->buf, stream->len + 1);
+    }
+
+    value_done(stream);
+    return 0;
+}
+
+/**
+ * A literal has ended: validate it and pick up the "error" flag
+ */
+static int literal_done(CityStream *stream) {
+    stream->buf[stream->len] = '\0';
+
+    int is_true = strcmp(stream->buf, "true") == 0;
+    int is_false = strcmp(stream->buf, "false") == 0;
+    if (!is_true && !is_false && strcmp(stream->buf, "null") != 0 && !is_json_number(stream->buf)) {
+        return fail(stream, "invalid literal");
+    }
+
+    if (in_top_object(stream) && stream->top_key == KEY_ERROR) {
+        stream->api_error = is_true ? 1 : is_false ? 0 : -1;
+    }
+
+    value_done(stream);
+    return 0;
+}
+
+/**
+ * Open an object or array
+ */
+static int push_container(CityStream *stream, char open) {
+    if (stream->depth == MAX_DEPTH) {
+        return fail(stream, "nesting too deep");
+    }
+
+    if (open == '[' && in_top_object(stream) && stream->top_key == KEY_DATA) {
+        stream->has_data = 1;
+    }
+
+    stream->stack[stream->depth++] = open;
+    stream->state = open == '{' ? ST_KEY_OR_END : ST_VALUE_OR_END;
+    return 0;
+}
+
+/**
+ * Close the innermost container if close matches it
+ */
+static int pop_container(CityStream *stream, char close) {
+    char open = close == '}' ? '{' : '[';
+
+    if (stream->depth == 0 || stream->stack[stream->depth - 1] != open) {
+        return fail(stream, "mismatched bracket");
+    }
+
+    stream->depth--;
+    value_done(stream);
+    return 0;
+}
+
+/**
+ * Start a string value or key
+ */
+static void begin_string(CityStream *stream, int is_key) {
+    stream->string_is_key = is_key;
+    stream->len = 0;
+    stream->high_surrogate = 0;
+    stream->state = ST_STRING;
+}
+
+/**
+ * Is c JSON whitespace?
+ */
+static int is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+/**
+ * Can c appear in true/false/null or a number?
+ */
+static int is_literal_char(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.'
+           || c == 'E';
+}
+
+/**
+ * Value of a hex digit, or -1
+ */
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+/**
+ * Feed the next chunk of the response body
+ */
+int city_stream_feed(CityStream *stream, const char *data, size_t len) {
+    if (!stream || (!data && len > 0)) {
+        return -1;
+    }
+
+    size_t i = 0;
+    while (i < len) {
+        char c = data[i];
+
+        switch (stream->state) {
+        case ST_VALUE:
+        case ST_VALUE_OR_END:
+            if (is_space(c)) {
+                i++;
+            } else if (c == ']' && stream->state == ST_VALUE_OR_END) {
+                pop_container(stream, ']');
+                i++;
+            } else if (c == '{' || c == '[') {
+                push_container(stream, c);
+                i++;
+            } else if (c == '"') {
+                begin_string(stream, 0);
+                i++;
+            } else if (is_literal_char(c)) {
+                // The literal's first character is read again in ST_LITERAL
+                stream->len = 0;
+                stream->state = ST_LITERAL;
+            } else {
+                return fail(stream, "unexpected character");
+            }
+            break;
+
+        case ST_KEY_OR_END:
+        case ST_KEY:
+            if (is_space(c)) {
+                i++;
+            } else if (c == '}' && stream->state == ST_KEY_OR_END) {
+                pop_container(stream, '}');
+                i++;
+            } else if (c == '"') {
+                begin_string(stream, 1);
+                i++;
+            } else {
+                return fail(stream, "expected object key");
+            }
+            break;
+
+        case ST_COLON:
+            if (is_space(c)) {
+                i++;
+            } else if (c == ':') {
+                stream->state = ST_VALUE;
+                i++;
+            } else {
+                return fail(stream, "expected ':'");
+            }
+            break;
+
+        case ST_COMMA_OR_END:
+            if (is_space(c)) {
+                i++;
+            } else if (c == ',') {
+                stream->state = stream->stack[stream->depth - 1] == '{' ? ST_KEY : ST_VALUE;
+                i++;
+            } else if (c == '}' || c == ']') {
+                pop_container(stream, c);
+                i++;
+            } else {
+                return fail(stream, "expected ',' or closing bracket");
+            }
+            break;
+
+        case ST_STRING: {
+            if (stream->high_surrogate && c != '\\') {
+                return fail(stream, "unpaired surrogate");
+            }
+
+            // Copy the longest run of plain characters in one go
+            size_t run = i;
+            while (run < len && data[run] != '"' && data[run] != '\\'
+                   && (unsigned char)data[run] >= 0x20) {
+                run++;
+            }
+            if (run > i) {
+                if (buf_append(stream, data + i, run - i) != 0) {
+                    return -1;
+                }
+                i = run;
+                break;
+            }
+
+            if (c == '"') {
+                string_done(stream);
+            } else if (c == '\\') {
+                stream->state = ST_ESCAPE;
+            } else {
+                return fail(stream, "control character in string");
+            }
+            i++;
+            break;
+        }
+
+        case ST_ESCAPE: {
+            const char *escapes = "\"\"\\\\//b\bf\fn\nr\rt\t";
+            const char *match = NULL;
+
+            if (stream->high_surrogate && c != 'u') {
+                return fail(stream, "unpaired surrogate");
+            }
+
+            if (c == 'u') {
+                stream->code_unit = 0;
+                stream->hex_digits = 0;
+                stream->state = ST_UNICODE;
+                i++;
+                break;
+            }
+
+            for (const char *e = escapes; *e; e += 2) {
+                if (*e == c) {
+                    match = e + 1;
+                    break;
+                }
+            }
+            if (!match) {
+                return fail(stream, "invalid escape");
+            }
+
+            if (buf_append(stream, match, 1) != 0) {
+                return -1;
+            }
+            stream->state = ST_STRING;
+            i++;
+            break;
+        }
+
+        case ST_UNICODE: {
+            int digit = hex_value(c);
+            if (digit < 0) {
+                return fail(stream, "invalid \\u escape");
+            }
+
+            stream->code_unit = (stream->code_unit << 4) | (uint32_t)digit;
+            i++;
+            if (++stream->hex_digits == 4) {
+                stream->state = ST_STRING;
+                handle_code_unit(stream, stream->code_unit);
+            }
+            break;
+        }
+
+        case ST_LITERAL:
+            if (is_literal_char(c)) {
+                buf_append(stream, &c, 1);
+                i++;
+            } else {
+                // The delimiter is handled by the next state
+                literal_done(stream);
+            }
+            break;
+
+        case ST_DONE:
+            if (!is_space(c)) {
+                return fail(stream, "trailing data after document");
+            }
+            i++;
+            break;
+
+        case ST_ERROR:
+            return -1;
+        }
+
+        if (stream->state == ST_ERROR) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Signal the end of the response body
+ */
+int city_stream_finish(CityStream *stream) {
+    if (!stream) {
+        return -1;
+    }
+
+    // A top-level literal ends at end of input
+    if (stream->state == ST_LITERAL && stream->depth == 0) {
+        literal_done(stream);
+    }
+
+    if (stream->state == ST_ERROR) {
+        return -1;
+    }
+    if (stream->state != ST_DONE) {
+        return fail(stream, "unexpected end of document");
+    }
+
+    return 0;
+}
+
+/**
+ * Get the value of the top-level "error" member
+ */
+int city_stream_api_error(const CityStream *stream) {
+    return stream ? stream->api_error : -1;
+}
+
+/**
+ * Get the value of the top-level "msg" member
+ */
+const char *city_stream_message(const CityStream *stream) {
+    return stream ? stream->message : NULL;
+}
+
+/**
+ * Check whether the top-level "data" array was present
+ */
+int city_stream_has_data(const CityStream *stream) {
+    return stream ? stream->has_data : 0;
+}
+
+/**
+ * Get the number of cities reported so far
+ */
+size_t city_stream_city_count(const CityStream *stream) {
+    return stream ? stream->city_count : 0;
+}
+
+/**
+ * Describe why parsing failed
+ */
+const char *city_stream_error(const CityStream *stream) {
+    return stream ? stream->error : NULL;
+}
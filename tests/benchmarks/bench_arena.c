@@ -0,0 +1,122 @@
+#include "bst.h"
+#include "bst_arena.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+ * Compares the malloc-backed tree with the arena-backed tree.
+ * Usage: bench_arena [city_count]
+ */
+
+// Monotonic clock in seconds
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Generate count distinct names in a deterministic shuffled order
+static char **make_cities(size_t count) {
+    char **cities = (char **)malloc(count * sizeof(*cities));
+    if (!cities) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        cities[i] = (char *)malloc(24);
+        snprintf(cities[i], 24, "City-%010zu", i * 2654435761u % 10000000019u);
+    }
+
+    // Fisher-Yates with a fixed-seed LCG so runs are reproducible
+    unsigned long long state = 42;
+    for (size_t i = count - 1; i > 0; i--) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t j = (size_t)(state >> 33) % (i + 1);
+        char *tmp = cities[i];
+        cities[i] = cities[j];
+        cities[j] = tmp;
+    }
+
+    return cities;
+}
+
+// Print one result line in ns per city
+static void report(const char *path, const char *phase, double seconds, size_t count) {
+    printf("%-7s %-9s %10.1f ns/city  (%.3f s)\n", path, phase, seconds * 1e9 / count, seconds);
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : 1000000;
+    char **cities = make_cities(count);
+    if (count == 0 || !cities) {
+        fprintf(stderr, "usage: %s [city_count > 0]\n", argv[0]);
+        return 1;
+    }
+
+    printf("Cities: %zu (shuffled insertion order)\n\n", count);
+
+    // malloc path
+    BSTNode *root = NULL;
+    double start = now_seconds();
+    for (size_t i = 0; i < count; i++) {
+        root = bst_insert(root, cities[i]);
+    }
+    report("malloc", "insert", now_seconds() - start, count);
+
+    start = now_seconds();
+    for (size_t i = 0; i < count; i++) {
+        if (!bst_search(root, cities[i])) {
+            fprintf(stderr, "missing city %s\n", cities[i]);
+        }
+    }
+    report("malloc", "search", now_seconds() - start, count);
+
+    start = now_seconds();
+    for (size_t i = 0; i < count; i += 2) {
+        root = bst_remove(root, cities[i]);
+    }
+    report("malloc", "remove", now_seconds() - start, count / 2);
+
+    start = now_seconds();
+    bst_delete_tree(root);
+    report("malloc", "teardown", now_seconds() - start, count - count / 2);
+
+    printf("\n");
+
+    // Arena path
+    BSTArena *arena = bst_arena_create();
+    root = NULL;
+    start = now_seconds();
+    for (size_t i = 0; i < count; i++) {
+        root = bst_arena_insert(arena, root, cities[i]);
+    }
+    report("arena", "insert", now_seconds() - start, count);
+
+    start = now_seconds();
+    for (size_t i = 0; i < count; i++) {
+        if (!bst_search(root, cities[i])) {
+            fprintf(stderr, "missing city %s\n", cities[i]);
+        }
+    }
+    report("arena", "search", now_seconds() - start, count);
+
+    start = now_seconds();
+    for (size_t i = 0; i < count; i += 2) {
+        root = bst_arena_remove(arena, root, cities[i]);
+    }
+    report("arena", "remove", now_seconds() - start, count / 2);
+
+    printf("arena   reserved  %10.1f MiB\n", bst_arena_bytes_reserved(arena) / (1024.0 * 1024.0));
+
+    start = now_seconds();
+    bst_arena_destroy(arena);
+    report("arena", "teardown", now_seconds() - start, count - count / 2);
+
+    for (size_t i = 0; i < count; i++) {
+        free(cities[i]);
+    }
+    free(cities);
+
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include "bst.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+ * Applies a diff (new cities plus removed ones) to a large tree, one city
+ * at a time with bst_insert/bst_remove and in one pass with the batch calls.
+ * Usage: bench_batch [city_count] [diff_size]
+ */
+
+#define NAME_SIZE 32
+
+// Monotonic clock in seconds
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Write a distinct, city-like name for id (an odd multiplier mod 2^40 is a bijection)
+static void make_name(char *out, unsigned long long id) {
+    unsigned long long mixed = (id * 0x9E3779B97ULL) & ((1ULL << 40) - 1);
+
+    for (int i = 0; i < 9; i++) {
+        out[i] = (char)((i == 0 ? 'A' : 'a') + mixed % 26);
+        mixed /= 26;
+    }
+    snprintf(out + 9, NAME_SIZE - 9, " Town");
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : 2000000;
+    size_t diff = argc > 2 ? (size_t)strtoull(argv[2], NULL, 10) : 50000;
+    if (count == 0 || diff == 0 || diff > count) {
+        fprintf(stderr, "usage: %s [city_count > 0] [0 < diff_size <= city_count]\n", argv[0]);
+        return 1;
+    }
+
+    // Names 0..count-1 start in the tree; the diff adds count..count+diff-1
+    // and removes every (count/diff)-th existing name
+    char *storage = (char *)malloc((count + diff) * NAME_SIZE);
+    const char **cities = (const char **)malloc(count * sizeof(*cities));
+    const char **added = (const char **)malloc(diff * sizeof(*added));
+    const char **removed = (const char **)malloc(diff * sizeof(*removed));
+    if (!storage || !cities || !added || !removed) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    for (size_t i = 0; i < count + diff; i++) {
+        make_name(storage + i * NAME_SIZE, i);
+    }
+    for (size_t i = 0; i < count; i++) {
+        cities[i] = storage + i * NAME_SIZE;
+    }
+    for (size_t i = 0; i < diff; i++) {
+        added[i] = storage + (count + i) * NAME_SIZE;
+        removed[i] = cities[i * (count / diff)];
+    }
+
+    printf("Tree: %zu cities, diff: +%zu / -%zu\n", count, diff, diff);
+
+    BSTNode *root = bst_build_from_array(cities, count);
+    double start = now_seconds();
+    for (size_t i = 0; i < diff; i++) {
+        root = bst_insert(root, added[i]);
+    }
+    for (size_t i = 0; i < diff; i++) {
+        root = bst_remove(root, removed[i]);
+    }
+    double single = now_seconds() - start;
+    size_t single_count = bst_count_nodes(root);
+    bst_delete_tree(root);
+
+    root = bst_build_from_array(cities, count);
+    start = now_seconds();
+    root = bst_insert_batch(root, added, diff);
+    root = bst_remove_batch(root, removed, diff);
+    double batch = now_seconds() - start;
+
+    printf("one at a time   %8.1f ms  (%zu cities)\n", single * 1e3, single_count);
+    printf("batch           %8.1f ms  (%zu cities)\n", batch * 1e3, bst_count_nodes(root));
+    printf("speedup         %8.2fx\n", single / batch);
+
+    bst_delete_tree(root);
+    free(removed);
+    free(added);
+    free(cities);
+    free(storage);
+
+    return 0;
+}
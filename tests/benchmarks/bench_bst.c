@@ -0,0 +1,531 @@
+#define _GNU_SOURCE
+#include "bst.h"
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+/*
+ * Regression suite for bst_insert, bst_search and bst_remove. For every
+ * dataset and size it inserts all names in dataset order, looks each one up
+ * in a shuffled order, then removes them in dataset order, and prints one
+ * JSON document with, per phase:
+ *   ns_per_op          loop time per operation, less the sampling timer cost
+ *   p50_ns, p99_ns     latency of individually timed (sampled) operations,
+ *                      timer overhead included (reported as timer_overhead_ns)
+ *   allocs_per_op      malloc/calloc/realloc calls per operation (glibc only)
+ *   peak_rss_kb        peak resident set during the phase (VmHWM, reset per phase)
+ *   cache_misses_per_op, cache_references_per_op, instructions_per_op
+ *                      hardware counters from perf_event_open, null when the
+ *                      kernel does not allow them (perf_event_paranoid)
+ * Datasets are generated from --seed, so two runs with the same arguments
+ * measure the same operations:
+ *   sorted, reverse    distinct synthetic names in (reverse) strcmp order
+ *   random             the same names shuffled
+ *   cities             city-like names ("San ...", "...-sur-Mer", "Bad ...")
+ *                      with a skewed prefix distribution, long names and
+ *                      duplicates
+ *
+ * Usage: bench_bst [--sizes 1000,10000,...] [--datasets sorted,random,...]
+ *                  [--seed N] [--output FILE]
+ * The default sizes are 1K to 1M; pass --sizes ...,10000000 for 10M.
+ */
+
+#define NAME_SIZE 48
+#define MAX_SAMPLES 65536
+#define MAX_SIZES 16
+
+// Allocation counting: the executable's malloc wraps glibc's, except under
+// sanitizers, which provide their own
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+#define COUNT_ALLOCATIONS 1
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static size_t allocation_count;
+
+void *malloc(size_t size) {
+    allocation_count++;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    allocation_count++;
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    allocation_count++;
+    return __libc_realloc(ptr, size);
+}
+#else
+#define COUNT_ALLOCATIONS 0
+static size_t allocation_count;
+#endif
+
+// Monotonic clock in nanoseconds
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// xorshift64* generator, so datasets depend only on the seed
+static uint64_t rng_state;
+
+static uint64_t rng_next(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+static void rng_seed(uint64_t seed) {
+    rng_state = seed * 0x9E3779B97F4A7C15ULL + 1;
+}
+
+/* ---------- Datasets ---------- */
+
+// Write a distinct synthetic name for id (an odd multiplier mod 2^40 is a bijection)
+static void make_synthetic(char *out, uint64_t id) {
+    uint64_t mixed = (id * 0x9E3779B97ULL) & ((1ULL << 40) - 1);
+
+    for (int i = 0; i < 9; i++) {
+        out[i] = (char)((i == 0 ? 'A' : 'a') + mixed % 26);
+        mixed /= 26;
+    }
+    snprintf(out + 9, NAME_SIZE - 9, " Town");
+}
+
+// Prefixes and suffixes of the city-like names; the empty ones come first and dominate
+static const char *city_prefixes[] = {"", "", "", "", "", "", "", "", "San ", "Santa ", "Saint-",
+                                      "New ", "Port ", "Fort ", "Lake ", "Bad ", "El ", "Los ", "Nova "};
+static const char *city_syllables[] = {"ber", "lin", "ham", "bur", "ton", "ford", "wood", "stad", "grad",
+                                       "ria", "na", "ka", "ro", "sa", "lo", "ma", "ta", "vi", "do",
+                                       "ri", "go", "ko", "ja", "pe", "ne", "da", "chester", "field"};
+static const char *city_suffixes[] = {"", "", "", "", "", "", "", "", "", "", " City", " Springs",
+                                      " Heights", "-sur-Mer", " am Main", " de la Sierra", " del Rio"};
+
+#define COUNT_OF(array) (sizeof(array) / sizeof((array)[0]))
+
+// Pick an index skewed towards the front (roughly 1/(i+1) weights)
+static size_t skewed_index(size_t count) {
+    uint64_t r = rng_next() % 1000;
+    size_t index = (size_t)((r * r) / 1000 * count / 1000);
+    return index < count ? index : count - 1;
+}
+
+// Write a city-like name; small datasets repeat names, as real ones do
+static void make_city(char *out) {
+    char root[NAME_SIZE];
+    size_t len = 0;
+    size_t syllables = 2 + rng_next() % 3;
+
+    for (size_t i = 0; i < syllables; i++) {
+        const char *syllable = city_syllables[skewed_index(COUNT_OF(city_syllables))];
+        size_t n = strlen(syllable);
+        if (len + n >= 20) {
+            break;
+        }
+        memcpy(root + len, syllable, n);
+        len += n;
+    }
+    root[len] = '\0';
+    root[0] = (char)(root[0] - ('a' - 'A'));
+
+    const char *prefix = city_prefixes[rng_next() % COUNT_OF(city_prefixes)];
+    const char *suffix = city_suffixes[rng_next() % COUNT_OF(city_suffixes)];
+    snprintf(out, NAME_SIZE, "%s%s%s", prefix, root, suffix);
+}
+
+static int compare_strings(const void *a, const void *b) {
+    return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+// Fisher-Yates shuffle with the seeded generator
+static void shuffle(const char **names, size_t n) {
+    for (size_t i = n; i > 1; i--) {
+        size_t j = (size_t)(rng_next() % i);
+        const char *tmp = names[i - 1];
+        names[i - 1] = names[j];
+        names[j] = tmp;
+    }
+}
+
+/**
+ * Fill names[0..n) for a dataset, using storage for the bytes
+ * Returns -1 for an unknown dataset.
+ */
+static int make_dataset(const char *dataset, size_t n, char *storage, const char **names) {
+    int cities = strcmp(dataset, "cities") == 0;
+
+    for (size_t i = 0; i < n; i++) {
+        if (cities) {
+            make_city(storage + i * NAME_SIZE);
+        } else {
+            make_synthetic(storage + i * NAME_SIZE, i);
+        }
+        names[i] = storage + i * NAME_SIZE;
+    }
+
+    if (strcmp(dataset, "sorted") == 0 || strcmp(dataset, "reverse") == 0) {
+        qsort(names, n, sizeof(*names), compare_strings);
+        if (dataset[0] == 'r') {
+            for (size_t i = 0; i < n / 2; i++) {
+                const char *tmp = names[i];
+                names[i] = names[n - 1 - i];
+                names[n - 1 - i] = tmp;
+            }
+        }
+    } else if (strcmp(dataset, "random") == 0) {
+        shuffle(names, n);
+    } else if (!cities) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/* ---------- Counters ---------- */
+
+#define COUNTER_COUNT 3
+
+static const char *counter_names[COUNTER_COUNT] = {"cache_misses", "cache_references", "instructions"};
+static int counter_fds[COUNTER_COUNT] = {-1, -1, -1};
+
+// Open the hardware counters that the kernel allows
+static void counters_open(void) {
+#ifdef __linux__
+    static const uint64_t configs[COUNTER_COUNT] = {PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_CACHE_REFERENCES,
+                                                    PERF_COUNT_HW_INSTRUCTIONS};
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[i];
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        counter_fds[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+#endif
+}
+
+static void counters_close(void) {
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        if (counter_fds[i] >= 0) {
+            close(counter_fds[i]);
+        }
+    }
+}
+
+static void counters_start(void) {
+#ifdef __linux__
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        if (counter_fds[i] >= 0) {
+            ioctl(counter_fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(counter_fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+}
+
+// Stop the counters; values[i] is -1 for a counter that is not available
+static void counters_stop(long long values[COUNTER_COUNT]) {
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        values[i] = -1;
+#ifdef __linux__
+        uint64_t value;
+        if (counter_fds[i] >= 0) {
+            ioctl(counter_fds[i], PERF_EVENT_IOC_DISABLE, 0);
+            if (read(counter_fds[i], &value, sizeof(value)) == (ssize_t)sizeof(value)) {
+                values[i] = (long long)value;
+            }
+        }
+#endif
+    }
+}
+
+// Reset the peak resident set to the current one (Linux 4.0+); elsewhere the
+// peak covers the whole run so far
+static void peak_rss_reset(void) {
+    int fd = open("/proc/self/clear_refs", O_WRONLY);
+    if (fd >= 0) {
+        ssize_t written = write(fd, "5", 1);
+        (void)written;
+        close(fd);
+    }
+}
+
+// Peak resident set in KiB since the last reset (VmHWM), or ru_maxrss
+static long peak_rss_kb(void) {
+    FILE *status = fopen("/proc/self/status", "r");
+    char line[256];
+    long kb = -1;
+
+    if (status) {
+        while (fgets(line, sizeof(line), status)) {
+            if (strncmp(line, "VmHWM:", 6) == 0) {
+                kb = strtol(line + 6, NULL, 10);
+                break;
+            }
+        }
+        fclose(status);
+    }
+    if (kb < 0) {
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        kb = usage.ru_maxrss;
+    }
+    return kb;
+}
+
+/* ---------- Phases ---------- */
+
+typedef enum { OP_INSERT, OP_SEARCH, OP_REMOVE } Operation;
+
+static const char *operation_names[] = {"insert", "search", "remove"};
+
+typedef struct PhaseResult {
+    double ns_per_op;
+    double p50_ns;
+    double p99_ns;
+    double allocs_per_op;
+    long peak_rss_kb;
+    long long counters[COUNTER_COUNT];
+} PhaseResult;
+
+static uint64_t samples[MAX_SAMPLES];
+static double timer_overhead_ns;
+
+static int compare_samples(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Cost of one pair of clock reads, subtracted from loop totals
+static void calibrate_timer(void) {
+    const int rounds = 100000;
+    uint64_t start = now_ns();
+    volatile uint64_t sink = 0;
+
+    for (int i = 0; i < rounds; i++) {
+        sink += now_ns() - now_ns();
+    }
+    timer_overhead_ns = (double)(now_ns() - start) / rounds;
+    (void)sink;
+}
+
+// Apply one operation to the tree
+static inline BSTNode *apply(Operation op, BSTNode *root, const char *name, volatile size_t *hits) {
+    switch (op) {
+    case OP_INSERT:
+        return bst_insert(root, name);
+    case OP_SEARCH:
+        *hits += bst_search(root, name) != NULL;
+        return root;
+    case OP_REMOVE:
+        return bst_remove(root, name);
+    }
+    return root;
+}
+
+/**
+ * Run one phase over names, timing every stride-th operation individually
+ */
+static BSTNode *run_phase(Operation op, BSTNode *root, const char **names, size_t n, PhaseResult *result) {
+    size_t stride = n / MAX_SAMPLES + 1;
+    size_t sample_count = 0;
+    volatile size_t hits = 0;
+
+    peak_rss_reset();
+    size_t allocations_before = allocation_count;
+    counters_start();
+    uint64_t start = now_ns();
+
+    for (size_t i = 0; i < n; i++) {
+        if (i % stride == 0) {
+            uint64_t op_start = now_ns();
+            root = apply(op, root, names[i], &hits);
+            samples[sample_count++] = now_ns() - op_start;
+        } else {
+            root = apply(op, root, names[i], &hits);
+        }
+    }
+
+    uint64_t elapsed = now_ns() - start;
+    counters_stop(result->counters);
+    size_t allocations = allocation_count - allocations_before;
+
+    qsort(samples, sample_count, sizeof(samples[0]), compare_samples);
+    double net = (double)elapsed - timer_overhead_ns * (double)sample_count;
+    result->ns_per_op = (net > 0 ? net : 0) / (double)n;
+    result->p50_ns = (double)samples[sample_count / 2];
+    result->p99_ns = (double)samples[sample_count * 99 / 100];
+    result->allocs_per_op = (double)allocations / (double)n;
+    result->peak_rss_kb = peak_rss_kb();
+
+    return root;
+}
+
+/* ---------- Output ---------- */
+
+static void print_per_op(FILE *out, const char *name, long long value, size_t n) {
+    if (value < 0) {
+        fprintf(out, ", \"%s_per_op\": null", name);
+    } else {
+        fprintf(out, ", \"%s_per_op\": %.3f", name, (double)value / (double)n);
+    }
+}
+
+static void print_result(FILE *out, int first, const char *dataset, size_t n, Operation op,
+                         const PhaseResult *result) {
+    fprintf(out, "%s\n    {\"dataset\": \"%s\", \"size\": %zu, \"op\": \"%s\"", first ? "" : ",", dataset, n,
+            operation_names[op]);
+    fprintf(out, ", \"ns_per_op\": %.1f, \"p50_ns\": %.0f, \"p99_ns\": %.0f", result->ns_per_op, result->p50_ns,
+            result->p99_ns);
+    if (COUNT_ALLOCATIONS) {
+        fprintf(out, ", \"allocs_per_op\": %.3f", result->allocs_per_op);
+    } else {
+        fprintf(out, ", \"allocs_per_op\": null");
+    }
+    fprintf(out, ", \"peak_rss_kb\": %ld", result->peak_rss_kb);
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        print_per_op(out, counter_names[i], result->counters[i], n);
+    }
+    fprintf(out, "}");
+}
+
+// Parse a comma-separated list of sizes, returning how many were read
+static size_t parse_sizes(const char *list, size_t *sizes) {
+    size_t count = 0;
+    char *end;
+
+    while (*list && count < MAX_SIZES) {
+        unsigned long long value = strtoull(list, &end, 10);
+        if (end == list || value == 0) {
+            return 0;
+        }
+        sizes[count++] = (size_t)value;
+        list = *end == ',' ? end + 1 : end;
+        if (*end && *end != ',') {
+            return 0;
+        }
+    }
+    return count;
+}
+
+int main(int argc, char *argv[]) {
+    size_t sizes[MAX_SIZES] = {1000, 10000, 100000, 1000000};
+    size_t size_count = 4;
+    char dataset_list[256] = "sorted,reverse,random,cities";
+    uint64_t seed = 42;
+    const char *output_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) {
+            size_count = parse_sizes(argv[++i], sizes);
+        } else if (strcmp(argv[i], "--datasets") == 0 && i + 1 < argc) {
+            snprintf(dataset_list, sizeof(dataset_list), "%s", argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output_path = argv[++i];
+        } else {
+            size_count = 0;
+            break;
+        }
+    }
+    if (size_count == 0) {
+        fprintf(stderr,
+                "usage: %s [--sizes 1000,10000,...] [--datasets sorted,reverse,random,cities] "
+                "[--seed N] [--output FILE]\n",
+                argv[0]);
+        return 1;
+    }
+
+    FILE *out = output_path ? fopen(output_path, "w") : stdout;
+    if (!out) {
+        perror(output_path);
+        return 1;
+    }
+
+    size_t max_size = 0;
+    for (size_t i = 0; i < size_count; i++) {
+        max_size = sizes[i] > max_size ? sizes[i] : max_size;
+    }
+    char *storage = (char *)malloc(max_size * NAME_SIZE);
+    const char **names = (const char **)malloc(max_size * sizeof(*names));
+    const char **queries = (const char **)malloc(max_size * sizeof(*queries));
+    if (!storage || !names || !queries) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    calibrate_timer();
+    counters_open();
+
+    fprintf(out, "{\n  \"benchmark\": \"bench_bst\",\n  \"seed\": %llu,\n", (unsigned long long)seed);
+    fprintf(out, "  \"timer_overhead_ns\": %.1f,\n  \"allocation_counting\": %s,\n", timer_overhead_ns,
+            COUNT_ALLOCATIONS ? "true" : "false");
+    fprintf(out, "  \"perf_counters\": %s,\n  \"results\": [", counter_fds[0] >= 0 ? "true" : "false");
+
+    int first = 1;
+    char *saveptr;
+    for (char *dataset = strtok_r(dataset_list, ",", &saveptr); dataset; dataset = strtok_r(NULL, ",", &saveptr)) {
+        for (size_t s = 0; s < size_count; s++) {
+            size_t n = sizes[s];
+
+            // Every (dataset, size) pair gets its own stream, independent of the others run
+            uint64_t stream = seed ^ ((uint64_t)n << 16);
+            for (const char *c = dataset; *c; c++) {
+                stream = stream * 31 + (unsigned char)*c;
+            }
+            rng_seed(stream);
+            if (make_dataset(dataset, n, storage, names) != 0) {
+                fprintf(stderr, "unknown dataset: %s\n", dataset);
+                return 1;
+            }
+            memcpy(queries, names, n * sizeof(*names));
+            shuffle(queries, n);
+
+            PhaseResult result;
+            BSTNode *root = run_phase(OP_INSERT, NULL, names, n, &result);
+            print_result(out, first, dataset, n, OP_INSERT, &result);
+            first = 0;
+
+            root = run_phase(OP_SEARCH, root, queries, n, &result);
+            print_result(out, first, dataset, n, OP_SEARCH, &result);
+
+            root = run_phase(OP_REMOVE, root, names, n, &result);
+            print_result(out, first, dataset, n, OP_REMOVE, &result);
+
+            bst_delete_tree(root);
+            fflush(out);
+        }
+    }
+    fprintf(out, "\n  ]\n}\n");
+
+    counters_close();
+    if (output_path) {
+        fclose(out);
+    }
+    free(queries);
+    free(names);
+    free(storage);
+    return 0;
+}
@@ -0,0 +1,210 @@
+#include "bst_collate.h"
+#include "bst_tree.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Cost of collated lookups. Looks up every city of a tree of accented,
+ * mixed-case UTF-8 names:
+ *   - in a byte-order tree (strcmp order, the default),
+ *   - in a BST_TREE_FOLD tree (one key conversion per lookup, then memcmp
+ *     against the keys stored in the nodes),
+ * and, to isolate the comparison itself, binary-searches a sorted array
+ * with a comparator that collates both operands on every call vs one that
+ * compares precomputed keys.
+ * Usage: bench_collate [city_count]
+ */
+
+#define NAME_SIZE 48
+#define KEY_SIZE 64
+
+// Monotonic clock in seconds
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Accented spellings of a, e, o, u (UTF-8), picked per letter from the id
+static const char *accents[4][3] = {
+    {"á", "Å", "ã"}, {"é", "È", "ë"}, {"ó", "Ø", "ö"}, {"ü", "Ú", "ů"},
+};
+
+// Write a distinct name for id: distinct base letters, some accented or upper-cased
+static void make_name(char *out, unsigned long long id) {
+    unsigned long long mixed = (id * 0x9E3779B97ULL) & ((1ULL << 40) - 1);
+    unsigned long long style = id * 0x2545F491ULL;
+    size_t len = 0;
+
+    for (int i = 0; i < 9; i++) {
+        char c = (char)('a' + mixed % 26);
+        const char *vowel = strchr("aeou", c);
+        mixed /= 26;
+
+        if (vowel && style % 3 != 0) {
+            const char *accented = accents[vowel - "aeou"][style % 3];
+            memcpy(out + len, accented, strlen(accented));
+            len += strlen(accented);
+        } else {
+            out[len++] = (char)(i == 0 || style % 5 == 0 ? c - ('a' - 'A') : c);
+        }
+        style /= 3;
+    }
+    snprintf(out + len, NAME_SIZE - len, " Town");
+}
+
+static size_t compare_calls;
+
+// Comparator that collates both operands on every call
+static int compare_collating(const char *a, const char *b) {
+    char key_a[KEY_SIZE];
+    char key_b[KEY_SIZE];
+
+    compare_calls++;
+    bst_collate_fold(a, key_a, sizeof(key_a), NULL);
+    bst_collate_fold(b, key_b, sizeof(key_b), NULL);
+    return strcmp(key_a, key_b);
+}
+
+static int qsort_collating(const void *a, const void *b) {
+    return compare_collating(*(const char *const *)a, *(const char *const *)b);
+}
+
+static int qsort_keys(const void *a, const void *b) {
+    return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+// Binary search for key among sorted entries, counting comparisons
+static int search_sorted(const char **sorted, size_t n, const char *key, int collating) {
+    size_t lo = 0, hi = n;
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int cmp;
+        if (collating) {
+            cmp = compare_collating(key, sorted[mid]);
+        } else {
+            compare_calls++;
+            cmp = strcmp(key, sorted[mid]);
+        }
+        if (cmp == 0) {
+            return 1;
+        }
+        if (cmp < 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : 1000000;
+    if (count == 0) {
+        fprintf(stderr, "usage: %s [city_count > 0]\n", argv[0]);
+        return 1;
+    }
+
+    char *storage = (char *)malloc(count * NAME_SIZE);
+    char *key_storage = (char *)malloc(count * KEY_SIZE);
+    const char **cities = (const char **)malloc(count * sizeof(*cities));
+    const char **queries = (const char **)malloc(count * sizeof(*queries));
+    const char **sorted = (const char **)malloc(count * sizeof(*sorted));
+    const char **keys = (const char **)malloc(count * sizeof(*keys));
+    if (!storage || !key_storage || !cities || !queries || !sorted || !keys) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        make_name(storage + i * NAME_SIZE, i);
+        cities[i] = storage + i * NAME_SIZE;
+    }
+    // Queries visit every city in a scrambled order
+    for (size_t i = 0; i < count; i++) {
+        queries[i] = cities[(i * 7919) % count];
+    }
+    if (count % 7919 == 0) {
+        memcpy(queries, cities, count * sizeof(*queries));
+    }
+
+    BSTree *plain = bst_tree_create(0);
+    BSTree *folded = bst_tree_create(BST_TREE_FOLD);
+    if (!plain || !folded || bst_tree_load(plain, cities, count) != 0 || bst_tree_load(folded, cities, count) != 0) {
+        fprintf(stderr, "tree setup failed\n");
+        return 1;
+    }
+    printf("Tree: %zu cities, e.g. \"%s\" (height %d)\n\n", count, cities[1], bst_tree_height(folded));
+
+    // Tree lookups
+    size_t found = 0;
+    double start = now_seconds();
+    for (size_t i = 0; i < count; i++) {
+        found += bst_tree_search(plain, queries[i]) != NULL;
+    }
+    double plain_time = now_seconds() - start;
+
+    start = now_seconds();
+    for (size_t i = 0; i < count; i++) {
+        found += bst_tree_search(folded, queries[i]) != NULL;
+    }
+    double folded_time = now_seconds() - start;
+
+    char key[KEY_SIZE];
+    size_t key_bytes = 0;
+    start = now_seconds();
+    for (size_t i = 0; i < count; i++) {
+        key_bytes += bst_collate_fold(queries[i], key, sizeof(key), NULL);
+    }
+    double fold_time = now_seconds() - start;
+
+    // Sorted-array searches: collate per comparison vs precomputed keys
+    memcpy(sorted, cities, count * sizeof(*sorted));
+    qsort(sorted, count, sizeof(*sorted), qsort_collating);
+    for (size_t i = 0; i < count; i++) {
+        bst_collate_fold(cities[i], key_storage + i * KEY_SIZE, KEY_SIZE, NULL);
+        keys[i] = key_storage + i * KEY_SIZE;
+    }
+    qsort(keys, count, sizeof(*keys), qsort_keys);
+
+    compare_calls = 0;
+    start = now_seconds();
+    for (size_t i = 0; i < count; i++) {
+        found += (size_t)search_sorted(sorted, count, queries[i], 1);
+    }
+    double collating_time = now_seconds() - start;
+    size_t collating_calls = compare_calls;
+
+    compare_calls = 0;
+    start = now_seconds();
+    for (size_t i = 0; i < count; i++) {
+        bst_collate_fold(queries[i], key, sizeof(key), NULL);
+        found += (size_t)search_sorted(keys, count, key, 0);
+    }
+    double keyed_time = now_seconds() - start;
+    size_t keyed_calls = compare_calls;
+
+    double per = 1e9 / (double)count;
+    printf("%-34s %12s %14s\n", "lookup", "ns/lookup", "ns/compare");
+    printf("%-34s %12.1f %14s\n", "byte-order tree", plain_time * per, "-");
+    printf("%-34s %12.1f %14s\n", "folded tree (key + memcmp)", folded_time * per, "-");
+    printf("%-34s %12.1f %14s\n", "  of which key conversion", fold_time * per, "-");
+    printf("%-34s %12.1f %14.1f\n", "array, collate per compare", collating_time * per,
+           collating_time * 1e9 / (double)collating_calls);
+    printf("%-34s %12.1f %14.1f\n", "array, precomputed keys", keyed_time * per,
+           (keyed_time - fold_time) * 1e9 / (double)keyed_calls);
+    printf("\ncompares per lookup: %.1f (found %zu of %zu, %zu key bytes)\n",
+           (double)keyed_calls / (double)count, found, 4 * count, key_bytes);
+
+    bst_tree_destroy(plain);
+    bst_tree_destroy(folded);
+    free(keys);
+    free(sorted);
+    free(queries);
+    free(cities);
+    free(key_storage);
+    free(storage);
+    return 0;
+}
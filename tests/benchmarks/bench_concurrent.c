@@ -0,0 +1,219 @@
+#include "bst.h"
+#include "bst_concurrent.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+ * Lookup throughput with 1..64 reader threads while one writer keeps
+ * inserting and removing cities, for the epoch-based concurrent tree and
+ * for a plain tree behind a pthread rwlock.
+ * Usage: bench_concurrent [city_count] [milliseconds_per_run] [max_readers]
+ */
+
+#define NAME_SIZE 32
+
+// Monotonic clock in seconds
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Write a distinct, city-like name for id (an odd multiplier mod 2^40 is a bijection)
+static void make_name(char *out, unsigned long long id) {
+    unsigned long long mixed = (id * 0x9E3779B97ULL) & ((1ULL << 40) - 1);
+
+    for (int i = 0; i < 9; i++) {
+        out[i] = (char)((i == 0 ? 'A' : 'a') + mixed % 26);
+        mixed /= 26;
+    }
+    snprintf(out + 9, NAME_SIZE - 9, " Town");
+}
+
+typedef struct Shared {
+    const char *names;       // count + churn names, NAME_SIZE apart
+    size_t count;            // Names present before the run
+    size_t churn;            // Extra names the writer adds and removes
+    atomic_int stop;
+    BSTConcurrent *tree;     // Concurrent variant
+    BSTNode *root;           // rwlock variant
+    pthread_rwlock_t lock;
+} Shared;
+
+typedef struct Worker {
+    Shared *shared;
+    unsigned seed;
+    unsigned long long ops;
+    pthread_t thread;
+} Worker;
+
+// Cheap per-thread PRNG (xorshift32)
+static unsigned next_random(unsigned *state) {
+    unsigned x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static void *concurrent_reader(void *arg) {
+    Worker *worker = (Worker *)arg;
+    Shared *shared = worker->shared;
+    BSTReader *reader = bst_reader_register(shared->tree);
+
+    while (!atomic_load_explicit(&shared->stop, memory_order_relaxed)) {
+        size_t id = next_random(&worker->seed) % shared->count;
+        worker->ops += (unsigned long long)bst_reader_contains(reader, shared->names + id * NAME_SIZE);
+    }
+
+    bst_reader_unregister(reader);
+    return NULL;
+}
+
+static void *concurrent_writer(void *arg) {
+    Worker *worker = (Worker *)arg;
+    Shared *shared = worker->shared;
+
+    for (size_t i = 0; !atomic_load_explicit(&shared->stop, memory_order_relaxed); i++) {
+        const char *name = shared->names + (shared->count + i % shared->churn) * NAME_SIZE;
+        if ((i / shared->churn) % 2 == 0) {
+            bst_concurrent_insert(shared->tree, name);
+        } else {
+            bst_concurrent_remove(shared->tree, name);
+        }
+        worker->ops++;
+    }
+
+    return NULL;
+}
+
+static void *rwlock_reader(void *arg) {
+    Worker *worker = (Worker *)arg;
+    Shared *shared = worker->shared;
+
+    while (!atomic_load_explicit(&shared->stop, memory_order_relaxed)) {
+        size_t id = next_random(&worker->seed) % shared->count;
+        pthread_rwlock_rdlock(&shared->lock);
+        worker->ops += bst_search(shared->root, shared->names + id * NAME_SIZE) != NULL;
+        pthread_rwlock_unlock(&shared->lock);
+    }
+
+    return NULL;
+}
+
+static void *rwlock_writer(void *arg) {
+    Worker *worker = (Worker *)arg;
+    Shared *shared = worker->shared;
+
+    for (size_t i = 0; !atomic_load_explicit(&shared->stop, memory_order_relaxed); i++) {
+        const char *name = shared->names + (shared->count + i % shared->churn) * NAME_SIZE;
+        pthread_rwlock_wrlock(&shared->lock);
+        if ((i / shared->churn) % 2 == 0) {
+            shared->root = bst_insert(shared->root, name);
+        } else {
+            shared->root = bst_remove(shared->root, name);
+        }
+        pthread_rwlock_unlock(&shared->lock);
+        worker->ops++;
+    }
+
+    return NULL;
+}
+
+/**
+ * Run readers plus one writer for the given time; returns reads/s and writes/s
+ */
+static void run(Shared *shared, void *(*reader)(void *), void *(*writer)(void *), int readers,
+                int milliseconds, double *reads_per_second, double *writes_per_second) {
+    Worker *workers = (Worker *)calloc((size_t)readers + 1, sizeof(Worker));
+    if (!workers) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+
+    atomic_store(&shared->stop, 0);
+    for (int i = 0; i <= readers; i++) {
+        workers[i].shared = shared;
+        workers[i].seed = 2463534242u + (unsigned)i * 7919u;
+        pthread_create(&workers[i].thread, NULL, i == readers ? writer : reader, &workers[i]);
+    }
+
+    double start = now_seconds();
+    struct timespec pause = {milliseconds / 1000, (long)(milliseconds % 1000) * 1000000L};
+    nanosleep(&pause, NULL);
+    atomic_store(&shared->stop, 1);
+
+    unsigned long long reads = 0;
+    for (int i = 0; i <= readers; i++) {
+        pthread_join(workers[i].thread, NULL);
+        if (i < readers) {
+            reads += workers[i].ops;
+        }
+    }
+    double elapsed = now_seconds() - start;
+
+    *reads_per_second = (double)reads / elapsed;
+    *writes_per_second = (double)workers[readers].ops / elapsed;
+    free(workers);
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : 200000;
+    int milliseconds = argc > 2 ? atoi(argv[2]) : 500;
+    int max_readers = argc > 3 ? atoi(argv[3]) : 64;
+    if (count == 0 || milliseconds <= 0 || max_readers <= 0 || max_readers >= BST_CONCURRENT_MAX_READERS) {
+        fprintf(stderr, "usage: %s [city_count > 0] [milliseconds > 0] [0 < max_readers < %d]\n",
+                argv[0], BST_CONCURRENT_MAX_READERS);
+        return 1;
+    }
+
+    Shared shared = {0};
+    shared.count = count;
+    shared.churn = 1024;
+
+    char *names = (char *)malloc((count + shared.churn) * NAME_SIZE);
+    const char **cities = (const char **)malloc(count * sizeof(*cities));
+    if (!names || !cities) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    for (size_t i = 0; i < count + shared.churn; i++) {
+        make_name(names + i * NAME_SIZE, i);
+    }
+    for (size_t i = 0; i < count; i++) {
+        cities[i] = names + i * NAME_SIZE;
+    }
+    shared.names = names;
+
+    shared.tree = bst_concurrent_create();
+    for (size_t i = 0; i < count; i++) {
+        bst_concurrent_insert(shared.tree, cities[i]);
+    }
+    shared.root = bst_build_from_array(cities, count);
+    pthread_rwlock_init(&shared.lock, NULL);
+
+    printf("Tree: %zu cities, one writer churning %zu names, %d ms per run\n\n",
+           count, shared.churn, milliseconds);
+    printf("%-8s %16s %14s %16s %14s\n", "readers", "epoch reads/s", "epoch writes/s",
+           "rwlock reads/s", "rwlock writes/s");
+
+    for (int readers = 1; readers <= max_readers; readers *= 2) {
+        double epoch_reads, epoch_writes, rwlock_reads, rwlock_writes;
+
+        run(&shared, concurrent_reader, concurrent_writer, readers, milliseconds, &epoch_reads, &epoch_writes);
+        run(&shared, rwlock_reader, rwlock_writer, readers, milliseconds, &rwlock_reads, &rwlock_writes);
+
+        printf("%-8d %16.0f %14.0f %16.0f %14.0f\n", readers, epoch_reads, epoch_writes,
+               rwlock_reads, rwlock_writes);
+    }
+
+    pthread_rwlock_destroy(&shared.lock);
+    bst_delete_tree(shared.root);
+    bst_concurrent_destroy(shared.tree);
+    free(cities);
+    free(names);
+    return 0;
+}
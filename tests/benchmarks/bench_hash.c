@@ -0,0 +1,133 @@
+#include "bst_tree.h"
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Exact-match lookups with and without the BST_TREE_HASH index: hits and
+ * misses through bst_tree_search, the cost of keeping the index in sync on
+ * single inserts/removes, and the heap each tree uses (from mallinfo2).
+ * Usage: bench_hash [city_count]
+ */
+
+#define NAME_SIZE 32
+
+// Monotonic clock in seconds
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Write a distinct, city-like name for id (an odd multiplier mod 2^40 is a bijection)
+static void make_name(char *out, unsigned long long id) {
+    unsigned long long mixed = (id * 0x9E3779B97ULL) & ((1ULL << 40) - 1);
+
+    for (int i = 0; i < 9; i++) {
+        out[i] = (char)((i == 0 ? 'A' : 'a') + mixed % 26);
+        mixed /= 26;
+    }
+    snprintf(out + 9, NAME_SIZE - 9, " Town");
+}
+
+// Bytes currently allocated from the heap
+static size_t heap_in_use(void) {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+// Look up every query, returning ns per lookup
+static double time_lookups(const BSTree *tree, const char **queries, size_t count, size_t *found) {
+    double start = now_seconds();
+    for (size_t i = 0; i < count; i++) {
+        *found += bst_tree_search(tree, queries[i]) != NULL;
+    }
+    return (now_seconds() - start) * 1e9 / (double)count;
+}
+
+// Insert then remove every city one at a time, returning ns per operation
+static double time_updates(unsigned flags, const char **cities, size_t count) {
+    BSTree *tree = bst_tree_create(flags);
+    double start = now_seconds();
+    for (size_t i = 0; i < count; i++) {
+        bst_tree_insert(tree, cities[i]);
+    }
+    for (size_t i = 0; i < count; i++) {
+        bst_tree_remove(tree, cities[i]);
+    }
+    double elapsed = now_seconds() - start;
+    bst_tree_destroy(tree);
+    return elapsed * 1e9 / (double)(2 * count);
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : 2000000;
+    if (count == 0) {
+        fprintf(stderr, "usage: %s [city_count > 0]\n", argv[0]);
+        return 1;
+    }
+
+    // Ids [0, count) are in the tree; [count, 2 * count) are misses
+    char *storage = (char *)malloc(2 * count * NAME_SIZE);
+    const char **cities = (const char **)malloc(count * sizeof(*cities));
+    const char **hits = (const char **)malloc(count * sizeof(*hits));
+    const char **misses = (const char **)malloc(count * sizeof(*misses));
+    if (!storage || !cities || !hits || !misses) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    for (size_t i = 0; i < 2 * count; i++) {
+        make_name(storage + i * NAME_SIZE, i);
+    }
+    for (size_t i = 0; i < count; i++) {
+        cities[i] = storage + i * NAME_SIZE;
+        hits[i] = storage + ((i * 7919) % count) * NAME_SIZE;
+        misses[i] = storage + (count + i) * NAME_SIZE;
+    }
+
+    size_t base = heap_in_use();
+    BSTree *plain = bst_tree_create(0);
+    if (!plain || bst_tree_load(plain, cities, count) != 0) {
+        fprintf(stderr, "tree setup failed\n");
+        return 1;
+    }
+    size_t plain_bytes = heap_in_use() - base;
+
+    base = heap_in_use();
+    BSTree *hashed = bst_tree_create(BST_TREE_HASH);
+    if (!hashed || bst_tree_load(hashed, cities, count) != 0) {
+        fprintf(stderr, "tree setup failed\n");
+        return 1;
+    }
+    size_t hashed_bytes = heap_in_use() - base;
+
+    size_t found = 0;
+    double plain_hit = time_lookups(plain, hits, count, &found);
+    double hashed_hit = time_lookups(hashed, hits, count, &found);
+    double plain_miss = time_lookups(plain, misses, count, &found);
+    double hashed_miss = time_lookups(hashed, misses, count, &found);
+
+    size_t update_count = count < 500000 ? count : 500000;
+    double plain_update = time_updates(0, cities, update_count);
+    double hashed_update = time_updates(BST_TREE_HASH, cities, update_count);
+
+    printf("Tree: %zu cities (height %d), found %zu\n\n", count, bst_tree_height(plain), found);
+    printf("%-22s %12s %12s %9s\n", "", "tree", "tree+hash", "ratio");
+    printf("%-22s %12.1f %12.1f %8.2fx\n", "hit ns/lookup", plain_hit, hashed_hit, plain_hit / hashed_hit);
+    printf("%-22s %12.1f %12.1f %8.2fx\n", "miss ns/lookup", plain_miss, hashed_miss, plain_miss / hashed_miss);
+    printf("%-22s %12.1f %12.1f %8.2fx\n", "update ns/op", plain_update, hashed_update,
+           plain_update / hashed_update);
+    printf("%-22s %12.1f %12.1f %8.2fx\n", "heap bytes/city", (double)plain_bytes / (double)count,
+           (double)hashed_bytes / (double)count, (double)hashed_bytes / (double)plain_bytes);
+    printf("(updates: %zu inserts then %zu removes, one at a time)\n", update_count, update_count);
+
+    bst_tree_destroy(plain);
+    bst_tree_destroy(hashed);
+    free(misses);
+    free(hits);
+    free(cities);
+    free(storage);
+    return 0;
+}
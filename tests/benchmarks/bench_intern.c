@@ -0,0 +1,163 @@
+#include "bst_intern.h"
+#include "bst_tree.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Memory saved by interning names across many trees. Loads one tree per
+ * country (200 by default) from a shared vocabulary in which popular names
+ * recur in many countries, the way "San Jose" or "Victoria" do, and
+ * reports the resident set before and after the load:
+ *   - copy:   BST_TREE_ARENA, every tree keeps its own copy of long names
+ *   - intern: BST_TREE_INTERN, long names are stored once in the interner
+ * and the same two with BST_TREE_FOLD, where every name is stored outside
+ * the node. Each configuration runs in its own process so the resident
+ * sets do not mix.
+ * Usage: bench_intern [countries] [cities_per_country]
+ */
+
+#define VOCABULARY 60000
+#define NAME_SIZE 64
+
+static const char *prefixes[] = {"", "", "San ", "Santa ", "Puerto ", "Villa ", "Saint ", "Nueva ", "Port "};
+static const char *suffixes[] = {"", "", "", " Town", " de la Sierra", " del Norte", " Heights",
+                                 " on the Water", " de los Caballeros"};
+
+// Monotonic clock in seconds
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Current resident set in KiB (VmRSS)
+static long rss_kb(void) {
+    FILE *status = fopen("/proc/self/status", "r");
+    char line[256];
+    long kb = -1;
+
+    if (status) {
+        while (fgets(line, sizeof(line), status)) {
+            if (strncmp(line, "VmRSS:", 6) == 0) {
+                kb = strtol(line + 6, NULL, 10);
+                break;
+            }
+        }
+        fclose(status);
+    }
+    return kb;
+}
+
+// Write vocabulary name id: an optional prefix, a made-up word, an optional suffix
+static void make_name(char *out, unsigned id) {
+    unsigned mixed = id * 2654435761u;
+    char word[16];
+    size_t len = 5 + mixed % 6;
+
+    for (size_t i = 0; i < len; i++) {
+        word[i] = (char)((i == 0 ? 'A' : 'a') + (id / (i + 1) + mixed % 7 * i) % 26);
+    }
+    word[len] = '\0';
+    snprintf(out, NAME_SIZE, "%s%s%u%s", prefixes[(mixed >> 8) % 9], word, id,
+             suffixes[(mixed >> 16) % 9]);
+}
+
+// Next value of a xorshift generator
+static unsigned long long next_random(unsigned long long *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/**
+ * Load every country into its own tree and print one result line
+ */
+static void run(const char *label, unsigned flags, char **vocabulary, size_t countries, size_t per_country) {
+    const char **names = (const char **)malloc(per_country * sizeof(*names));
+    BSTree **trees = (BSTree **)calloc(countries, sizeof(*trees));
+    unsigned long long state = 0x9E3779B97F4A7C15ULL;
+    size_t cities = 0;
+
+    long before = rss_kb();
+    double start = now_seconds();
+    for (size_t c = 0; c < countries; c++) {
+        // Skewed draw: low ids (popular names) recur in many countries
+        for (size_t i = 0; i < per_country; i++) {
+            double u = (double)(next_random(&state) % 1000003) / 1000003.0;
+            names[i] = vocabulary[(size_t)(u * u * u * VOCABULARY)];
+        }
+        trees[c] = bst_tree_create(flags);
+        if (!trees[c] || bst_tree_load(trees[c], names, per_country) != 0) {
+            fprintf(stderr, "%s: load failed\n", label);
+            exit(1);
+        }
+        cities += bst_tree_count(trees[c]);
+    }
+    double elapsed = now_seconds() - start;
+    long after = rss_kb();
+
+    BSTInternStats stats;
+    bst_intern_stats(&stats);
+    printf("%-12s %10zu %12ld %12ld %12ld %10.1f %10zu %12zu\n", label, cities, before, after, after - before,
+           elapsed * 1000.0, stats.strings, stats.bytes_saved / 1024);
+
+    for (size_t c = 0; c < countries; c++) {
+        bst_tree_destroy(trees[c]);
+    }
+    free(trees);
+    free(names);
+}
+
+int main(int argc, char *argv[]) {
+    size_t countries = argc > 1 ? strtoul(argv[1], NULL, 10) : 200;
+    size_t per_country = argc > 2 ? strtoul(argv[2], NULL, 10) : 5000;
+    if (countries == 0 || per_country == 0) {
+        fprintf(stderr, "usage: %s [countries] [cities_per_country]\n", argv[0]);
+        return 2;
+    }
+
+    char **vocabulary = (char **)malloc(VOCABULARY * sizeof(*vocabulary));
+    char *storage = (char *)malloc((size_t)VOCABULARY * NAME_SIZE);
+    size_t long_names = 0;
+    for (unsigned i = 0; i < VOCABULARY; i++) {
+        vocabulary[i] = storage + (size_t)i * NAME_SIZE;
+        make_name(vocabulary[i], i);
+        long_names += strlen(vocabulary[i]) >= 24;
+    }
+
+    printf("%zu countries x %zu draws from %d names (%.0f%% of them 24 bytes or longer)\n\n", countries,
+           per_country, VOCABULARY, 100.0 * (double)long_names / VOCABULARY);
+    printf("%-12s %10s %12s %12s %12s %10s %10s %12s\n", "mode", "cities", "rss_before", "rss_after",
+           "rss_delta", "load_ms", "interned", "saved_kb");
+    fflush(stdout);
+
+    struct {
+        const char *label;
+        unsigned flags;
+    } modes[] = {
+        {"copy", BST_TREE_ARENA},
+        {"intern", BST_TREE_INTERN},
+        {"fold-copy", BST_TREE_ARENA | BST_TREE_FOLD},
+        {"fold-intern", BST_TREE_INTERN | BST_TREE_FOLD},
+    };
+
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        pid_t child = fork();
+        if (child == 0) {
+            run(modes[m].label, modes[m].flags, vocabulary, countries, per_country);
+            fflush(stdout);
+            _exit(0);
+        }
+        int status;
+        waitpid(child, &status, 0);
+    }
+
+    free(storage);
+    free(vocabulary);
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include "bst.h"
+#include "bst_parallel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Export and teardown of a large tree: bst_print_inorder and bst_delete_tree
+ * on one thread vs bst_parallel_export and bst_parallel_delete on pools of
+ * 1, 2, 4, ... threads. Output goes to output_path (default /dev/null, which
+ * measures formatting rather than the disk).
+ * Usage: bench_parallel [city_count] [max_threads] [output_path]
+ */
+
+#define NAME_SIZE 32
+
+// Monotonic clock in seconds
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Write a distinct, city-like name for id (an odd multiplier mod 2^40 is a bijection)
+static void make_name(char *out, unsigned long long id) {
+    unsigned long long mixed = (id * 0x9E3779B97ULL) & ((1ULL << 40) - 1);
+
+    for (int i = 0; i < 9; i++) {
+        out[i] = (char)((i == 0 ? 'A' : 'a') + mixed % 26);
+        mixed /= 26;
+    }
+    snprintf(out + 9, NAME_SIZE - 9, " Town");
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : 5000000;
+    size_t max_threads = argc > 2 ? (size_t)strtoull(argv[2], NULL, 10) : 16;
+    const char *output_path = argc > 3 ? argv[3] : "/dev/null";
+    if (count == 0 || max_threads == 0) {
+        fprintf(stderr, "usage: %s [city_count > 0] [max_threads > 0] [output_path]\n", argv[0]);
+        return 1;
+    }
+
+    char *storage = (char *)malloc(count * NAME_SIZE);
+    const char **cities = (const char **)malloc(count * sizeof(*cities));
+    if (!storage || !cities) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        make_name(storage + i * NAME_SIZE, i);
+        cities[i] = storage + i * NAME_SIZE;
+    }
+
+    printf("Tree: %zu cities, output: %s, online CPUs: %ld\n\n", count, output_path,
+           sysconf(_SC_NPROCESSORS_ONLN));
+
+    // Serial baseline: bst_print_inorder with stdout pointed at the output
+    BSTNode *root = bst_build_from_array(cities, count);
+    FILE *out = fopen(output_path, "w");
+    if (!out) {
+        perror(output_path);
+        return 1;
+    }
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    dup2(fileno(out), STDOUT_FILENO);
+    double start = now_seconds();
+    bst_print_inorder(root);
+    fflush(stdout);
+    double serial_export = now_seconds() - start;
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+    fclose(out);
+
+    start = now_seconds();
+    bst_delete_tree(root);
+    double serial_delete = now_seconds() - start;
+
+    printf("%-8s %12s %12s\n", "threads", "export ms", "delete ms");
+    printf("%-8s %12.1f %12.1f\n", "serial", serial_export * 1000.0, serial_delete * 1000.0);
+
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        BSTPool *pool = bst_pool_create(threads);
+        root = bst_build_from_array(cities, count);
+        out = fopen(output_path, "w");
+        if (!pool || !root || !out) {
+            fprintf(stderr, "setup failed\n");
+            return 1;
+        }
+
+        start = now_seconds();
+        int status = bst_parallel_export(pool, root, out);
+        fflush(out);
+        double export_time = now_seconds() - start;
+        fclose(out);
+
+        start = now_seconds();
+        bst_parallel_delete(pool, root);
+        double delete_time = now_seconds() - start;
+
+        printf("%-8zu %12.1f %12.1f%s\n", threads, export_time * 1000.0, delete_time * 1000.0,
+               status == 0 ? "" : "  (export failed)");
+        bst_pool_destroy(pool);
+    }
+
+    free(cities);
+    free(storage);
+    return 0;
+}
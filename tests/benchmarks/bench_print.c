@@ -0,0 +1,123 @@
+#include "bst.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Dumps a large tree with printf per city / per indentation column (the
+ * previous print path) and with bst_print_inorder/bst_print_rotated, which
+ * batch output through a BSTWriter. stdout is pointed at output_path.
+ * Usage: bench_print [city_count] [output_path]
+ */
+
+#define NAME_SIZE 32
+
+// Monotonic clock in seconds
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Write a distinct, city-like name for id (an odd multiplier mod 2^40 is a bijection)
+static void make_name(char *out, unsigned long long id) {
+    unsigned long long mixed = (id * 0x9E3779B97ULL) & ((1ULL << 40) - 1);
+
+    for (int i = 0; i < 9; i++) {
+        out[i] = (char)((i == 0 ? 'A' : 'a') + mixed % 26);
+        mixed /= 26;
+    }
+    snprintf(out + 9, NAME_SIZE - 9, " Town");
+}
+
+// The previous in-order print: one printf per city
+static void printf_inorder(BSTNode *node) {
+    while (node) {
+        printf_inorder(bst_node_left(node));
+        printf("%s\n", bst_node_city(node));
+        node = bst_node_right(node);
+    }
+}
+
+// The previous rotated print: one printf per indentation column
+static void printf_rotated(BSTNode *node, int space, int depth) {
+    while (node) {
+        printf_rotated(bst_node_right(node), space, depth + 1);
+        printf("\n");
+        for (int i = 0; i < space + 5 * depth; i++) {
+            printf(" ");
+        }
+        printf("%s\n", bst_node_city(node));
+        node = bst_node_left(node);
+        depth++;
+    }
+}
+
+static void print_rotated_default(BSTNode *root) {
+    bst_print_rotated(root, 0);
+}
+
+static void printf_rotated_default(BSTNode *root) {
+    printf_rotated(root, 0, 0);
+}
+
+// Time fn(root) with its output flushed
+static double time_dump(void (*fn)(BSTNode *), BSTNode *root) {
+    double start = now_seconds();
+    fn(root);
+    fflush(stdout);
+    return now_seconds() - start;
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : 2000000;
+    const char *output_path = argc > 2 ? argv[2] : "/dev/null";
+    if (count == 0) {
+        fprintf(stderr, "usage: %s [city_count > 0] [output_path]\n", argv[0]);
+        return 1;
+    }
+
+    char *storage = (char *)malloc(count * NAME_SIZE);
+    const char **cities = (const char **)malloc(count * sizeof(*cities));
+    if (!storage || !cities) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        make_name(storage + i * NAME_SIZE, i);
+        cities[i] = storage + i * NAME_SIZE;
+    }
+    BSTNode *root = bst_build_from_array(cities, count);
+
+    int out = open(output_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out < 0) {
+        perror(output_path);
+        return 1;
+    }
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    dup2(out, STDOUT_FILENO);
+    close(out);
+
+    double old_inorder = time_dump(printf_inorder, root);
+    double new_inorder = time_dump(bst_print_inorder, root);
+    double old_rotated = time_dump(printf_rotated_default, root);
+    double new_rotated = time_dump(print_rotated_default, root);
+
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+
+    printf("Tree: %zu cities, output: %s\n\n", count, output_path);
+    printf("%-10s %14s %14s %9s\n", "dump", "printf ms", "writer ms", "speedup");
+    printf("%-10s %14.1f %14.1f %8.2fx\n", "inorder", old_inorder * 1000.0, new_inorder * 1000.0,
+           old_inorder / new_inorder);
+    printf("%-10s %14.1f %14.1f %8.2fx\n", "rotated", old_rotated * 1000.0, new_rotated * 1000.0,
+           old_rotated / new_rotated);
+
+    bst_delete_tree(root);
+    free(cities);
+    free(storage);
+    return 0;
+}
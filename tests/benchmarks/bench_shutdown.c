@@ -0,0 +1,158 @@
+#include "bst_snapshot.h"
+#include "bst_tree.h"
+#include "cli_shutdown.h"
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Shutdown latency of a large tree: for each exit path, a child process
+ * builds the tree, waits on the CLI's shutdown self-pipe and runs the exit
+ * path when the parent sends SIGTERM. The latency is measured by the parent
+ * from kill() until waitpid() returns, so it includes the kernel tearing
+ * down the child's address space.
+ *   full          bst_tree_destroy on a malloc-backed tree (--full-cleanup)
+ *   arena full    bst_tree_destroy on an arena-backed tree
+ *   fast          exit without freeing (the CLI's default)
+ *   snapshot      bst_save_snapshot, then exit without freeing (--snapshot)
+ * Usage: bench_shutdown [city_count] [snapshot_path]
+ */
+
+#define NAME_SIZE 32
+#define BATCH_SIZE 100000
+
+typedef enum ExitPath {
+    EXIT_FULL,
+    EXIT_ARENA_FULL,
+    EXIT_FAST,
+    EXIT_SNAPSHOT
+} ExitPath;
+
+static const char *exit_path_names[] = {"full", "arena full", "fast", "snapshot + fast"};
+
+// Monotonic clock in seconds
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Write a distinct, city-like name for id (an odd multiplier mod 2^40 is a bijection)
+static void make_name(char *out, unsigned long long id) {
+    unsigned long long mixed = (id * 0x9E3779B97ULL) & ((1ULL << 40) - 1);
+
+    for (int i = 0; i < 9; i++) {
+        out[i] = (char)((i == 0 ? 'A' : 'a') + mixed % 26);
+        mixed /= 26;
+    }
+    snprintf(out + 9, NAME_SIZE - 9, " Town");
+}
+
+/**
+ * Child: build the tree in batches (as the CLI applies them), signal
+ * readiness, wait for SIGTERM and run the exit path
+ */
+static int run_child(ExitPath path, size_t count, const char *snapshot_path, int ready_fd) {
+    int wake_fd = cli_shutdown_install();
+    BSTree *tree = bst_tree_create(path == EXIT_ARENA_FULL ? BST_TREE_ARENA : 0);
+    char *storage = (char *)malloc(BATCH_SIZE * NAME_SIZE);
+    const char **names = (const char **)malloc(BATCH_SIZE * sizeof(*names));
+    if (wake_fd < 0 || !tree || !storage || !names) {
+        return 1;
+    }
+
+    for (size_t base = 0; base < count; base += BATCH_SIZE) {
+        size_t n = count - base < BATCH_SIZE ? count - base : BATCH_SIZE;
+        for (size_t i = 0; i < n; i++) {
+            make_name(storage + i * NAME_SIZE, base + i);
+            names[i] = storage + i * NAME_SIZE;
+        }
+        if (bst_tree_insert_batch(tree, names, n, NULL) < 0) {
+            return 1;
+        }
+    }
+    free(names);
+    free(storage);
+
+    char byte = 1;
+    if (write(ready_fd, &byte, 1) != 1) {
+        return 1;
+    }
+
+    struct pollfd fds[1] = {{wake_fd, POLLIN, 0}};
+    while (!cli_shutdown_signal()) {
+        poll(fds, 1, -1);
+    }
+
+    if (path == EXIT_SNAPSHOT && bst_save_snapshot(bst_tree_root(tree), snapshot_path) < 0) {
+        return 1;
+    }
+    if (path == EXIT_FULL || path == EXIT_ARENA_FULL) {
+        bst_tree_destroy(tree);
+    }
+    return 0;
+}
+
+/**
+ * Measure one exit path; returns the latency in seconds, or -1 on failure
+ */
+static double measure(ExitPath path, size_t count, const char *snapshot_path) {
+    int ready[2];
+    if (pipe(ready) < 0) {
+        return -1;
+    }
+
+    fflush(stdout);
+    pid_t child = fork();
+    if (child < 0) {
+        return -1;
+    }
+    if (child == 0) {
+        close(ready[0]);
+        exit(run_child(path, count, snapshot_path, ready[1]));
+    }
+
+    close(ready[1]);
+    char byte;
+    ssize_t got = read(ready[0], &byte, 1);
+    close(ready[0]);
+    if (got != 1) {
+        waitpid(child, NULL, 0);
+        return -1;
+    }
+
+    int status;
+    double start = now_seconds();
+    kill(child, SIGTERM);
+    waitpid(child, &status, 0);
+    double elapsed = now_seconds() - start;
+
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? elapsed : -1;
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : 10000000;
+    const char *snapshot_path = argc > 2 ? argv[2] : "bench_shutdown.snap";
+    if (count == 0) {
+        fprintf(stderr, "usage: %s [city_count > 0] [snapshot_path]\n", argv[0]);
+        return 1;
+    }
+
+    printf("Cities: %zu\n\n", count);
+    printf("%-16s %14s\n", "exit path", "SIGTERM->exit");
+    for (ExitPath path = EXIT_FULL; path <= EXIT_SNAPSHOT; path++) {
+        double elapsed = measure(path, count, snapshot_path);
+        if (elapsed < 0) {
+            fprintf(stderr, "%s: child failed\n", exit_path_names[path]);
+            return 1;
+        }
+        printf("%-16s %11.1f ms\n", exit_path_names[path], elapsed * 1e3);
+    }
+
+    unlink(snapshot_path);
+    return 0;
+}
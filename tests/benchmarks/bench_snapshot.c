@@ -0,0 +1,110 @@
+#include "bst.h"
+#include "bst_snapshot.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+ * Compares bst_search on the pointer tree with bst_snapshot_search.
+ * Usage: bench_snapshot [city_count] [lookup_count]
+ */
+
+#define NAME_SIZE 32
+
+// Monotonic clock in seconds
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Write a distinct, city-like name for id (an odd multiplier mod 2^40 is a bijection)
+static void make_name(char *out, unsigned long long id) {
+    unsigned long long mixed = (id * 0x9E3779B97ULL) & ((1ULL << 40) - 1);
+
+    for (int i = 0; i < 9; i++) {
+        out[i] = (char)((i == 0 ? 'A' : 'a') + mixed % 26);
+        mixed /= 26;
+    }
+    snprintf(out + 9, NAME_SIZE - 9, " Town");
+}
+
+// Fixed-seed generator so runs are reproducible
+static unsigned long long next_random(unsigned long long *state) {
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return *state >> 33;
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : 10000000;
+    size_t lookups = argc > 2 ? (size_t)strtoull(argv[2], NULL, 10) : 5000000;
+    if (count == 0 || lookups == 0) {
+        fprintf(stderr, "usage: %s [city_count > 0] [lookup_count > 0]\n", argv[0]);
+        return 1;
+    }
+
+    char *storage = (char *)malloc(count * NAME_SIZE);
+    const char **cities = (const char **)malloc(count * sizeof(*cities));
+    const char **queries = (const char **)malloc(lookups * sizeof(*queries));
+    if (!storage || !cities || !queries) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    // Even-numbered names are in the tree; odd-numbered ones are misses
+    for (size_t i = 0; i < count; i++) {
+        make_name(storage + i * NAME_SIZE, 2 * i);
+        cities[i] = storage + i * NAME_SIZE;
+    }
+
+    unsigned long long state = 7;
+    char (*misses)[NAME_SIZE] = malloc(lookups / 10 * NAME_SIZE + NAME_SIZE);
+    for (size_t i = 0; i < lookups; i++) {
+        size_t pick = (size_t)next_random(&state) % count;
+        if (i % 10 == 9) {
+            // One lookup in ten misses
+            make_name(misses[i / 10], 2 * pick + 1);
+            queries[i] = misses[i / 10];
+        } else {
+            queries[i] = cities[pick];
+        }
+    }
+
+    double start = now_seconds();
+    BSTNode *root = bst_build_from_array(cities, count);
+    double build = now_seconds() - start;
+
+    start = now_seconds();
+    BSTSnapshot *snapshot = bst_freeze(root);
+    double freeze = now_seconds() - start;
+
+    printf("Cities: %zu, lookups: %zu (10%% misses)\n", count, lookups);
+    printf("build tree      %8.3f s\n", build);
+    printf("freeze          %8.3f s\n\n", freeze);
+
+    size_t hits = 0;
+    start = now_seconds();
+    for (size_t i = 0; i < lookups; i++) {
+        hits += bst_search(root, queries[i]) != NULL;
+    }
+    double tree_time = now_seconds() - start;
+    printf("bst_search      %8.1f ns/lookup  (%zu hits)\n", tree_time * 1e9 / lookups, hits);
+
+    hits = 0;
+    start = now_seconds();
+    for (size_t i = 0; i < lookups; i++) {
+        hits += bst_snapshot_search(snapshot, queries[i]) != NULL;
+    }
+    double snapshot_time = now_seconds() - start;
+    printf("snapshot_search %8.1f ns/lookup  (%zu hits)\n", snapshot_time * 1e9 / lookups, hits);
+    printf("speedup         %8.2fx\n", tree_time / snapshot_time);
+
+    bst_snapshot_free(snapshot);
+    bst_delete_tree(root);
+    free(misses);
+    free(queries);
+    free(cities);
+    free(storage);
+
+    return 0;
+}
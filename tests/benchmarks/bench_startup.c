@@ -0,0 +1,101 @@
+#include "bst.h"
+#include "bst_snapshot.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Compares startup paths: rebuilding the tree with one bst_insert per city
+ * against mapping a snapshot file saved by bst_save_snapshot.
+ * Usage: bench_startup [city_count] [snapshot_path]
+ * The snapshot is read from the page cache, as on a warm restart.
+ */
+
+#define NAME_SIZE 32
+#define FIRST_LOOKUPS 1000
+
+// Monotonic clock in seconds
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Write a distinct, city-like name for id (an odd multiplier mod 2^40 is a bijection)
+static void make_name(char *out, unsigned long long id) {
+    unsigned long long mixed = (id * 0x9E3779B97ULL) & ((1ULL << 40) - 1);
+
+    for (int i = 0; i < 9; i++) {
+        out[i] = (char)((i == 0 ? 'A' : 'a') + mixed % 26);
+        mixed /= 26;
+    }
+    snprintf(out + 9, NAME_SIZE - 9, " Town");
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : 10000000;
+    const char *path = argc > 2 ? argv[2] : "bench_startup.snap";
+    if (count == 0) {
+        fprintf(stderr, "usage: %s [city_count > 0] [snapshot_path]\n", argv[0]);
+        return 1;
+    }
+
+    char *storage = (char *)malloc(count * NAME_SIZE);
+    if (!storage) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        make_name(storage + i * NAME_SIZE, i);
+    }
+
+    printf("Cities: %zu\n", count);
+
+    double start = now_seconds();
+    BSTNode *root = NULL;
+    for (size_t i = 0; i < count; i++) {
+        root = bst_insert(root, storage + i * NAME_SIZE);
+    }
+    double insert_time = now_seconds() - start;
+    printf("bst_insert loop      %10.3f ms\n", insert_time * 1e3);
+
+    start = now_seconds();
+    if (bst_save_snapshot(root, path) != 0) {
+        fprintf(stderr, "cannot write %s\n", path);
+        return 1;
+    }
+    printf("bst_save_snapshot    %10.3f ms\n", (now_seconds() - start) * 1e3);
+
+    // Open and answer a first batch of lookups, as a starting process would
+    size_t hits = 0;
+    start = now_seconds();
+    BSTSnapshot *snapshot = bst_open_snapshot(path, 0);
+    for (size_t i = 0; snapshot && i < FIRST_LOOKUPS; i++) {
+        hits += bst_snapshot_search(snapshot, storage + (i * 7919 % count) * NAME_SIZE) != NULL;
+    }
+    double open_time = now_seconds() - start;
+    if (!snapshot) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return 1;
+    }
+    printf("open + %d lookups  %10.3f ms  (%zu hits, %.0fx faster than inserting)\n", FIRST_LOOKUPS,
+           open_time * 1e3, hits, insert_time / open_time);
+    bst_snapshot_free(snapshot);
+
+    start = now_seconds();
+    snapshot = bst_open_snapshot(path, BST_SNAPSHOT_VERIFY);
+    printf("open, verified       %10.3f ms\n", (now_seconds() - start) * 1e3);
+
+    start = now_seconds();
+    BSTNode *thawed = bst_thaw(snapshot);
+    printf("bst_thaw             %10.3f ms\n", (now_seconds() - start) * 1e3);
+
+    bst_delete_tree(thawed);
+    bst_snapshot_free(snapshot);
+    bst_delete_tree(root);
+    unlink(path);
+    free(storage);
+
+    return 0;
+}
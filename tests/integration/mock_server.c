@@ -0,0 +1,315 @@
+#define _GNU_SOURCE  // strcasestr
+#include "mock_server.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_CONNECTIONS 64
+#define REQUEST_BUFFER 8192
+
+static const char NOT_FOUND_BODY[] = "{\"error\":true,\"msg\":\"country not found\"}";
+static const char ERROR_PAGE[] = "<html><body><h1>Internal Server Error</h1></body></html>";
+
+typedef struct Connection {
+    MockServer *server;
+    int fd;
+    pthread_t thread;
+} Connection;
+
+struct MockServer {
+    const MockRoute *routes;
+    size_t route_count;
+    int *rate_limited;           // 429s sent per route
+    int listen_fd;
+    pthread_t accept_thread;
+    char url[64];
+
+    pthread_mutex_t lock;
+    Connection connections[MAX_CONNECTIONS];
+    size_t connection_count;
+    size_t request_count;
+    size_t not_modified_count;
+    size_t in_flight;
+    size_t max_in_flight;
+};
+
+static void sleep_ms(long ms) {
+    struct timespec ts = {ms / 1000, (ms % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+}
+
+// Does the request carry "<header>: <value>" exactly?
+static int header_matches(const char *headers, const char *header, const char *value) {
+    if (!value) {
+        return 0;
+    }
+
+    const char *line = strcasestr(headers, header);
+    if (!line) {
+        return 0;
+    }
+
+    line += strlen(header);
+    while (*line == ' ') {
+        line++;
+    }
+    return strncmp(line, value, strlen(value)) == 0 && line[strlen(value)] == '\r';
+}
+
+static int send_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t sent = send(fd, data, len, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            return -1;
+        }
+        data += sent;
+        len -= (size_t)sent;
+    }
+    return 0;
+}
+
+// Find the route whose country appears as "country": "<name>" in the body
+static int find_route(MockServer *server, const char *body) {
+    const char *value = strstr(body, "\"country\"");
+    if (!value || !(value = strchr(value + 9, '"'))) {
+        return -1;
+    }
+    value++;
+
+    for (size_t i = 0; i < server->route_count; i++) {
+        size_t len = strlen(server->routes[i].country);
+        if (strncmp(value, server->routes[i].country, len) == 0 && value[len] == '"') {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+// Serve requests on one keep-alive connection until the client closes it
+static void *serve_connection(void *arg) {
+    Connection *conn = (Connection *)arg;
+    MockServer *server = conn->server;
+    char buf[REQUEST_BUFFER + 1];
+    size_t have = 0;
+
+    for (;;) {
+        // Read until the headers and the announced body are complete
+        char *headers_end = NULL;
+        size_t body_len = 0;
+        while (!headers_end || have < (size_t)(headers_end - buf) + 4 + body_len) {
+            if (have == REQUEST_BUFFER) {
+                goto done;
+            }
+            ssize_t got = recv(conn->fd, buf + have, REQUEST_BUFFER - have, 0);
+            if (got <= 0) {
+                goto done;
+            }
+            have += (size_t)got;
+            buf[have] = '\0';
+
+            if (!headers_end && (headers_end = strstr(buf, "\r\n\r\n"))) {
+                const char *cl = strcasestr(buf, "Content-Length:");
+                body_len = cl && cl < headers_end ? strtoul(cl + 15, NULL, 10) : 0;
+            }
+        }
+
+        size_t request_len = (size_t)(headers_end - buf) + 4 + body_len;
+        char saved = buf[request_len];
+        buf[request_len] = '\0';
+        int route = find_route(server, headers_end + 4);
+        headers_end[2] = '\0';
+        const MockRoute *r = route >= 0 ? &server->routes[route] : NULL;
+        int unchanged = r && (header_matches(buf, "If-None-Match:", r->etag)
+                              || header_matches(buf, "If-Modified-Since:", r->last_modified));
+        headers_end[2] = '\r';
+        buf[request_len] = saved;
+
+        pthread_mutex_lock(&server->lock);
+        server->request_count++;
+        if (++server->in_flight > server->max_in_flight) {
+            server->max_in_flight = server->in_flight;
+        }
+        int limited = route >= 0 && server->rate_limited[route] < server->routes[route].rate_limit_first;
+        if (limited) {
+            server->rate_limited[route]++;
+        } else if (unchanged) {
+            server->not_modified_count++;
+        }
+        pthread_mutex_unlock(&server->lock);
+
+        if (r && r->latency_ms > 0) {
+            sleep_ms(r->latency_ms);
+        }
+
+        const char *status = "200 OK";
+        const char *content_type = "application/json";
+        const char *body = r ? r->body : NOT_FOUND_BODY;
+        char error_status[32];
+        char extra[256] = "";
+        if (!r) {
+            status = "404 Not Found";
+        } else if (r->error_status) {
+            snprintf(error_status, sizeof(error_status), "%d Error", r->error_status);
+            status = error_status;
+            content_type = "text/html";
+            body = ERROR_PAGE;
+        } else if (limited) {
+            status = "429 Too Many Requests";
+            body = "Too Many Requests";
+            if (r->retry_after >= 0) {
+                snprintf(extra, sizeof(extra), "Retry-After: %d\r\n", r->retry_after);
+            }
+        } else {
+            if (unchanged) {
+                status = "304 Not Modified";
+                body = "";
+            }
+            snprintf(extra, sizeof(extra), "%s%s%s%s%s%s",
+                     r->etag ? "ETag: " : "", r->etag ? r->etag : "", r->etag ? "\r\n" : "",
+                     r->last_modified ? "Last-Modified: " : "", r->last_modified ? r->last_modified : "",
+                     r->last_modified ? "\r\n" : "");
+        }
+
+        char head[512];
+        int head_len = snprintf(head, sizeof(head),
+                                "HTTP/1.1 %s\r\nContent-Type: %s\r\n"
+                                "Content-Length: %zu\r\nConnection: keep-alive\r\n%s\r\n",
+                                status, content_type, strlen(body), extra);
+
+        pthread_mutex_lock(&server->lock);
+        server->in_flight--;
+        pthread_mutex_unlock(&server->lock);
+
+        if (send_all(conn->fd, head, (size_t)head_len) != 0 || send_all(conn->fd, body, strlen(body)) != 0) {
+            goto done;
+        }
+
+        memmove(buf, buf + request_len, have - request_len);
+        have -= request_len;
+    }
+
+done:
+    shutdown(conn->fd, SHUT_RDWR);
+    return NULL;
+}
+
+static void *accept_loop(void *arg) {
+    MockServer *server = (MockServer *)arg;
+
+    for (;;) {
+        int fd = accept(server->listen_fd, NULL, NULL);
+        if (fd < 0) {
+            return NULL;
+        }
+
+        pthread_mutex_lock(&server->lock);
+        if (server->connection_count == MAX_CONNECTIONS) {
+            pthread_mutex_unlock(&server->lock);
+            close(fd);
+            continue;
+        }
+        Connection *conn = &server->connections[server->connection_count];
+        conn->server = server;
+        conn->fd = fd;
+        if (pthread_create(&conn->thread, NULL, serve_connection, conn) == 0) {
+            server->connection_count++;
+        } else {
+            close(fd);
+        }
+        pthread_mutex_unlock(&server->lock);
+    }
+}
+
+MockServer *mock_server_start(const MockRoute *routes, size_t n) {
+    MockServer *server = (MockServer *)calloc(1, sizeof(MockServer));
+    if (!server) {
+        return NULL;
+    }
+
+    server->routes = routes;
+    server->route_count = n;
+    server->rate_limited = (int *)calloc(n ? n : 1, sizeof(int));
+    pthread_mutex_init(&server->lock, NULL);
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len = sizeof(addr);
+
+    server->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (!server->rate_limited || server->listen_fd < 0
+        || bind(server->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0
+        || listen(server->listen_fd, MAX_CONNECTIONS) != 0
+        || getsockname(server->listen_fd, (struct sockaddr *)&addr, &addr_len) != 0
+        || pthread_create(&server->accept_thread, NULL, accept_loop, server) != 0) {
+        if (server->listen_fd >= 0) {
+            close(server->listen_fd);
+        }
+        free(server->rate_limited);
+        free(server);
+        return NULL;
+    }
+
+    snprintf(server->url, sizeof(server->url), "http://127.0.0.1:%d/countries/cities", ntohs(addr.sin_port));
+    return server;
+}
+
+void mock_server_stop(MockServer *server) {
+    if (!server) {
+        return;
+    }
+
+    // Unblock accept() and every recv() so the threads can finish
+    shutdown(server->listen_fd, SHUT_RDWR);
+    pthread_join(server->accept_thread, NULL);
+    close(server->listen_fd);
+
+    for (size_t i = 0; i < server->connection_count; i++) {
+        shutdown(server->connections[i].fd, SHUT_RDWR);
+        pthread_join(server->connections[i].thread, NULL);
+        close(server->connections[i].fd);
+    }
+
+    pthread_mutex_destroy(&server->lock);
+    free(server->rate_limited);
+    free(server);
+}
+
+const char *mock_server_url(const MockServer *server) {
+    return server->url;
+}
+
+size_t mock_server_connections(MockServer *server) {
+    pthread_mutex_lock(&server->lock);
+    size_t count = server->connection_count;
+    pthread_mutex_unlock(&server->lock);
+    return count;
+}
+
+size_t mock_server_requests(MockServer *server) {
+    pthread_mutex_lock(&server->lock);
+    size_t count = server->request_count;
+    pthread_mutex_unlock(&server->lock);
+    return count;
+}
+
+size_t mock_server_not_modified(MockServer *server) {
+    pthread_mutex_lock(&server->lock);
+    size_t count = server->not_modified_count;
+    pthread_mutex_unlock(&server->lock);
+    return count;
+}
+
+size_t mock_server_max_in_flight(MockServer *server) {
+    pthread_mutex_lock(&server->lock);
+    size_t count = server->max_in_flight;
+    pthread_mutex_unlock(&server->lock);
+    return count;
+}
@@ -0,0 +1,66 @@
+#ifndef MOCK_SERVER_H
+#define MOCK_SERVER_H
+
+#include <stddef.h>
+
+/**
+ * Minimal HTTP/1.1 server for connector tests
+ * Listens on an ephemeral loopback port and answers city requests
+ * (POST with {"country": "..."}) from a table of canned responses, keeping
+ * connections alive between requests. Each connection is served by its
+ * own thread, so slow routes overlap like a real server.
+ */
+typedef struct MockServer MockServer;
+
+/**
+ * Canned response for one country
+ */
+typedef struct MockRoute {
+    const char *country;         // Country name matched against the request body
+    const char *body;            // Response body for a successful answer
+    long latency_ms;             // Delay before answering
+    int rate_limit_first;        // Answer this many requests with 429 before succeeding
+    int retry_after;             // Retry-After seconds sent with a 429 (negative to omit)
+    const char *etag;            // ETag to send; a matching If-None-Match gets a 304 (NULL for none)
+    const char *last_modified;   // Last-Modified to send; a matching If-Modified-Since gets a 304
+    int error_status;            // Answer with this status and an HTML error page (0 for none)
+} MockRoute;
+
+/**
+ * Start serving routes (the table must outlive the server)
+ * Unknown countries get a 404 with a CountriesNow-style error body.
+ * @return The running server, or NULL on failure
+ */
+MockServer *mock_server_start(const MockRoute *routes, size_t n);
+
+/**
+ * Stop the server and wait for its threads
+ */
+void mock_server_stop(MockServer *server);
+
+/**
+ * URL of the city endpoint, valid until the server stops
+ */
+const char *mock_server_url(const MockServer *server);
+
+/**
+ * Number of TCP connections accepted so far
+ */
+size_t mock_server_connections(MockServer *server);
+
+/**
+ * Number of requests answered so far
+ */
+size_t mock_server_requests(MockServer *server);
+
+/**
+ * Number of requests answered with 304 Not Modified
+ */
+size_t mock_server_not_modified(MockServer *server);
+
+/**
+ * Largest number of requests that were being handled at the same time
+ */
+size_t mock_server_max_in_flight(MockServer *server);
+
+#endif // MOCK_SERVER_H
@@ -0,0 +1,198 @@
+#include "countries_cache.h"
+#include "mock_server.h"
+#include "test_framework.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static const char *GHANA_BODY =
+    "{\"error\":false,\"msg\":\"cities in ghana retrieved\",\"data\":[\"Accra\",\"Kumasi\",\"Tamale\",\"Accra\"]}";
+static const char *TOGO_BODY =
+    "{\"error\":false,\"msg\":\"cities in togo retrieved\",\"data\":[\"Lome\",\"Sokode\"]}";
+
+static MockRoute routes[] = {
+    {"ghana", NULL, 0, 0, -1, "\"v1\"", NULL, 0},
+    {"togo", NULL, 0, 0, -1, NULL, "Wed, 01 Oct 2025 10:00:00 GMT", 0},
+    {"benin", NULL, 0, 0, -1, NULL, NULL, 0},
+};
+
+static char cache_dir[64];
+
+// Unreachable endpoint: port 9 (discard) on loopback refuses connections
+static CountriesFetchOptions offline = {"http://127.0.0.1:9/countries/cities", 2000};
+
+static void reset_cache_dir(void) {
+    char command[128];
+    if (cache_dir[0]) {
+        snprintf(command, sizeof(command), "rm -rf %s", cache_dir);
+        if (system(command) != 0) {
+            perror("rm");
+        }
+    }
+    strcpy(cache_dir, "/tmp/citysorter-cache-XXXXXX");
+    if (!mkdtemp(cache_dir)) {
+        perror("mkdtemp");
+    }
+}
+
+// Test: A miss fetches and persists; a warm start needs no network
+TEST(test_cache_miss_then_hit) {
+    reset_cache_dir();
+    MockServer *server = mock_server_start(routes, 3);
+    ASSERT_NOT_NULL(server, "Mock server failed to start");
+    CountriesFetchOptions options = {mock_server_url(server), 5000};
+    CountriesCacheStats stats;
+    BSTree *tree = bst_tree_create(0);
+
+    CountriesCache *cache = countries_cache_open(cache_dir, 3600);
+    ASSERT_NOT_NULL(cache, "Cache should open");
+    ASSERT_EQUAL(countries_cache_load_tree(cache, &options, "ghana", tree), COUNTRIES_OK, "Miss should fetch");
+    ASSERT_EQUAL(bst_tree_count(tree), 3, "Fetched cities should be loaded");
+    ASSERT_EQUAL(mock_server_requests(server), 1, "Miss should make one request");
+    countries_cache_close(cache);
+
+    // Restart: the entry is fresh, so the offline endpoint is never needed
+    bst_tree_destroy(tree);
+    tree = bst_tree_create(BST_TREE_ARENA);
+    cache = countries_cache_open(cache_dir, 3600);
+    ASSERT_EQUAL(countries_cache_load_tree(cache, &offline, "ghana", tree), COUNTRIES_OK, "Hit should load");
+    ASSERT_EQUAL(bst_tree_count(tree), 3, "Cached cities should be loaded");
+    ASSERT_NOT_NULL(bst_tree_search(tree, "Tamale"), "Tamale should be cached");
+
+    countries_cache_stats(cache, &stats);
+    ASSERT_EQUAL(stats.hits, 1, "One hit expected");
+    ASSERT_EQUAL(stats.misses, 0, "No miss expected after restart");
+    ASSERT_EQUAL(mock_server_requests(server), 1, "Hit should not make a request");
+
+    countries_cache_close(cache);
+    bst_tree_destroy(tree);
+    mock_server_stop(server);
+}
+
+// Test: Stale entries are revalidated with ETag and Last-Modified
+TEST(test_cache_revalidation) {
+    reset_cache_dir();
+    MockServer *server = mock_server_start(routes, 3);
+    ASSERT_NOT_NULL(server, "Mock server failed to start");
+    CountriesFetchOptions options = {mock_server_url(server), 5000};
+    CountriesCacheStats stats;
+    BSTree *tree = bst_tree_create(0);
+
+    // A TTL of 0 makes every existing entry stale
+    CountriesCache *cache = countries_cache_open(cache_dir, 0);
+    const char *countries[] = {"ghana", "togo", "benin"};
+    for (int round = 0; round < 2; round++) {
+        for (int i = 0; i < 3; i++) {
+            ASSERT_EQUAL(countries_cache_load_tree(cache, &options, countries[i], tree), COUNTRIES_OK,
+                         "Load should succeed");
+        }
+    }
+    ASSERT_EQUAL(bst_tree_count(tree), 2, "Last load (benin) should replace the tree");
+
+    countries_cache_stats(cache, &stats);
+    ASSERT_EQUAL(stats.misses, 3, "First round should miss");
+    ASSERT_EQUAL(stats.stale, 3, "Second round should find stale entries");
+    ASSERT_EQUAL(stats.revalidated, 2, "ghana (ETag) and togo (Last-Modified) should revalidate");
+    ASSERT_EQUAL(mock_server_not_modified(server), 2, "Server should answer two 304s");
+    ASSERT_EQUAL(mock_server_requests(server), 6, "Every stale load should make a request");
+
+    // A 304 still yields the cached cities
+    ASSERT_EQUAL(countries_cache_load_tree(cache, &options, "ghana", tree), COUNTRIES_OK, "Load should succeed");
+    ASSERT_EQUAL(bst_tree_count(tree), 3, "Revalidated cities should be loaded");
+
+    countries_cache_close(cache);
+    bst_tree_destroy(tree);
+    mock_server_stop(server);
+}
+
+// Test: A failed request falls back to the stale entry
+TEST(test_cache_stale_if_error) {
+    reset_cache_dir();
+    MockServer *server = mock_server_start(routes, 3);
+    ASSERT_NOT_NULL(server, "Mock server failed to start");
+    CountriesFetchOptions options = {mock_server_url(server), 5000};
+    CountriesCacheStats stats;
+    BSTree *tree = bst_tree_create(0);
+
+    CountriesCache *cache = countries_cache_open(cache_dir, 0);
+    ASSERT_EQUAL(countries_cache_load_tree(cache, &options, "togo", tree), COUNTRIES_OK, "Fetch should succeed");
+    mock_server_stop(server);
+
+    bst_tree_insert(tree, "Placeholder");
+    ASSERT_EQUAL(countries_cache_load_tree(cache, &offline, "togo", tree), COUNTRIES_OK,
+                 "Stale entry should be served");
+    ASSERT_EQUAL(bst_tree_count(tree), 2, "Stale cities should be loaded");
+
+    ASSERT_EQUAL(countries_cache_load_tree(cache, &offline, "ghana", tree), COUNTRIES_ERR_NETWORK,
+                 "Without an entry the failure should surface");
+    ASSERT_EQUAL(bst_tree_count(tree), 2, "Failed load should not modify the tree");
+
+    countries_cache_stats(cache, &stats);
+    ASSERT_EQUAL(stats.stale_served, 1, "One stale fallback expected");
+
+    countries_cache_close(cache);
+    bst_tree_destroy(tree);
+}
+
+// Test: Corrupt or invalidated entries are refetched; API errors are not cached
+TEST(test_cache_corrupt_and_invalidate) {
+    reset_cache_dir();
+    MockServer *server = mock_server_start(routes, 3);
+    ASSERT_NOT_NULL(server, "Mock server failed to start");
+    CountriesFetchOptions options = {mock_server_url(server), 5000};
+    CountriesCacheStats stats;
+    BSTree *tree = bst_tree_create(0);
+    char path[128];
+
+    CountriesCache *cache = countries_cache_open(cache_dir, 3600);
+    ASSERT_EQUAL(countries_cache_load_tree(cache, &options, "ghana", tree), COUNTRIES_OK, "Fetch should succeed");
+
+    // Simulate a torn write from some other tool: the entry is cut short
+    snprintf(path, sizeof(path), "%s/ghana.cities", cache_dir);
+    ASSERT_EQUAL(truncate(path, 40), 0, "Truncate failed");
+    ASSERT_EQUAL(countries_cache_load_tree(cache, &options, "ghana", tree), COUNTRIES_OK, "Refetch should succeed");
+    ASSERT_EQUAL(bst_tree_count(tree), 3, "Refetched cities should be loaded");
+
+    ASSERT_EQUAL(countries_cache_invalidate(cache, "ghana"), 1, "Entry should be removed");
+    ASSERT_EQUAL(countries_cache_invalidate(cache, "ghana"), 0, "Entry should already be gone");
+    ASSERT_EQUAL(countries_cache_load_tree(cache, &options, "ghana", tree), COUNTRIES_OK, "Refetch should succeed");
+
+    ASSERT_EQUAL(countries_cache_load_tree(cache, &options, "atlantis", tree), COUNTRIES_ERR_API,
+                 "Unknown country should fail");
+    ASSERT_EQUAL(countries_cache_load_tree(cache, &options, "atlantis", tree), COUNTRIES_ERR_API,
+                 "Failures should not be cached");
+
+    countries_cache_stats(cache, &stats);
+    ASSERT_EQUAL(stats.misses, 5, "Every load here should miss");
+    ASSERT_EQUAL(stats.hits, 0, "No hits expected");
+    ASSERT_EQUAL(mock_server_requests(server), 5, "Every miss should make a request");
+    ASSERT_EQUAL(bst_tree_count(tree), 3, "Failed loads should not modify the tree");
+
+    ASSERT_EQUAL(countries_cache_load_tree(NULL, &options, "ghana", tree), COUNTRIES_ERR_INVALID,
+                 "NULL cache should be rejected");
+    ASSERT_NULL(countries_cache_open(NULL, 60), "NULL directory should be rejected");
+
+    countries_cache_close(cache);
+    bst_tree_destroy(tree);
+    mock_server_stop(server);
+}
+
+// Main test runner
+int main() {
+    routes[0].body = GHANA_BODY;
+    routes[1].body = TOGO_BODY;
+    routes[2].body = TOGO_BODY;
+
+    print_test_header("Countries Cache Integration Tests");
+
+    RUN_TEST(test_cache_miss_then_hit);
+    RUN_TEST(test_cache_revalidation);
+    RUN_TEST(test_cache_stale_if_error);
+    RUN_TEST(test_cache_corrupt_and_invalidate);
+
+    reset_cache_dir();
+    rmdir(cache_dir);
+
+    return print_test_summary();
+}
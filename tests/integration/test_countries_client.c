@@ -0,0 +1,114 @@
+#include "countries_client.h"
+#include "test_framework.h"
+#include <stdio.h>
+#include <string.h>
+
+// Fixture responses are served through file:// URLs (FIXTURE_DIR comes from CMake)
+static const char *fixture_url(const char *name) {
+    static char url[1024];
+    snprintf(url, sizeof(url), "file://%s/%s", FIXTURE_DIR, name);
+    return url;
+}
+
+// Count cities and remember the first one
+typedef struct {
+    size_t count;
+    char first[64];
+} CityTally;
+
+static int tally_city(const char *city, size_t len, void *ctx) {
+    CityTally *tally = (CityTally *)ctx;
+    if (tally->count++ == 0 && len < sizeof(tally->first)) {
+        memcpy(tally->first, city, len + 1);
+    }
+    return 0;
+}
+
+static int stop_immediately(const char *city, size_t len, void *ctx) {
+    (void)city;
+    (void)len;
+    (void)ctx;
+    return 1;
+}
+
+// Test: Cities stream to the callback in response order
+TEST(test_fetch_streams_cities) {
+    CountriesFetchOptions options = {fixture_url("nigeria.json"), 5000};
+    CityTally tally = {0};
+
+    ASSERT_EQUAL(countries_fetch_cities(&options, "nigeria", tally_city, &tally), COUNTRIES_OK,
+                 "Fetch should succeed");
+    ASSERT_EQUAL(tally.count, 37, "Every entry (including duplicates) should be reported");
+    ASSERT_STR_EQUAL(tally.first, "Aba", "First city mismatch");
+}
+
+// Test: Loading builds a balanced, deduplicated tree
+TEST(test_load_tree) {
+    unsigned flags[] = {0, BST_TREE_ARENA};
+
+    for (size_t f = 0; f < 2; f++) {
+        CountriesFetchOptions options = {fixture_url("nigeria.json"), 5000};
+        BSTree *tree = bst_tree_create(flags[f]);
+        ASSERT_EQUAL(bst_tree_insert(tree, "Stale"), 1, "Setup insert failed");
+
+        ASSERT_EQUAL(countries_load_tree(&options, "nigeria", tree), COUNTRIES_OK, "Load should succeed");
+        ASSERT_EQUAL(bst_tree_count(tree), 35, "Duplicates should be dropped");
+        ASSERT_EQUAL(bst_tree_height(tree), 5, "Bulk-built tree should be perfectly balanced");
+        ASSERT_NULL(bst_tree_search(tree, "Stale"), "Old contents should be replaced");
+        ASSERT_NOT_NULL(bst_tree_search(tree, "Port Harcourt"), "Port Harcourt should be loaded");
+        ASSERT_STR_EQUAL(bst_node_city(bst_tree_select(tree, 0)), "Aba", "Smallest city mismatch");
+
+        bst_tree_destroy(tree);
+    }
+}
+
+// Test: Failures are classified and leave the tree untouched
+TEST(test_load_failures) {
+    BSTree *tree = bst_tree_create(0);
+    bst_tree_insert(tree, "Kept");
+
+    CountriesFetchOptions options = {fixture_url("unknown_country.json"), 5000};
+    ASSERT_EQUAL(countries_load_tree(&options, "atlantis", tree), COUNTRIES_ERR_API,
+                 "API error should be reported");
+
+    options.url = fixture_url("truncated.json");
+    ASSERT_EQUAL(countries_load_tree(&options, "nigeria", tree), COUNTRIES_ERR_PARSE,
+                 "Truncated body should be a parse error");
+
+    options.url = fixture_url("missing.json");
+    ASSERT_EQUAL(countries_load_tree(&options, "nigeria", tree), COUNTRIES_ERR_NETWORK,
+                 "Unreadable URL should be a transfer error");
+
+    ASSERT_EQUAL(bst_tree_count(tree), 1, "Failed loads should not modify the tree");
+    ASSERT_NOT_NULL(bst_tree_search(tree, "Kept"), "Original city should remain");
+
+    bst_tree_destroy(tree);
+}
+
+// Test: Argument checks and callback aborts
+TEST(test_invalid_and_abort) {
+    CountriesFetchOptions options = {fixture_url("nigeria.json"), 5000};
+
+    ASSERT_EQUAL(countries_fetch_cities(&options, NULL, NULL, NULL), COUNTRIES_ERR_INVALID,
+                 "NULL country should be rejected");
+    ASSERT_EQUAL(countries_fetch_cities(&options, "", NULL, NULL), COUNTRIES_ERR_INVALID,
+                 "Empty country should be rejected");
+    ASSERT_EQUAL(countries_load_tree(&options, "nigeria", NULL), COUNTRIES_ERR_INVALID,
+                 "NULL tree should be rejected");
+    ASSERT_EQUAL(countries_fetch_cities(&options, "nigeria", stop_immediately, NULL), COUNTRIES_ERR_ABORTED,
+                 "Callback abort should be reported");
+    ASSERT_STR_EQUAL(countries_status_string(COUNTRIES_ERR_API), "API reported an error",
+                     "Status description mismatch");
+}
+
+// Main test runner
+int main() {
+    print_test_header("Countries Client Integration Tests");
+
+    RUN_TEST(test_fetch_streams_cities);
+    RUN_TEST(test_load_tree);
+    RUN_TEST(test_load_failures);
+    RUN_TEST(test_invalid_and_abort);
+
+    return print_test_summary();
+}
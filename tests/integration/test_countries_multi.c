@@ -0,0 +1,185 @@
+#include "countries_multi.h"
+#include "mock_server.h"
+#include "test_framework.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define COUNTRY_COUNT 8
+
+static char bodies[COUNTRY_COUNT][256];
+static char names[COUNTRY_COUNT][16];
+
+// Eight countries with three cities each; "Capital" is shared by all of them
+static void make_routes(MockRoute *routes, long latency_ms) {
+    for (int i = 0; i < COUNTRY_COUNT; i++) {
+        snprintf(names[i], sizeof(names[i]), "country%d", i);
+        snprintf(bodies[i], sizeof(bodies[i]),
+                 "{\"error\":false,\"msg\":\"cities in %s retrieved\","
+                 "\"data\":[\"Capital\",\"North %d\",\"South %d\"]}", names[i], i, i);
+
+        memset(&routes[i], 0, sizeof(routes[i]));
+        routes[i].country = names[i];
+        routes[i].body = bodies[i];
+        routes[i].latency_ms = latency_ms;
+        routes[i].retry_after = -1;
+    }
+}
+
+static long long elapsed_ms(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000LL + (now.tv_nsec - start->tv_nsec) / 1000000;
+}
+
+// Test: Requests overlap up to the cap and reuse pooled connections
+TEST(test_concurrent_fetch) {
+    MockRoute routes[COUNTRY_COUNT];
+    make_routes(routes, 150);
+    MockServer *server = mock_server_start(routes, COUNTRY_COUNT);
+    ASSERT_NOT_NULL(server, "Mock server failed to start");
+
+    const char *countries[COUNTRY_COUNT];
+    for (int i = 0; i < COUNTRY_COUNT; i++) {
+        countries[i] = names[i];
+    }
+
+    CountriesMultiOptions options = {mock_server_url(server), 5000, 4, 0, 0};
+    CountriesStatus statuses[COUNTRY_COUNT];
+    BSTree *tree = bst_tree_create(BST_TREE_ARENA);
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    CountriesStatus status = countries_load_tree_many(&options, countries, COUNTRY_COUNT, tree, statuses);
+    long long elapsed = elapsed_ms(&start);
+
+    ASSERT_EQUAL(status, COUNTRIES_OK, "Every country should load");
+    for (int i = 0; i < COUNTRY_COUNT; i++) {
+        ASSERT_EQUAL(statuses[i], COUNTRIES_OK, "Per-country status mismatch");
+    }
+    ASSERT_EQUAL(bst_tree_count(tree), 1 + 2 * COUNTRY_COUNT, "Cities should be merged without duplicates");
+    ASSERT_NOT_NULL(bst_tree_search(tree, "South 7"), "Last country's cities should be present");
+
+    // 8 requests of 150 ms in slots of 4 take two rounds, not eight
+    ASSERT(elapsed < 4 * 150, "Requests should run concurrently");
+    ASSERT(mock_server_max_in_flight(server) <= 4, "Concurrency cap exceeded");
+    ASSERT_EQUAL(mock_server_requests(server), COUNTRY_COUNT, "One request per country expected");
+    ASSERT(mock_server_connections(server) <= 4, "Connections should be reused");
+
+    bst_tree_destroy(tree);
+    mock_server_stop(server);
+}
+
+// Test: A cap of one serializes requests over a single kept-alive connection
+TEST(test_single_connection) {
+    MockRoute routes[COUNTRY_COUNT];
+    make_routes(routes, 0);
+    MockServer *server = mock_server_start(routes, COUNTRY_COUNT);
+    ASSERT_NOT_NULL(server, "Mock server failed to start");
+
+    const char *countries[COUNTRY_COUNT];
+    for (int i = 0; i < COUNTRY_COUNT; i++) {
+        countries[i] = names[i];
+    }
+
+    CountriesMultiOptions options = {mock_server_url(server), 5000, 1, 0, 0};
+    BSTree *tree = bst_tree_create(0);
+
+    ASSERT_EQUAL(countries_load_tree_many(&options, countries, COUNTRY_COUNT, tree, NULL), COUNTRIES_OK,
+                 "Every country should load");
+    ASSERT_EQUAL(mock_server_max_in_flight(server), 1, "Only one request should be in flight");
+    ASSERT_EQUAL(mock_server_connections(server), 1, "All requests should share one connection");
+
+    bst_tree_destroy(tree);
+    mock_server_stop(server);
+}
+
+// Test: 429 answers are retried with backoff until the retry budget runs out
+TEST(test_rate_limit_backoff) {
+    MockRoute routes[COUNTRY_COUNT];
+    make_routes(routes, 0);
+    routes[0].rate_limit_first = 2;     // Succeeds on the third attempt
+    routes[1].rate_limit_first = 100;   // Never succeeds
+    routes[2].rate_limit_first = 1;
+    routes[2].retry_after = 0;
+    MockServer *server = mock_server_start(routes, COUNTRY_COUNT);
+    ASSERT_NOT_NULL(server, "Mock server failed to start");
+
+    const char *countries[] = {names[0], names[1], names[2], "atlantis"};
+    CountriesMultiOptions options = {mock_server_url(server), 5000, 2, 2, 40};
+    CountriesStatus statuses[4];
+    BSTree *tree = bst_tree_create(0);
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    CountriesStatus status = countries_load_tree_many(&options, countries, 4, tree, statuses);
+    long long elapsed = elapsed_ms(&start);
+
+    ASSERT_EQUAL(statuses[0], COUNTRIES_OK, "Country 0 should succeed after backing off");
+    ASSERT_EQUAL(statuses[1], COUNTRIES_ERR_RATE_LIMITED, "Country 1 should exhaust its retries");
+    ASSERT_EQUAL(statuses[2], COUNTRIES_OK, "Country 2 should succeed after one retry");
+    ASSERT_EQUAL(statuses[3], COUNTRIES_ERR_API, "Unknown country should be an API error");
+    ASSERT_EQUAL(status, COUNTRIES_ERR_RATE_LIMITED, "First failure should be returned");
+
+    // Backoff of 40 ms then 80 ms before the final attempts
+    ASSERT(elapsed >= 120, "Retries should wait for the backoff");
+    ASSERT_EQUAL(mock_server_requests(server), 3 + 3 + 2 + 1, "Unexpected number of attempts");
+    ASSERT_EQUAL(bst_tree_count(tree), 5, "Only successful countries should be merged");
+    ASSERT_NULL(bst_tree_search(tree, "North 1"), "Rate-limited country should contribute nothing");
+
+    bst_tree_destroy(tree);
+    mock_server_stop(server);
+}
+
+// Test: An HTML error page is an HTTP error, not a parse error
+TEST(test_http_error_page) {
+    MockRoute routes[COUNTRY_COUNT];
+    make_routes(routes, 0);
+    routes[0].error_status = 500;
+    MockServer *server = mock_server_start(routes, COUNTRY_COUNT);
+    ASSERT_NOT_NULL(server, "Mock server failed to start");
+
+    const char *countries[] = {names[0], names[1]};
+    CountriesMultiOptions options = {mock_server_url(server), 5000, 2, 2, 40};
+    CountriesStatus statuses[2];
+    BSTree *tree = bst_tree_create(0);
+
+    CountriesStatus status = countries_load_tree_many(&options, countries, 2, tree, statuses);
+
+    ASSERT_EQUAL(statuses[0], COUNTRIES_ERR_HTTP, "Error page should be an HTTP error");
+    ASSERT_EQUAL(statuses[1], COUNTRIES_OK, "Other country should still load");
+    ASSERT_EQUAL(status, COUNTRIES_ERR_HTTP, "First failure should be returned");
+    ASSERT_EQUAL(mock_server_requests(server), 2, "Server errors should not be retried");
+    ASSERT_EQUAL(bst_tree_count(tree), 3, "Only the successful country should be merged");
+
+    bst_tree_destroy(tree);
+    mock_server_stop(server);
+}
+
+// Test: Argument checks and an empty request list
+TEST(test_multi_invalid) {
+    BSTree *tree = bst_tree_create(0);
+    const char *countries[] = {"x"};
+
+    ASSERT_EQUAL(countries_load_tree_many(NULL, countries, 1, NULL, NULL), COUNTRIES_ERR_INVALID,
+                 "NULL tree should be rejected");
+    ASSERT_EQUAL(countries_load_tree_many(NULL, NULL, 1, tree, NULL), COUNTRIES_ERR_INVALID,
+                 "NULL country list should be rejected");
+    ASSERT_EQUAL(countries_load_tree_many(NULL, NULL, 0, tree, NULL), COUNTRIES_OK,
+                 "Empty list should succeed");
+
+    bst_tree_destroy(tree);
+}
+
+// Main test runner
+int main() {
+    print_test_header("Countries Multi-Fetch Integration Tests");
+
+    RUN_TEST(test_concurrent_fetch);
+    RUN_TEST(test_single_connection);
+    RUN_TEST(test_rate_limit_backoff);
+    RUN_TEST(test_http_error_page);
+    RUN_TEST(test_multi_invalid);
+
+    return print_test_summary();
+}
@@ -0,0 +1,32 @@
+#ifndef BST_CHECKS_H
+#define BST_CHECKS_H
+
+#include "bst.h"
+#include <string.h>
+
+// Helper: verify ordering, AVL heights and subtree sizes, returning the height or -2 on violation
+static int check_avl(BSTNode *node, const char *lo, const char *hi) {
+    if (node == NULL) {
+        return -1;
+    }
+    if ((lo && strcmp(bst_node_city(node), lo) <= 0) || (hi && strcmp(bst_node_city(node), hi) >= 0)) {
+        return -2;
+    }
+
+    int left = check_avl(bst_node_left(node), lo, bst_node_city(node));
+    int right = check_avl(bst_node_right(node), bst_node_city(node), hi);
+    if (left == -2 || right == -2 || left - right > 1 || right - left > 1) {
+        return -2;
+    }
+
+    // Subtree sizes must match the children's sizes
+    size_t size = 1 + bst_count_nodes(bst_node_left(node)) + bst_count_nodes(bst_node_right(node));
+    if (size != bst_count_nodes(node)) {
+        return -2;
+    }
+
+    int height = 1 + (left > right ? left : right);
+    return height == bst_height(node) ? height : -2;
+}
+
+#endif // BST_CHECKS_H
@@ -1,51 +1,18 @@
 #include "bst.h"
+#include "test_framework.h"
+#include "bst_checks.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 
-// Test statistics
-static int tests_run = 0;
-static int tests_passed = 0;
-static int tests_failed = 0;
-
-// Color codes for terminal output
-#define COLOR_GREEN "\033[0;32m"
-#define COLOR_RED "\033[0;31m"
-#define COLOR_RESET "\033[0m"
-#define COLOR_YELLOW "\033[0;33m"
-#define COLOR_CYAN "\033[0;36m"
-
-// Test macros
-#define TEST(name) void name()
-#define RUN_TEST(test) do { \
-    printf(COLOR_CYAN "Running: %s" COLOR_RESET "\n", #test); \
-    tests_run++; \
-    test(); \
-    tests_passed++; \
-    printf(COLOR_GREEN "✓ PASSED: %s" COLOR_RESET "\n\n", #test); \
-} while(0)
-
-#define ASSERT(condition, message) do { \
-    if (!(condition)) { \
-        printf(COLOR_RED "✗ FAILED: %s" COLOR_RESET "\n", message); \
-        printf("  at %s:%d\n\n", __FILE__, __LINE__); \
-        tests_failed++; \
-        return; \
-    } \
-} while(0)
-
-#define ASSERT_NULL(ptr, message) ASSERT((ptr) == NULL, message)
-#define ASSERT_NOT_NULL(ptr, message) ASSERT((ptr) != NULL, message)
-#define ASSERT_EQUAL(a, b, message) ASSERT((a) == (b), message)
-#define ASSERT_STR_EQUAL(a, b, message) ASSERT(strcmp((a), (b)) == 0, message)
-
 // Test: Create a single node
 TEST(test_create_node) {
     BSTNode *node = bst_create_node("Stockholm");
     ASSERT_NOT_NULL(node, "Node creation failed");
-    ASSERT_STR_EQUAL(node->city, "Stockholm", "City name mismatch");
-    ASSERT_NULL(node->left, "Left child should be NULL");
-    ASSERT_NULL(node->right, "Right child should be NULL");
+    ASSERT_STR_EQUAL(bst_node_city(node), "Stockholm", "City name mismatch");
+    ASSERT_NULL(bst_node_left(node), "Left child should be NULL");
+    ASSERT_NULL(bst_node_right(node), "Right child should be NULL");
     bst_delete_tree(node);
 }
 
@@ -60,7 +27,7 @@ TEST(test_insert_single) {
     BSTNode *root = NULL;
     root = bst_insert(root, "Paris");
     ASSERT_NOT_NULL(root, "Root should not be NULL after insertion");
-    ASSERT_STR_EQUAL(root->city, "Paris", "Root city mismatch");
+    ASSERT_STR_EQUAL(bst_node_city(root), "Paris", "Root city mismatch");
     bst_delete_tree(root);
 }
 
@@ -72,11 +39,11 @@ TEST(test_insert_multiple) {
     root = bst_insert(root, "Tokyo");
     
     ASSERT_NOT_NULL(root, "Root should not be NULL");
-    ASSERT_STR_EQUAL(root->city, "London", "Root city mismatch");
-    ASSERT_NOT_NULL(root->left, "Left child should exist (Berlin)");
-    ASSERT_STR_EQUAL(root->left->city, "Berlin", "Left child city mismatch");
-    ASSERT_NOT_NULL(root->right, "Right child should exist (Tokyo)");
-    ASSERT_STR_EQUAL(root->right->city, "Tokyo", "Right child city mismatch");
+    ASSERT_STR_EQUAL(bst_node_city(root), "London", "Root city mismatch");
+    ASSERT_NOT_NULL(bst_node_left(root), "Left child should exist (Berlin)");
+    ASSERT_STR_EQUAL(bst_node_city(bst_node_left(root)), "Berlin", "Left child city mismatch");
+    ASSERT_NOT_NULL(bst_node_right(root), "Right child should exist (Tokyo)");
+    ASSERT_STR_EQUAL(bst_node_city(bst_node_right(root)), "Tokyo", "Right child city mismatch");
     
     bst_delete_tree(root);
 }
@@ -105,6 +72,105 @@ TEST(test_insert_null) {
     bst_delete_tree(root);
 }
 
+// Test: Build from a sorted array
+TEST(test_build_sorted) {
+    const char *cities[] = {"Aba", "Abuja", "Enugu", "Ibadan", "Kano", "Lagos", "Warri"};
+    BSTNode *root = bst_build_from_array(cities, 7);
+
+    ASSERT_NOT_NULL(root, "Root should not be NULL");
+    ASSERT_STR_EQUAL(bst_node_city(root), "Ibadan", "Middle city should be the root");
+    ASSERT_EQUAL(bst_count_nodes(root), 7, "Tree should have 7 nodes");
+    ASSERT_EQUAL(bst_height(root), 2, "Seven nodes should form a perfect tree");
+    ASSERT(check_avl(root, NULL, NULL) >= 0, "Tree should be a valid AVL tree");
+
+    bst_delete_tree(root);
+}
+
+// Test: Build from an unsorted array with duplicates and NULL entries
+TEST(test_build_unsorted_duplicates) {
+    const char *cities[] = {"Warri", "Abraka", NULL, "Aba", "Warri", "Lagos", "Abraka", "Kano"};
+    BSTNode *root = bst_build_from_array(cities, 8);
+
+    ASSERT_EQUAL(bst_count_nodes(root), 5, "Duplicates and NULLs should be skipped");
+    ASSERT_STR_EQUAL(bst_node_city(bst_find_min(root)), "Aba", "Minimum should be Aba");
+    ASSERT_NOT_NULL(bst_search(root, "Warri"), "Warri should be found");
+    ASSERT(check_avl(root, NULL, NULL) >= 0, "Tree should be a valid AVL tree");
+
+    // The result is a regular tree that supports further updates
+    root = bst_insert(root, "Yola");
+    root = bst_remove(root, "Aba");
+    ASSERT_EQUAL(bst_count_nodes(root), 5, "Tree should have 5 nodes");
+    ASSERT(check_avl(root, NULL, NULL) >= 0, "Tree should stay balanced");
+
+    bst_delete_tree(root);
+}
+
+// Test: Build from an empty array
+TEST(test_build_empty) {
+    const char *cities[] = {NULL};
+    ASSERT_NULL(bst_build_from_array(NULL, 0), "NULL array should give an empty tree");
+    ASSERT_NULL(bst_build_from_array(cities, 1), "All-NULL array should give an empty tree");
+}
+
+// Test: Build 1M sorted names into a minimum-height tree
+TEST(test_build_large) {
+    const size_t count = 1000000;
+    char *storage = (char *)malloc(count * 16);
+    const char **cities = (const char **)malloc(count * sizeof(*cities));
+    ASSERT(storage && cities, "Allocation failed");
+
+    for (size_t i = 0; i < count; i++) {
+        snprintf(storage + i * 16, 16, "City%07zu", i);
+        cities[i] = storage + i * 16;
+    }
+
+    BSTNode *root = bst_build_from_array(cities, count);
+    free(cities);
+    free(storage);
+
+    ASSERT_EQUAL(bst_count_nodes(root), count, "All names should be in the tree");
+    ASSERT_EQUAL(bst_height(root), 19, "1M nodes should have minimum height 19");
+    ASSERT_NOT_NULL(bst_search(root, "City0999999"), "Last city should be found");
+
+    bst_delete_tree(root);
+}
+
+// Test: Names sharing a long prefix, around the inline storage limit
+TEST(test_long_and_prefix_names) {
+    const char *cities[] = {
+        "Santa",                                 // shorter than the prefix
+        "Santa Cruz",                            // shares the 8-byte prefix
+        "Santa Cruz de Tenerife",                // 22 bytes, stored inline
+        "Santa Cruz de la Sierra",               // 23 bytes, longest inline name
+        "Santa Cruz de la Sierra!",              // 24 bytes, stored out of line
+        "Santa Cruz de Mompox, Bolivar Department",
+        "S\xc3\xa3o Paulo",                       // UTF-8 bytes compare as unsigned
+        "Zaragoza",
+    };
+    const size_t count = sizeof(cities) / sizeof(cities[0]);
+    BSTNode *root = NULL;
+
+    for (size_t i = 0; i < count; i++) {
+        root = bst_insert(root, cities[i]);
+    }
+    ASSERT_EQUAL(bst_count_nodes(root), count, "All names should be distinct");
+    ASSERT(check_avl(root, NULL, NULL) >= 0, "Order should match strcmp");
+
+    for (size_t i = 0; i < count; i++) {
+        BSTNode *found = bst_search(root, cities[i]);
+        ASSERT_NOT_NULL(found, "Every name should be found");
+        ASSERT_STR_EQUAL(bst_node_city(found), cities[i], "Stored name should be intact");
+    }
+    ASSERT_NULL(bst_search(root, "Santa Cruz de la Sierr"), "Prefix of a name is not a match");
+    ASSERT_NULL(bst_search(root, "Santa Cruz de la Sierra!!"), "Extension of a name is not a match");
+
+    // Removing through the node's own name must not confuse the two-child swap
+    while (root) {
+        root = bst_remove(root, bst_node_city(root));
+        ASSERT(check_avl(root, NULL, NULL) >= -1, "Tree should stay valid while draining");
+    }
+}
+
 // Test: Search for existing city
 TEST(test_search_found) {
     BSTNode *root = NULL;
@@ -114,7 +180,7 @@ TEST(test_search_found) {
     
     BSTNode *found = bst_search(root, "Brussels");
     ASSERT_NOT_NULL(found, "Search should find Brussels");
-    ASSERT_STR_EQUAL(found->city, "Brussels", "Found city mismatch");
+    ASSERT_STR_EQUAL(bst_node_city(found), "Brussels", "Found city mismatch");
     
     bst_delete_tree(root);
 }
@@ -159,7 +225,7 @@ TEST(test_find_min) {
     
     BSTNode *min = bst_find_min(root);
     ASSERT_NOT_NULL(min, "Find min should return a node");
-    ASSERT_STR_EQUAL(min->city, "Frankfurt", "Minimum city should be Frankfurt");
+    ASSERT_STR_EQUAL(bst_node_city(min), "Frankfurt", "Minimum city should be Frankfurt");
     
     bst_delete_tree(root);
 }
@@ -282,7 +348,7 @@ TEST(test_height_balanced) {
     bst_delete_tree(root);
 }
 
-// Test: Height of unbalanced tree
+// Test: Height of sorted insertions (rebalanced instead of a linked list)
 TEST(test_height_unbalanced) {
     BSTNode *root = NULL;
     root = bst_insert(root, "A");
@@ -291,11 +357,62 @@ TEST(test_height_unbalanced) {
     root = bst_insert(root, "D");
     
     int height = bst_height(root);
-    ASSERT_EQUAL(height, 3, "Height of unbalanced tree should be 3");
+    ASSERT_EQUAL(height, 2, "Sorted insertions should be rebalanced to height 2");
+    ASSERT_STR_EQUAL(bst_node_city(root), "B", "Root should be B after rotations");
     
     bst_delete_tree(root);
 }
 
+// Test: Height stays logarithmic for 1M pre-sorted names
+TEST(test_height_sorted_large) {
+    const size_t count = 1000000;
+    char city[32];
+    BSTNode *root = NULL;
+
+    for (size_t i = 0; i < count; i++) {
+        snprintf(city, sizeof(city), "City%07zu", i);
+        root = bst_insert(root, city);
+    }
+
+    ASSERT_EQUAL(bst_count_nodes(root), count, "All sorted names should be inserted");
+
+    // AVL trees are at most ~1.44 * log2(n) high; log2(1M) rounds up to 20
+    int log2_count = 0;
+    while (((size_t)1 << log2_count) < count) {
+        log2_count++;
+    }
+    ASSERT(bst_height(root) >= log2_count - 1, "Height below the information-theoretic bound");
+    ASSERT(bst_height(root) <= (int)(1.45 * log2_count), "Height should stay O(log n)");
+
+    snprintf(city, sizeof(city), "City%07zu", count / 2);
+    ASSERT_NOT_NULL(bst_search(root, city), "Middle city should be found");
+
+    bst_delete_tree(root);
+}
+
+// Test: Removals keep the tree balanced
+TEST(test_remove_rebalances) {
+    char city[32];
+    BSTNode *root = NULL;
+
+    for (int i = 0; i < 1024; i++) {
+        snprintf(city, sizeof(city), "City%04d", i);
+        root = bst_insert(root, city);
+    }
+
+    // Remove every city in the lower half, which would leave a lopsided tree
+    for (int i = 0; i < 512; i++) {
+        snprintf(city, sizeof(city), "City%04d", i);
+        root = bst_remove(root, city);
+    }
+
+    ASSERT_EQUAL(bst_count_nodes(root), 512, "Tree should have 512 nodes");
+    ASSERT(bst_height(root) <= 12, "Height should stay logarithmic after removals");
+    ASSERT_STR_EQUAL(bst_node_city(bst_find_min(root)), "City0512", "Minimum should be City0512");
+
+    bst_delete_tree(root);
+}
+
 // Test: Count nodes in empty tree
 TEST(test_count_empty) {
     BSTNode *root = NULL;
@@ -318,6 +435,41 @@ TEST(test_count_nodes) {
     bst_delete_tree(root);
 }
 
+// Test: Rank and select agree with alphabetical order
+TEST(test_rank_select) {
+    const char *sorted[] = {"Bern", "Bremen", "Dresden", "Essen", "Kiel", "Mainz", "Ulm"};
+    BSTNode *root = NULL;
+
+    // Insert in a scrambled order
+    root = bst_insert(root, "Kiel");
+    root = bst_insert(root, "Bern");
+    root = bst_insert(root, "Ulm");
+    root = bst_insert(root, "Essen");
+    root = bst_insert(root, "Mainz");
+    root = bst_insert(root, "Bremen");
+    root = bst_insert(root, "Dresden");
+
+    for (size_t i = 0; i < 7; i++) {
+        ASSERT_EQUAL(bst_rank(root, sorted[i]), i, "Rank should match position");
+        ASSERT_STR_EQUAL(bst_node_city(bst_select(root, i)), sorted[i], "Select should match position");
+    }
+
+    ASSERT_EQUAL(bst_rank(root, "Aachen"), 0, "Name before all cities has rank 0");
+    ASSERT_EQUAL(bst_rank(root, "Hamburg"), 4, "Name in a gap ranks after smaller cities");
+    ASSERT_EQUAL(bst_rank(root, "Zwickau"), 7, "Name after all cities has rank count");
+    ASSERT_EQUAL(bst_rank(root, NULL), 0, "NULL city has rank 0");
+    ASSERT_NULL(bst_select(root, 7), "Select past the end should return NULL");
+    ASSERT_NULL(bst_select(NULL, 0), "Select in empty tree should return NULL");
+
+    // Sizes stay correct through removals
+    root = bst_remove(root, "Essen");
+    ASSERT_EQUAL(bst_rank(root, "Kiel"), 3, "Rank should shift after removal");
+    ASSERT_STR_EQUAL(bst_node_city(bst_select(root, 3)), "Kiel", "Select should shift after removal");
+    ASSERT(check_avl(root, NULL, NULL) >= 0, "Subtree sizes should stay consistent");
+
+    bst_delete_tree(root);
+}
+
 // Test: Complex operations sequence
 TEST(test_complex_operations) {
     BSTNode *root = NULL;
@@ -363,11 +515,12 @@ TEST(test_alphabetical_order) {
     
     // Check that Berlin (alphabetically first) is leftmost
     BSTNode *min = bst_find_min(root);
-    ASSERT_STR_EQUAL(min->city, "Berlin", "Berlin should be the minimum");
+    ASSERT_STR_EQUAL(bst_node_city(min), "Berlin", "Berlin should be the minimum");
     
-    // Verify structure
-    ASSERT_STR_EQUAL(root->city, "Munich", "Root should be Munich");
-    ASSERT_NOT_NULL(root->left, "Munich should have left subtree");
+    // Verify structure (Munich, Berlin, Hamburg triggers a left-right rotation)
+    ASSERT_STR_EQUAL(bst_node_city(root), "Hamburg", "Root should be Hamburg");
+    ASSERT_NOT_NULL(bst_node_left(root), "Hamburg should have left subtree");
+    ASSERT_STR_EQUAL(bst_node_city(bst_node_right(root)), "Munich", "Munich should be the right child");
     
     bst_delete_tree(root);
 }
@@ -393,12 +546,89 @@ TEST(test_delete_null_tree) {
     ASSERT(1, "Deleting NULL tree succeeded");
 }
 
+// Test: Two-child removal moves the successor node instead of copying its name
+TEST(test_remove_relinks_successor) {
+    const char *cities[] = {"Bergen", "Drammen", "Fredrikstad", "Hamar", "Kristiansand", "Molde", "Oslo"};
+    BSTNode *root = bst_build_from_array(cities, 7);
+
+    // Hamar is the root; its successor Kristiansand must survive as the same node
+    ASSERT_STR_EQUAL(bst_node_city(root), "Hamar", "Unexpected root");
+    BSTNode *successor = bst_search(root, "Kristiansand");
+
+    root = bst_remove(root, "Hamar");
+    ASSERT(root == successor, "Successor node should take the removed node's place");
+    ASSERT_STR_EQUAL(bst_node_city(root), "Kristiansand", "Root name mismatch");
+    ASSERT(check_avl(root, NULL, NULL) >= 0, "Tree should be valid");
+    ASSERT_EQUAL(bst_count_nodes(root), 6, "Count mismatch");
+
+    // Successor directly below the removed node
+    root = bst_remove(root, "Drammen");
+    ASSERT(check_avl(root, NULL, NULL) >= 0, "Tree should be valid");
+    ASSERT_NULL(bst_search(root, "Drammen"), "Drammen should be gone");
+    ASSERT_NOT_NULL(bst_search(root, "Fredrikstad"), "Fredrikstad should remain");
+
+    bst_delete_tree(root);
+}
+
+// Test: Batch insert and remove agree with a reference set
+TEST(test_batch_insert_remove) {
+    enum { UNIVERSE = 5000, ROUNDS = 40 };
+    static char names[UNIVERSE][40];
+    static int present[UNIVERSE];
+    int picks[600];
+    const char *batch[600];
+    BSTNode *root = NULL;
+    unsigned long long state = 12345;
+
+    for (int i = 0; i < UNIVERSE; i++) {
+        snprintf(names[i], sizeof(names[i]), i % 4 ? "City %04d" : "Somewhat longer city name %04d", i);
+    }
+
+    for (int round = 0; round < ROUNDS; round++) {
+        // Batches vary from a handful of cities to a large share of the tree
+        size_t n = 1 + (size_t)(round * 15 % 600);
+        int inserting = round % 3 != 2;
+
+        for (size_t i = 0; i < n; i++) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            picks[i] = (int)((state >> 33) % UNIVERSE);
+            batch[i] = names[picks[i]];
+        }
+        batch[n / 2] = NULL;   // NULL entries are skipped
+        for (size_t i = 0; i < n; i++) {
+            if (batch[i]) {
+                present[picks[i]] = inserting;
+            }
+        }
+
+        root = inserting ? bst_insert_batch(root, batch, n) : bst_remove_batch(root, batch, n);
+        ASSERT(check_avl(root, NULL, NULL) >= -1, "Tree should stay a valid AVL tree");
+
+        size_t expected = 0;
+        for (int i = 0; i < UNIVERSE; i++) {
+            ASSERT_EQUAL(bst_search(root, names[i]) != NULL, present[i], "Tree should match the reference");
+            expected += (size_t)present[i];
+        }
+        ASSERT_EQUAL(bst_count_nodes(root), expected, "Count should match the reference");
+    }
+
+    // A whole reversed universe merges into a balanced tree and removes cleanly
+    static const char *all[UNIVERSE];
+    for (int i = 0; i < UNIVERSE; i++) {
+        all[i] = names[UNIVERSE - 1 - i];
+    }
+    root = bst_insert_batch(root, NULL, 0);
+    root = bst_insert_batch(root, all, UNIVERSE);
+    ASSERT_EQUAL(bst_count_nodes(root), UNIVERSE, "Every city should be present");
+    ASSERT(check_avl(root, NULL, NULL) >= 0, "Merged tree should be valid");
+    ASSERT(bst_height(root) <= 17, "Merged tree should stay balanced");
+    root = bst_remove_batch(root, all, UNIVERSE);
+    ASSERT_NULL(root, "Removing every city should empty the tree");
+}
+
 // Main test runner
 int main() {
-    printf("\n");
-    printf("================================================\n");
-    printf("         BST Unit Tests\n");
-    printf("================================================\n\n");
+    print_test_header("BST Unit Tests");
     
     // Run all tests
     RUN_TEST(test_create_node);
@@ -407,6 +637,11 @@ int main() {
     RUN_TEST(test_insert_multiple);
     RUN_TEST(test_insert_duplicate);
     RUN_TEST(test_insert_null);
+    RUN_TEST(test_build_sorted);
+    RUN_TEST(test_build_unsorted_duplicates);
+    RUN_TEST(test_build_empty);
+    RUN_TEST(test_build_large);
+    RUN_TEST(test_long_and_prefix_names);
     RUN_TEST(test_search_found);
     RUN_TEST(test_search_not_found);
     RUN_TEST(test_search_empty);
@@ -423,29 +658,17 @@ int main() {
     RUN_TEST(test_height_single);
     RUN_TEST(test_height_balanced);
     RUN_TEST(test_height_unbalanced);
+    RUN_TEST(test_height_sorted_large);
+    RUN_TEST(test_remove_rebalances);
     RUN_TEST(test_count_empty);
     RUN_TEST(test_count_nodes);
+    RUN_TEST(test_rank_select);
+    RUN_TEST(test_remove_relinks_successor);
+    RUN_TEST(test_batch_insert_remove);
     RUN_TEST(test_complex_operations);
     RUN_TEST(test_alphabetical_order);
     RUN_TEST(test_delete_tree);
     RUN_TEST(test_delete_null_tree);
     
-    // Print summary
-    printf("================================================\n");
-    printf("         Test Summary\n");
-    printf("================================================\n");
-    printf("Tests Run:    %s%d%s\n", COLOR_CYAN, tests_run, COLOR_RESET);
-    printf("Tests Passed: %s%d%s\n", COLOR_GREEN, tests_passed, COLOR_RESET);
-    printf("Tests Failed: %s%d%s\n", tests_failed > 0 ? COLOR_RED : COLOR_GREEN, tests_failed, COLOR_RESET);
-    printf("------------------------------------------------\n");
-    
-    if (tests_failed == 0) {
-        printf("%s✓ All tests passed!%s\n", COLOR_GREEN, COLOR_RESET);
-        printf("================================================\n\n");
-        return 0;
-    } else {
-        printf("%s✗ Some tests failed!%s\n", COLOR_RED, COLOR_RESET);
-        printf("================================================\n\n");
-        return 1;
-    }
+    return print_test_summary();
 }
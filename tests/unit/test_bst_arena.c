@@ -0,0 +1,185 @@
+#include "bst_arena.h"
+#include "test_framework.h"
+#include "bst_checks.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// Test: Create and destroy an empty arena
+TEST(test_arena_create_destroy) {
+    BSTArena *arena = bst_arena_create();
+    ASSERT_NOT_NULL(arena, "Arena creation failed");
+    ASSERT_EQUAL(bst_arena_bytes_reserved(arena), 0, "Empty arena should reserve nothing");
+    bst_arena_destroy(arena);
+    bst_arena_destroy(NULL);
+}
+
+// Test: Insert and search in an arena-backed tree
+TEST(test_arena_insert_search) {
+    BSTArena *arena = bst_arena_create();
+    BSTNode *root = NULL;
+    root = bst_arena_insert(arena, root, "London");
+    root = bst_arena_insert(arena, root, "Berlin");
+    root = bst_arena_insert(arena, root, "Tokyo");
+    root = bst_arena_insert(arena, root, "Berlin");
+
+    ASSERT_EQUAL(bst_count_nodes(root), 3, "Duplicate should not be inserted");
+    ASSERT_NOT_NULL(bst_search(root, "Tokyo"), "Tokyo should be found");
+    ASSERT_NULL(bst_search(root, "Paris"), "Paris should not be found");
+    ASSERT(check_avl(root, NULL, NULL) >= 0, "Tree should be a valid AVL tree");
+
+    bst_arena_destroy(arena);
+}
+
+// Test: Removed slots are recycled by later inserts
+TEST(test_arena_remove_reuses_slots) {
+    BSTArena *arena = bst_arena_create();
+    BSTNode *root = NULL;
+    root = bst_arena_insert(arena, root, "Milan");
+    root = bst_arena_insert(arena, root, "Florence");
+    root = bst_arena_insert(arena, root, "Venice");
+    root = bst_arena_insert(arena, root, "Rome");
+
+    BSTNode *rome = bst_search(root, "Rome");
+    root = bst_arena_remove(arena, root, "Rome");
+    ASSERT_NULL(bst_search(root, "Rome"), "Rome should be removed");
+
+    root = bst_arena_insert(arena, root, "Naples");
+    ASSERT(bst_search(root, "Naples") == rome, "Freed slot should be reused");
+
+    // Two-child removal must keep every other city reachable
+    root = bst_arena_remove(arena, root, "Milan");
+    ASSERT_EQUAL(bst_count_nodes(root), 3, "Tree should have 3 nodes");
+    ASSERT_NOT_NULL(bst_search(root, "Florence"), "Florence should exist");
+    ASSERT_NOT_NULL(bst_search(root, "Venice"), "Venice should exist");
+    ASSERT_NOT_NULL(bst_search(root, "Naples"), "Naples should exist");
+    ASSERT(check_avl(root, NULL, NULL) >= 0, "Tree should be a valid AVL tree");
+
+    bst_arena_destroy(arena);
+}
+
+// Test: Long names stored for recycled slots keep later nodes aligned
+TEST(test_arena_recycled_alignment) {
+    BSTArena *arena = bst_arena_create();
+    BSTNode *root = NULL;
+    char name[64];
+
+    root = bst_arena_insert(arena, root, "Cork");
+    root = bst_arena_insert(arena, root, "Galway");
+    root = bst_arena_remove(arena, root, "Cork");
+
+    // The first insert takes the recycled slot and bumps only its 25-byte
+    // name; the nodes inserted after it are carved right behind that name
+    for (int i = 0; i < 8; i++) {
+        snprintf(name, sizeof(name), "Long City Name Numbers %.*s", i + 1, "ABCDEFGH");
+        root = bst_arena_insert(arena, root, name);
+        BSTNode *node = bst_search(root, name);
+        ASSERT_NOT_NULL(node, "Long name should be found");
+        ASSERT_EQUAL((uintptr_t)node % sizeof(void *), 0, "Node should be aligned");
+        ASSERT_STR_EQUAL(bst_node_city(node), name, "Long name should be intact");
+    }
+    ASSERT(check_avl(root, NULL, NULL) >= 0, "Tree should be a valid AVL tree");
+
+    bst_arena_destroy(arena);
+}
+
+// Test: Adding and removing long names reuses their space instead of growing the arena
+TEST(test_arena_name_churn) {
+    BSTArena *arena = bst_arena_create();
+    BSTNode *root = NULL;
+    char name[700];
+    size_t settled = 0;
+
+    for (int round = 0; round < 2000; round++) {
+        // Lengths from 24 bytes to well past the largest size class
+        size_t len = 24 + (size_t)(round * 37) % 640;
+        memset(name, 'a' + round % 26, len);
+        snprintf(name, len + 1, "%05d", round);
+        name[5] = ' ';
+        name[len] = '\0';
+
+        root = bst_arena_insert(arena, root, name);
+        ASSERT_STR_EQUAL(bst_node_city(bst_search(root, name)), name, "Long name should be intact");
+        root = bst_arena_remove(arena, root, name);
+        ASSERT_NULL(root, "Tree should be empty again");
+        if (round == 999) {
+            settled = bst_arena_bytes_reserved(arena);
+        }
+    }
+
+    ASSERT_EQUAL(bst_arena_bytes_reserved(arena), settled, "Churn should not reserve more memory");
+    bst_arena_destroy(arena);
+}
+
+// Test: Long names spill into dedicated string chunks
+TEST(test_arena_long_names) {
+    static char long_name[40000];
+    BSTArena *arena = bst_arena_create();
+    BSTNode *root = NULL;
+
+    memset(long_name, 'x', sizeof(long_name) - 1);
+    long_name[sizeof(long_name) - 1] = '\0';
+
+    root = bst_arena_insert(arena, root, "Aba");
+    root = bst_arena_insert(arena, root, long_name);
+    root = bst_arena_insert(arena, root, "Zaria");
+
+    BSTNode *found = bst_search(root, long_name);
+    ASSERT_NOT_NULL(found, "Long name should be found");
+    ASSERT_EQUAL(strlen(bst_node_city(found)), sizeof(long_name) - 1, "Long name should be intact");
+    ASSERT_STR_EQUAL(bst_node_city(bst_search(root, "Aba")), "Aba", "Short names should be intact");
+
+    bst_arena_destroy(arena);
+}
+
+// Test: Bulk build and whole-arena teardown with many cities
+TEST(test_arena_bulk) {
+    const size_t count = 100000;
+    static char storage[100000][16];
+    static const char *cities[100000];
+    BSTArena *arena = bst_arena_create();
+
+    for (size_t i = 0; i < count; i++) {
+        snprintf(storage[i], sizeof(storage[i]), "City%06zu", i);
+        cities[i] = storage[i];
+    }
+
+    BSTNode *root = bst_arena_build_from_array(arena, cities, count);
+    ASSERT_EQUAL(bst_count_nodes(root), count, "All cities should be in the tree");
+    ASSERT_EQUAL(bst_height(root), 16, "100K nodes should have minimum height 16");
+
+    for (size_t i = 0; i < count; i += 2) {
+        root = bst_arena_remove(arena, root, cities[i]);
+    }
+    ASSERT_EQUAL(bst_count_nodes(root), count / 2, "Half the cities should remain");
+    ASSERT(check_avl(root, NULL, NULL) >= 0, "Tree should be a valid AVL tree");
+    ASSERT(bst_arena_bytes_reserved(arena) > count * 2 * sizeof(void *), "Arena should own the nodes");
+
+    bst_arena_destroy(arena);
+}
+
+// Test: NULL arguments are rejected
+TEST(test_arena_null) {
+    BSTArena *arena = bst_arena_create();
+    ASSERT_NULL(bst_arena_insert(NULL, NULL, "Oslo"), "NULL arena should not insert");
+    ASSERT_NULL(bst_arena_insert(arena, NULL, NULL), "NULL city should not insert");
+    ASSERT_NULL(bst_arena_remove(arena, NULL, "Oslo"), "Removing from empty tree gives NULL");
+    ASSERT_NULL(bst_arena_build_from_array(NULL, NULL, 0), "NULL arena should not build");
+    bst_arena_destroy(arena);
+}
+
+// Main test runner
+int main() {
+    print_test_header("BST Arena Unit Tests");
+
+    RUN_TEST(test_arena_create_destroy);
+    RUN_TEST(test_arena_insert_search);
+    RUN_TEST(test_arena_remove_reuses_slots);
+    RUN_TEST(test_arena_recycled_alignment);
+    RUN_TEST(test_arena_name_churn);
+    RUN_TEST(test_arena_long_names);
+    RUN_TEST(test_arena_bulk);
+    RUN_TEST(test_arena_null);
+
+    return print_test_summary();
+}
@@ -0,0 +1,181 @@
+#include "bst_collate.h"
+#include "bst_iter.h"
+#include "bst_tree.h"
+#include "test_framework.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Helper: fold into a local buffer
+static const char *fold(const char *city) {
+    static char key[256];
+    bst_collate_fold(city, key, sizeof(key), NULL);
+    return key;
+}
+
+// Helper: cities in scrambled order, with accents, case variants and decomposed forms
+static const char *mixed_cities[] = {
+    "Zürich", "ÅLESUND", "São Paulo", "Évora", "aachen", "Berlin", "Łódź", "Sao Paulo",
+    "Alesund", "evora", "Straße", "Ærøskøbing", "Timișoara", "Sa\xcc\x83o Paulo", "Zagreb", "Évian",
+};
+
+// Test: Keys are case-folded and accent-stripped
+TEST(test_fold_keys) {
+    ASSERT_STR_EQUAL(fold("Ålesund"), "alesund", "Ring above should be stripped");
+    ASSERT_STR_EQUAL(fold("SÃO PAULO"), "sao paulo", "Case and tilde should fold");
+    ASSERT_STR_EQUAL(fold("Sa\xcc\x83o Paulo"), "sao paulo", "Combining accents should be dropped");
+    ASSERT_STR_EQUAL(fold("Straße"), "strasse", "Sharp s should be spelled out");
+    ASSERT_STR_EQUAL(fold("Ærøskøbing"), "aeroskobing", "Ligatures and slashed o should fold");
+    ASSERT_STR_EQUAL(fold("Łódź"), "lodz", "Latin Extended-A should fold");
+    ASSERT_STR_EQUAL(fold("Timișoara"), "timisoara", "Comma-below s should fold");
+    ASSERT_STR_EQUAL(fold("Αθήνα"), "Αθήνα", "Other scripts should be kept as they are");
+    ASSERT_STR_EQUAL(fold("A\xff" "b"), "a\xff" "b", "Invalid UTF-8 should be kept byte for byte");
+    ASSERT_STR_EQUAL(fold(""), "", "Empty city should give an empty key");
+
+    // Truncation reports the full length like snprintf
+    char small[4];
+    ASSERT_EQUAL(bst_collate_fold("Ærøskøbing", small, sizeof(small), NULL), 11, "Full length should be returned");
+    ASSERT_STR_EQUAL(small, "aer", "Key should be truncated and terminated");
+    ASSERT_EQUAL(bst_collate_fold("Évora", NULL, 0, NULL), 5, "Zero capacity should only measure");
+
+    // The key of a prefix is a prefix of the key
+    const char *full = "São Paulo";
+    char prefix_key[64];
+    char full_key[64];
+    bst_collate_fold("Sã", prefix_key, sizeof(prefix_key), NULL);
+    bst_collate_fold(full, full_key, sizeof(full_key), NULL);
+    ASSERT(strncmp(full_key, prefix_key, strlen(prefix_key)) == 0, "Prefix keys should be key prefixes");
+}
+
+// Test: A folded tree orders accented names among their base letters and merges variants
+TEST(test_tree_fold_order) {
+    unsigned flags[] = {BST_TREE_FOLD, BST_TREE_FOLD | BST_TREE_ARENA};
+    const char *expected[] = {"aachen", "Ærøskøbing", "ÅLESUND", "Berlin", "Évian", "Évora",
+                              "Łódź", "São Paulo", "Straße", "Timișoara", "Zagreb", "Zürich"};
+    size_t expected_count = sizeof(expected) / sizeof(expected[0]);
+    size_t total = sizeof(mixed_cities) / sizeof(mixed_cities[0]);
+
+    for (size_t f = 0; f < 2; f++) {
+        BSTree *tree = bst_tree_create(flags[f]);
+        ASSERT_NOT_NULL(tree, "Tree creation failed");
+
+        size_t inserted = 0;
+        for (size_t i = 0; i < total; i++) {
+            int result = bst_tree_insert(tree, mixed_cities[i]);
+            ASSERT(result == 0 || result == 1, "Insert should succeed");
+            inserted += (size_t)result;
+        }
+        ASSERT_EQUAL(inserted, expected_count, "Variants should be merged into one entry");
+
+        for (size_t i = 0; i < expected_count; i++) {
+            ASSERT_STR_EQUAL(bst_node_city(bst_tree_select(tree, i)), expected[i], "Collated order mismatch");
+        }
+
+        // Lookups by any variant find the stored spelling
+        ASSERT_STR_EQUAL(bst_node_city(bst_tree_search(tree, "sao paulo")), "São Paulo", "Folded lookup failed");
+        ASSERT_STR_EQUAL(bst_node_city(bst_tree_search(tree, "ZURICH")), "Zürich", "Folded lookup failed");
+        ASSERT_NULL(bst_tree_search(tree, "Zurich am See"), "Missing city should not be found");
+        ASSERT_EQUAL(bst_tree_rank(tree, "BERLIN"), 3, "Rank should use the key");
+        ASSERT_EQUAL(bst_tree_insert(tree, "Zurich"), 0, "Unaccented variant should be a duplicate");
+
+        ASSERT_EQUAL(bst_tree_remove(tree, "lodz"), 1, "Removal by variant should work");
+        ASSERT_NULL(bst_tree_search(tree, "Łódź"), "Removed city should be gone");
+        ASSERT_EQUAL(bst_tree_count(tree), expected_count - 1, "Count after removal mismatch");
+        ASSERT_EQUAL(bst_tree_set_collation(tree, NULL, NULL), -1, "Collation of a non-empty tree is fixed");
+
+        bst_tree_destroy(tree);
+    }
+}
+
+// Test: Batches, loads and long keys go through the collation too
+TEST(test_tree_fold_batches) {
+    size_t total = sizeof(mixed_cities) / sizeof(mixed_cities[0]);
+    BSTree *tree = bst_tree_create(BST_TREE_FOLD);
+    size_t count;
+
+    ASSERT_EQUAL(bst_tree_insert_batch(tree, mixed_cities, total, &count), 0, "Batch insert should succeed");
+    ASSERT_EQUAL(count, 12, "Batch should merge variants");
+    ASSERT_EQUAL(bst_tree_insert_batch(tree, mixed_cities, total, &count), 0, "Repeated batch should succeed");
+    ASSERT_EQUAL(count, 0, "Repeated batch should add nothing");
+
+    const char *removals[] = {"SAO PAULO", NULL, "zurich", "Nowhere"};
+    ASSERT_EQUAL(bst_tree_remove_batch(tree, removals, 4, &count), 0, "Batch remove should succeed");
+    ASSERT_EQUAL(count, 2, "Batch remove should match by key");
+    ASSERT_NULL(bst_tree_search(tree, "São Paulo"), "Removed city should be gone");
+
+    // Keys longer than the on-stack buffer, and many of them to grow the batch storage
+    char names[300][200];
+    const char *batch[300];
+    for (int i = 0; i < 300; i++) {
+        snprintf(names[i], sizeof(names[i]), "%0150d Ville-Évêque", i);
+        batch[i] = names[i];
+    }
+    ASSERT_EQUAL(bst_tree_load(tree, batch, 300), 0, "Load should succeed");
+    ASSERT_EQUAL(bst_tree_count(tree), 300, "Load should replace the contents");
+    ASSERT_STR_EQUAL(bst_node_city(bst_tree_search(tree, names[123])), names[123], "Long-key lookup failed");
+    ASSERT_EQUAL(bst_tree_insert(tree, names[7]), 0, "Long-key duplicate should be found");
+    ASSERT_EQUAL(bst_tree_remove(tree, names[7]), 1, "Long-key removal failed");
+
+    // Raw functions on the root work in key space
+    bst_tree_load(tree, mixed_cities, total);
+    ASSERT_EQUAL(bst_count_prefix(bst_tree_root(tree), fold("Ev")), 2, "Prefix count should use keys");
+    BSTIter it;
+    bst_iter_init(&it, bst_tree_root(tree));
+    ASSERT_STR_EQUAL(bst_iter_seek_prefix(&it, fold("SÃ")), "São Paulo", "Prefix seek should return the city");
+    bst_iter_release(&it);
+
+    bst_tree_destroy(tree);
+}
+
+// Helper: reverse byte order, to check custom collations are used as given
+static size_t reverse_collate(const char *city, char *key, size_t capacity, void *ctx) {
+    size_t len = strlen(city);
+    (void)ctx;
+
+    for (size_t i = 0; i < len && i + 1 < capacity; i++) {
+        key[i] = (char)(0xFF - (unsigned char)city[i]);
+    }
+    if (capacity > 0) {
+        key[len < capacity ? len : capacity - 1] = '\0';
+    }
+    return len;
+}
+
+// Test: A custom collation orders the tree and its output
+TEST(test_tree_custom_collation) {
+    BSTree *tree = bst_tree_create(0);
+    ASSERT_EQUAL(bst_tree_set_collation(tree, reverse_collate, NULL), 0, "Empty tree should accept a collation");
+
+    const char *cities[] = {"Bern", "Athens", "Cairo"};
+    ASSERT_EQUAL(bst_tree_load(tree, cities, 3), 0, "Load should succeed");
+    ASSERT_STR_EQUAL(bst_node_city(bst_tree_select(tree, 0)), "Cairo", "Custom order mismatch");
+    ASSERT_STR_EQUAL(bst_node_city(bst_tree_select(tree, 2)), "Athens", "Custom order mismatch");
+
+    // Dumps print the cities, not their keys
+    FILE *out = tmpfile();
+    char buffer[64];
+    BSTWriter writer;
+    bst_writer_init_fd(&writer, fileno(out), buffer, sizeof(buffer));
+    ASSERT_EQUAL(bst_write_inorder(bst_tree_root(tree), &writer), 0, "Dump should succeed");
+    bst_writer_flush(&writer);
+
+    char text[64] = {0};
+    rewind(out);
+    ASSERT(fread(text, 1, sizeof(text) - 1, out) > 0, "Dump should produce output");
+    ASSERT_STR_EQUAL(text, "Cairo\nBern\nAthens\n", "Dump should list cities in collated order");
+    fclose(out);
+
+    ASSERT_EQUAL(bst_tree_set_collation(NULL, NULL, NULL), -1, "NULL tree should be rejected");
+    bst_tree_destroy(tree);
+}
+
+int main() {
+    print_test_header("BST Collation Unit Tests");
+
+    RUN_TEST(test_fold_keys);
+    RUN_TEST(test_tree_fold_order);
+    RUN_TEST(test_tree_fold_batches);
+    RUN_TEST(test_tree_custom_collation);
+
+    return print_test_summary();
+}
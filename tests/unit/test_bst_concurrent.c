@@ -0,0 +1,241 @@
+#include "bst_concurrent.h"
+#include "bst_snapshot.h"
+#include "test_framework.h"
+#include "bst_checks.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+// Test: Single-threaded insert, remove and lookup
+TEST(test_concurrent_basic) {
+    BSTConcurrent *tree = bst_concurrent_create();
+    ASSERT_NOT_NULL(tree, "Tree creation failed");
+
+    BSTReader *reader = bst_reader_register(tree);
+    ASSERT_NOT_NULL(reader, "Reader registration failed");
+    ASSERT_NULL(bst_reader_enter(reader), "Empty tree should have no root");
+    bst_reader_exit(reader);
+
+    ASSERT_EQUAL(bst_concurrent_insert(tree, "Paris"), 1, "New city should be inserted");
+    ASSERT_EQUAL(bst_concurrent_insert(tree, "Paris"), 0, "Duplicate should report 0");
+    ASSERT_EQUAL(bst_concurrent_insert(tree, NULL), -1, "NULL city should be rejected");
+    ASSERT_EQUAL(bst_concurrent_insert(NULL, "Paris"), -1, "NULL tree should be rejected");
+    ASSERT_EQUAL(bst_concurrent_remove(tree, "Lyon"), 0, "Missing city should report 0");
+    ASSERT_EQUAL(bst_reader_contains(reader, "Paris"), 1, "Paris should be present");
+
+    // Long names exercise the shared heap name when nodes are copied
+    char city[64];
+    for (int i = 0; i < 2000; i++) {
+        snprintf(city, sizeof(city), "%s%04d", i % 2 ? "City" : "A rather long city name number ", i);
+        ASSERT_EQUAL(bst_concurrent_insert(tree, city), 1, "Insert should succeed");
+    }
+    for (int i = 0; i < 2000; i += 3) {
+        snprintf(city, sizeof(city), "%s%04d", i % 2 ? "City" : "A rather long city name number ", i);
+        ASSERT_EQUAL(bst_concurrent_remove(tree, city), 1, "Remove should succeed");
+    }
+
+    BSTNode *root = bst_reader_enter(reader);
+    ASSERT_EQUAL(bst_count_nodes(root), 1334, "Count should be maintained");
+    ASSERT(check_avl(root, NULL, NULL) >= 0, "Published version should be valid");
+    ASSERT_NOT_NULL(bst_search(root, "City0001"), "City0001 should be present");
+    ASSERT_NULL(bst_search(root, "City0003"), "City0003 should be removed");
+    ASSERT_NOT_NULL(bst_search(root, "A rather long city name number 0002"), "Long name should be present");
+    bst_reader_exit(reader);
+
+    bst_reader_unregister(reader);
+    bst_concurrent_destroy(tree);
+    bst_concurrent_destroy(NULL);
+}
+
+// Test: A read section keeps its version intact while writers move on
+TEST(test_concurrent_versions) {
+    BSTConcurrent *tree = bst_concurrent_create();
+    BSTReader *reader = bst_reader_register(tree);
+    char city[32];
+
+    for (int i = 0; i < 500; i++) {
+        snprintf(city, sizeof(city), "City%04d", i);
+        bst_concurrent_insert(tree, city);
+    }
+
+    BSTNode *old_root = bst_reader_enter(reader);
+
+    for (int i = 0; i < 500; i += 2) {
+        snprintf(city, sizeof(city), "City%04d", i);
+        ASSERT_EQUAL(bst_concurrent_remove(tree, city), 1, "Remove should succeed");
+    }
+    ASSERT_EQUAL(bst_concurrent_insert(tree, "Zurich"), 1, "Insert should succeed");
+
+    // The old version still has everything, and nothing was freed under it
+    ASSERT_EQUAL(bst_count_nodes(old_root), 500, "Old version should be unchanged");
+    ASSERT(check_avl(old_root, NULL, NULL) >= 0, "Old version should be valid");
+    ASSERT_NOT_NULL(bst_search(old_root, "City0000"), "Old version should keep removed cities");
+    ASSERT_NULL(bst_search(old_root, "Zurich"), "Old version should not see new cities");
+    ASSERT(bst_concurrent_pending(tree) > 0, "Replaced nodes should wait for the reader");
+    bst_reader_exit(reader);
+
+    BSTNode *new_root = bst_reader_enter(reader);
+    ASSERT_EQUAL(bst_count_nodes(new_root), 251, "New version should have the updates");
+    ASSERT(check_avl(new_root, NULL, NULL) >= 0, "New version should be valid");
+    bst_reader_exit(reader);
+
+    // With no reader active, a few more writes let the epoch advance and free the backlog
+    for (int i = 0; i < 4; i++) {
+        bst_concurrent_insert(tree, "Tmp");
+        bst_concurrent_remove(tree, "Tmp");
+    }
+    ASSERT(bst_concurrent_pending(tree) < 100, "Retired nodes should be reclaimed");
+
+    bst_reader_unregister(reader);
+    bst_concurrent_destroy(tree);
+}
+
+// Test: Reader slots are limited and reusable
+TEST(test_concurrent_reader_slots) {
+    BSTConcurrent *tree = bst_concurrent_create();
+    BSTReader *readers[BST_CONCURRENT_MAX_READERS];
+
+    for (int i = 0; i < BST_CONCURRENT_MAX_READERS; i++) {
+        readers[i] = bst_reader_register(tree);
+        ASSERT_NOT_NULL(readers[i], "Registration within the limit should succeed");
+    }
+    ASSERT_NULL(bst_reader_register(tree), "Registration past the limit should fail");
+
+    bst_reader_unregister(readers[7]);
+    readers[7] = bst_reader_register(tree);
+    ASSERT_NOT_NULL(readers[7], "A released slot should be reusable");
+
+    for (int i = 0; i < BST_CONCURRENT_MAX_READERS; i++) {
+        bst_reader_unregister(readers[i]);
+    }
+    ASSERT_NULL(bst_reader_register(NULL), "NULL tree should be rejected");
+    ASSERT_EQUAL(bst_reader_contains(NULL, "Paris"), 0, "NULL reader should find nothing");
+
+    bst_concurrent_destroy(tree);
+}
+
+#define STABLE_CITIES 512
+#define CHURN_CITIES 256
+#define CHURN_ROUNDS 40
+#define READER_THREADS 6
+
+typedef struct StressState {
+    BSTConcurrent *tree;
+    atomic_int writer_done;
+    atomic_int failures;
+} StressState;
+
+// Writer: repeatedly adds and removes a churn set around the stable cities
+static void *stress_writer(void *arg) {
+    StressState *state = (StressState *)arg;
+    char city[32];
+
+    for (int round = 0; round < CHURN_ROUNDS; round++) {
+        for (int i = 0; i < CHURN_CITIES; i++) {
+            snprintf(city, sizeof(city), "Churn%04d", (i * 37 + round) % CHURN_CITIES);
+            if (bst_concurrent_insert(state->tree, city) < 0) {
+                atomic_fetch_add(&state->failures, 1);
+            }
+        }
+        for (int i = 0; i < CHURN_CITIES; i++) {
+            snprintf(city, sizeof(city), "Churn%04d", (i * 53 + round) % CHURN_CITIES);
+            if (bst_concurrent_remove(state->tree, city) != 1) {
+                atomic_fetch_add(&state->failures, 1);
+            }
+        }
+    }
+
+    atomic_store(&state->writer_done, 1);
+    return NULL;
+}
+
+// Reader: stable cities must always be visible and every version must be a valid AVL tree
+static void *stress_reader(void *arg) {
+    StressState *state = (StressState *)arg;
+    BSTReader *reader = bst_reader_register(state->tree);
+    char city[32];
+    unsigned iteration = 0;
+
+    if (!reader) {
+        atomic_fetch_add(&state->failures, 1);
+        return NULL;
+    }
+
+    while (!atomic_load(&state->writer_done)) {
+        snprintf(city, sizeof(city), "Stable%04u", (iteration * 131) % STABLE_CITIES);
+        if (!bst_reader_contains(reader, city)) {
+            atomic_fetch_add(&state->failures, 1);
+        }
+
+        if (iteration % 64 == 0) {
+            BSTNode *root = bst_reader_enter(reader);
+            size_t count = bst_count_nodes(root);
+            if (check_avl(root, NULL, NULL) < 0 || count < STABLE_CITIES ||
+                count > STABLE_CITIES + CHURN_CITIES) {
+                atomic_fetch_add(&state->failures, 1);
+            }
+
+            // Other readers may be freezing the same version at the same time
+            BSTSnapshot *snapshot = bst_freeze(root);
+            if (!snapshot || bst_snapshot_count(snapshot) != count) {
+                atomic_fetch_add(&state->failures, 1);
+            }
+            bst_snapshot_free(snapshot);
+            bst_reader_exit(reader);
+        }
+        iteration++;
+    }
+
+    bst_reader_unregister(reader);
+    return NULL;
+}
+
+// Test: Readers run against a churning writer without locks or torn versions
+TEST(test_concurrent_stress) {
+    StressState state;
+    pthread_t writer;
+    pthread_t readers[READER_THREADS];
+    char city[32];
+
+    state.tree = bst_concurrent_create();
+    atomic_init(&state.writer_done, 0);
+    atomic_init(&state.failures, 0);
+
+    for (int i = 0; i < STABLE_CITIES; i++) {
+        snprintf(city, sizeof(city), "Stable%04d", i);
+        bst_concurrent_insert(state.tree, city);
+    }
+
+    for (int i = 0; i < READER_THREADS; i++) {
+        pthread_create(&readers[i], NULL, stress_reader, &state);
+    }
+    pthread_create(&writer, NULL, stress_writer, &state);
+
+    pthread_join(writer, NULL);
+    for (int i = 0; i < READER_THREADS; i++) {
+        pthread_join(readers[i], NULL);
+    }
+
+    ASSERT_EQUAL(atomic_load(&state.failures), 0, "Readers and writer should see consistent versions");
+
+    BSTReader *reader = bst_reader_register(state.tree);
+    BSTNode *root = bst_reader_enter(reader);
+    ASSERT_EQUAL(bst_count_nodes(root), STABLE_CITIES, "Only the stable cities should remain");
+    ASSERT(check_avl(root, NULL, NULL) >= 0, "Final version should be valid");
+    bst_reader_exit(reader);
+    bst_reader_unregister(reader);
+
+    bst_concurrent_destroy(state.tree);
+}
+
+int main() {
+    print_test_header("BST Concurrent Unit Tests");
+
+    RUN_TEST(test_concurrent_basic);
+    RUN_TEST(test_concurrent_versions);
+    RUN_TEST(test_concurrent_reader_slots);
+    RUN_TEST(test_concurrent_stress);
+
+    return print_test_summary();
+}
@@ -0,0 +1,272 @@
+#include "bst_intern.h"
+#include "bst_tree.h"
+#include "test_framework.h"
+#include "bst_checks.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define THREAD_COUNT 4
+#define THREAD_ROUNDS 200
+#define THREAD_NAMES 64
+
+// Test: Equal strings share one copy; the last release frees it
+TEST(test_intern_share_release) {
+    BSTInternStats stats;
+    char buffer[] = "Santa Cruz de la Sierra";
+
+    const char *a = bst_intern(buffer, strlen(buffer));
+    const char *b = bst_intern("Santa Cruz de la Sierra", strlen(buffer));
+    const char *c = bst_intern("Santa Cruz de Tenerife", 22);
+    ASSERT_NOT_NULL(a, "Interning should succeed");
+    ASSERT(a == b, "Equal strings should share one pointer");
+    ASSERT(a != c, "Different strings should not");
+    ASSERT(a != buffer, "The interner should keep its own copy");
+    ASSERT_STR_EQUAL(c, "Santa Cruz de Tenerife", "Copy should be terminated");
+    ASSERT_NULL(bst_intern(NULL, 0), "NULL should be rejected");
+
+    bst_intern_stats(&stats);
+    ASSERT_EQUAL(stats.strings, 2, "Two distinct strings should be stored");
+    ASSERT_EQUAL(stats.references, 3, "Three references should be held");
+    ASSERT_EQUAL(stats.bytes, 24 + 23, "Bytes should count each string once");
+    ASSERT_EQUAL(stats.bytes_saved, 24, "The second reference should save a copy");
+    ASSERT(stats.bytes_reserved > 0, "Storage should be reserved");
+
+    ASSERT(bst_intern_retain(a) == a, "Retain should return its argument");
+    bst_intern_release(a);
+    bst_intern_release(b);
+    bst_intern_stats(&stats);
+    ASSERT_EQUAL(stats.strings, 2, "A referenced string should stay");
+    ASSERT_STR_EQUAL(a, "Santa Cruz de la Sierra", "A referenced string should be intact");
+
+    const char *last[] = {a, NULL, c};
+    bst_intern_release_many(last, 3);
+    bst_intern_release(NULL);
+    bst_intern_stats(&stats);
+    ASSERT_EQUAL(stats.strings, 0, "Every string should be freed");
+    ASSERT_EQUAL(stats.references, 0, "No reference should be left");
+    ASSERT_EQUAL(stats.bytes_reserved, 0, "Storage should be returned once empty");
+}
+
+/**
+ * Fill buffer with the i-th test string and return its length
+ * Lengths cycle up to ~1200 bytes, so some spans have no size class; the
+ * index bytes at the front make every string distinct and embed NULs.
+ */
+static size_t make_name(int i, char *buffer) {
+    size_t len = (size_t)(i * 37) % 1200 + sizeof(i);
+
+    memset(buffer, 'a' + i % 26, len);
+    memcpy(buffer, &i, sizeof(i));
+    return len;
+}
+
+// Test: Many strings of every size class, embedded NUL bytes, reuse of freed spans
+TEST(test_intern_many) {
+    enum { COUNT = 5000 };
+    const char **strs = (const char **)malloc(COUNT * sizeof(*strs));
+    char buffer[2048];
+    BSTInternStats stats;
+
+    for (int i = 0; i < COUNT; i++) {
+        size_t len = make_name(i, buffer);
+        strs[i] = bst_intern(buffer, len);
+        ASSERT_NOT_NULL(strs[i], "Interning should succeed");
+    }
+    bst_intern_stats(&stats);
+    ASSERT_EQUAL(stats.strings, COUNT, "Every string should be distinct");
+
+    // Free every other string and intern them again
+    for (int i = 0; i < COUNT; i += 2) {
+        bst_intern_release(strs[i]);
+    }
+    for (int i = 0; i < COUNT; i += 2) {
+        size_t len = make_name(i, buffer);
+        strs[i] = bst_intern(buffer, len);
+    }
+    for (int i = 0; i < COUNT; i++) {
+        size_t len = make_name(i, buffer);
+        ASSERT(bst_intern(buffer, len) == strs[i], "Lookups should find the stored copy");
+        ASSERT(memcmp(strs[i], buffer, len) == 0 && strs[i][len] == '\0', "Bytes should survive reuse");
+        bst_intern_release(strs[i]);
+    }
+
+    bst_intern_release_many(strs, COUNT);
+    bst_intern_stats(&stats);
+    ASSERT_EQUAL(stats.strings, 0, "Every string should be freed");
+    ASSERT_EQUAL(stats.bytes_reserved, 0, "Storage should be returned once empty");
+    free(strs);
+}
+
+// Test: Interned trees share long names, keep short ones inline, and release on destroy
+TEST(test_intern_trees) {
+    const char *cities[] = {"San Jose", "Santa Cruz de la Sierra", "Victoria",
+                            "San Cristobal de las Casas", "Llanfairpwllgwyngyll Town"};
+    BSTInternStats stats;
+    BSTree *trees[3];
+
+    for (int t = 0; t < 3; t++) {
+        trees[t] = bst_tree_create(t == 2 ? BST_TREE_INTERN | BST_TREE_HASH : BST_TREE_INTERN);
+        ASSERT_NOT_NULL(trees[t], "Tree creation failed");
+    }
+    ASSERT_EQUAL(bst_tree_load(trees[0], cities, 5), 0, "Load should succeed");
+    for (int i = 4; i >= 0; i--) {
+        ASSERT_EQUAL(bst_tree_insert(trees[1], cities[i]), 1, "Insert should succeed");
+    }
+    ASSERT_EQUAL(bst_tree_insert_batch(trees[2], cities, 5, NULL), 0, "Batch should succeed");
+
+    // The two names of 24 bytes or more are stored once for all three trees
+    bst_intern_stats(&stats);
+    ASSERT_EQUAL(stats.strings, 2, "Each long name should be stored once");
+    ASSERT_EQUAL(stats.references, 6, "Each tree should hold its own references");
+
+    for (int i = 0; i < 5; i++) {
+        const char *first = bst_node_city(bst_tree_search(trees[0], cities[i]));
+        ASSERT_STR_EQUAL(first, cities[i], "Every city should be found");
+        for (int t = 1; t < 3; t++) {
+            const char *other = bst_node_city(bst_tree_search(trees[t], cities[i]));
+            ASSERT_STR_EQUAL(other, cities[i], "Every city should be found");
+            if (strlen(cities[i]) >= 24) {
+                ASSERT(other == first, "Long names should be shared");
+            } else {
+                ASSERT(other != first, "Short names should stay inside their nodes");
+            }
+        }
+
+        // A name taken from one tree is found in another
+        ASSERT(bst_tree_search(trees[2], first) != NULL, "Shared names should be found");
+        ASSERT_EQUAL(bst_tree_insert(trees[1], first), 0, "Shared names should be duplicates");
+    }
+
+    // Removing drops the node's reference; re-adding takes a new one
+    ASSERT_EQUAL(bst_tree_remove(trees[1], "San Cristobal de las Casas"), 1, "Remove should succeed");
+    bst_intern_stats(&stats);
+    ASSERT_EQUAL(stats.references, 5, "The removed node's reference should be dropped");
+    ASSERT_EQUAL(bst_tree_insert(trees[1], "San Cristobal de las Casas"), 1, "Insert should succeed");
+    ASSERT(check_avl(bst_tree_root(trees[1]), NULL, NULL) >= 0, "Tree should be valid");
+    ASSERT_EQUAL(bst_tree_count(trees[1]), 5, "Count should be maintained");
+
+    bst_intern_stats(&stats);
+    ASSERT_EQUAL(stats.references, 6, "The re-added node should hold one reference");
+
+    // Reloading with two short names swaps in a new arena and drops the old nodes' references
+    ASSERT_EQUAL(bst_tree_load(trees[0], cities, 2), 0, "Reload should succeed");
+    bst_intern_stats(&stats);
+    ASSERT_EQUAL(stats.strings, 2, "Names still in use should stay");
+    ASSERT_EQUAL(stats.references, 4, "The old nodes' references should be dropped");
+
+    for (int t = 0; t < 3; t++) {
+        bst_tree_destroy(trees[t]);
+    }
+    bst_intern_stats(&stats);
+    ASSERT_EQUAL(stats.strings, 0, "Destroying the trees should free every name");
+    ASSERT_EQUAL(stats.bytes_reserved, 0, "Storage should be returned once empty");
+}
+
+// Test: Collated trees intern the sort key together with the city
+TEST(test_intern_collated) {
+    BSTInternStats stats;
+    BSTree *upper = bst_tree_create(BST_TREE_INTERN | BST_TREE_FOLD);
+    BSTree *lower = bst_tree_create(BST_TREE_INTERN | BST_TREE_FOLD);
+
+    ASSERT_EQUAL(bst_tree_insert(upper, "Ålesund"), 1, "Insert should succeed");
+    ASSERT_EQUAL(bst_tree_insert(lower, "Ålesund"), 1, "Insert should succeed");
+    ASSERT_EQUAL(bst_tree_insert(lower, "alesund"), 0, "Folded duplicate should be rejected");
+    ASSERT_EQUAL(bst_tree_insert(lower, "Bergen"), 1, "Insert should succeed");
+
+    BSTNode *a = bst_tree_search(upper, "ALESUND");
+    BSTNode *b = bst_tree_search(lower, "alesund");
+    ASSERT_NOT_NULL(a, "Folded search should match");
+    ASSERT_STR_EQUAL(bst_node_city(a), "Ålesund", "City should be kept as inserted");
+    ASSERT(bst_node_city(a) == bst_node_city(b), "Collated names should be shared");
+
+    bst_intern_stats(&stats);
+    ASSERT_EQUAL(stats.strings, 2, "Sort key and city should be interned together");
+
+    bst_tree_destroy(upper);
+    bst_tree_destroy(lower);
+    bst_intern_stats(&stats);
+    ASSERT_EQUAL(stats.strings, 0, "Destroying the trees should free every name");
+}
+
+// Test: Adding and removing cities over and over does not accumulate references
+TEST(test_intern_churn) {
+    enum { ROUNDS = 100000, LIVE = 64 };
+    BSTree *tree = bst_tree_create(BST_TREE_INTERN | BST_TREE_HASH);
+    BSTInternStats stats;
+    char name[64];
+
+    ASSERT_NOT_NULL(tree, "Tree creation failed");
+    for (int i = 0; i < ROUNDS; i++) {
+        snprintf(name, sizeof(name), "Churning city name number %d", i);
+        ASSERT_EQUAL(bst_tree_insert(tree, name), 1, "Insert should succeed");
+        if (i >= LIVE) {
+            snprintf(name, sizeof(name), "Churning city name number %d", i - LIVE);
+            ASSERT_EQUAL(bst_tree_remove(tree, name), 1, "Remove should succeed");
+        }
+    }
+
+    bst_intern_stats(&stats);
+    ASSERT_EQUAL(stats.strings, LIVE, "Only names in the tree should be stored");
+    ASSERT_EQUAL(stats.references, LIVE, "Only nodes in the tree should hold references");
+
+    for (int i = ROUNDS - LIVE; i < ROUNDS; i++) {
+        snprintf(name, sizeof(name), "Churning city name number %d", i);
+        bst_tree_remove(tree, name);
+    }
+    ASSERT_EQUAL(bst_tree_count(tree), 0, "Tree should be empty");
+    bst_intern_stats(&stats);
+    ASSERT_EQUAL(stats.references, 0, "An empty tree should hold no references");
+    ASSERT_EQUAL(stats.bytes_reserved, 0, "Storage should be returned once empty");
+
+    bst_tree_destroy(tree);
+}
+
+/**
+ * Intern and release a shared set of names repeatedly
+ */
+static void *intern_worker(void *arg) {
+    const char **held = (const char **)arg;
+    char name[64];
+
+    for (int round = 0; round < THREAD_ROUNDS; round++) {
+        for (int i = 0; i < THREAD_NAMES; i++) {
+            snprintf(name, sizeof(name), "Shared city name number %d", i);
+            held[i] = bst_intern(name, strlen(name));
+        }
+        bst_intern_release_many(held, THREAD_NAMES);
+    }
+    return NULL;
+}
+
+// Test: Threads interning the same names concurrently
+TEST(test_intern_threads) {
+    static const char *held[THREAD_COUNT][THREAD_NAMES];
+    pthread_t threads[THREAD_COUNT];
+    BSTInternStats stats;
+
+    for (int i = 0; i < THREAD_COUNT; i++) {
+        pthread_create(&threads[i], NULL, intern_worker, held[i]);
+    }
+    for (int i = 0; i < THREAD_COUNT; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    bst_intern_stats(&stats);
+    ASSERT_EQUAL(stats.strings, 0, "Every name should be released");
+    ASSERT_EQUAL(stats.references, 0, "No reference should be left");
+}
+
+int main() {
+    print_test_header("BST Intern Unit Tests");
+
+    RUN_TEST(test_intern_share_release);
+    RUN_TEST(test_intern_many);
+    RUN_TEST(test_intern_trees);
+    RUN_TEST(test_intern_collated);
+    RUN_TEST(test_intern_churn);
+    RUN_TEST(test_intern_threads);
+
+    return print_test_summary();
+}
@@ -0,0 +1,218 @@
+#include "bst.h"
+#include "bst_iter.h"
+#include "test_framework.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CITY_COUNT 3000
+
+// Helper: sorted reference names, a third of them too long to store inline
+static char names[CITY_COUNT][64];
+
+static int compare_names(const void *a, const void *b) {
+    return strcmp((const char *)a, (const char *)b);
+}
+
+// Helper: tree of CITY_COUNT cities inserted in scrambled order, plus the sorted reference
+static BSTNode *build_cities(void) {
+    BSTNode *root = NULL;
+
+    for (int i = 0; i < CITY_COUNT; i++) {
+        int id = (i * 7919) % CITY_COUNT;
+        snprintf(names[i], sizeof(names[i]), "%s%04d", id % 3 ? "San " : "Santa Cruz de la Sierra ", id);
+        if (id % 5 == 0) {
+            names[i][0] = 'P';
+        }
+        root = bst_insert(root, names[i]);
+    }
+    qsort(names, CITY_COUNT, sizeof(names[0]), compare_names);
+    return root;
+}
+
+// Helper: brute-force count of reference names in [lo, hi)
+static size_t reference_range(const char *lo, const char *hi) {
+    size_t count = 0;
+    for (int i = 0; i < CITY_COUNT; i++) {
+        if ((!lo || strcmp(names[i], lo) >= 0) && (!hi || strcmp(names[i], hi) < 0)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+static size_t reference_prefix(const char *prefix) {
+    size_t count = 0;
+    for (int i = 0; i < CITY_COUNT; i++) {
+        if (strncmp(names[i], prefix, strlen(prefix)) == 0) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// Test: Seek lands on the lower bound and next/prev walk the sorted order
+TEST(test_iter_seek_and_step) {
+    BSTNode *root = build_cities();
+    BSTIter it;
+    bst_iter_init(&it, root);
+
+    ASSERT_NULL(bst_iter_current(&it), "Fresh iterator should not be positioned");
+    ASSERT_STR_EQUAL(bst_iter_seek(&it, NULL), names[0], "NULL seek should land on the first city");
+
+    // Forward over everything
+    int index = 0;
+    for (const char *city = bst_iter_current(&it); city; city = bst_iter_next(&it)) {
+        ASSERT_STR_EQUAL(city, names[index], "Forward order mismatch");
+        index++;
+    }
+    ASSERT_EQUAL(index, CITY_COUNT, "Forward walk should visit every city");
+    ASSERT_NULL(bst_iter_current(&it), "Iterator should be exhausted");
+    ASSERT_NULL(bst_iter_next(&it), "Next on an exhausted iterator should stay NULL");
+
+    // Backward from the last rank
+    index = CITY_COUNT - 1;
+    for (const char *city = bst_iter_seek_rank(&it, CITY_COUNT - 1); city; city = bst_iter_prev(&it)) {
+        ASSERT_STR_EQUAL(city, names[index], "Backward order mismatch");
+        index--;
+    }
+    ASSERT_EQUAL(index, -1, "Backward walk should visit every city");
+
+    // Exact hits, keys between cities, and past the end
+    for (int i = 0; i < CITY_COUNT; i += 97) {
+        char key[sizeof(names[0]) + 1];   // Room for the name and the "!"
+        ASSERT_STR_EQUAL(bst_iter_seek(&it, names[i]), names[i], "Exact seek mismatch");
+        snprintf(key, sizeof(key), "%.*s!", (int)sizeof(names[0]) - 1, names[i]);
+        const char *after = bst_iter_seek(&it, key);
+        if (i + 1 < CITY_COUNT) {
+            ASSERT_STR_EQUAL(after, names[i + 1], "Seek between cities should land on the next one");
+            ASSERT_STR_EQUAL(bst_iter_prev(&it), names[i], "Prev should return to the lower city");
+        }
+    }
+    ASSERT_NULL(bst_iter_seek(&it, "zzz"), "Seek past the end should find nothing");
+    ASSERT_NULL(bst_iter_seek_rank(&it, CITY_COUNT), "Rank past the end should find nothing");
+
+    bst_iter_release(&it);
+    bst_delete_tree(root);
+}
+
+// Test: Prefix seeks stop at the edges of the matching cities
+TEST(test_iter_prefix) {
+    BSTNode *root = build_cities();
+    const char *prefixes[] = {"San", "Santa", "San 1", "P", "Santa Cruz de la Sierra 0", "", "Q", "Sao"};
+    BSTIter it;
+    bst_iter_init(&it, root);
+
+    for (size_t p = 0; p < sizeof(prefixes) / sizeof(prefixes[0]); p++) {
+        const char *prefix = prefixes[p];
+        size_t expected = reference_prefix(prefix);
+        size_t seen = 0;
+        const char *last = NULL;
+
+        for (const char *city = bst_iter_seek_prefix(&it, prefix); city; city = bst_iter_next(&it)) {
+            ASSERT(strncmp(city, prefix, strlen(prefix)) == 0, "Prefix iteration left the prefix");
+            last = city;
+            seen++;
+        }
+        ASSERT_EQUAL(seen, expected, "Prefix iteration count mismatch");
+        ASSERT_EQUAL(bst_count_prefix(root, prefix), expected, "Prefix count mismatch");
+
+        // Step to the last match without leaving it, then walk back to the first
+        if (last) {
+            size_t back = 0;
+            bst_iter_seek_prefix(&it, prefix);
+            for (size_t i = 1; i < expected; i++) {
+                bst_iter_next(&it);
+            }
+            ASSERT_STR_EQUAL(bst_iter_current(&it), last, "Stepping should reach the last match");
+            for (const char *city = bst_iter_current(&it); city; city = bst_iter_prev(&it)) {
+                back++;
+            }
+            ASSERT_EQUAL(back, expected, "Backward prefix iteration count mismatch");
+        }
+    }
+
+    ASSERT_EQUAL(bst_count_prefix(root, NULL), 0, "NULL prefix should count 0");
+    ASSERT_NULL(bst_iter_seek_prefix(&it, NULL), "NULL prefix should be rejected");
+
+    bst_iter_release(&it);
+    bst_delete_tree(root);
+}
+
+// Test: Autocomplete pages combine rank, count and seek_rank
+TEST(test_iter_pagination) {
+    BSTNode *root = build_cities();
+    const size_t page_size = 20;
+    BSTIter it;
+    bst_iter_init(&it, root);
+
+    const char *prefix = "San ";
+    size_t total = bst_count_prefix(root, prefix);
+    size_t first = bst_rank(root, prefix);
+    size_t seen = 0;
+
+    bst_iter_seek_prefix(&it, prefix);
+    for (size_t page = 0; page * page_size < total; page++) {
+        const char *city = bst_iter_seek_rank(&it, first + page * page_size);
+        for (size_t i = 0; city && i < page_size; i++, city = bst_iter_next(&it)) {
+            ASSERT_STR_EQUAL(city, names[first + seen], "Page content mismatch");
+            seen++;
+        }
+    }
+    ASSERT_EQUAL(seen, total, "Pages should cover every match once");
+    ASSERT_NULL(bst_iter_seek_rank(&it, first + total), "Rank past the matches should be outside the bound");
+
+    bst_iter_release(&it);
+    bst_delete_tree(root);
+}
+
+// Test: Range counts agree with a brute-force count
+TEST(test_count_range) {
+    BSTNode *root = build_cities();
+    const char *bounds[] = {NULL, "", "A", "P", "San 0500", "San 05", "San 9", "Santa", "Santa Cruz de la Sierra 1200",
+                            "zzz"};
+    size_t count = sizeof(bounds) / sizeof(bounds[0]);
+
+    for (size_t l = 0; l < count; l++) {
+        for (size_t h = 0; h < count; h++) {
+            ASSERT_EQUAL(bst_count_range(root, bounds[l], bounds[h]), reference_range(bounds[l], bounds[h]),
+                         "Range count mismatch");
+        }
+    }
+    ASSERT_EQUAL(bst_count_range(root, NULL, NULL), CITY_COUNT, "Unbounded range should count every city");
+    ASSERT_EQUAL(bst_count_range(root, names[10], names[10]), 0, "Empty range should count 0");
+    ASSERT_EQUAL(bst_count_range(root, names[10], names[11]), 1, "Adjacent bounds should count 1");
+
+    bst_delete_tree(root);
+}
+
+// Test: Empty trees and NULL iterators
+TEST(test_iter_empty) {
+    BSTIter it;
+    bst_iter_init(&it, NULL);
+
+    ASSERT_NULL(bst_iter_seek(&it, NULL), "Empty tree has no first city");
+    ASSERT_NULL(bst_iter_seek_prefix(&it, ""), "Empty tree has no prefix match");
+    ASSERT_NULL(bst_iter_seek_rank(&it, 0), "Empty tree has no rank 0");
+    ASSERT_NULL(bst_iter_next(&it), "Next on an empty tree should be NULL");
+    ASSERT_NULL(bst_iter_prev(&it), "Prev on an empty tree should be NULL");
+    ASSERT_EQUAL(bst_count_range(NULL, "A", "Z"), 0, "Empty tree range should count 0");
+    ASSERT_EQUAL(bst_count_prefix(NULL, ""), 0, "Empty tree prefix should count 0");
+
+    ASSERT_NULL(bst_iter_seek(NULL, "A"), "NULL iterator should be rejected");
+    ASSERT_NULL(bst_iter_next(NULL), "NULL iterator should be rejected");
+    bst_iter_release(&it);
+    bst_iter_release(NULL);
+}
+
+int main() {
+    print_test_header("BST Iterator Unit Tests");
+
+    RUN_TEST(test_iter_seek_and_step);
+    RUN_TEST(test_iter_prefix);
+    RUN_TEST(test_iter_pagination);
+    RUN_TEST(test_count_range);
+    RUN_TEST(test_iter_empty);
+
+    return print_test_summary();
+}
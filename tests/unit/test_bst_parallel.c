@@ -0,0 +1,182 @@
+#include "bst_parallel.h"
+#include "test_framework.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Helper: build a tree of n cities, every fifth with a name too long to store inline
+static BSTNode *build_cities(size_t n) {
+    BSTNode *root = NULL;
+    char city[64];
+
+    for (size_t i = 0; i < n; i++) {
+        snprintf(city, sizeof(city), "%s%06zu", i % 5 ? "City" : "Rather long city name ", i);
+        root = bst_insert(root, city);
+    }
+    return root;
+}
+
+// Helper: record which ranks each range visited
+typedef struct RangeCheck {
+    BSTNode *root;
+    atomic_int failures;
+    atomic_size_t visited;
+} RangeCheck;
+
+typedef struct RangeCursor {
+    RangeCheck *check;
+    size_t rank;
+} RangeCursor;
+
+static void check_node(const BSTNode *node, void *ctx) {
+    RangeCursor *cursor = (RangeCursor *)ctx;
+    if (bst_select(cursor->check->root, cursor->rank) != node) {
+        atomic_fetch_add(&cursor->check->failures, 1);
+    }
+    cursor->rank++;
+}
+
+static void check_range(const BSTRange *range, void *ctx) {
+    RangeCheck *check = (RangeCheck *)ctx;
+    RangeCursor cursor = {check, range->first};
+
+    bst_range_walk(range, check_node, &cursor);
+    if (cursor.rank != range->first + range->count) {
+        atomic_fetch_add(&check->failures, 1);
+    }
+    atomic_fetch_add(&check->visited, range->count);
+}
+
+// Test: Ranges are ordered, contiguous and cover every city once
+TEST(test_parallel_ranges) {
+    BSTPool *pool = bst_pool_create(4);
+    ASSERT_NOT_NULL(pool, "Pool creation failed");
+    ASSERT_EQUAL(bst_pool_threads(pool), 4, "Pool should have 4 workers");
+
+    BSTNode *root = build_cities(5000);
+    size_t requested[] = {0, 1, 3, 7, 64, 5000, 10000};
+
+    for (size_t i = 0; i < sizeof(requested) / sizeof(requested[0]); i++) {
+        RangeCheck check;
+        check.root = root;
+        atomic_init(&check.failures, 0);
+        atomic_init(&check.visited, 0);
+
+        size_t ranges = bst_parallel_ranges(pool, root, requested[i], check_range, &check);
+        ASSERT(ranges > 0 && ranges <= 5000, "Range count should be clamped to the tree size");
+        ASSERT_EQUAL(atomic_load(&check.failures), 0, "Every range should walk its own ranks in order");
+        ASSERT_EQUAL(atomic_load(&check.visited), 5000, "Ranges should cover every city once");
+    }
+
+    ASSERT_EQUAL(bst_parallel_ranges(pool, NULL, 0, check_range, NULL), 0, "Empty tree has no ranges");
+    ASSERT_EQUAL(bst_parallel_ranges(NULL, root, 0, check_range, NULL), 0, "NULL pool should be rejected");
+
+    bst_delete_tree(root);
+    bst_pool_destroy(pool);
+    bst_pool_destroy(NULL);
+}
+
+static int is_long_name(const char *city, void *ctx) {
+    (void)ctx;
+    return strncmp(city, "Rather", 6) == 0;
+}
+
+// Test: Parallel count agrees with a serial count
+TEST(test_parallel_count_if) {
+    BSTPool *pool = bst_pool_create(3);
+    BSTNode *root = build_cities(20000);
+
+    ASSERT_EQUAL(bst_parallel_count_if(pool, root, is_long_name, NULL), 4000, "Count mismatch");
+    ASSERT_EQUAL(bst_parallel_count_if(pool, NULL, is_long_name, NULL), 0, "Empty tree should count 0");
+
+    bst_delete_tree(root);
+    bst_pool_destroy(pool);
+}
+
+// Helper: run bst_print_inorder with stdout sent to a temporary file
+static char *capture_print_inorder(BSTNode *root, size_t *len) {
+    FILE *capture = tmpfile();
+    int saved = dup(STDOUT_FILENO);
+
+    fflush(stdout);
+    dup2(fileno(capture), STDOUT_FILENO);
+    bst_print_inorder(root);
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+
+    fseek(capture, 0, SEEK_END);
+    long size = ftell(capture);
+    char *data = (char *)malloc((size_t)size + 1);
+    rewind(capture);
+    *len = fread(data, 1, (size_t)size, capture);
+    fclose(capture);
+
+    return data;
+}
+
+// Test: Export writes the same bytes as bst_print_inorder
+TEST(test_parallel_export) {
+    size_t sizes[] = {1, 1000, 30000};
+
+    for (size_t s = 0; s < 3; s++) {
+        BSTNode *root = build_cities(sizes[s]);
+        size_t expected_len;
+        char *expected = capture_print_inorder(root, &expected_len);
+
+        for (size_t threads = 1; threads <= 4; threads += 3) {
+            BSTPool *pool = bst_pool_create(threads);
+            FILE *out = tmpfile();
+
+            ASSERT_EQUAL(bst_parallel_export(pool, root, out), 0, "Export should succeed");
+            ASSERT_EQUAL((size_t)ftell(out), expected_len, "Export length mismatch");
+
+            char *actual = (char *)malloc(expected_len + 1);
+            rewind(out);
+            ASSERT_EQUAL(fread(actual, 1, expected_len, out), expected_len, "Export read-back failed");
+            ASSERT(memcmp(actual, expected, expected_len) == 0, "Export should match bst_print_inorder");
+
+            free(actual);
+            fclose(out);
+            bst_pool_destroy(pool);
+        }
+
+        free(expected);
+        bst_delete_tree(root);
+    }
+
+    BSTPool *pool = bst_pool_create(2);
+    ASSERT_EQUAL(bst_parallel_export(pool, NULL, stdout), 0, "Empty export should succeed");
+    ASSERT_EQUAL(bst_parallel_export(pool, NULL, NULL), -1, "NULL stream should be rejected");
+    bst_pool_destroy(pool);
+}
+
+// Test: Parallel delete frees every node (checked by the sanitizer builds)
+TEST(test_parallel_delete) {
+    size_t threads[] = {1, 2, 5, 16};
+
+    for (size_t t = 0; t < 4; t++) {
+        BSTPool *pool = bst_pool_create(threads[t]);
+        bst_parallel_delete(pool, build_cities(10000));
+        bst_parallel_delete(pool, build_cities(3));
+        bst_parallel_delete(pool, NULL);
+        bst_pool_destroy(pool);
+    }
+
+    // Without a pool it falls back to a serial delete
+    bst_parallel_delete(NULL, build_cities(100));
+    ASSERT(1, "Deletes should complete");
+}
+
+int main() {
+    print_test_header("BST Parallel Unit Tests");
+
+    RUN_TEST(test_parallel_ranges);
+    RUN_TEST(test_parallel_count_if);
+    RUN_TEST(test_parallel_export);
+    RUN_TEST(test_parallel_delete);
+
+    return print_test_summary();
+}
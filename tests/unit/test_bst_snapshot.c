@@ -0,0 +1,260 @@
+#include "bst_snapshot.h"
+#include "test_framework.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Fresh path for a snapshot file (the file itself is created by the test)
+static void temp_path(char *path, size_t size) {
+    snprintf(path, size, "/tmp/citysorter-snapshot-XXXXXX");
+    int fd = mkstemp(path);
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+// Flip one byte of a file at offset (negative counts from the end)
+static int corrupt_byte(const char *path, long offset) {
+    FILE *file = fopen(path, "r+b");
+    if (!file || fseek(file, offset, offset < 0 ? SEEK_END : SEEK_SET) != 0) {
+        if (file) {
+            fclose(file);
+        }
+        return -1;
+    }
+    int c = fgetc(file);
+    fseek(file, -1, SEEK_CUR);
+    fputc(c ^ 0x20, file);
+    return fclose(file);
+}
+
+// Test: Freezing an empty tree gives an empty snapshot
+TEST(test_freeze_empty) {
+    BSTSnapshot *snapshot = bst_freeze(NULL);
+    ASSERT_NOT_NULL(snapshot, "Empty snapshot should be created");
+    ASSERT_EQUAL(bst_snapshot_count(snapshot), 0, "Empty snapshot should have no cities");
+    ASSERT_NULL(bst_snapshot_search(snapshot, "Oslo"), "Search in empty snapshot should fail");
+    bst_snapshot_free(snapshot);
+    bst_snapshot_free(NULL);
+}
+
+// Test: Every city in the tree is found, and nothing else
+TEST(test_snapshot_search) {
+    const char *cities[] = {"Aba", "Abakaliki", "Abeokuta", "Abraka", "Abuja",
+                            "Ado-Ekiti", "Benin City", "Port Harcourt", "Zaria"};
+    const size_t count = sizeof(cities) / sizeof(cities[0]);
+    BSTNode *root = bst_build_from_array(cities, count);
+
+    BSTSnapshot *snapshot = bst_freeze(root);
+    ASSERT_NOT_NULL(snapshot, "Snapshot should be created");
+    ASSERT_EQUAL(bst_snapshot_count(snapshot), count, "Snapshot should hold every city");
+
+    for (size_t i = 0; i < count; i++) {
+        const char *found = bst_snapshot_search(snapshot, cities[i]);
+        ASSERT_NOT_NULL(found, "Every city should be found");
+        ASSERT_STR_EQUAL(found, cities[i], "Found name should match");
+    }
+
+    ASSERT_NULL(bst_snapshot_search(snapshot, "A"), "Name before the first should fail");
+    ASSERT_NULL(bst_snapshot_search(snapshot, "Ab"), "Prefix of a name should fail");
+    ASSERT_NULL(bst_snapshot_search(snapshot, "Abakalik"), "Shorter name should fail");
+    ASSERT_NULL(bst_snapshot_search(snapshot, "Kano"), "Name in a gap should fail");
+    ASSERT_NULL(bst_snapshot_search(snapshot, "Zz"), "Name after the last should fail");
+    ASSERT_NULL(bst_snapshot_search(snapshot, NULL), "NULL city should fail");
+
+    bst_snapshot_free(snapshot);
+    bst_delete_tree(root);
+}
+
+// Test: The snapshot is independent of later tree changes
+TEST(test_snapshot_immutable) {
+    BSTNode *root = NULL;
+    root = bst_insert(root, "Lisbon");
+    root = bst_insert(root, "Porto");
+
+    BSTSnapshot *snapshot = bst_freeze(root);
+    root = bst_remove(root, "Porto");
+    root = bst_insert(root, "Faro");
+
+    ASSERT_NOT_NULL(bst_snapshot_search(snapshot, "Porto"), "Removed city stays in snapshot");
+    ASSERT_NULL(bst_snapshot_search(snapshot, "Faro"), "New city is not in old snapshot");
+
+    // Rebuilding on demand picks up the changes
+    bst_snapshot_free(snapshot);
+    snapshot = bst_freeze(root);
+    ASSERT_NULL(bst_snapshot_search(snapshot, "Porto"), "Rebuilt snapshot drops Porto");
+    ASSERT_NOT_NULL(bst_snapshot_search(snapshot, "Faro"), "Rebuilt snapshot has Faro");
+
+    bst_snapshot_free(snapshot);
+    bst_delete_tree(root);
+}
+
+// Test: Snapshot sizes that are not full levels, with long shared prefixes
+TEST(test_snapshot_all_sizes) {
+    char city[64];
+    BSTNode *root = NULL;
+
+    for (int n = 1; n <= 300; n++) {
+        snprintf(city, sizeof(city), "Long shared prefix city number %04d", n * 7 % 1000);
+        root = bst_insert(root, city);
+
+        BSTSnapshot *snapshot = bst_freeze(root);
+        ASSERT_EQUAL(bst_snapshot_count(snapshot), (size_t)n, "Snapshot size mismatch");
+
+        for (int i = 0; i < 1000; i++) {
+            snprintf(city, sizeof(city), "Long shared prefix city number %04d", i);
+            int expected = bst_search(root, city) != NULL;
+            int found = bst_snapshot_search(snapshot, city) != NULL;
+            ASSERT_EQUAL(found, expected, "Snapshot and tree should agree");
+        }
+
+        bst_snapshot_free(snapshot);
+    }
+
+    bst_delete_tree(root);
+}
+
+// Test: A saved snapshot maps back with the same contents as the tree
+TEST(test_snapshot_file_round_trip) {
+    char path[64], city[64];
+    BSTNode *root = NULL;
+    temp_path(path, sizeof(path));
+
+    // Mix of inline and heap-stored names, inserted one at a time
+    for (int i = 0; i < 20000; i++) {
+        snprintf(city, sizeof(city), i % 3 ? "City %05d" : "A much longer city name number %05d", i * 7919 % 20000);
+        root = bst_insert(root, city);
+    }
+
+    ASSERT_EQUAL(bst_save_snapshot(root, path), 0, "Save should succeed");
+
+    unsigned flags[] = {0, BST_SNAPSHOT_VERIFY};
+    for (size_t f = 0; f < 2; f++) {
+        BSTSnapshot *snapshot = bst_open_snapshot(path, flags[f]);
+        ASSERT_NOT_NULL(snapshot, "Open should succeed");
+        ASSERT_EQUAL(bst_snapshot_count(snapshot), bst_count_nodes(root), "Count should round-trip");
+
+        for (int i = 0; i < 20000; i++) {
+            snprintf(city, sizeof(city), i % 3 ? "City %05d" : "A much longer city name number %05d", i);
+            int expected = bst_search(root, city) != NULL;
+            const char *found = bst_snapshot_search(snapshot, city);
+            ASSERT_EQUAL(found != NULL, expected, "Mapped snapshot and tree should agree");
+            if (found) {
+                ASSERT_STR_EQUAL(found, city, "Mapped name should match");
+            }
+        }
+        ASSERT_NULL(bst_snapshot_search(snapshot, "City 99999"), "Absent city should not be found");
+
+        // The names come back in order, pointing into the mapping
+        size_t count = bst_snapshot_count(snapshot);
+        const char **names = (const char **)malloc(count * sizeof(*names));
+        ASSERT_EQUAL(bst_snapshot_names(snapshot, names), count, "Every name should be listed");
+        for (size_t k = 0; k < count; k += 97) {
+            ASSERT_STR_EQUAL(names[k], bst_node_city(bst_select(root, k)), "Names should be in order");
+            ASSERT(bst_snapshot_search(snapshot, names[k]) == names[k], "Names should be the stored copies");
+        }
+        free(names);
+
+        // Thawing gives back an identical, balanced tree
+        BSTNode *thawed = bst_thaw(snapshot);
+        ASSERT_EQUAL(bst_count_nodes(thawed), bst_count_nodes(root), "Thawed count mismatch");
+        ASSERT(bst_height(thawed) <= bst_height(root), "Thawed tree should be balanced");
+        for (size_t k = 0; k < bst_count_nodes(root); k += 97) {
+            ASSERT_STR_EQUAL(bst_node_city(bst_select(thawed, k)), bst_node_city(bst_select(root, k)),
+                             "Thawed order mismatch");
+        }
+        bst_delete_tree(thawed);
+
+        bst_snapshot_free(snapshot);
+    }
+
+    // Empty trees round-trip too
+    ASSERT_EQUAL(bst_save_snapshot(NULL, path), 0, "Saving an empty tree should succeed");
+    BSTSnapshot *empty = bst_open_snapshot(path, BST_SNAPSHOT_VERIFY);
+    ASSERT_NOT_NULL(empty, "Empty snapshot should open");
+    ASSERT_EQUAL(bst_snapshot_count(empty), 0, "Empty snapshot should have no cities");
+    ASSERT_NULL(bst_snapshot_search(empty, "City 00001"), "Empty snapshot finds nothing");
+    ASSERT_NULL(bst_thaw(empty), "Thawing an empty snapshot gives an empty tree");
+    bst_snapshot_free(empty);
+
+    unlink(path);
+    bst_delete_tree(root);
+}
+
+// Test: Damaged or foreign files are rejected
+TEST(test_snapshot_file_validation) {
+    const char *cities[] = {"Bergen", "Oslo", "Stavanger", "Tromso", "Trondheim"};
+    BSTNode *root = bst_build_from_array(cities, 5);
+    char path[64];
+    temp_path(path, sizeof(path));
+
+    ASSERT_NULL(bst_open_snapshot("/nonexistent/citysorter.snap", 0), "Missing file should fail");
+    ASSERT_NULL(bst_open_snapshot(path, 0), "Empty file should fail");
+    ASSERT_EQUAL(bst_save_snapshot(root, "/nonexistent/citysorter.snap"), -1, "Unwritable path should fail");
+
+    // A flipped byte in the string table is caught by the body checksum
+    ASSERT_EQUAL(bst_save_snapshot(root, path), 0, "Save should succeed");
+    ASSERT_EQUAL(corrupt_byte(path, -3), 0, "Corrupting the file failed");
+    ASSERT_NULL(bst_open_snapshot(path, BST_SNAPSHOT_VERIFY), "Body corruption should fail verification");
+
+    // Header damage is always caught
+    ASSERT_EQUAL(bst_save_snapshot(root, path), 0, "Save should succeed");
+    ASSERT_EQUAL(corrupt_byte(path, 16), 0, "Corrupting the file failed");
+    ASSERT_NULL(bst_open_snapshot(path, 0), "Header corruption should fail");
+
+    ASSERT_EQUAL(bst_save_snapshot(root, path), 0, "Save should succeed");
+    ASSERT_EQUAL(corrupt_byte(path, 0), 0, "Corrupting the file failed");
+    ASSERT_NULL(bst_open_snapshot(path, 0), "Wrong magic should fail");
+
+    // So is a file cut short
+    ASSERT_EQUAL(bst_save_snapshot(root, path), 0, "Save should succeed");
+    ASSERT_EQUAL(truncate(path, 100), 0, "Truncating the file failed");
+    ASSERT_NULL(bst_open_snapshot(path, 0), "Truncated file should fail");
+
+    unlink(path);
+    bst_delete_tree(root);
+}
+
+// Test: Unverified files with a damaged entry make lookups miss, never read outside
+TEST(test_snapshot_damaged_entry) {
+    const char *cities[] = {"Santa Cruz de la Sierra 1", "Santa Cruz de la Sierra 2",
+                            "Santa Cruz de la Sierra 3", "Santa Cruz de la Sierra 4"};
+    BSTNode *root = bst_build_from_array(cities, 4);
+    char path[64];
+    temp_path(path, sizeof(path));
+
+    // Entry 1 sits at 64 + 16; push its offset 512 MiB past the file
+    long fields[] = {64 + 16 + 8 + 3, 64 + 16 + 12 + 3};
+    for (size_t f = 0; f < 2; f++) {
+        ASSERT_EQUAL(bst_save_snapshot(root, path), 0, "Save should succeed");
+        ASSERT_EQUAL(corrupt_byte(path, fields[f]), 0, "Corrupting the file failed");
+        ASSERT_NULL(bst_open_snapshot(path, BST_SNAPSHOT_VERIFY), "Verification should catch the entry");
+
+        BSTSnapshot *snapshot = bst_open_snapshot(path, 0);
+        ASSERT_NOT_NULL(snapshot, "Opening without verification maps the file");
+        for (int i = 0; i < 4; i++) {
+            const char *found = bst_snapshot_search(snapshot, cities[i]);
+            ASSERT(!found || strcmp(found, cities[i]) == 0, "Lookups should match or miss");
+        }
+        bst_snapshot_free(snapshot);
+    }
+
+    unlink(path);
+    bst_delete_tree(root);
+}
+
+// Main test runner
+int main() {
+    print_test_header("BST Snapshot Unit Tests");
+
+    RUN_TEST(test_freeze_empty);
+    RUN_TEST(test_snapshot_search);
+    RUN_TEST(test_snapshot_immutable);
+    RUN_TEST(test_snapshot_all_sizes);
+    RUN_TEST(test_snapshot_file_round_trip);
+    RUN_TEST(test_snapshot_file_validation);
+    RUN_TEST(test_snapshot_damaged_entry);
+
+    return print_test_summary();
+}
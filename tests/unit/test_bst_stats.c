@@ -0,0 +1,309 @@
+#include "bst.h"
+#include "bst_arena.h"
+#include "bst_stats.h"
+#include "bst_writer.h"
+#include "test_framework.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define THREAD_COUNT 4
+#define THREAD_SEARCHES 20000
+
+// Helper: growable in-memory sink
+typedef struct MemorySink {
+    char *data;
+    size_t len;
+    size_t capacity;
+} MemorySink;
+
+static int memory_write(const char *data, size_t len, void *ctx) {
+    MemorySink *sink = (MemorySink *)ctx;
+
+    if (sink->len + len + 1 > sink->capacity) {
+        sink->capacity = (sink->len + len + 1) * 2;
+        sink->data = (char *)realloc(sink->data, sink->capacity);
+    }
+    memcpy(sink->data + sink->len, data, len);
+    sink->len += len;
+    sink->data[sink->len] = '\0';
+    return 0;
+}
+
+// Helper: total of a histogram row
+static uint64_t histogram_total(const uint64_t *histogram, unsigned buckets) {
+    uint64_t total = 0;
+    for (unsigned i = 0; i < buckets; i++) {
+        total += histogram[i];
+    }
+    return total;
+}
+
+// Helper: tree of "City 0000".."City n-1" inserted in scrambled order
+static BSTNode *build_cities(int n) {
+    BSTNode *root = NULL;
+    char city[32];
+
+    for (int i = 0; i < n; i++) {
+        snprintf(city, sizeof(city), "City %04d", (i * 7919) % n);
+        root = bst_insert(root, city);
+    }
+    return root;
+}
+
+// Test: Latency buckets keep values within 1/16 of themselves
+TEST(test_stats_buckets) {
+    BSTStatsReport *report = (BSTStatsReport *)malloc(sizeof(*report));
+    uint64_t values[] = {0, 1, 15, 16, 17, 100, 1000, 12345, 999999, 123456789, 5000000000ULL};
+
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        bst_stats_reset();
+        bst_stats_record_latency(BST_STAT_FETCH, values[i]);
+        bst_stats_read(report);
+        if (!bst_stats_enabled()) {
+            ASSERT_EQUAL(report->ops[BST_STAT_FETCH], 0, "Disabled stats should read as zero");
+            continue;
+        }
+
+        uint64_t got = bst_stats_percentile(report->latency[BST_STAT_FETCH], 50);
+        uint64_t error = got > values[i] ? got - values[i] : values[i] - got;
+        ASSERT(error * 16 <= values[i], "Bucket value should be within 1/16 of the recorded value");
+        ASSERT_EQUAL(report->ops[BST_STAT_FETCH], 1, "Fetch should be counted");
+    }
+
+    // Percentiles walk the cumulative counts
+    uint64_t histogram[BST_STATS_LATENCY_BUCKETS] = {0};
+    histogram[3] = 90;
+    histogram[10] = 9;
+    histogram[15] = 1;
+    ASSERT_EQUAL(bst_stats_percentile(histogram, 50), 3, "p50 mismatch");
+    ASSERT_EQUAL(bst_stats_percentile(histogram, 90), 3, "p90 mismatch");
+    ASSERT_EQUAL(bst_stats_percentile(histogram, 99), 10, "p99 mismatch");
+    ASSERT_EQUAL(bst_stats_percentile(histogram, 100), 15, "p100 mismatch");
+    ASSERT_EQUAL(bst_stats_percentile(NULL, 50), 0, "NULL histogram should give 0");
+
+    // Bucket values grow with the bucket index
+    for (unsigned i = 1; i < BST_STATS_LATENCY_BUCKETS; i++) {
+        ASSERT(bst_stats_bucket_value(i) > bst_stats_bucket_value(i - 1), "Bucket values should increase");
+    }
+
+    free(report);
+}
+
+// Test: Tree operations, depths, comparisons and allocations are counted
+TEST(test_stats_tree_ops) {
+    BSTStatsReport *report = (BSTStatsReport *)malloc(sizeof(*report));
+    char city[32];
+
+    bst_stats_sample_period(1);
+    bst_stats_reset();
+    BSTNode *root = build_cities(1000);
+    root = bst_insert(root, "City 0001");
+    for (int i = 0; i < 1000; i++) {
+        snprintf(city, sizeof(city), "City %04d", i * 2);
+        bst_search(root, city);
+    }
+    for (int i = 0; i < 200; i++) {
+        snprintf(city, sizeof(city), "City %04d", i * 5);
+        root = bst_remove(root, city);
+    }
+    root = bst_insert(root, "A city name that is too long to be stored inline");
+    bst_stats_read(report);
+
+    if (!bst_stats_enabled()) {
+        ASSERT_EQUAL(report->ops[BST_STAT_INSERT], 0, "Disabled stats should read as zero");
+        bst_delete_tree(root);
+        free(report);
+        return;
+    }
+
+    ASSERT_EQUAL(report->ops[BST_STAT_INSERT], 1002, "Insert count mismatch");
+    ASSERT_EQUAL(report->ops[BST_STAT_SEARCH], 1000, "Search count mismatch");
+    ASSERT_EQUAL(report->ops[BST_STAT_REMOVE], 200, "Remove count mismatch");
+    ASSERT_EQUAL(report->counters[BST_STAT_NODE_ALLOCS], 1001, "Node allocation count mismatch");
+    ASSERT_EQUAL(report->counters[BST_STAT_NAME_ALLOCS], 1, "Name allocation count mismatch");
+    ASSERT_EQUAL(report->counters[BST_STAT_NODE_FREES], 200, "Node free count mismatch");
+
+    uint64_t compares = 0;
+    for (int op = BST_STAT_INSERT; op <= BST_STAT_REMOVE; op++) {
+        ASSERT_EQUAL(histogram_total(report->depth[op], BST_STATS_DEPTH_BUCKETS), report->ops[op],
+                     "Every call should have a depth");
+        ASSERT_EQUAL(histogram_total(report->latency[op], BST_STATS_LATENCY_BUCKETS), report->ops[op],
+                     "Every call should be timed with period 1");
+        for (unsigned d = 0; d < BST_STATS_DEPTH_BUCKETS; d++) {
+            compares += report->depth[op][d] * d;
+        }
+    }
+    ASSERT_EQUAL(report->counters[BST_STAT_COMPARES], compares, "Compares should add up the depths");
+
+    // An AVL tree of 1000 cities is at most 1.44 log2(n) deep
+    for (unsigned d = 15; d < BST_STATS_DEPTH_BUCKETS; d++) {
+        ASSERT_EQUAL(report->depth[BST_STAT_SEARCH][d], 0, "Searches should stay shallow");
+    }
+    ASSERT(report->depth[BST_STAT_SEARCH][0] == 0, "A search on a non-empty tree visits a node");
+
+    // Only the first insert went into an empty tree; the others walked it
+    ASSERT_EQUAL(report->depth[BST_STAT_INSERT][0], 1, "Inserts into a non-empty tree should have a depth");
+    bst_stats_reset();
+    for (int i = 0; i < 100; i++) {
+        snprintf(city, sizeof(city), "New City %03d", i);
+        root = bst_insert(root, city);
+    }
+    bst_stats_read(report);
+    ASSERT_EQUAL(report->depth[BST_STAT_INSERT][0], 0, "Inserts into a non-empty tree should have a depth");
+    ASSERT(report->counters[BST_STAT_COMPARES] >= 100 * 9, "Inserts should count their comparisons");
+
+    // Batches count their cities, not single operations
+    const char *batch[] = {"Batch A", "Batch B", "Batch C"};
+    bst_stats_reset();
+    root = bst_insert_batch(root, batch, 3);
+    bst_stats_read(report);
+    ASSERT_EQUAL(report->counters[BST_STAT_BATCH_CITIES], 3, "Batch city count mismatch");
+    ASSERT_EQUAL(report->ops[BST_STAT_INSERT], 0, "Batch inserts are not single inserts");
+    ASSERT_EQUAL(report->counters[BST_STAT_NODE_ALLOCS], 3, "Batch allocations should be counted");
+
+    // Arena nodes count as allocations too
+    BSTArena *arena = bst_arena_create();
+    BSTNode *arena_root = NULL;
+    bst_stats_reset();
+    arena_root = bst_arena_insert(arena, arena_root, "Arena A");
+    arena_root = bst_arena_insert(arena, arena_root, "Arena B");
+    arena_root = bst_arena_remove(arena, arena_root, "Arena A");
+    bst_stats_read(report);
+    ASSERT_EQUAL(report->counters[BST_STAT_NODE_ALLOCS], 2, "Arena allocation count mismatch");
+    ASSERT_EQUAL(report->counters[BST_STAT_NODE_FREES], 1, "Arena free count mismatch");
+    bst_arena_destroy(arena);
+
+    bst_stats_sample_period(64);
+    bst_delete_tree(root);
+    free(report);
+}
+
+// Test: One call in the sampling period is timed
+TEST(test_stats_sampling) {
+    BSTStatsReport *report = (BSTStatsReport *)malloc(sizeof(*report));
+    BSTNode *root = build_cities(100);
+
+    bst_stats_sample_period(64);
+    bst_stats_reset();
+    for (int i = 0; i < 6400; i++) {
+        bst_search(root, "City 0042");
+    }
+    bst_stats_read(report);
+
+    if (bst_stats_enabled()) {
+        ASSERT_EQUAL(report->ops[BST_STAT_SEARCH], 6400, "Every call should be counted");
+        ASSERT_EQUAL(histogram_total(report->latency[BST_STAT_SEARCH], BST_STATS_LATENCY_BUCKETS), 100,
+                     "One call in 64 should be timed");
+    }
+
+    bst_delete_tree(root);
+    free(report);
+}
+
+typedef struct SearchJob {
+    BSTNode *root;
+} SearchJob;
+
+static void *search_worker(void *arg) {
+    SearchJob *job = (SearchJob *)arg;
+    for (int i = 0; i < THREAD_SEARCHES; i++) {
+        bst_search(job->root, "City 0007");
+    }
+    return NULL;
+}
+
+// Test: Shards of running and exited threads are merged on read
+TEST(test_stats_threads) {
+    BSTStatsReport *report = (BSTStatsReport *)malloc(sizeof(*report));
+    BSTNode *root = build_cities(500);
+    SearchJob job = {root};
+    pthread_t threads[THREAD_COUNT];
+
+    bst_stats_reset();
+    for (int i = 0; i < THREAD_COUNT; i++) {
+        pthread_create(&threads[i], NULL, search_worker, &job);
+    }
+
+    // Reads while the workers record never go backwards
+    uint64_t last = 0;
+    for (int i = 0; i < 50; i++) {
+        bst_stats_read(report);
+        ASSERT(report->ops[BST_STAT_SEARCH] >= last, "Counts should not go backwards");
+        last = report->ops[BST_STAT_SEARCH];
+    }
+
+    for (int i = 0; i < THREAD_COUNT; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    bst_search(root, "City 0007");
+    bst_stats_read(report);
+
+    if (bst_stats_enabled()) {
+        ASSERT_EQUAL(report->ops[BST_STAT_SEARCH], (uint64_t)THREAD_COUNT * THREAD_SEARCHES + 1,
+                     "Exited threads' counts should be kept");
+        ASSERT_EQUAL(histogram_total(report->depth[BST_STAT_SEARCH], BST_STATS_DEPTH_BUCKETS),
+                     report->ops[BST_STAT_SEARCH], "Depth histograms should be merged");
+    }
+
+    bst_stats_reset();
+    bst_stats_read(report);
+    ASSERT_EQUAL(report->ops[BST_STAT_SEARCH], 0, "Reset should start from zero");
+
+    bst_delete_tree(root);
+    free(report);
+}
+
+// Test: Text and JSON dumps
+TEST(test_stats_write) {
+    BSTStatsReport *report = (BSTStatsReport *)malloc(sizeof(*report));
+    BSTNode *root = build_cities(50);
+    MemorySink sink = {0};
+    char buffer[128];
+    BSTWriter writer;
+
+    bst_stats_reset();
+    bst_stats_sample_period(1);
+    bst_search(root, "City 0010");
+    bst_stats_sample_period(64);
+    bst_stats_read(report);
+
+    bst_writer_init(&writer, memory_write, &sink, buffer, sizeof(buffer));
+    ASSERT_EQUAL(bst_stats_write_text(report, &writer), 0, "Text dump should succeed");
+    bst_writer_flush(&writer);
+    if (bst_stats_enabled()) {
+        ASSERT(strstr(sink.data, "search") != NULL, "Text dump should list the operations");
+        ASSERT(strstr(sink.data, "compares") != NULL, "Text dump should list the counters");
+    } else {
+        ASSERT(strstr(sink.data, "not compiled in") != NULL, "Text dump should say stats are off");
+    }
+
+    sink.len = 0;
+    ASSERT_EQUAL(bst_stats_write_json(report, &writer), 0, "JSON dump should succeed");
+    bst_writer_flush(&writer);
+    if (bst_stats_enabled()) {
+        const char *start = "{\"enabled\":true,\"ops\":{\"insert\":{\"calls\":0,";
+        ASSERT(strncmp(sink.data, start, strlen(start)) == 0, "JSON dump should start with the insert counts");
+        ASSERT(strstr(sink.data, "\"search\":{\"calls\":1,") != NULL, "JSON dump should list searches");
+        ASSERT(strstr(sink.data, "\"counters\":{\"compares\":") != NULL, "JSON dump should list the counters");
+    }
+    ASSERT_EQUAL(sink.data[sink.len - 1], '\n', "JSON dump should end with a newline");
+    ASSERT_EQUAL(bst_stats_write_json(NULL, &writer), -1, "NULL report should be rejected");
+
+    free(sink.data);
+    bst_delete_tree(root);
+    free(report);
+}
+
+int main() {
+    print_test_header("BST Stats Unit Tests");
+
+    RUN_TEST(test_stats_buckets);
+    RUN_TEST(test_stats_tree_ops);
+    RUN_TEST(test_stats_sampling);
+    RUN_TEST(test_stats_threads);
+    RUN_TEST(test_stats_write);
+
+    return print_test_summary();
+}
@@ -0,0 +1,223 @@
+#include "bst.h"
+#include "bst_internal.h"
+#include "bst_iter.h"
+#include "test_framework.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ * Stress tests on degenerate trees. The balancing code never produces a
+ * chain, so these tests link nodes by hand to check that every operation
+ * runs without recursion under the default 8MB stack.
+ */
+
+#define CHAIN_LENGTH 5000000
+
+// Helper: build a right-leaning chain City0000000 -> City0000001 -> ...
+static BSTNode *build_right_chain(size_t length) {
+    char city[32];
+    BSTNode *root = NULL;
+
+    // Build from the tail so each new node becomes the head
+    for (size_t i = length; i-- > 0;) {
+        snprintf(city, sizeof(city), "City%07zu", i);
+        BSTNode *node = bst_create_node(city);
+        if (!node) {
+            bst_delete_tree(root);
+            return NULL;
+        }
+        node->right = root;
+        node->height = (int32_t)(length - 1 - i);
+        node->size = length - i;
+        root = node;
+    }
+
+    return root;
+}
+
+// Helper: build a left-leaning chain with the largest name at the root
+static BSTNode *build_left_chain(size_t length) {
+    char city[32];
+    BSTNode *root = NULL;
+
+    for (size_t i = 0; i < length; i++) {
+        snprintf(city, sizeof(city), "City%07zu", i);
+        BSTNode *node = bst_create_node(city);
+        if (!node) {
+            bst_delete_tree(root);
+            return NULL;
+        }
+        node->left = root;
+        node->height = (int32_t)i;
+        node->size = i + 1;
+        root = node;
+    }
+
+    return root;
+}
+
+// Helper: run fn with stdout redirected to a temporary file, returning its size
+static long capture_stdout_size(void (*fn)(BSTNode *), BSTNode *root) {
+    FILE *capture = tmpfile();
+    if (!capture) {
+        return -1;
+    }
+
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    dup2(fileno(capture), STDOUT_FILENO);
+
+    fn(root);
+
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+
+    fseek(capture, 0, SEEK_END);
+    long size = ftell(capture);
+    fclose(capture);
+    return size;
+}
+
+// Helper: rotated print with the default indentation
+static void print_rotated_default(BSTNode *root) {
+    bst_print_rotated(root, 0);
+}
+
+// Test: Read-only operations on a 5M-node right chain
+TEST(test_chain_queries) {
+    BSTNode *root = build_right_chain(CHAIN_LENGTH);
+    ASSERT_NOT_NULL(root, "Chain allocation failed");
+
+    ASSERT_EQUAL(bst_count_nodes(root), CHAIN_LENGTH, "Count should match the chain");
+    ASSERT_EQUAL(bst_height(root), CHAIN_LENGTH - 1, "Height should match the chain");
+    ASSERT_EQUAL(bst_rank(root, "City4999999"), CHAIN_LENGTH - 1, "Rank of the last city");
+    ASSERT_STR_EQUAL(bst_node_city(bst_select(root, CHAIN_LENGTH - 1)), "City4999999",
+                     "Select of the last rank");
+    ASSERT_NOT_NULL(bst_search(root, "City4999999"), "Last city should be found");
+    ASSERT_NULL(bst_search(root, "City5000000"), "City past the end should not be found");
+    ASSERT_STR_EQUAL(bst_node_city(bst_find_min(root)), "City0000000", "Minimum mismatch");
+
+    // 5M lines of "City0000000\n"
+    long size = capture_stdout_size(bst_print_inorder, root);
+    ASSERT_EQUAL(size, (long)CHAIN_LENGTH * 12, "In-order output size mismatch");
+    ASSERT_NOT_NULL(bst_search(root, "City4999999"), "Traversal should restore the tree");
+
+    bst_delete_tree(root);
+}
+
+// Test: Updates at the deep end of a 5M-node right chain
+TEST(test_chain_updates) {
+    BSTNode *root = build_right_chain(CHAIN_LENGTH);
+    ASSERT_NOT_NULL(root, "Chain allocation failed");
+
+    root = bst_insert(root, "City9999999");
+    ASSERT_NOT_NULL(bst_search(root, "City9999999"), "Inserted city should be found");
+
+    root = bst_remove(root, "City4999999");
+    root = bst_remove(root, "City0000000");
+    root = bst_remove(root, "City2500000");
+    ASSERT_NULL(bst_search(root, "City4999999"), "Removed city should be gone");
+    ASSERT_NULL(bst_search(root, "City2500000"), "Removed city should be gone");
+    ASSERT_EQUAL(bst_count_nodes(root), CHAIN_LENGTH - 2, "Count after updates mismatch");
+    ASSERT_STR_EQUAL(bst_node_city(bst_find_min(root)), "City0000001", "Minimum mismatch");
+
+    bst_delete_tree(root);
+}
+
+// Test: A 5M-node left chain exercises the other traversal direction
+TEST(test_left_chain) {
+    BSTNode *root = build_left_chain(CHAIN_LENGTH);
+    ASSERT_NOT_NULL(root, "Chain allocation failed");
+
+    ASSERT_EQUAL(bst_count_nodes(root), CHAIN_LENGTH, "Count should match the chain");
+    ASSERT_NOT_NULL(bst_search(root, "City0000000"), "Deepest city should be found");
+
+    root = bst_insert(root, "Aachen");
+    root = bst_remove(root, "City0000001");
+    ASSERT_STR_EQUAL(bst_node_city(bst_find_min(root)), "Aachen", "Minimum mismatch");
+    ASSERT_EQUAL(bst_count_nodes(root), CHAIN_LENGTH, "Count after updates mismatch");
+
+    bst_delete_tree(root);
+}
+
+// Test: Rotated print indents by depth on a deep chain
+TEST(test_chain_rotated) {
+    const size_t length = 2000;
+    BSTNode *root = build_right_chain(length);
+    ASSERT_NOT_NULL(root, "Chain allocation failed");
+
+    // Each node prints "\n", 5 * depth spaces and "City0000000\n"
+    long expected = 0;
+    for (size_t depth = 0; depth < length; depth++) {
+        expected += 1 + 5 * (long)depth + 12;
+    }
+
+    long size = capture_stdout_size(print_rotated_default, root);
+    ASSERT_EQUAL(size, expected, "Rotated output size mismatch");
+    ASSERT_NOT_NULL(bst_search(root, "City0001999"), "Traversal should restore the tree");
+
+    bst_delete_tree(root);
+}
+
+// Test: Cursors and range counts on a chain deeper than the inline path
+TEST(test_chain_iterator) {
+    const size_t length = 100000;
+    BSTNode *root = build_right_chain(length);
+    ASSERT_NOT_NULL(root, "Chain allocation failed");
+
+    BSTIter it;
+    bst_iter_init(&it, root);
+    ASSERT_STR_EQUAL(bst_iter_seek(&it, "City0099998"), "City0099998", "Seek near the tail mismatch");
+    ASSERT_STR_EQUAL(bst_iter_next(&it), "City0099999", "Next at the tail mismatch");
+    ASSERT_NULL(bst_iter_next(&it), "Next past the last city should end");
+
+    // Walk the whole chain backwards from the last rank
+    size_t visited = 0;
+    for (const char *city = bst_iter_seek_rank(&it, length - 1); city; city = bst_iter_prev(&it)) {
+        visited++;
+    }
+    ASSERT_EQUAL(visited, length, "Backward walk should visit every city");
+
+    ASSERT_EQUAL(bst_count_prefix(root, "City009"), 10000, "Prefix count mismatch");
+    ASSERT_EQUAL(bst_count_range(root, "City0050000", NULL), 50000, "Open range count mismatch");
+
+    bst_iter_release(&it);
+    bst_delete_tree(root);
+}
+
+// Test: Balanced inserts and removes of 5M sorted names
+TEST(test_sorted_bulk_updates) {
+    char city[32];
+    BSTNode *root = NULL;
+
+    for (size_t i = 0; i < CHAIN_LENGTH; i++) {
+        snprintf(city, sizeof(city), "City%07zu", i);
+        root = bst_insert(root, city);
+    }
+    ASSERT(bst_height(root) < 40, "Sorted inserts should stay balanced");
+
+    for (size_t i = 0; i < CHAIN_LENGTH; i += 2) {
+        snprintf(city, sizeof(city), "City%07zu", i);
+        root = bst_remove(root, city);
+    }
+    ASSERT_EQUAL(bst_count_nodes(root), CHAIN_LENGTH / 2, "Half the cities should remain");
+
+    bst_delete_tree(root);
+}
+
+// Main test runner
+int main() {
+    print_test_header("BST Stress Tests");
+
+    RUN_TEST(test_chain_queries);
+    RUN_TEST(test_chain_updates);
+    RUN_TEST(test_left_chain);
+    RUN_TEST(test_chain_rotated);
+    RUN_TEST(test_chain_iterator);
+    RUN_TEST(test_sorted_bulk_updates);
+
+    return print_test_summary();
+}
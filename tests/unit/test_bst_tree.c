@@ -0,0 +1,204 @@
+#include "bst_tree.h"
+#include "test_framework.h"
+#include "bst_checks.h"
+#include <stdio.h>
+#include <string.h>
+
+// Test: Create and destroy empty trees
+TEST(test_tree_create_destroy) {
+    BSTree *tree = bst_tree_create(0);
+    ASSERT_NOT_NULL(tree, "Tree creation failed");
+    ASSERT_EQUAL(bst_tree_count(tree), 0, "Empty tree should have no cities");
+    ASSERT_EQUAL(bst_tree_height(tree), -1, "Empty tree should have height -1");
+    ASSERT_NULL(bst_tree_root(tree), "Empty tree should have no root");
+    bst_tree_destroy(tree);
+    bst_tree_destroy(NULL);
+}
+
+// Test: Insert and remove report what happened
+TEST(test_tree_insert_remove_results) {
+    BSTree *tree = bst_tree_create(0);
+
+    ASSERT_EQUAL(bst_tree_insert(tree, "Paris"), 1, "New city should be inserted");
+    ASSERT_EQUAL(bst_tree_insert(tree, "Paris"), 0, "Duplicate should report 0");
+    ASSERT_EQUAL(bst_tree_insert(tree, NULL), -1, "NULL city should be rejected");
+    ASSERT_EQUAL(bst_tree_insert(NULL, "Paris"), -1, "NULL tree should be rejected");
+    ASSERT_EQUAL(bst_tree_count(tree), 1, "Tree should have 1 city");
+
+    ASSERT_EQUAL(bst_tree_remove(tree, "Lyon"), 0, "Missing city should report 0");
+    ASSERT_EQUAL(bst_tree_remove(tree, "Paris"), 1, "Present city should be removed");
+    ASSERT_EQUAL(bst_tree_count(tree), 0, "Tree should be empty");
+
+    bst_tree_destroy(tree);
+}
+
+// Test: Count, height, rank and select on both allocators, with and without the index
+TEST(test_tree_metrics) {
+    unsigned flags[] = {0, BST_TREE_ARENA, BST_TREE_HASH, BST_TREE_HASH | BST_TREE_ARENA};
+    char city[32];
+
+    for (size_t f = 0; f < 4; f++) {
+        BSTree *tree = bst_tree_create(flags[f]);
+        ASSERT_NOT_NULL(tree, "Tree creation failed");
+
+        for (int i = 0; i < 10000; i++) {
+            snprintf(city, sizeof(city), "City%05d", i);
+            ASSERT_EQUAL(bst_tree_insert(tree, city), 1, "Insert should succeed");
+        }
+        for (int i = 0; i < 10000; i += 3) {
+            snprintf(city, sizeof(city), "City%05d", i);
+            ASSERT_EQUAL(bst_tree_remove(tree, city), 1, "Remove should succeed");
+        }
+
+        // 3334 multiples of 3 were removed
+        ASSERT_EQUAL(bst_tree_count(tree), 6666, "Count should be maintained");
+        ASSERT(bst_tree_height(tree) <= 17, "Height should stay logarithmic");
+        ASSERT(check_avl(bst_tree_root(tree), NULL, NULL) >= 0, "Tree should be valid");
+
+        // City00001, City00002, City00004, City00005, ...
+        ASSERT_EQUAL(bst_tree_rank(tree, "City00004"), 2, "Rank mismatch");
+        ASSERT_EQUAL(bst_tree_rank(tree, "City00003"), 2, "Rank of a removed city mismatch");
+        ASSERT_STR_EQUAL(bst_node_city(bst_tree_select(tree, 3)), "City00005", "Select mismatch");
+        ASSERT_STR_EQUAL(bst_node_city(bst_tree_select(tree, 6665)), "City09998", "Last select mismatch");
+        ASSERT_NULL(bst_tree_select(tree, 6666), "Select past the end should be NULL");
+        ASSERT_NOT_NULL(bst_tree_search(tree, "City09998"), "Search should find City09998");
+        ASSERT_NULL(bst_tree_search(tree, "City09999"), "Search should not find City09999");
+
+        bst_tree_destroy(tree);
+    }
+}
+
+// Test: Bulk load replaces the contents (and the index)
+TEST(test_tree_load) {
+    unsigned flags[] = {0, BST_TREE_ARENA, BST_TREE_HASH, BST_TREE_HASH | BST_TREE_ARENA};
+    const char *cities[] = {"Rome", "Oslo", "Bern", "Oslo", "Kyiv", "Riga", "Lima"};
+
+    for (size_t f = 0; f < 4; f++) {
+        BSTree *tree = bst_tree_create(flags[f]);
+        bst_tree_insert(tree, "Paris");
+
+        ASSERT_EQUAL(bst_tree_load(tree, cities, 7), 0, "Load should succeed");
+        ASSERT_EQUAL(bst_tree_count(tree), 6, "Duplicates should be dropped");
+        ASSERT_EQUAL(bst_tree_height(tree), 2, "Loaded tree should be balanced");
+        ASSERT_NULL(bst_tree_search(tree, "Paris"), "Old contents should be gone");
+        ASSERT(check_avl(bst_tree_root(tree), NULL, NULL) >= 0, "Tree should be valid");
+
+        // The loaded tree stays mutable
+        ASSERT_EQUAL(bst_tree_insert(tree, "Paris"), 1, "Insert after load should succeed");
+        ASSERT_EQUAL(bst_tree_remove(tree, "Bern"), 1, "Remove after load should succeed");
+
+        ASSERT_EQUAL(bst_tree_load(tree, NULL, 0), 0, "Empty load should succeed");
+        ASSERT_EQUAL(bst_tree_count(tree), 0, "Empty load should clear the tree");
+        ASSERT_EQUAL(bst_tree_load(NULL, cities, 7), -1, "NULL tree should be rejected");
+
+        bst_tree_destroy(tree);
+    }
+}
+
+// Test: Batch updates report how many cities changed
+TEST(test_tree_batches) {
+    unsigned flags[] = {0, BST_TREE_ARENA, BST_TREE_HASH, BST_TREE_HASH | BST_TREE_ARENA};
+    const char *add[] = {"Rome", "Oslo", "Bern", "Oslo", NULL, "Kyiv"};
+    const char *drop[] = {"Oslo", "Lima", "Bern"};
+    size_t changed;
+
+    for (size_t f = 0; f < 4; f++) {
+        BSTree *tree = bst_tree_create(flags[f]);
+        bst_tree_insert(tree, "Bern");
+
+        ASSERT_EQUAL(bst_tree_insert_batch(tree, add, 6, &changed), 0, "Batch insert should succeed");
+        ASSERT_EQUAL(changed, 3, "Only new cities should count");
+        ASSERT_EQUAL(bst_tree_count(tree), 4, "Count mismatch after insert");
+
+        ASSERT_EQUAL(bst_tree_remove_batch(tree, drop, 3, &changed), 0, "Batch remove should succeed");
+        ASSERT_EQUAL(changed, 2, "Only present cities should count");
+        ASSERT_NULL(bst_tree_search(tree, "Oslo"), "Oslo should be removed");
+        ASSERT(check_avl(bst_tree_root(tree), NULL, NULL) >= 0, "Tree should be valid");
+
+        ASSERT_EQUAL(bst_tree_insert_batch(NULL, add, 6, &changed), -1, "NULL tree should be rejected");
+        ASSERT_EQUAL(changed, 0, "Nothing should change on error");
+
+        bst_tree_destroy(tree);
+    }
+}
+
+// Test: The hash index agrees with the tree through random updates
+TEST(test_tree_hash_sync) {
+    unsigned flags[] = {BST_TREE_HASH, BST_TREE_HASH | BST_TREE_ARENA, BST_TREE_HASH | BST_TREE_FOLD};
+    char city[32];
+    char batch_names[64][32];
+    const char *batch[64];
+
+    for (size_t f = 0; f < 3; f++) {
+        BSTree *hashed = bst_tree_create(flags[f]);
+        BSTree *plain = bst_tree_create(flags[f] & ~BST_TREE_HASH);
+        unsigned state = 12345;
+
+        for (int step = 0; step < 20000; step++) {
+            state = state * 1103515245u + 12345u;
+            unsigned id = (state >> 8) % 3000;
+            snprintf(city, sizeof(city), "%s%04u", id % 2 ? "City" : "CITY", id);
+
+            switch ((state >> 4) % 8) {
+            case 0:
+            case 1:
+            case 2:
+                ASSERT_EQUAL(bst_tree_insert(hashed, city), bst_tree_insert(plain, city), "Insert results differ");
+                break;
+            case 3:
+            case 4:
+                ASSERT_EQUAL(bst_tree_remove(hashed, city), bst_tree_remove(plain, city), "Remove results differ");
+                break;
+            case 5: {
+                // Batches of nearby ids, half of them already present
+                size_t changed_hashed, changed_plain;
+                for (int i = 0; i < 64; i++) {
+                    snprintf(batch_names[i], sizeof(batch_names[i]), "City%04u", (id + (unsigned)i * 7) % 3000);
+                    batch[i] = batch_names[i];
+                }
+                if (state & 0x10000) {
+                    bst_tree_insert_batch(hashed, batch, 64, &changed_hashed);
+                    bst_tree_insert_batch(plain, batch, 64, &changed_plain);
+                } else {
+                    bst_tree_remove_batch(hashed, batch, 64, &changed_hashed);
+                    bst_tree_remove_batch(plain, batch, 64, &changed_plain);
+                }
+                ASSERT_EQUAL(changed_hashed, changed_plain, "Batch results differ");
+                break;
+            }
+            default: {
+                BSTNode *found = bst_tree_search(hashed, city);
+                BSTNode *expected = bst_tree_search(plain, city);
+                ASSERT((found == NULL) == (expected == NULL), "Search results differ");
+                ASSERT(!found || strcmp(bst_node_city(found), bst_node_city(expected)) == 0,
+                       "Search should return the stored city");
+                break;
+            }
+            }
+        }
+
+        // Every stored city is found through the index, at its own node
+        ASSERT_EQUAL(bst_tree_count(hashed), bst_tree_count(plain), "Counts differ");
+        for (size_t k = 0; k < bst_tree_count(hashed); k++) {
+            BSTNode *node = bst_tree_select(hashed, k);
+            ASSERT(bst_tree_search(hashed, bst_node_city(node)) == node, "Index should point at the tree's node");
+        }
+
+        bst_tree_destroy(hashed);
+        bst_tree_destroy(plain);
+    }
+}
+
+// Main test runner
+int main() {
+    print_test_header("BST Tree Handle Unit Tests");
+
+    RUN_TEST(test_tree_create_destroy);
+    RUN_TEST(test_tree_insert_remove_results);
+    RUN_TEST(test_tree_metrics);
+    RUN_TEST(test_tree_load);
+    RUN_TEST(test_tree_batches);
+    RUN_TEST(test_tree_hash_sync);
+
+    return print_test_summary();
+}
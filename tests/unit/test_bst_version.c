@@ -0,0 +1,265 @@
+#include "bst_version.h"
+#include "test_framework.h"
+#include "bst_checks.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Helper: collect a walk into a newline-separated string
+typedef struct Collector {
+    char buffer[256];
+    size_t used;
+} Collector;
+
+static void collect_city(const char *city, void *ctx) {
+    Collector *collector = (Collector *)ctx;
+    collector->used += (size_t)snprintf(collector->buffer + collector->used,
+                                        sizeof(collector->buffer) - collector->used, "%s\n", city);
+}
+
+// Test: Updates create new versions and leave the old ones untouched
+TEST(test_version_updates) {
+    BSTVersion *empty = bst_version_create();
+    ASSERT_NOT_NULL(empty, "Version creation failed");
+    ASSERT_EQUAL(bst_version_count(empty), 0, "Empty version should have no cities");
+    ASSERT_NULL(bst_version_root(empty), "Empty version should have no root");
+
+    BSTVersion *v1 = bst_version_insert(empty, "Paris");
+    BSTVersion *v2 = bst_version_insert(v1, "Berlin");
+    BSTVersion *v3 = bst_version_insert(v2, "Zagreb");
+    BSTVersion *v4 = bst_version_remove(v3, "Paris");
+    ASSERT(v1 && v2 && v3 && v4, "Updates should succeed");
+
+    ASSERT_EQUAL(bst_version_count(empty), 0, "Empty version should stay empty");
+    ASSERT_EQUAL(bst_version_count(v1), 1, "v1 should have 1 city");
+    ASSERT_EQUAL(bst_version_count(v3), 3, "v3 should have 3 cities");
+    ASSERT_EQUAL(bst_version_count(v4), 2, "v4 should have 2 cities");
+    ASSERT_NOT_NULL(bst_search(bst_version_root(v3), "Paris"), "v3 should still have Paris");
+    ASSERT_NULL(bst_search(bst_version_root(v4), "Paris"), "v4 should not have Paris");
+
+    // No-op updates hand back the same version
+    BSTVersion *same = bst_version_insert(v4, "Berlin");
+    ASSERT(same == v4, "Inserting a present city should return the same version");
+    bst_version_release(same);
+    same = bst_version_remove(v4, "Lyon");
+    ASSERT(same == v4, "Removing a missing city should return the same version");
+    bst_version_release(same);
+
+    ASSERT_NULL(bst_version_insert(NULL, "Paris"), "NULL version should be rejected");
+    ASSERT_NULL(bst_version_insert(v4, NULL), "NULL city should be rejected");
+    ASSERT_NULL(bst_version_remove(v4, NULL), "NULL city should be rejected");
+
+    Collector collector = {{0}, 0};
+    bst_version_walk(v3, collect_city, &collector);
+    ASSERT_STR_EQUAL(collector.buffer, "Berlin\nParis\nZagreb\n", "Walk should be alphabetical");
+
+    // Releasing in any order frees exactly what is no longer shared
+    bst_version_release(v2);
+    bst_version_release(empty);
+    ASSERT_EQUAL(bst_version_count(v4), 2, "v4 should survive releasing older versions");
+    bst_version_release(v4);
+    bst_version_release(v1);
+    bst_version_release(v3);
+    bst_version_release(NULL);
+}
+
+// Test: An update copies only its path and shares every other node
+TEST(test_version_sharing) {
+    BSTVersion *base = bst_version_create();
+    char city[64];
+
+    for (int i = 0; i < 4096; i++) {
+        // Every fourth name is long enough to live outside the node
+        snprintf(city, sizeof(city), "%s%05d", i % 4 ? "City" : "A city with a long name ", i);
+        BSTVersion *next = bst_version_insert(base, city);
+        ASSERT_NOT_NULL(next, "Insert should succeed");
+        bst_version_release(base);
+        base = next;
+    }
+
+    BSTVersion *removed = bst_version_remove(base, "City02049");
+    BSTVersion *added = bst_version_insert(base, "City02049x");
+    ASSERT(removed && added, "Updates should succeed");
+
+    int shared = 0;
+    for (int i = 0; i < 4096; i++) {
+        snprintf(city, sizeof(city), "%s%05d", i % 4 ? "City" : "A city with a long name ", i);
+        BSTNode *old_node = bst_search(bst_version_root(base), city);
+        if (old_node && old_node == bst_search(bst_version_root(added), city)) {
+            shared++;
+        }
+    }
+
+    // The path to a leaf is at most 2 * height nodes including rotations
+    int copied = 4096 - shared;
+    ASSERT(copied <= 2 * (bst_height(bst_version_root(base)) + 1), "Only the path should be copied");
+    ASSERT(check_avl(bst_version_root(removed), NULL, NULL) >= 0, "Removed version should be valid");
+    ASSERT(check_avl(bst_version_root(added), NULL, NULL) >= 0, "Added version should be valid");
+    ASSERT_EQUAL(bst_version_count(removed), 4095, "Removed version count mismatch");
+    ASSERT_EQUAL(bst_version_count(added), 4097, "Added version count mismatch");
+
+    // Roll back: dropping the newer versions leaves the base complete
+    bst_version_release(removed);
+    bst_version_release(added);
+    ASSERT_EQUAL(bst_version_count(base), 4096, "Base version should be intact");
+    ASSERT(check_avl(bst_version_root(base), NULL, NULL) >= 0, "Base version should be valid");
+    ASSERT_NOT_NULL(bst_search(bst_version_root(base), "A city with a long name 00000"),
+                    "Long names should survive");
+
+    bst_version_release(base);
+}
+
+// Helper: count cities and check their order
+typedef struct ScanCount {
+    size_t count;
+    char last[32];
+    int ordered;
+} ScanCount;
+
+static void count_city(const char *city, void *ctx) {
+    ScanCount *scan = (ScanCount *)ctx;
+    if (scan->count > 0 && strcmp(scan->last, city) >= 0) {
+        scan->ordered = 0;
+    }
+    snprintf(scan->last, sizeof(scan->last), "%s", city);
+    scan->count++;
+}
+
+// Test: Random updates against a kept history of versions
+TEST(test_version_history) {
+    enum { HISTORY = 64, KEYS = 300 };
+    BSTVersion *history[HISTORY];
+    unsigned char present[HISTORY][KEYS];
+    size_t counts[HISTORY];
+    char city[32];
+    unsigned seed = 12345;
+
+    history[0] = bst_version_create();
+    memset(present[0], 0, KEYS);
+
+    for (int v = 1; v < HISTORY; v++) {
+        BSTVersion *current = bst_version_retain(history[v - 1]);
+        memcpy(present[v], present[v - 1], KEYS);
+
+        for (int op = 0; op < 40; op++) {
+            seed = seed * 1103515245u + 12345u;
+            int id = (int)((seed >> 8) % KEYS);
+            snprintf(city, sizeof(city), "City%03d", id);
+
+            BSTVersion *next = (seed >> 20) % 3 ? bst_version_insert(current, city) : bst_version_remove(current, city);
+            ASSERT_NOT_NULL(next, "Update should succeed");
+            present[v][id] = (seed >> 20) % 3 ? 1 : 0;
+            bst_version_release(current);
+            current = next;
+        }
+        history[v] = current;
+    }
+
+    // Every version still holds exactly its own set
+    for (int v = 0; v < HISTORY; v++) {
+        size_t expected = 0;
+        for (int id = 0; id < KEYS; id++) {
+            snprintf(city, sizeof(city), "City%03d", id);
+            int found = bst_search(bst_version_root(history[v]), city) != NULL;
+            ASSERT_EQUAL(found, present[v][id], "Version contents mismatch");
+            expected += present[v][id];
+        }
+        ASSERT_EQUAL(bst_version_count(history[v]), expected, "Version count mismatch");
+        counts[v] = expected;
+        ASSERT(check_avl(bst_version_root(history[v]), NULL, NULL) != -2, "Version should be valid");
+    }
+
+    // Release odd versions first; the even ones keep the nodes they share
+    for (int v = 1; v < HISTORY; v += 2) {
+        bst_version_release(history[v]);
+    }
+    for (int v = 0; v < HISTORY; v += 2) {
+        ScanCount scan = {0, "", 1};
+        bst_version_walk(history[v], count_city, &scan);
+        ASSERT_EQUAL(scan.count, counts[v], "Even versions should survive");
+        bst_version_release(history[v]);
+    }
+}
+
+typedef struct ScanState {
+    BSTVersion *_Atomic current;     // Written only by the updater
+    pthread_mutex_t lock;            // Guards taking a reference to current
+    atomic_int done;
+    atomic_int failures;
+} ScanState;
+
+// Scanner: walks whole snapshots while the updater keeps replacing the current version
+static void *scan_versions(void *arg) {
+    ScanState *state = (ScanState *)arg;
+
+    while (!atomic_load(&state->done)) {
+        pthread_mutex_lock(&state->lock);
+        BSTVersion *snapshot = bst_version_retain(atomic_load(&state->current));
+        pthread_mutex_unlock(&state->lock);
+
+        ScanCount scan = {0, "", 1};
+        bst_version_walk(snapshot, count_city, &scan);
+        if (!scan.ordered || scan.count != bst_version_count(snapshot)) {
+            atomic_fetch_add(&state->failures, 1);
+        }
+        bst_version_release(snapshot);
+    }
+
+    return NULL;
+}
+
+// Test: Scans of a snapshot stay consistent while other threads update and release versions
+TEST(test_version_concurrent_scans) {
+    ScanState state;
+    pthread_t scanners[3];
+    char city[32];
+
+    atomic_init(&state.current, bst_version_create());
+    pthread_mutex_init(&state.lock, NULL);
+    atomic_init(&state.done, 0);
+    atomic_init(&state.failures, 0);
+
+    for (int i = 0; i < 3; i++) {
+        pthread_create(&scanners[i], NULL, scan_versions, &state);
+    }
+
+    for (int i = 0; i < 3000; i++) {
+        snprintf(city, sizeof(city), "City%04d", (i * 7) % 1000);
+        BSTVersion *old = atomic_load(&state.current);
+        BSTVersion *next = i % 3 == 2 ? bst_version_remove(old, city) : bst_version_insert(old, city);
+        if (!next) {
+            atomic_fetch_add(&state.failures, 1);
+            continue;
+        }
+
+        pthread_mutex_lock(&state.lock);
+        atomic_store(&state.current, next);
+        pthread_mutex_unlock(&state.lock);
+        bst_version_release(old);
+    }
+
+    atomic_store(&state.done, 1);
+    for (int i = 0; i < 3; i++) {
+        pthread_join(scanners[i], NULL);
+    }
+
+    ASSERT_EQUAL(atomic_load(&state.failures), 0, "Every scan should see a complete version");
+    ASSERT(check_avl(bst_version_root(atomic_load(&state.current)), NULL, NULL) >= 0,
+           "Final version should be valid");
+
+    bst_version_release(atomic_load(&state.current));
+    pthread_mutex_destroy(&state.lock);
+}
+
+int main() {
+    print_test_header("BST Version Unit Tests");
+
+    RUN_TEST(test_version_updates);
+    RUN_TEST(test_version_sharing);
+    RUN_TEST(test_version_history);
+    RUN_TEST(test_version_concurrent_scans);
+
+    return print_test_summary();
+}
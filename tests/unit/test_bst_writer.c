@@ -0,0 +1,230 @@
+#include "bst.h"
+#include "bst_writer.h"
+#include "test_framework.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Helper: growable in-memory sink
+typedef struct MemorySink {
+    char *data;
+    size_t len;
+    size_t capacity;
+    int calls;
+    int fail_after;          // Fail on this call (0 = never)
+} MemorySink;
+
+static int memory_write(const char *data, size_t len, void *ctx) {
+    MemorySink *sink = (MemorySink *)ctx;
+
+    sink->calls++;
+    if (sink->fail_after && sink->calls >= sink->fail_after) {
+        return -1;
+    }
+    if (sink->len + len + 1 > sink->capacity) {
+        sink->capacity = (sink->len + len + 1) * 2;
+        sink->data = (char *)realloc(sink->data, sink->capacity);
+    }
+    memcpy(sink->data + sink->len, data, len);
+    sink->len += len;
+    sink->data[sink->len] = '\0';
+    return 0;
+}
+
+// Helper: the printf-per-call format the print functions always produced
+static void reference_rotated(MemorySink *sink, BSTNode *node, int space, int depth) {
+    char line[256];
+
+    if (node == NULL) {
+        return;
+    }
+    reference_rotated(sink, bst_node_right(node), space, depth + 1);
+
+    int indent = space + 5 * depth;
+    int used = snprintf(line, sizeof(line), "\n%*s%s\n", indent > 0 ? indent : 0, "", bst_node_city(node));
+    memory_write(line, (size_t)used, sink);
+
+    reference_rotated(sink, bst_node_left(node), space, depth + 1);
+}
+
+static void reference_inorder(MemorySink *sink, BSTNode *node) {
+    char line[256];
+
+    if (node == NULL) {
+        return;
+    }
+    reference_inorder(sink, bst_node_left(node));
+    int used = snprintf(line, sizeof(line), "%s\n", bst_node_city(node));
+    memory_write(line, (size_t)used, sink);
+    reference_inorder(sink, bst_node_right(node));
+}
+
+// Helper: tree with a mix of short and long names in scrambled insertion order
+static BSTNode *build_cities(int n) {
+    BSTNode *root = NULL;
+    char city[64];
+
+    for (int i = 0; i < n; i++) {
+        int id = (i * 7919) % n;
+        snprintf(city, sizeof(city), "%s%05d", id % 3 ? "City" : "A much longer city name ", id);
+        root = bst_insert(root, city);
+    }
+    return root;
+}
+
+// Test: Puts and fills arrive in order through small and large buffers
+TEST(test_writer_buffering) {
+    MemorySink sink = {0};
+    char buffer[4];
+    BSTWriter writer;
+
+    bst_writer_init(&writer, memory_write, &sink, buffer, sizeof(buffer));
+    ASSERT_EQUAL(bst_writer_put(&writer, "ab", 2), 0, "Put should succeed");
+    ASSERT_EQUAL(bst_writer_put(&writer, "cdefgh", 6), 0, "Oversized put should succeed");
+    ASSERT_EQUAL(bst_writer_fill(&writer, ' ', 10), 0, "Fill should succeed");
+    ASSERT_EQUAL(bst_writer_put(&writer, "xyz", 3), 0, "Put should succeed");
+    ASSERT_EQUAL(bst_writer_flush(&writer), 0, "Flush should succeed");
+    ASSERT_STR_EQUAL(sink.data, "abcdefgh          xyz", "Output mismatch");
+
+    // A large buffer turns many small puts into a single sink call
+    char large[4096];
+    sink.len = 0;
+    sink.calls = 0;
+    bst_writer_init(&writer, memory_write, &sink, large, sizeof(large));
+    for (int i = 0; i < 500; i++) {
+        bst_writer_put(&writer, "City\n", 5);
+    }
+    bst_writer_flush(&writer);
+    ASSERT_EQUAL(sink.len, 2500, "Output size mismatch");
+    ASSERT_EQUAL(sink.calls, 1, "Small puts should be batched");
+
+    free(sink.data);
+}
+
+// Test: A failing sink is reported and later output is dropped
+TEST(test_writer_failure) {
+    MemorySink sink = {0};
+    char buffer[8];
+    BSTWriter writer;
+
+    sink.fail_after = 2;
+    bst_writer_init(&writer, memory_write, &sink, buffer, sizeof(buffer));
+    ASSERT_EQUAL(bst_writer_put(&writer, "12345678", 8), 0, "First block should be buffered");
+    ASSERT_EQUAL(bst_writer_put(&writer, "9", 1), 0, "First flush should succeed");
+    ASSERT_EQUAL(bst_writer_fill(&writer, '-', 20), -1, "Second flush should fail");
+    ASSERT_EQUAL(bst_writer_put(&writer, "x", 1), -1, "Writes after a failure should fail");
+    ASSERT_EQUAL(bst_writer_flush(&writer), -1, "Flush should report the failure");
+    ASSERT_STR_EQUAL(sink.data, "12345678", "Only the first block should arrive");
+
+    BSTNode *root = build_cities(50);
+    ASSERT_EQUAL(bst_write_inorder(root, &writer), -1, "Dump should report the failure");
+    ASSERT_EQUAL(bst_count_nodes(root), 50, "A failed dump should leave the tree intact");
+    ASSERT_EQUAL(bst_write_inorder(root, NULL), -1, "NULL writer should be rejected");
+
+    bst_writer_init(&writer, NULL, NULL, buffer, sizeof(buffer));
+    ASSERT_EQUAL(bst_writer_flush(&writer), -1, "Writer without a sink should fail");
+    bst_writer_init_fd(&writer, 1, buffer, 0);
+    ASSERT_EQUAL(bst_writer_put(&writer, "x", 1), -1, "Writer without buffer space should fail");
+
+    bst_delete_tree(root);
+    free(sink.data);
+}
+
+// Test: Dumps are byte-identical to the printf format
+TEST(test_writer_dump_format) {
+    int sizes[] = {0, 1, 2, 1000};
+    int spaces[] = {0, 3, -7};
+
+    for (size_t s = 0; s < 4; s++) {
+        BSTNode *root = build_cities(sizes[s]);
+
+        for (size_t capacity = 1; capacity <= 65536; capacity *= 16) {
+            char *buffer = (char *)malloc(capacity);
+            MemorySink expected = {0};
+            MemorySink actual = {0};
+            BSTWriter writer;
+
+            reference_inorder(&expected, root);
+            bst_writer_init(&writer, memory_write, &actual, buffer, capacity);
+            ASSERT_EQUAL(bst_write_inorder(root, &writer), 0, "In-order dump should succeed");
+            bst_writer_flush(&writer);
+            ASSERT_EQUAL(actual.len, expected.len, "In-order size mismatch");
+            ASSERT(actual.len == 0 || memcmp(actual.data, expected.data, actual.len) == 0,
+                   "In-order output mismatch");
+
+            for (size_t p = 0; p < 3; p++) {
+                expected.len = 0;
+                actual.len = 0;
+                reference_rotated(&expected, root, spaces[p], 0);
+                bst_writer_init(&writer, memory_write, &actual, buffer, capacity);
+                ASSERT_EQUAL(bst_write_rotated(root, spaces[p], &writer), 0, "Rotated dump should succeed");
+                bst_writer_flush(&writer);
+                ASSERT_EQUAL(actual.len, expected.len, "Rotated size mismatch");
+                ASSERT(actual.len == 0 || memcmp(actual.data, expected.data, actual.len) == 0,
+                       "Rotated output mismatch");
+            }
+
+            free(expected.data);
+            free(actual.data);
+            free(buffer);
+        }
+
+        bst_delete_tree(root);
+    }
+}
+
+// Test: Descriptor sink and stdout ordering of the print functions
+TEST(test_writer_fd) {
+    BSTNode *root = build_cities(2000);
+    MemorySink expected = {0};
+    reference_inorder(&expected, root);
+
+    // Through a descriptor, with stdio output printed before the dump
+    FILE *capture = tmpfile();
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    dup2(fileno(capture), STDOUT_FILENO);
+    printf("header\n");
+    bst_print_inorder(root);
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+
+    fseek(capture, 0, SEEK_END);
+    long size = ftell(capture);
+    char *data = (char *)malloc((size_t)size + 1);
+    rewind(capture);
+    size_t got = fread(data, 1, (size_t)size, capture);
+    fclose(capture);
+
+    ASSERT_EQUAL(got, expected.len + 7, "Captured size mismatch");
+    ASSERT(memcmp(data, "header\n", 7) == 0, "Earlier stdio output should come first");
+    ASSERT(memcmp(data + 7, expected.data, expected.len) == 0, "Printed output mismatch");
+
+    // A closed descriptor makes the writer fail
+    char buffer[16];
+    BSTWriter writer;
+    int fds[2];
+    ASSERT_EQUAL(pipe(fds), 0, "Pipe creation failed");
+    close(fds[0]);
+    close(fds[1]);
+    bst_writer_init_fd(&writer, fds[1], buffer, sizeof(buffer));
+    bst_writer_put(&writer, "0123456789abcdefXYZ", 19);
+    ASSERT_EQUAL(bst_writer_flush(&writer), -1, "Writing to a closed descriptor should fail");
+
+    free(data);
+    free(expected.data);
+    bst_delete_tree(root);
+}
+
+int main() {
+    print_test_header("BST Writer Unit Tests");
+
+    RUN_TEST(test_writer_buffering);
+    RUN_TEST(test_writer_failure);
+    RUN_TEST(test_writer_dump_format);
+    RUN_TEST(test_writer_fd);
+
+    return print_test_summary();
+}
@@ -0,0 +1,231 @@
+#include "city_catalog.h"
+#include "test_framework.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Test: Countries are kept sorted, each with its own tree
+TEST(test_catalog_countries) {
+    CityCatalog *catalog = city_catalog_create(0);
+    const char *nigeria[] = {"Lagos", "Abuja", "Kano"};
+    const char *ghana[] = {"Accra", "Kumasi"};
+
+    ASSERT_NOT_NULL(catalog, "Catalog creation failed");
+    ASSERT_EQUAL(city_catalog_load(catalog, "nigeria", nigeria, 3), 0, "Load should succeed");
+    ASSERT_EQUAL(city_catalog_load(catalog, "ghana", ghana, 2), 0, "Load should succeed");
+    BSTree *kenya = city_catalog_tree(catalog, "kenya");
+    ASSERT_NOT_NULL(kenya, "A missing country should be added");
+    ASSERT(city_catalog_tree(catalog, "kenya") == kenya, "An existing country should keep its tree");
+    ASSERT_EQUAL(bst_tree_insert(kenya, "Nairobi"), 1, "Country trees should be usable directly");
+
+    ASSERT_EQUAL(city_catalog_country_count(catalog), 3, "Three countries should be stored");
+    ASSERT_STR_EQUAL(city_catalog_country_at(catalog, 0), "ghana", "Countries should be sorted");
+    ASSERT_STR_EQUAL(city_catalog_country_at(catalog, 1), "kenya", "Countries should be sorted");
+    ASSERT_STR_EQUAL(city_catalog_country_at(catalog, 2), "nigeria", "Countries should be sorted");
+    ASSERT_NULL(city_catalog_country_at(catalog, 3), "Out-of-range index should give NULL");
+    ASSERT_EQUAL(city_catalog_city_count(catalog), 6, "Cities should be summed over countries");
+
+    ASSERT_NOT_NULL(bst_tree_search(city_catalog_find(catalog, "nigeria"), "Kano"), "Per-country search");
+    ASSERT_NULL(bst_tree_search(city_catalog_find(catalog, "ghana"), "Kano"), "Countries should not mix");
+    ASSERT_NULL(city_catalog_find(catalog, "peru"), "Find should not add countries");
+
+    // Reloading one country leaves the others' trees untouched
+    BSTNode *ghana_root = bst_tree_root(city_catalog_find(catalog, "ghana"));
+    const char *reload[] = {"Ibadan", "Lagos", "Ibadan"};
+    ASSERT_EQUAL(city_catalog_load(catalog, "nigeria", reload, 3), 0, "Reload should succeed");
+    ASSERT_EQUAL(bst_tree_count(city_catalog_find(catalog, "nigeria")), 2, "Reload should replace the cities");
+    ASSERT(bst_tree_root(city_catalog_find(catalog, "ghana")) == ghana_root, "Other countries should be untouched");
+
+    ASSERT_EQUAL(city_catalog_remove(catalog, "kenya"), 1, "Remove should succeed");
+    ASSERT_EQUAL(city_catalog_remove(catalog, "kenya"), 0, "Missing country should report 0");
+    ASSERT_EQUAL(city_catalog_remove(catalog, NULL), -1, "NULL country should be rejected");
+    ASSERT_EQUAL(city_catalog_country_count(catalog), 2, "Two countries should remain");
+    ASSERT_NULL(city_catalog_tree(NULL, "peru"), "NULL catalog should be rejected");
+    ASSERT_EQUAL(city_catalog_load(catalog, NULL, reload, 1), -1, "NULL country should be rejected");
+
+    city_catalog_destroy(catalog);
+    city_catalog_destroy(NULL);
+}
+
+/**
+ * Iterate a whole catalog into cities and countries, returning the count
+ */
+static size_t collect(CityCatalogIter *it, const char **cities, const char **countries, size_t max) {
+    size_t n = 0;
+    const char *city;
+    const char *country;
+
+    while (n < max && city_catalog_iter_next(it, &city, &country) == 1) {
+        cities[n] = city;
+        countries[n] = country;
+        n++;
+    }
+    return n;
+}
+
+// Test: The merged view lists every city in order, once per country holding it
+TEST(test_catalog_merge) {
+    CityCatalog *catalog = city_catalog_create(0);
+    const char *usa[] = {"San Jose", "Springfield", "Portland", "Victoria"};
+    const char *canada[] = {"Victoria", "Ottawa", "Portland"};
+    const char *costa_rica[] = {"San Jose", "Liberia"};
+    const char *cities[16];
+    const char *countries[16];
+
+    city_catalog_load(catalog, "usa", usa, 4);
+    city_catalog_load(catalog, "canada", canada, 3);
+    city_catalog_load(catalog, "costa rica", costa_rica, 2);
+    city_catalog_tree(catalog, "antarctica");
+
+    CityCatalogIter *it = city_catalog_iter_create(catalog, NULL);
+    ASSERT_NOT_NULL(it, "Iterator creation failed");
+    size_t n = collect(it, cities, countries, 16);
+    ASSERT_EQUAL(n, 9, "Every city of every country should be listed");
+    ASSERT_EQUAL(city_catalog_iter_next(it, NULL, NULL), 0, "The end should be reported again");
+    city_catalog_iter_destroy(it);
+
+    const char *expected[][2] = {
+        {"Liberia", "costa rica"}, {"Ottawa", "canada"}, {"Portland", "canada"},
+        {"Portland", "usa"},       {"San Jose", "costa rica"}, {"San Jose", "usa"},
+        {"Springfield", "usa"},    {"Victoria", "canada"}, {"Victoria", "usa"},
+    };
+    for (size_t i = 0; i < 9; i++) {
+        ASSERT_STR_EQUAL(cities[i], expected[i][0], "Cities should be merged in order");
+        ASSERT_STR_EQUAL(countries[i], expected[i][1], "Ties should follow country order");
+    }
+
+    // Start from a lower bound
+    it = city_catalog_iter_create(catalog, "Sao Paulo");
+    n = collect(it, cities, countries, 16);
+    ASSERT_EQUAL(n, 3, "Cities before the bound should be skipped");
+    ASSERT_STR_EQUAL(cities[0], "Springfield", "Iteration should start at the bound");
+    city_catalog_iter_destroy(it);
+
+    it = city_catalog_iter_create(catalog, "Zurich");
+    ASSERT_EQUAL(city_catalog_iter_next(it, NULL, NULL), 0, "A bound past every city should be empty");
+    city_catalog_iter_destroy(it);
+
+    city_catalog_destroy(catalog);
+}
+
+// Test: Changing the countries ends open iterations
+TEST(test_catalog_invalidation) {
+    CityCatalog *catalog = city_catalog_create(0);
+    const char *cities[] = {"Lima", "Cusco"};
+
+    CityCatalogIter *it = city_catalog_iter_create(catalog, NULL);
+    ASSERT_NOT_NULL(it, "Empty catalogs should be iterable");
+    ASSERT_EQUAL(city_catalog_iter_next(it, NULL, NULL), 0, "An empty catalog should list nothing");
+    city_catalog_iter_destroy(it);
+    ASSERT_NULL(city_catalog_iter_create(NULL, NULL), "NULL catalog should be rejected");
+    ASSERT_EQUAL(city_catalog_iter_next(NULL, NULL, NULL), -1, "NULL iterator should be rejected");
+
+    city_catalog_load(catalog, "peru", cities, 2);
+    it = city_catalog_iter_create(catalog, NULL);
+    ASSERT_EQUAL(city_catalog_iter_next(it, NULL, NULL), 1, "The first city should be listed");
+    city_catalog_load(catalog, "peru", cities, 1);
+    ASSERT_EQUAL(city_catalog_iter_next(it, NULL, NULL), -1, "A reload should end the iteration");
+    city_catalog_iter_destroy(it);
+
+    it = city_catalog_iter_create(catalog, NULL);
+    city_catalog_tree(catalog, "chile");
+    ASSERT_EQUAL(city_catalog_iter_next(it, NULL, NULL), -1, "A new country should end the iteration");
+    city_catalog_iter_destroy(it);
+
+    it = city_catalog_iter_create(catalog, NULL);
+    city_catalog_remove(catalog, "chile");
+    ASSERT_EQUAL(city_catalog_iter_next(it, NULL, NULL), -1, "A removal should end the iteration");
+    city_catalog_iter_destroy(it);
+
+    city_catalog_destroy(catalog);
+}
+
+// Test: Folded catalogs merge by folded keys; interned ones share long names
+TEST(test_catalog_folded_interned) {
+    CityCatalog *folded = city_catalog_create(BST_TREE_FOLD);
+    const char *norway[] = {"Ålesund", "Bergen", "oslo"};
+    const char *denmark[] = {"aarhus", "Odense", "ALESUND"};
+    const char *cities[16];
+    const char *countries[16];
+
+    city_catalog_load(folded, "norway", norway, 3);
+    city_catalog_load(folded, "denmark", denmark, 3);
+    CityCatalogIter *it = city_catalog_iter_create(folded, "ALES");
+    size_t n = collect(it, cities, countries, 16);
+    city_catalog_iter_destroy(it);
+
+    const char *expected[] = {"ALESUND", "Ålesund", "Bergen", "Odense", "oslo"};
+    ASSERT_EQUAL(n, 5, "Cities from the folded bound on should be listed");
+    for (size_t i = 0; i < 5 && i < n; i++) {
+        ASSERT_STR_EQUAL(cities[i], expected[i], "Cities should be merged in folded order");
+    }
+    city_catalog_destroy(folded);
+
+    CityCatalog *interned = city_catalog_create(BST_TREE_INTERN);
+    const char *long_names[] = {"San Cristobal de las Casas", "Villa de los Caballeros"};
+    city_catalog_load(interned, "mexico", long_names, 2);
+    city_catalog_load(interned, "spain", long_names, 2);
+    it = city_catalog_iter_create(interned, NULL);
+    n = collect(it, cities, countries, 16);
+    city_catalog_iter_destroy(it);
+
+    ASSERT_EQUAL(n, 4, "Both countries should be listed");
+    ASSERT(cities[0] == cities[1], "Equal long names should share one copy");
+    ASSERT_STR_EQUAL(countries[0], "mexico", "Ties should follow country order");
+    ASSERT_STR_EQUAL(countries[1], "spain", "Ties should follow country order");
+    city_catalog_destroy(interned);
+}
+
+// Test: Many countries with overlapping random cities merge into one sorted listing
+TEST(test_catalog_merge_random) {
+    enum { COUNTRIES = 60, PER_COUNTRY = 500 };
+    CityCatalog *catalog = city_catalog_create(BST_TREE_INTERN);
+    char storage[PER_COUNTRY][32];
+    const char *names[PER_COUNTRY];
+    char country[16];
+    unsigned seed = 12345;
+
+    for (int c = 0; c < COUNTRIES; c++) {
+        for (int i = 0; i < PER_COUNTRY; i++) {
+            seed = seed * 1103515245u + 12345u;
+            snprintf(storage[i], sizeof(storage[i]), "City %05u of the Long Valley", (seed >> 8) % 20000);
+            names[i] = storage[i];
+        }
+        snprintf(country, sizeof(country), "country%02d", c);
+        ASSERT_EQUAL(city_catalog_load(catalog, country, names, PER_COUNTRY), 0, "Load should succeed");
+    }
+
+    CityCatalogIter *it = city_catalog_iter_create(catalog, NULL);
+    const char *city;
+    const char *holder;
+    const char *previous = NULL;
+    const char *previous_holder = NULL;
+    size_t n = 0;
+    int ordered = 1;
+    while (city_catalog_iter_next(it, &city, &holder) == 1) {
+        if (previous) {
+            int cmp = strcmp(previous, city);
+            ordered &= cmp < 0 || (cmp == 0 && strcmp(previous_holder, holder) < 0);
+        }
+        previous = city;
+        previous_holder = holder;
+        n++;
+    }
+    city_catalog_iter_destroy(it);
+
+    ASSERT(ordered, "Cities should be in order, ties in country order");
+    ASSERT_EQUAL(n, city_catalog_city_count(catalog), "Every city should be listed once per country");
+    city_catalog_destroy(catalog);
+}
+
+int main() {
+    print_test_header("City Catalog Unit Tests");
+
+    RUN_TEST(test_catalog_countries);
+    RUN_TEST(test_catalog_merge);
+    RUN_TEST(test_catalog_invalidation);
+    RUN_TEST(test_catalog_folded_interned);
+    RUN_TEST(test_catalog_merge_random);
+
+    return print_test_summary();
+}
@@ -0,0 +1,191 @@
+#include "city_stream.h"
+#include "city_batch.h"
+#include "test_framework.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *SAMPLE =
+    "{\"error\": false, \"msg\": \"cities in nigeria retrieved\",\n"
+    " \"meta\": {\"data\": [\"Nested\"], \"n\": [1, -2.5e3, true, null]},\n"
+    " \"data\": [\"Aba\", \"Abuja\", \"Ado-Ekiti\", \"Ile-Ife\\u0301\", \"Lagos \\\"Island\\\"\",\n"
+    "          \"Port Harcourt\", \"\\u00c9tat\", \"\\ud83c\\udf0d City\"]}";
+
+static const char *SAMPLE_CITIES[] = {
+    "Aba", "Abuja", "Ado-Ekiti", "Ile-Ife\xcc\x81", "Lagos \"Island\"",
+    "Port Harcourt", "\xc3\x89tat", "\xf0\x9f\x8c\x8d City"
+};
+
+#define SAMPLE_COUNT (sizeof(SAMPLE_CITIES) / sizeof(SAMPLE_CITIES[0]))
+
+// Parse a whole document in fixed-size chunks into a batch
+static int parse_chunked(const char *doc, size_t chunk, CityBatch *batch, CityStream **out) {
+    CityStream *stream = city_stream_create(city_batch_collect, batch);
+    size_t len = strlen(doc);
+    int rc = 0;
+
+    for (size_t pos = 0; pos < len && rc == 0; pos += chunk) {
+        size_t n = len - pos < chunk ? len - pos : chunk;
+        rc = city_stream_feed(stream, doc + pos, n);
+    }
+    if (rc == 0) {
+        rc = city_stream_finish(stream);
+    }
+
+    *out = stream;
+    return rc;
+}
+
+// Stop after the second city
+static int stop_after_two(const char *city, size_t len, void *ctx) {
+    (void)city;
+    (void)len;
+    return ++*(int *)ctx == 2;
+}
+
+// Test: Every chunk size yields the same cities, decoded
+TEST(test_stream_chunk_boundaries) {
+    size_t chunks[] = {1, 2, 3, 7, 64, 4096};
+
+    for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+        CityBatch *batch = city_batch_create();
+        CityStream *stream = NULL;
+
+        ASSERT_EQUAL(parse_chunked(SAMPLE, chunks[c], batch, &stream), 0, "Sample should parse");
+        ASSERT_EQUAL(city_batch_count(batch), SAMPLE_COUNT, "All top-level cities should be reported");
+        ASSERT_EQUAL(city_stream_city_count(stream), SAMPLE_COUNT, "City count mismatch");
+
+        const char **names = city_batch_names(batch);
+        for (size_t i = 0; i < SAMPLE_COUNT; i++) {
+            ASSERT_STR_EQUAL(names[i], SAMPLE_CITIES[i], "City name mismatch");
+        }
+
+        ASSERT_EQUAL(city_stream_api_error(stream), 0, "error should be false");
+        ASSERT_STR_EQUAL(city_stream_message(stream), "cities in nigeria retrieved", "msg mismatch");
+        ASSERT_EQUAL(city_stream_has_data(stream), 1, "data should be present");
+        ASSERT_NULL(city_stream_error(stream), "No parse error expected");
+
+        city_stream_destroy(stream);
+        city_batch_destroy(batch);
+    }
+}
+
+// Test: API error documents are parsed and reported
+TEST(test_stream_api_error) {
+    CityBatch *batch = city_batch_create();
+    CityStream *stream = NULL;
+
+    ASSERT_EQUAL(parse_chunked("{\"error\":true,\"msg\":\"country not found\"}", 5, batch, &stream), 0,
+                 "Error document should parse");
+    ASSERT_EQUAL(city_stream_api_error(stream), 1, "error should be true");
+    ASSERT_STR_EQUAL(city_stream_message(stream), "country not found", "msg mismatch");
+    ASSERT_EQUAL(city_stream_has_data(stream), 0, "data should be absent");
+    ASSERT_EQUAL(city_batch_count(batch), 0, "No cities expected");
+
+    city_stream_destroy(stream);
+    city_batch_destroy(batch);
+}
+
+// Test: Malformed documents are rejected
+TEST(test_stream_malformed) {
+    const char *bad[] = {
+        "",
+        "{\"data\": [\"Aba\"",
+        "{\"data\": [\"Aba\",]}",
+        "{\"data\": [\"Aba\"]} x",
+        "{\"data\": [\"Ab\na\"]}",
+        "{\"data\": [\"\\x\"]}",
+        "{\"data\": [\"\\ud83c\"]}",
+        "{\"data\": [\"\\u0000\"]}",
+        "{\"data\": [tru]}",
+        "{\"data\": [01]}",
+        "{\"data\": [\"Aba\"}",
+        "{data: []}",
+    };
+
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        CityBatch *batch = city_batch_create();
+        CityStream *stream = NULL;
+
+        ASSERT_EQUAL(parse_chunked(bad[i], 1, batch, &stream), -1, "Malformed document should fail");
+        ASSERT_NOT_NULL(city_stream_error(stream), "Failure should have a reason");
+        ASSERT_EQUAL(city_stream_feed(stream, "{}", 2), -1, "A failed parser should stay failed");
+
+        city_stream_destroy(stream);
+        city_batch_destroy(batch);
+    }
+}
+
+// Test: An escape that overflows the string buffer fails instead of truncating
+TEST(test_stream_escape_too_long) {
+    enum { RUN = 64 * 1024 - 1 };
+    const char *head = "{\"data\":[\"";
+    const char *tail = "\\n\"]}";
+    char *doc = (char *)malloc(strlen(head) + RUN + strlen(tail) + 1);
+    CityBatch *batch = city_batch_create();
+    CityStream *stream = NULL;
+
+    ASSERT_NOT_NULL(doc, "Allocation failed");
+    strcpy(doc, head);
+    memset(doc + strlen(head), 'a', RUN);
+    strcpy(doc + strlen(head) + RUN, tail);
+
+    ASSERT_EQUAL(parse_chunked(doc, 4096, batch, &stream), -1, "Overlong string should fail");
+    ASSERT_STR_EQUAL(city_stream_error(stream), "string too long", "Failure should name the cause");
+    ASSERT_EQUAL(city_batch_count(batch), 0, "No truncated city should be delivered");
+
+    city_stream_destroy(stream);
+    city_batch_destroy(batch);
+    free(doc);
+}
+
+// Test: A nonzero callback result stops the parse
+TEST(test_stream_callback_abort) {
+    int seen = 0;
+    CityStream *stream = city_stream_create(stop_after_two, &seen);
+
+    ASSERT_EQUAL(city_stream_feed(stream, SAMPLE, strlen(SAMPLE)), -1, "Abort should fail the feed");
+    ASSERT_EQUAL(seen, 2, "Callback should not run after aborting");
+    ASSERT_NOT_NULL(city_stream_error(stream), "Abort should have a reason");
+
+    city_stream_destroy(stream);
+}
+
+// Test: A large document streams through with a bounded string buffer
+TEST(test_stream_large_document) {
+    CityBatch *batch = city_batch_create();
+    CityStream *stream = city_stream_create(city_batch_collect, batch);
+    char city[32];
+
+    ASSERT_EQUAL(city_stream_feed(stream, "{\"error\":false,\"data\":[", 23), 0, "Header should parse");
+    for (int i = 0; i < 100000; i++) {
+        int n = snprintf(city, sizeof(city), "%s\"City%06d\"", i ? "," : "", i);
+        ASSERT_EQUAL(city_stream_feed(stream, city, (size_t)n), 0, "City should parse");
+    }
+    ASSERT_EQUAL(city_stream_feed(stream, "]}", 2), 0, "Footer should parse");
+    ASSERT_EQUAL(city_stream_finish(stream), 0, "Document should be complete");
+
+    ASSERT_EQUAL(city_batch_count(batch), 100000, "All cities should be collected");
+    ASSERT_STR_EQUAL(city_batch_names(batch)[99999], "City099999", "Last city mismatch");
+
+    city_batch_clear(batch);
+    ASSERT_EQUAL(city_batch_count(batch), 0, "Cleared batch should be empty");
+    ASSERT_NULL(city_batch_names(batch), "Cleared batch should have no names");
+
+    city_stream_destroy(stream);
+    city_batch_destroy(batch);
+}
+
+// Main test runner
+int main() {
+    print_test_header("City Stream Unit Tests");
+
+    RUN_TEST(test_stream_chunk_boundaries);
+    RUN_TEST(test_stream_api_error);
+    RUN_TEST(test_stream_malformed);
+    RUN_TEST(test_stream_escape_too_long);
+    RUN_TEST(test_stream_callback_abort);
+    RUN_TEST(test_stream_large_document);
+
+    return print_test_summary();
+}
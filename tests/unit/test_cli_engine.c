@@ -0,0 +1,272 @@
+#include "bst_tree.h"
+#include "bst_writer.h"
+#include "cli_engine.h"
+#include "test_framework.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Helper: growable in-memory sink
+typedef struct MemorySink {
+    char *data;
+    size_t len;
+    size_t capacity;
+} MemorySink;
+
+static int memory_write(const char *data, size_t len, void *ctx) {
+    MemorySink *sink = (MemorySink *)ctx;
+
+    if (sink->len + len + 1 > sink->capacity) {
+        sink->capacity = (sink->len + len + 1) * 2;
+        sink->data = (char *)realloc(sink->data, sink->capacity);
+    }
+    memcpy(sink->data + sink->len, data, len);
+    sink->len += len;
+    sink->data[sink->len] = '\0';
+    return 0;
+}
+
+// Helper: a tree, an engine and the output it produced
+typedef struct Session {
+    BSTree *tree;
+    CliEngine *engine;
+    BSTWriter writer;
+    char buffer[256];
+    MemorySink sink;
+} Session;
+
+static void session_open(Session *session) {
+    memset(session, 0, sizeof(*session));
+    session->tree = bst_tree_create(0);
+    bst_writer_init(&session->writer, memory_write, &session->sink, session->buffer, sizeof(session->buffer));
+    session->engine = cli_engine_create(session->tree, &session->writer);
+}
+
+static void session_close(Session *session) {
+    cli_engine_destroy(session->engine);
+    bst_tree_destroy(session->tree);
+    free(session->sink.data);
+}
+
+static const char *session_output(Session *session) {
+    return session->sink.data ? session->sink.data : "";
+}
+
+// Helper: the rotated dump of a tree
+static void rotated_dump(BSTree *tree, MemorySink *sink) {
+    char buffer[256];
+    BSTWriter writer;
+
+    bst_writer_init(&writer, memory_write, sink, buffer, sizeof(buffer));
+    bst_write_rotated(bst_tree_root(tree), 0, &writer);
+    bst_writer_flush(&writer);
+}
+
+// Test: Commands update the tree and print shows it
+TEST(test_engine_commands) {
+    Session session;
+    CliEngineStats stats;
+    const char *script = "# setup\n"
+                         "add Paris\n"
+                         "  add   New York  \r\n"
+                         "\n"
+                         "add Berlin\n"
+                         "add Paris\n"
+                         "remove Berlin\n"
+                         "remove Oslo\n"
+                         "add Berlin\n"
+                         "print\n";
+
+    session_open(&session);
+    ASSERT_NOT_NULL(session.engine, "Engine creation failed");
+    ASSERT_EQUAL(cli_engine_feed(session.engine, script, strlen(script)), 0, "Feed should succeed");
+    ASSERT_EQUAL(cli_engine_finish(session.engine), 0, "Finish should succeed");
+
+    ASSERT_EQUAL(bst_tree_count(session.tree), 3, "Tree should hold three cities");
+    ASSERT_NOT_NULL(bst_tree_search(session.tree, "New York"), "City should be trimmed, inner blanks kept");
+    ASSERT_NOT_NULL(bst_tree_search(session.tree, "Berlin"), "Re-added city should be present");
+
+    MemorySink expected = {0};
+    rotated_dump(session.tree, &expected);
+    ASSERT_STR_EQUAL(session_output(&session), expected.data, "Print should dump the rotated tree");
+
+    cli_engine_stats(session.engine, &stats);
+    ASSERT_EQUAL(stats.lines, 10, "Line count mismatch");
+    ASSERT_EQUAL(stats.commands, 8, "Command count mismatch");
+    ASSERT_EQUAL(stats.added, 4, "Added count mismatch");
+    ASSERT_EQUAL(stats.removed, 1, "Removed count mismatch");
+    ASSERT_EQUAL(stats.batches, 3, "Runs of adds and removes should be batched");
+    ASSERT_EQUAL(stats.errors, 0, "No errors expected");
+
+    free(expected.data);
+    session_close(&session);
+}
+
+// Test: Large scripts are applied in few batches, in command order
+TEST(test_engine_batching) {
+    Session session;
+    CliEngineStats stats;
+    size_t capacity = 1 << 20;
+    char *script = (char *)malloc(capacity);
+    size_t len = 0;
+
+    for (int i = 0; i < 20000; i++) {
+        len += (size_t)snprintf(script + len, capacity - len, "add City %05d\n", i);
+    }
+    for (int i = 0; i < 20000; i += 2) {
+        len += (size_t)snprintf(script + len, capacity - len, "remove City %05d\n", i);
+    }
+    len += (size_t)snprintf(script + len, capacity - len, "add City 00000\n");
+
+    session_open(&session);
+    ASSERT_EQUAL(cli_engine_feed(session.engine, script, len), 0, "Feed should succeed");
+    ASSERT_EQUAL(cli_engine_finish(session.engine), 0, "Finish should succeed");
+
+    ASSERT_EQUAL(bst_tree_count(session.tree), 10001, "City count mismatch");
+    ASSERT_NOT_NULL(bst_tree_search(session.tree, "City 00000"), "Add after remove should win");
+    ASSERT_NULL(bst_tree_search(session.tree, "City 00002"), "Removed city should be gone");
+    ASSERT_NOT_NULL(bst_tree_search(session.tree, "City 19999"), "Kept city should be present");
+
+    cli_engine_stats(session.engine, &stats);
+    ASSERT_EQUAL(stats.commands, 30001, "Command count mismatch");
+    ASSERT(stats.batches < 30, "Commands should be applied in large batches");
+    ASSERT_EQUAL(session.sink.len, 0, "Adds and removes should be silent");
+
+    free(script);
+    session_close(&session);
+}
+
+// Test: Lines split across chunks give the same result as one chunk
+TEST(test_engine_chunking) {
+    const char *script = "add Alpha\nadd Beta\nremove Alpha\nadd Gamma Delta\nprint\nadd Last";
+    size_t len = strlen(script);
+    Session whole;
+    Session bytes;
+
+    session_open(&whole);
+    cli_engine_feed(whole.engine, script, len);
+    ASSERT_EQUAL(bst_tree_count(whole.tree), 2, "Unterminated last line should wait for finish");
+    cli_engine_finish(whole.engine);
+    ASSERT_EQUAL(bst_tree_count(whole.tree), 3, "Finish should run the last line");
+
+    session_open(&bytes);
+    for (size_t i = 0; i < len; i++) {
+        ASSERT_EQUAL(cli_engine_feed(bytes.engine, script + i, 1), 0, "Feed should succeed");
+    }
+    cli_engine_finish(bytes.engine);
+
+    ASSERT_EQUAL(bst_tree_count(bytes.tree), 3, "City count mismatch");
+    ASSERT_NOT_NULL(bst_tree_search(bytes.tree, "Gamma Delta"), "Split city should be reassembled");
+    ASSERT_NULL(bst_tree_search(bytes.tree, "Alpha"), "Removed city should be gone");
+    ASSERT_STR_EQUAL(session_output(&bytes), session_output(&whole), "Output should not depend on chunking");
+
+    session_close(&whole);
+    session_close(&bytes);
+}
+
+// Test: Malformed lines are reported and skipped
+TEST(test_engine_errors) {
+    Session session;
+    CliEngineStats stats;
+    const char *script = "add\n"
+                         "fly Paris\n"
+                         "print now\n"
+                         "add Bad\x01Name\n"
+                         "remove\n"
+                         "add Rome\n";
+
+    session_open(&session);
+    cli_engine_feed(session.engine, script, strlen(script));
+
+    // A line longer than the input buffer is dropped up to its newline
+    size_t long_len = 100000;
+    char *long_line = (char *)malloc(long_len);
+    memcpy(long_line, "add ", 4);
+    memset(long_line + 4, 'x', long_len - 4);
+    cli_engine_feed(session.engine, long_line, long_len);
+    cli_engine_feed(session.engine, "\nadd Oslo\n", 10);
+    cli_engine_finish(session.engine);
+
+    const char *expected = "line 1: missing city for 'add'\n"
+                           "line 2: unknown command 'fly'\n"
+                           "line 3: unexpected argument to 'print'\n"
+                           "line 4: control character in city for 'add'\n"
+                           "line 5: missing city for 'remove'\n"
+                           "line 7: line too long\n";
+    ASSERT_STR_EQUAL(session_output(&session), expected, "Error messages mismatch");
+    ASSERT_EQUAL(bst_tree_count(session.tree), 2, "Only valid adds should apply");
+    ASSERT_NOT_NULL(bst_tree_search(session.tree, "Oslo"), "Input after a long line should be read");
+
+    cli_engine_stats(session.engine, &stats);
+    ASSERT_EQUAL(stats.errors, 6, "Error count mismatch");
+    ASSERT_EQUAL(stats.commands, 2, "Command count mismatch");
+
+    ASSERT_NULL(cli_engine_create(NULL, &session.writer), "NULL tree should be rejected");
+    ASSERT_EQUAL(cli_engine_feed(NULL, "x", 1), -1, "NULL engine should be rejected");
+
+    free(long_line);
+    session_close(&session);
+}
+
+// Test: Stop applies queued commands and ends the input
+TEST(test_engine_stop) {
+    Session session;
+    const char *script = "add Lima\nadd Quito\nstop\nadd Bogota\nprint\n";
+
+    session_open(&session);
+    cli_engine_feed(session.engine, script, strlen(script));
+    ASSERT(cli_engine_stopped(session.engine), "Engine should be stopped");
+    cli_engine_feed(session.engine, "add Caracas\n", 12);
+    ASSERT_EQUAL(cli_engine_finish(session.engine), 0, "Finish should succeed");
+
+    ASSERT_EQUAL(bst_tree_count(session.tree), 2, "Commands after stop should be ignored");
+    ASSERT_EQUAL(session.sink.len, 0, "Print after stop should not run");
+
+    session_close(&session);
+}
+
+// Test: Reading commands from a descriptor
+TEST(test_engine_read_fd) {
+    Session session;
+    FILE *input = tmpfile();
+
+    for (int i = 0; i < 50000; i++) {
+        fprintf(input, "add Town %06d\n", i);
+    }
+    fprintf(input, "remove Town 000000\nprint");
+    fflush(input);
+    rewind(input);
+
+    session_open(&session);
+    long got;
+    int reads = 0;
+    while ((got = cli_engine_read(session.engine, fileno(input))) > 0) {
+        reads++;
+    }
+    ASSERT_EQUAL(got, 0, "Read should end at end of input");
+    ASSERT(reads < 50, "Input should be read in large blocks");
+    ASSERT_EQUAL(cli_engine_finish(session.engine), 0, "Finish should succeed");
+    ASSERT_EQUAL(bst_tree_count(session.tree), 49999, "City count mismatch");
+
+    MemorySink expected = {0};
+    rotated_dump(session.tree, &expected);
+    ASSERT_STR_EQUAL(session_output(&session), expected.data, "Final print should run at finish");
+
+    free(expected.data);
+    fclose(input);
+    session_close(&session);
+}
+
+int main() {
+    print_test_header("CLI Engine Unit Tests");
+
+    RUN_TEST(test_engine_commands);
+    RUN_TEST(test_engine_batching);
+    RUN_TEST(test_engine_chunking);
+    RUN_TEST(test_engine_errors);
+    RUN_TEST(test_engine_stop);
+    RUN_TEST(test_engine_read_fd);
+
+    return print_test_summary();
+}
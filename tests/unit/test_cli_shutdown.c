@@ -0,0 +1,212 @@
+#include "cli_shutdown.h"
+#include "test_framework.h"
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Helper: check whether the wake pipe is readable without blocking
+static int wake_ready(int wake_fd) {
+    struct pollfd fds[1] = {{wake_fd, POLLIN, 0}};
+    return poll(fds, 1, 0) == 1 && (fds[0].revents & POLLIN);
+}
+
+// Test: A signal is recorded and wakes the pipe instead of killing the process
+TEST(test_shutdown_signal) {
+    int wake_fd = cli_shutdown_install();
+    ASSERT(wake_fd >= 0, "Install should succeed");
+    ASSERT_EQUAL(cli_shutdown_install(), wake_fd, "Installing twice should reuse the pipe");
+    ASSERT_EQUAL(cli_shutdown_signal(), 0, "No signal should be recorded yet");
+    ASSERT(!wake_ready(wake_fd), "Pipe should be empty");
+
+    raise(SIGTERM);
+    ASSERT_EQUAL(cli_shutdown_signal(), SIGTERM, "SIGTERM should be recorded");
+    ASSERT(wake_ready(wake_fd), "Pipe should be readable");
+
+    cli_shutdown_uninstall();
+    ASSERT_EQUAL(cli_shutdown_signal(), 0, "Uninstall should forget the signal");
+
+    wake_fd = cli_shutdown_install();
+    raise(SIGINT);
+    ASSERT_EQUAL(cli_shutdown_signal(), SIGINT, "SIGINT should be recorded");
+    cli_shutdown_uninstall();
+}
+
+// Test: A blocked reader wakes up and exits through its normal path
+TEST(test_shutdown_wakes_poll) {
+    int ready[2];
+    int input[2];
+    ASSERT_EQUAL(pipe(ready), 0, "Pipe creation failed");
+    ASSERT_EQUAL(pipe(input), 0, "Pipe creation failed");
+
+    pid_t child = fork();
+    ASSERT(child >= 0, "Fork failed");
+    if (child == 0) {
+        // Wait on input that never arrives, as the CLI loop does
+        int wake_fd = cli_shutdown_install();
+        char byte = 1;
+        if (write(ready[1], &byte, 1) != 1) {
+            _exit(2);
+        }
+        struct pollfd fds[2] = {{input[0], POLLIN, 0}, {wake_fd, POLLIN, 0}};
+        while (!cli_shutdown_signal()) {
+            if (poll(fds, 2, -1) < 0 && errno != EINTR) {
+                _exit(3);
+            }
+        }
+        _exit(cli_shutdown_signal() == SIGTERM ? 0 : 4);
+    }
+
+    char byte;
+    ASSERT_EQUAL(read(ready[0], &byte, 1), 1, "Child should report readiness");
+    kill(child, SIGTERM);
+    int status;
+    waitpid(child, &status, 0);
+    ASSERT(WIFEXITED(status), "Child should exit normally, not be killed");
+    ASSERT_EQUAL(WEXITSTATUS(status), 0, "Child should see SIGTERM");
+
+    close(ready[0]);
+    close(ready[1]);
+    close(input[0]);
+    close(input[1]);
+}
+
+// Test: A second signal during shutdown forces the default action
+TEST(test_shutdown_forced) {
+    pid_t child = fork();
+    ASSERT(child >= 0, "Fork failed");
+    if (child == 0) {
+        cli_shutdown_install();
+        raise(SIGTERM);
+        raise(SIGTERM);
+        _exit(0);
+    }
+
+    int status;
+    waitpid(child, &status, 0);
+    ASSERT(WIFSIGNALED(status) && WTERMSIG(status) == SIGTERM, "Second signal should kill the process");
+}
+
+// Test: The stop command ends the program while its input is still open
+TEST(test_shutdown_stop_command) {
+    int input[2];
+    int output[2];
+    ASSERT_EQUAL(pipe(input), 0, "Pipe creation failed");
+    ASSERT_EQUAL(pipe(output), 0, "Pipe creation failed");
+
+    pid_t child = fork();
+    ASSERT(child >= 0, "Fork failed");
+    if (child == 0) {
+        dup2(input[0], STDIN_FILENO);
+        dup2(output[1], STDOUT_FILENO);
+        close(input[1]);
+        close(output[0]);
+        execl(CITYSORTER_PATH, "citysorter", (char *)NULL);
+        _exit(127);
+    }
+    close(input[0]);
+    close(output[1]);
+
+    const char *commands = "add Zurich\nadd Aba\nstop\n";
+    ASSERT_EQUAL(write(input[1], commands, strlen(commands)), (ssize_t)strlen(commands), "Write failed");
+
+    // Keep the write end open; the child has to leave on its own
+    int status = 0;
+    pid_t done = 0;
+    for (int waited = 0; waited < 200 && done == 0; waited++) {
+        done = waitpid(child, &status, WNOHANG);
+        if (done == 0) {
+            usleep(10000);
+        }
+    }
+    if (done == 0) {
+        kill(child, SIGKILL);
+        waitpid(child, &status, 0);
+    }
+    close(input[1]);
+    close(output[0]);
+
+    ASSERT(done == child, "stop should end the program without waiting for end of input");
+    ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == 0, "stop should exit cleanly");
+}
+
+/**
+ * Run citysorter (argv[0] included, NULL-terminated) on input, capturing up to size - 1 bytes of output
+ * Returns the exit status, or -1 if the program could not be run.
+ */
+static int run_cli(char *const argv[], const char *input, char *output, size_t size) {
+    int in[2];
+    int out[2];
+    if (pipe(in) != 0 || pipe(out) != 0) {
+        return -1;
+    }
+
+    pid_t child = fork();
+    if (child < 0) {
+        return -1;
+    }
+    if (child == 0) {
+        dup2(in[0], STDIN_FILENO);
+        dup2(out[1], STDOUT_FILENO);
+        close(in[1]);
+        close(out[0]);
+        execv(CITYSORTER_PATH, argv);
+        _exit(127);
+    }
+    close(in[0]);
+    close(out[1]);
+
+    ssize_t written = write(in[1], input, strlen(input));
+    close(in[1]);
+    size_t used = 0;
+    ssize_t got;
+    while (used + 1 < size && (got = read(out[0], output + used, size - 1 - used)) > 0) {
+        used += (size_t)got;
+    }
+    output[used] = '\0';
+    close(out[0]);
+
+    int status;
+    waitpid(child, &status, 0);
+    return written < 0 || !WIFEXITED(status) ? -1 : WEXITSTATUS(status);
+}
+
+// Test: The tree saved on exit is loaded again at the next start
+TEST(test_shutdown_snapshot_restart) {
+    char path[64];
+    char output[256];
+    snprintf(path, sizeof(path), "/tmp/citysorter-cli-XXXXXX");
+    int fd = mkstemp(path);
+    ASSERT(fd >= 0, "Temporary file creation failed");
+    close(fd);
+    unlink(path);
+
+    char *save[] = {"citysorter", "--snapshot", path, NULL};
+    char *verify[] = {"citysorter", "--verify-snapshot", "--snapshot", path, NULL};
+
+    ASSERT_EQUAL(run_cli(save, "add Zurich\nadd Aba\nstop\n", output, sizeof(output)), 0,
+                 "First run should succeed");
+    ASSERT_EQUAL(run_cli(save, "print\nstop\n", output, sizeof(output)), 0, "Restart should succeed");
+    ASSERT(strstr(output, "Zurich") && strstr(output, "Aba"), "Cities should survive the restart");
+
+    ASSERT_EQUAL(run_cli(verify, "remove Aba\nprint\n", output, sizeof(output)), 0,
+                 "A verified restart should succeed");
+    ASSERT(strstr(output, "Zurich") && !strstr(output, "Aba"), "The verified snapshot should be loaded");
+    unlink(path);
+}
+
+int main() {
+    print_test_header("CLI Shutdown Unit Tests");
+
+    RUN_TEST(test_shutdown_signal);
+    RUN_TEST(test_shutdown_wakes_poll);
+    RUN_TEST(test_shutdown_forced);
+    RUN_TEST(test_shutdown_stop_command);
+    RUN_TEST(test_shutdown_snapshot_restart);
+
+    return print_test_summary();
+}
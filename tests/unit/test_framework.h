@@ -0,0 +1,72 @@
+#ifndef TEST_FRAMEWORK_H
+#define TEST_FRAMEWORK_H
+
+#include <stdio.h>
+#include <string.h>
+
+// Test statistics
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+// Color codes for terminal output
+#define COLOR_GREEN "\033[0;32m"
+#define COLOR_RED "\033[0;31m"
+#define COLOR_RESET "\033[0m"
+#define COLOR_YELLOW "\033[0;33m"
+#define COLOR_CYAN "\033[0;36m"
+
+// Test macros
+#define TEST(name) void name()
+#define RUN_TEST(test) do { \
+    printf(COLOR_CYAN "Running: %s" COLOR_RESET "\n", #test); \
+    tests_run++; \
+    test(); \
+    tests_passed++; \
+    printf(COLOR_GREEN "✓ PASSED: %s" COLOR_RESET "\n\n", #test); \
+} while(0)
+
+#define ASSERT(condition, message) do { \
+    if (!(condition)) { \
+        printf(COLOR_RED "✗ FAILED: %s" COLOR_RESET "\n", message); \
+        printf("  at %s:%d\n\n", __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+#define ASSERT_NULL(ptr, message) ASSERT((ptr) == NULL, message)
+#define ASSERT_NOT_NULL(ptr, message) ASSERT((ptr) != NULL, message)
+#define ASSERT_EQUAL(a, b, message) ASSERT((a) == (b), message)
+#define ASSERT_STR_EQUAL(a, b, message) ASSERT(strcmp((a), (b)) == 0, message)
+
+// Print the banner shown before a test suite runs
+static void print_test_header(const char *title) {
+    printf("\n");
+    printf("================================================\n");
+    printf("         %s\n", title);
+    printf("================================================\n\n");
+}
+
+// Print the summary and return the process exit code
+static int print_test_summary(void) {
+    printf("================================================\n");
+    printf("         Test Summary\n");
+    printf("================================================\n");
+    printf("Tests Run:    %s%d%s\n", COLOR_CYAN, tests_run, COLOR_RESET);
+    printf("Tests Passed: %s%d%s\n", COLOR_GREEN, tests_passed, COLOR_RESET);
+    printf("Tests Failed: %s%d%s\n", tests_failed > 0 ? COLOR_RED : COLOR_GREEN, tests_failed, COLOR_RESET);
+    printf("------------------------------------------------\n");
+
+    if (tests_failed == 0) {
+        printf("%s✓ All tests passed!%s\n", COLOR_GREEN, COLOR_RESET);
+        printf("================================================\n\n");
+        return 0;
+    } else {
+        printf("%s✗ Some tests failed!%s\n", COLOR_RED, COLOR_RESET);
+        printf("================================================\n\n");
+        return 1;
+    }
+}
+
+#endif // TEST_FRAMEWORK_H